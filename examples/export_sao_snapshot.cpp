@@ -0,0 +1,72 @@
+/**
+ * @file export_sao_snapshot.cpp
+ * @brief Esporta il database Gaia-SAO in uno snapshot binario mappabile
+ *
+ * Uso: export_sao_snapshot [database.db] [snapshot.bin]
+ *
+ * Dopo l'esportazione lo snapshot viene riaperto e confrontato con il
+ * database SQLite su un campione di ricerche.
+ */
+
+#include <starmap/catalog/GaiaSAODatabase.h>
+#include <starmap/catalog/GaiaSAOSnapshot.h>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+using namespace starmap;
+
+int main(int argc, char* argv[]) {
+    std::string dbPath = argc > 1 ? argv[1] : "gaia_sao_xmatch.db";
+    std::string snapshotPath = argc > 2 ? argv[2] : "gaia_sao_xmatch.snapshot";
+
+    std::cout << "=== Export snapshot Gaia-SAO ===\n\n";
+
+    catalog::GaiaSAODatabase db(dbPath);
+    if (!db.isAvailable() || db.isSnapshot()) {
+        std::cerr << "✗ Database SQLite non disponibile: " << dbPath << "\n";
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if (!db.exportSnapshot(snapshotPath)) {
+        std::cerr << "✗ Esportazione fallita\n";
+        return 1;
+    }
+    auto exported = std::chrono::steady_clock::now();
+    std::cout << "✓ Snapshot scritto in " << snapshotPath << " ("
+              << std::chrono::duration<double, std::milli>(exported - start).count()
+              << " ms)\n";
+
+    // Riapertura: solo mmap e validazione dell'header
+    start = std::chrono::steady_clock::now();
+    catalog::GaiaSAODatabase snapshotDb(snapshotPath);
+    auto opened = std::chrono::steady_clock::now();
+    if (!snapshotDb.isAvailable() || !snapshotDb.isSnapshot()) {
+        std::cerr << "✗ Impossibile riaprire lo snapshot\n";
+        return 1;
+    }
+    std::cout << "✓ Snapshot aperto in "
+              << std::chrono::duration<double, std::micro>(opened - start).count() << " us\n\n";
+    std::cout << snapshotDb.getStatistics() << "\n";
+
+    // Confronto su un campione di coni: stesse stelle e stessi SAO
+    catalog::GaiaSAOSnapshot snapshot(snapshotPath);
+    size_t checked = 0, mismatches = 0;
+    for (int i = 0; i < 100; ++i) {
+        core::EquatorialCoordinates center(i * 3.6, -80.0 + i * 1.6);
+        auto entries = db.coneSearch(center, 1.0, 100000);
+        auto fromSnapshot = snapshotDb.coneSearch(center, 1.0, 100000);
+        if (entries.size() != fromSnapshot.size()) mismatches++;
+
+        for (const auto& entry : entries) {
+            auto row = snapshot.findBySourceId(entry.gaiaSourceId);
+            if (!row || snapshot.saoNumber(*row) != entry.saoNumber) mismatches++;
+            checked++;
+        }
+    }
+
+    std::cout << "Verifica: " << checked << " entry confrontate, "
+              << mismatches << " differenze\n";
+    return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,218 @@
+/**
+ * @file loopback_http_server.h
+ * @brief Server HTTP/1.1 minimale su 127.0.0.1 per i test dei client HTTP
+ *
+ * Sostituisce VizieR/SIMBAD nei test: ogni richiesta viene passata a un
+ * handler che restituisce stato, header e corpo. Supporta keep-alive,
+ * quindi i test possono contare le connessioni aperte dai client.
+ */
+
+#ifndef STARMAP_EXAMPLES_LOOPBACK_HTTP_SERVER_H
+#define STARMAP_EXAMPLES_LOOPBACK_HTTP_SERVER_H
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace starmap {
+namespace examples {
+
+struct LoopbackRequest {
+    std::string method;
+    std::string target;                          // Path e query
+    std::map<std::string, std::string> headers;  // Nomi in minuscolo
+    std::string body;
+};
+
+struct LoopbackResponse {
+    int status = 200;
+    std::map<std::string, std::string> headers;
+    std::string body;
+};
+
+class LoopbackHttpServer {
+public:
+    using Handler = std::function<LoopbackResponse(const LoopbackRequest&)>;
+
+    explicit LoopbackHttpServer(Handler handler) : handler_(std::move(handler)) {
+        listenFd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        int yes = 1;
+        ::setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;   // Porta scelta dal sistema
+        if (::bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            ::listen(listenFd_, 128) != 0) {
+            ::close(listenFd_);
+            listenFd_ = -1;
+            return;
+        }
+        socklen_t len = sizeof(addr);
+        ::getsockname(listenFd_, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+
+        acceptThread_ = std::thread([this] { acceptLoop(); });
+    }
+
+    ~LoopbackHttpServer() {
+        stopping_ = true;
+        if (listenFd_ >= 0) {
+            ::shutdown(listenFd_, SHUT_RDWR);
+            ::close(listenFd_);
+        }
+        if (acceptThread_.joinable()) acceptThread_.join();
+
+        std::vector<std::thread> workers;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (int fd : clients_) ::shutdown(fd, SHUT_RDWR);
+            workers.swap(workers_);
+        }
+        for (auto& worker : workers) worker.join();
+    }
+
+    bool isRunning() const { return port_ != 0; }
+    int port() const { return port_; }
+    std::string url(const std::string& path) const {
+        return "http://127.0.0.1:" + std::to_string(port_) + path;
+    }
+
+    size_t requests() const { return requests_; }
+    size_t connections() const { return connections_; }
+
+private:
+    void acceptLoop() {
+        while (!stopping_) {
+            int fd = ::accept(listenFd_, nullptr, nullptr);
+            if (fd < 0) {
+                if (stopping_) return;
+                continue;
+            }
+            connections_++;
+            std::lock_guard<std::mutex> lock(mutex_);
+            clients_.push_back(fd);
+            workers_.emplace_back([this, fd] { serve(fd); });
+        }
+    }
+
+    void serve(int fd) {
+        std::string buffer;
+        char chunk[8192];
+        for (;;) {
+            // Header completi
+            size_t headerEnd;
+            while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+                ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0) return finish(fd);
+                buffer.append(chunk, static_cast<size_t>(n));
+            }
+
+            LoopbackRequest request;
+            std::string head = buffer.substr(0, headerEnd);
+            buffer.erase(0, headerEnd + 4);
+
+            size_t lineEnd = head.find("\r\n");
+            std::string requestLine = head.substr(0, lineEnd);
+            size_t sp1 = requestLine.find(' ');
+            size_t sp2 = requestLine.find(' ', sp1 + 1);
+            request.method = requestLine.substr(0, sp1);
+            request.target = requestLine.substr(sp1 + 1, sp2 - sp1 - 1);
+
+            size_t pos = lineEnd == std::string::npos ? head.size() : lineEnd + 2;
+            while (pos < head.size()) {
+                size_t end = head.find("\r\n", pos);
+                if (end == std::string::npos) end = head.size();
+                std::string line = head.substr(pos, end - pos);
+                size_t colon = line.find(':');
+                if (colon != std::string::npos) {
+                    std::string name = line.substr(0, colon);
+                    std::transform(name.begin(), name.end(), name.begin(),
+                                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+                    size_t valueStart = line.find_first_not_of(' ', colon + 1);
+                    request.headers[name] = valueStart == std::string::npos ? "" : line.substr(valueStart);
+                }
+                pos = end + 2;
+            }
+
+            size_t contentLength = 0;
+            auto it = request.headers.find("content-length");
+            if (it != request.headers.end()) contentLength = std::stoul(it->second);
+            while (buffer.size() < contentLength) {
+                ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0) return finish(fd);
+                buffer.append(chunk, static_cast<size_t>(n));
+            }
+            request.body = buffer.substr(0, contentLength);
+            buffer.erase(0, contentLength);
+
+            requests_++;
+            LoopbackResponse response = handler_(request);
+
+            std::string out = "HTTP/1.1 " + std::to_string(response.status) + " " +
+                              reason(response.status) + "\r\n";
+            for (const auto& [name, value] : response.headers) {
+                out += name + ": " + value + "\r\n";
+            }
+            out += "Content-Length: " + std::to_string(response.body.size()) + "\r\n\r\n";
+            out += response.body;
+
+            size_t sent = 0;
+            while (sent < out.size()) {
+                ssize_t n = ::send(fd, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+                if (n <= 0) return finish(fd);
+                sent += static_cast<size_t>(n);
+            }
+
+            auto connection = request.headers.find("connection");
+            if (connection != request.headers.end() && connection->second == "close") {
+                return finish(fd);
+            }
+        }
+    }
+
+    void finish(int fd) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        clients_.erase(std::remove(clients_.begin(), clients_.end(), fd), clients_.end());
+        ::close(fd);
+    }
+
+    static const char* reason(int status) {
+        switch (status) {
+            case 200: return "OK";
+            case 304: return "Not Modified";
+            case 404: return "Not Found";
+            case 429: return "Too Many Requests";
+            case 503: return "Service Unavailable";
+            default: return "Status";
+        }
+    }
+
+    Handler handler_;
+    int listenFd_ = -1;
+    int port_ = 0;
+    std::atomic<bool> stopping_{false};
+    std::atomic<size_t> requests_{0};
+    std::atomic<size_t> connections_{0};
+    std::thread acceptThread_;
+    std::mutex mutex_;
+    std::vector<int> clients_;
+    std::vector<std::thread> workers_;
+};
+
+} // namespace examples
+} // namespace starmap
+
+#endif // STARMAP_EXAMPLES_LOOPBACK_HTTP_SERVER_H
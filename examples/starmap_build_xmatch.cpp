@@ -0,0 +1,730 @@
+/**
+ * @file starmap_build_xmatch.cpp
+ * @brief Costruisce il database di cross-match Gaia-SAO da file locali
+ *
+ * Alternativa nativa a scripts/build_gaia_sao_database.py: invece di una
+ * query al Gaia Archive per ogni stella SAO, legge in streaming una
+ * tabella SAO (VizieR I/131A) e una o più tabelle di sorgenti Gaia DR3
+ * (VOTable o CSV, ad esempio esportate dal Gaia Archive) e le confronta in
+ * memoria:
+ *
+ * 1. le stelle SAO vengono ordinate per pixel di SkyIndex (indice spaziale);
+ * 2. le sorgenti Gaia arrivano a blocchi dal lettore e ogni blocco viene
+ *    confrontato in parallelo (OpenMP), riportando le posizioni a J2000
+ *    con il moto proprio se presente;
+ * 3. per ogni SAO si tengono le sorgenti Gaia più vicine entro il raggio;
+ *    le coppie vengono assegnate dalla più vicina, e una SAO la cui
+ *    sorgente è già presa da una SAO più vicina passa al candidato
+ *    successivo;
+ * 4. le righe, già ordinate, vengono caricate con journal e sync
+ *    disattivati e INSERT a più righe; indici e ANALYZE solo alla fine.
+ *
+ * Il risultato ha lo schema corrente di GaiaSAOSchema (tabella sao_xmatch
+ * con indici coprenti); le stelle SAO senza controparte Gaia sono incluse
+ * con chiave -SAO, come nei database migrati.
+ *
+ * Uso: starmap_build_xmatch --sao sao.vot --gaia gaia.csv [--gaia ...]
+ *          [--output gaia_sao_xmatch.db] [--radius 5] [--max-dmag 0]
+ *          [--gaia-epoch 2016.0] [--threads N]
+ */
+
+#include <starmap/catalog/GaiaSAODatabase.h>
+#include <starmap/catalog/GaiaSAOSchema.h>
+#include <starmap/catalog/SkyIndex.h>
+#include <starmap/catalog/VOTableReader.h>
+#include <starmap/core/UnitVector.h>
+#include <sqlite3.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace starmap;
+using catalog::SkyIndex;
+using Clock = std::chrono::steady_clock;
+
+constexpr double DEG_TO_RAD = M_PI / 180.0;
+constexpr double MAS_TO_DEG = 1.0 / 3.6e6;
+
+// Righe per blocco letto dai file e confrontato in parallelo
+constexpr size_t BLOCK_ROWS = 65536;
+
+// Righe per INSERT (al più 7 parametri per riga: sotto il limite di 999)
+constexpr size_t INSERT_ROWS = 128;
+
+constexpr size_t READ_CHUNK = 1 << 20;
+
+// Candidati Gaia tenuti per ogni SAO (i più vicini) per risolvere i conflitti
+constexpr size_t MAX_CANDIDATES = 4;
+
+/**
+ * @brief Blocco di righe letto da una tabella (NaN = valore mancante)
+ */
+struct RowBlock {
+    std::vector<long long> ids;
+    std::vector<double> ra;
+    std::vector<double> dec;
+    std::vector<double> mag;
+    std::vector<double> pmra;       // mas/anno (solo Gaia)
+    std::vector<double> pmdec;
+
+    size_t size() const { return ids.size(); }
+
+    void clear() {
+        ids.clear(); ra.clear(); dec.clear(); mag.clear(); pmra.clear(); pmdec.clear();
+    }
+};
+
+/**
+ * @brief Nomi accettati per ogni colonna (il primo presente nel file vale)
+ */
+struct ColumnNames {
+    std::vector<std::string> id, ra, dec, mag, pmra, pmdec;
+};
+
+static const ColumnNames SAO_COLUMNS = {
+    {"SAO"}, {"_RAJ2000", "RAdeg", "ra", "RA"}, {"_DEJ2000", "DEdeg", "dec", "DEC"},
+    {"Vmag", "vmag", "mag"}, {}, {}
+};
+
+static const ColumnNames GAIA_COLUMNS = {
+    {"source_id", "SOURCE_ID", "Source"}, {"ra", "RA_ICRS"}, {"dec", "DE_ICRS"},
+    {"phot_g_mean_mag", "Gmag"}, {"pmra", "pmRA"}, {"pmdec", "pmDE"}
+};
+
+using BlockCallback = std::function<void(const RowBlock&)>;
+
+/**
+ * @brief Indice della prima colonna presente tra i nomi accettati, -1 se nessuna
+ */
+static int findColumn(const std::vector<std::string>& header, const std::vector<std::string>& names) {
+    for (const auto& name : names) {
+        auto it = std::find(header.begin(), header.end(), name);
+        if (it != header.end()) return static_cast<int>(it - header.begin());
+    }
+    return -1;
+}
+
+struct ColumnMap {
+    int id = -1, ra = -1, dec = -1, mag = -1, pmra = -1, pmdec = -1;
+
+    ColumnMap(const std::vector<std::string>& header, const ColumnNames& names)
+        : id(findColumn(header, names.id)), ra(findColumn(header, names.ra)),
+          dec(findColumn(header, names.dec)), mag(findColumn(header, names.mag)),
+          pmra(findColumn(header, names.pmra)), pmdec(findColumn(header, names.pmdec)) {}
+
+    bool valid() const { return id >= 0 && ra >= 0 && dec >= 0; }
+};
+
+static bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() &&
+           text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/**
+ * @brief Legge una tabella VOTable a blocchi con VOTableReader
+ */
+static bool readVOTable(const std::string& path, const ColumnNames& names, const BlockCallback& onBlock) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        std::cerr << "✗ Impossibile aprire " << path << "\n";
+        return false;
+    }
+
+    RowBlock block;
+    bool columnsFound = true;
+    catalog::VOTableReader reader([&](size_t, const catalog::VOTableColumns& columns) {
+        std::vector<std::string> header;
+        for (const auto& field : columns.fields()) header.push_back(field.name);
+        ColumnMap map(header, names);
+        if (!map.valid()) {
+            columnsFound = false;
+            return;
+        }
+
+        const double nan = std::numeric_limits<double>::quiet_NaN();
+        auto real = [&columns, nan](int column, size_t row) {
+            return column >= 0 ? columns.getReal(column, row).value_or(nan) : nan;
+        };
+        block.clear();
+        for (size_t row = 0; row < columns.rowCount(); ++row) {
+            auto id = columns.getInteger(map.id, row);
+            if (!id) continue;
+            block.ids.push_back(*id);
+            block.ra.push_back(real(map.ra, row));
+            block.dec.push_back(real(map.dec, row));
+            block.mag.push_back(real(map.mag, row));
+            block.pmra.push_back(real(map.pmra, row));
+            block.pmdec.push_back(real(map.pmdec, row));
+        }
+        onBlock(block);
+    }, BLOCK_ROWS);
+
+    std::vector<char> buffer(READ_CHUNK);
+    while (file) {
+        file.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        if (file.gcount() > 0 && !reader.feed(buffer.data(), static_cast<size_t>(file.gcount()))) break;
+    }
+    if (!reader.finish()) {
+        std::cerr << "✗ " << path << ": " << reader.getError() << "\n";
+        return false;
+    }
+    if (!columnsFound) {
+        std::cerr << "✗ " << path << ": colonne identificativo/RA/Dec non trovate\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Divide una riga CSV (virgolette semplici, senza separatori nei campi)
+ */
+static void splitCsv(const std::string& line, std::vector<std::string>& fields) {
+    fields.clear();
+    size_t start = 0;
+    while (true) {
+        size_t end = line.find(',', start);
+        std::string field = line.substr(start, end == std::string::npos ? std::string::npos : end - start);
+        if (!field.empty() && field.back() == '\r') field.pop_back();
+        if (field.size() >= 2 && field.front() == '"' && field.back() == '"') {
+            field = field.substr(1, field.size() - 2);
+        }
+        fields.push_back(field);
+        if (end == std::string::npos) break;
+        start = end + 1;
+    }
+}
+
+/**
+ * @brief Legge una tabella CSV con intestazione a blocchi di BLOCK_ROWS righe
+ */
+static bool readCsv(const std::string& path, const ColumnNames& names, const BlockCallback& onBlock) {
+    std::ifstream file(path);
+    std::string line;
+    if (!file || !std::getline(file, line)) {
+        std::cerr << "✗ Impossibile leggere " << path << "\n";
+        return false;
+    }
+
+    std::vector<std::string> fields;
+    splitCsv(line, fields);
+    ColumnMap map(fields, names);
+    if (!map.valid()) {
+        std::cerr << "✗ " << path << ": colonne identificativo/RA/Dec non trovate\n";
+        return false;
+    }
+
+    const double nan = std::numeric_limits<double>::quiet_NaN();
+    auto real = [&fields, nan](int column) {
+        if (column < 0 || static_cast<size_t>(column) >= fields.size() || fields[column].empty()) return nan;
+        char* end = nullptr;
+        double value = std::strtod(fields[column].c_str(), &end);
+        return end == fields[column].c_str() ? nan : value;
+    };
+
+    RowBlock block;
+    while (std::getline(file, line)) {
+        splitCsv(line, fields);
+        if (static_cast<size_t>(map.id) >= fields.size() || fields[map.id].empty()) continue;
+        block.ids.push_back(std::strtoll(fields[map.id].c_str(), nullptr, 10));
+        block.ra.push_back(real(map.ra));
+        block.dec.push_back(real(map.dec));
+        block.mag.push_back(real(map.mag));
+        block.pmra.push_back(real(map.pmra));
+        block.pmdec.push_back(real(map.pmdec));
+        if (block.size() == BLOCK_ROWS) {
+            onBlock(block);
+            block.clear();
+        }
+    }
+    if (block.size() > 0) onBlock(block);
+    return true;
+}
+
+static bool readTable(const std::string& path, const ColumnNames& names, const BlockCallback& onBlock) {
+    if (endsWith(path, ".csv")) return readCsv(path, names, onBlock);
+    return readVOTable(path, names, onBlock);
+}
+
+/**
+ * @brief Stelle SAO ordinate per pixel di SkyIndex, con l'offset di ogni pixel
+ */
+struct SAOIndex {
+    std::vector<int> sao;
+    std::vector<double> ra;
+    std::vector<double> dec;
+    std::vector<float> mag;
+    std::vector<double> x, y, z;        // Versori, per la distanza angolare
+    std::vector<uint32_t> pixelStart;   // NUM_PIXELS + 1
+
+    void build(const RowBlock& rows) {
+        std::vector<size_t> order(rows.size());
+        std::vector<int64_t> pixels(rows.size());
+        for (size_t i = 0; i < rows.size(); ++i) {
+            order[i] = i;
+            pixels[i] = SkyIndex::pixelId(rows.ra[i], rows.dec[i]);
+        }
+        std::sort(order.begin(), order.end(),
+                  [&pixels](size_t a, size_t b) { return pixels[a] < pixels[b]; });
+
+        pixelStart.assign(static_cast<size_t>(SkyIndex::NUM_PIXELS) + 1, 0);
+        for (size_t i : order) {
+            sao.push_back(static_cast<int>(rows.ids[i]));
+            ra.push_back(rows.ra[i]);
+            dec.push_back(rows.dec[i]);
+            mag.push_back(static_cast<float>(std::isnan(rows.mag[i]) ? 99.0 : rows.mag[i]));
+            auto v = core::UnitVector::fromRaDec(rows.ra[i], rows.dec[i]);
+            x.push_back(v.x);
+            y.push_back(v.y);
+            z.push_back(v.z);
+            pixelStart[static_cast<size_t>(pixels[i]) + 1]++;
+        }
+        for (size_t p = 1; p < pixelStart.size(); ++p) pixelStart[p] += pixelStart[p - 1];
+    }
+
+    size_t size() const { return sao.size(); }
+};
+
+/**
+ * @brief Coppia candidata: stella SAO (indice in SAOIndex) e sorgente Gaia
+ */
+struct Candidate {
+    uint32_t star;
+    double separation;      // arcsec
+    long long gaiaId;
+    float magnitude;
+};
+
+/**
+ * @brief Candidati più vicini di una stella SAO, ordinati per separazione
+ */
+struct CandidateList {
+    Candidate items[MAX_CANDIDATES];
+    uint32_t count = 0;
+
+    void offer(const Candidate& candidate) {
+        // Una sorgente ripetuta (più file Gaia) conta una volta sola
+        for (uint32_t k = 0; k < count; ++k) {
+            if (items[k].gaiaId != candidate.gaiaId) continue;
+            if (candidate.separation >= items[k].separation) return;
+            std::copy(items + k + 1, items + count, items + k);
+            count--;
+            break;
+        }
+        uint32_t position = count;
+        while (position > 0 && items[position - 1].separation > candidate.separation) position--;
+        if (position >= MAX_CANDIDATES) return;
+        if (count < MAX_CANDIDATES) count++;
+        std::copy_backward(items + position, items + count - 1, items + count);
+        items[position] = candidate;
+    }
+};
+
+struct Options {
+    std::string saoPath;
+    std::vector<std::string> gaiaPaths;
+    std::string output = "gaia_sao_xmatch.db";
+    double radiusArcsec = 5.0;
+    double maxDeltaMag = 0.0;       // 0 = nessun controllo
+    double gaiaEpoch = 2016.0;
+    int threads = 0;
+};
+
+/**
+ * @brief Confronta un blocco di sorgenti Gaia con le stelle SAO, in parallelo
+ *
+ * Ogni thread raccoglie le coppie entro il raggio in un proprio vettore;
+ * poi ogni SAO tiene le MAX_CANDIDATES più vicine.
+ */
+static void matchBlock(const RowBlock& gaia, const SAOIndex& index, const Options& options,
+                       std::vector<CandidateList>& candidates) {
+    const double radiusDeg = options.radiusArcsec / 3600.0;
+    const double years = 2000.0 - options.gaiaEpoch;
+
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    std::vector<std::vector<Candidate>> found(static_cast<size_t>(threads));
+
+    #pragma omp parallel
+    {
+        int thread = 0;
+#ifdef _OPENMP
+        thread = omp_get_thread_num();
+#endif
+        auto& local = found[static_cast<size_t>(thread)];
+        catalog::PixelRange ranges[SkyIndex::MAX_COVER_RANGES];
+
+        #pragma omp for schedule(static)
+        for (long long i = 0; i < static_cast<long long>(gaia.size()); ++i) {
+            double ra = gaia.ra[i];
+            double dec = gaia.dec[i];
+            if (std::isnan(ra) || std::isnan(dec)) continue;
+
+            // Posizione riportata a J2000 con il moto proprio
+            if (!std::isnan(gaia.pmra[i]) && !std::isnan(gaia.pmdec[i]) && years != 0.0) {
+                double cd = std::cos(dec * DEG_TO_RAD);
+                if (cd > 1e-9) ra += gaia.pmra[i] * years * MAS_TO_DEG / cd;
+                dec += gaia.pmdec[i] * years * MAS_TO_DEG;
+                ra = std::fmod(ra + 360.0, 360.0);
+                dec = std::max(-90.0, std::min(90.0, dec));
+            }
+
+            const auto cap = core::SphericalCap::cone(ra, dec, radiusDeg);
+            float gmag = static_cast<float>(std::isnan(gaia.mag[i]) ? 99.0 : gaia.mag[i]);
+
+            size_t count = SkyIndex::coverCone(ra, dec, radiusDeg, ranges, SkyIndex::MAX_COVER_RANGES);
+            for (size_t r = 0; r < count; ++r) {
+                uint32_t begin = index.pixelStart[static_cast<size_t>(ranges[r].first)];
+                uint32_t end = index.pixelStart[static_cast<size_t>(ranges[r].last) + 1];
+                for (uint32_t s = begin; s < end; ++s) {
+                    core::UnitVector star{index.x[s], index.y[s], index.z[s]};
+                    if (!cap.contains(star)) continue;
+                    if (options.maxDeltaMag > 0.0 && gmag < 99.0 && index.mag[s] < 99.0 &&
+                        std::fabs(gmag - index.mag[s]) > options.maxDeltaMag) continue;
+
+                    // Dalla corda: acos(dot) perde precisione sotto l'arcsec
+                    double separation = core::angularSeparation(cap.axis(), star) * 3600.0;
+                    local.push_back({s, separation, gaia.ids[i], gmag});
+                }
+            }
+        }
+    }
+
+    for (const auto& local : found) {
+        for (const auto& candidate : local) {
+            candidates[candidate.star].offer(candidate);
+        }
+    }
+}
+
+/**
+ * @brief Esegue SQL senza risultati, riportando l'errore
+ */
+static bool exec(sqlite3* db, const std::string& sql) {
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        std::cerr << "✗ SQL error: " << (errMsg ? errMsg : "?") << "\n";
+        sqlite3_free(errMsg);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief INSERT a più righe: un blocco di INSERT_ROWS righe per step
+ */
+class BulkInsert {
+public:
+    using Binder = std::function<void(sqlite3_stmt*, int firstParam, size_t row)>;
+
+    BulkInsert(sqlite3* db, const std::string& table, const std::string& columns, int columnCount)
+        : db_(db), table_(table), columns_(columns), columnCount_(columnCount) {}
+
+    ~BulkInsert() {
+        sqlite3_finalize(full_);
+    }
+
+    /**
+     * @brief Inserisce le righe [0, count) nell'ordine dato
+     */
+    bool insert(size_t count, const Binder& bind) {
+        if (!full_) full_ = prepare(INSERT_ROWS);
+        if (!full_) return false;
+
+        size_t row = 0;
+        while (row < count) {
+            size_t rows = std::min(INSERT_ROWS, count - row);
+            sqlite3_stmt* stmt = rows == INSERT_ROWS ? full_ : prepare(rows);
+            if (!stmt) return false;
+
+            for (size_t k = 0; k < rows; ++k) {
+                bind(stmt, static_cast<int>(k) * columnCount_ + 1, row + k);
+            }
+            bool ok = sqlite3_step(stmt) == SQLITE_DONE;
+            if (stmt == full_) {
+                sqlite3_reset(stmt);
+            } else {
+                sqlite3_finalize(stmt);
+            }
+            if (!ok) {
+                std::cerr << "✗ Insert in " << table_ << ": " << sqlite3_errmsg(db_) << "\n";
+                return false;
+            }
+            row += rows;
+        }
+        return true;
+    }
+
+private:
+    sqlite3_stmt* prepare(size_t rows) {
+        std::string tuple = "(";
+        for (int c = 0; c < columnCount_; ++c) tuple += c ? ",?" : "?";
+        tuple += ")";
+
+        std::string sql = "INSERT INTO " + table_ + " (" + columns_ + ") VALUES ";
+        for (size_t r = 0; r < rows; ++r) sql += (r ? "," : "") + tuple;
+
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+            std::cerr << "✗ Prepare " << table_ << ": " << sqlite3_errmsg(db_) << "\n";
+            return nullptr;
+        }
+        return stmt;
+    }
+
+    sqlite3* db_;
+    std::string table_;
+    std::string columns_;
+    int columnCount_;
+    sqlite3_stmt* full_ = nullptr;
+};
+
+/**
+ * @brief Riga del database: una stella SAO con la sua controparte Gaia
+ */
+struct Match {
+    long long gaiaId;       // -SAO se senza controparte Gaia
+    int sao;
+    double ra, dec;         // Posizione SAO (J2000)
+    double magnitude;       // Magnitudine G (SAO se senza controparte)
+    double separation;      // NaN se senza controparte
+    int64_t pixel;
+};
+
+static bool writeDatabase(const Options& options, std::vector<Match>& matches) {
+    std::remove(options.output.c_str());
+
+    sqlite3* db = nullptr;
+    if (sqlite3_open(options.output.c_str(), &db) != SQLITE_OK) {
+        std::cerr << "✗ Impossibile creare " << options.output << ": " << sqlite3_errmsg(db) << "\n";
+        sqlite3_close(db);
+        return false;
+    }
+
+    // Caricamento in blocco su un file nuovo: nessun journal né fsync
+    // (un'interruzione lascia un file da ricostruire, non un database usato)
+    bool ok = exec(db, "PRAGMA page_size = 8192;"
+                       "PRAGMA journal_mode = OFF;"
+                       "PRAGMA synchronous = OFF;"
+                       "PRAGMA locking_mode = EXCLUSIVE;"
+                       "PRAGMA temp_store = MEMORY;"
+                       "PRAGMA cache_size = -262144;");
+
+    ok = ok && catalog::GaiaSAOSchema::create(db);
+
+    std::ostringstream metadata;
+    metadata << "INSERT OR REPLACE INTO metadata VALUES ('builder', 'starmap_build_xmatch'), "
+             << "('radius_arcsec', '" << options.radiusArcsec << "'), "
+             << "('entries', '" << matches.size() << "');";
+    ok = ok && exec(db, metadata.str()) && exec(db, "BEGIN;");
+
+    // Ordine di chiave primaria: le pagine della tabella si riempiono in coda
+    std::sort(matches.begin(), matches.end(),
+              [](const Match& a, const Match& b) { return a.gaiaId < b.gaiaId; });
+    if (ok) {
+        using catalog::GaiaSAOSchema;
+        BulkInsert xmatch(db, GaiaSAOSchema::TABLE,
+                          "source_id, sao, ra_udeg, dec_udeg, mag_mmag, sep_mas, sky_pix", 7);
+        ok = xmatch.insert(matches.size(), [&matches](sqlite3_stmt* stmt, int p, size_t row) {
+            const Match& m = matches[row];
+            sqlite3_bind_int64(stmt, p, m.gaiaId);
+            sqlite3_bind_int(stmt, p + 1, m.sao);
+            sqlite3_bind_int64(stmt, p + 2, GaiaSAOSchema::scaledAngle(m.ra));
+            sqlite3_bind_int64(stmt, p + 3, GaiaSAOSchema::scaledAngle(m.dec));
+            if (std::isnan(m.magnitude)) {
+                sqlite3_bind_null(stmt, p + 4);
+            } else {
+                sqlite3_bind_int64(stmt, p + 4, GaiaSAOSchema::scaledMilli(m.magnitude));
+            }
+            if (std::isnan(m.separation)) {
+                sqlite3_bind_null(stmt, p + 5);
+            } else {
+                sqlite3_bind_int64(stmt, p + 5, GaiaSAOSchema::scaledMilli(m.separation));
+            }
+            sqlite3_bind_int64(stmt, p + 6, m.pixel);
+        });
+    }
+    ok = ok && exec(db, "COMMIT;");
+
+    // Indici solo a dati caricati
+    auto start = Clock::now();
+    ok = ok && catalog::GaiaSAOSchema::createIndices(db);
+    if (ok) {
+        std::cout << "  Indici e ANALYZE: "
+                  << std::chrono::duration<double>(Clock::now() - start).count() << " s\n";
+    }
+
+    sqlite3_close(db);
+    return ok;
+}
+
+static void usage() {
+    std::cerr << "Uso: starmap_build_xmatch --sao <sao.vot|csv> --gaia <gaia.vot|csv> [--gaia ...]\n"
+              << "           [--output gaia_sao_xmatch.db] [--radius arcsec] [--max-dmag mag]\n"
+              << "           [--gaia-epoch anno] [--threads N]\n";
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--sao" && hasValue) options.saoPath = argv[++i];
+        else if (arg == "--gaia" && hasValue) options.gaiaPaths.push_back(argv[++i]);
+        else if ((arg == "--output" || arg == "-o") && hasValue) options.output = argv[++i];
+        else if (arg == "--radius" && hasValue) options.radiusArcsec = std::atof(argv[++i]);
+        else if (arg == "--max-dmag" && hasValue) options.maxDeltaMag = std::atof(argv[++i]);
+        else if (arg == "--gaia-epoch" && hasValue) options.gaiaEpoch = std::atof(argv[++i]);
+        else if (arg == "--threads" && hasValue) options.threads = std::atoi(argv[++i]);
+        else {
+            usage();
+            return 1;
+        }
+    }
+    if (options.saoPath.empty() || options.gaiaPaths.empty() || options.radiusArcsec <= 0.0) {
+        usage();
+        return 1;
+    }
+#ifdef _OPENMP
+    if (options.threads > 0) omp_set_num_threads(options.threads);
+#endif
+
+    std::cout << "=== Costruzione database Gaia-SAO ===\n\n";
+    auto total = Clock::now();
+
+    // 1. Catalogo SAO in memoria, ordinato per pixel
+    auto start = Clock::now();
+    RowBlock saoRows;
+    bool ok = readTable(options.saoPath, SAO_COLUMNS, [&saoRows](const RowBlock& block) {
+        for (size_t i = 0; i < block.size(); ++i) {
+            if (block.ids[i] <= 0 || std::isnan(block.ra[i]) || std::isnan(block.dec[i])) continue;
+            saoRows.ids.push_back(block.ids[i]);
+            saoRows.ra.push_back(block.ra[i]);
+            saoRows.dec.push_back(block.dec[i]);
+            saoRows.mag.push_back(block.mag[i]);
+        }
+    });
+    if (!ok || saoRows.size() == 0) {
+        std::cerr << "✗ Nessuna stella SAO letta da " << options.saoPath << "\n";
+        return 1;
+    }
+    SAOIndex index;
+    index.build(saoRows);
+    saoRows = RowBlock();
+    std::cout << "Stelle SAO: " << index.size() << " ("
+              << std::chrono::duration<double>(Clock::now() - start).count() << " s)\n";
+
+    // 2. Sorgenti Gaia in streaming, confrontate a blocchi
+    start = Clock::now();
+    std::vector<CandidateList> candidates(index.size());
+    size_t gaiaRows = 0;
+    for (const auto& path : options.gaiaPaths) {
+        ok = readTable(path, GAIA_COLUMNS, [&](const RowBlock& block) {
+            matchBlock(block, index, options, candidates);
+            gaiaRows += block.size();
+            if (gaiaRows % (BLOCK_ROWS * 16) < block.size()) {
+                std::cout << "  " << gaiaRows << " sorgenti Gaia...\n";
+            }
+        });
+        if (!ok) return 1;
+    }
+    double matchSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::cout << "Sorgenti Gaia: " << gaiaRows << " (" << matchSeconds << " s, "
+              << (matchSeconds > 0 ? gaiaRows / matchSeconds : 0.0) << " righe/s)\n";
+
+    // 3. Una riga per SAO e una SAO per sorgente Gaia: le coppie vengono
+    //    assegnate dalla più vicina; se la sorgente è già presa la SAO
+    //    ripiega sul suo candidato successivo
+    std::vector<Candidate> pairs;
+    for (const auto& list : candidates) {
+        pairs.insert(pairs.end(), list.items, list.items + list.count);
+    }
+    std::sort(pairs.begin(), pairs.end(), [](const Candidate& a, const Candidate& b) {
+        if (a.separation != b.separation) return a.separation < b.separation;
+        return a.gaiaId != b.gaiaId ? a.gaiaId < b.gaiaId : a.star < b.star;
+    });
+
+    std::vector<const Candidate*> assigned(index.size(), nullptr);
+    std::unordered_set<long long> usedSources;
+    size_t fallbacks = 0;
+    for (const auto& pair : pairs) {
+        if (assigned[pair.star] || !usedSources.insert(pair.gaiaId).second) continue;
+        assigned[pair.star] = &pair;
+        if (pair.gaiaId != candidates[pair.star].items[0].gaiaId) fallbacks++;
+    }
+
+    std::vector<Match> matches;
+    std::vector<Match> unmatched;
+    size_t shared = 0;
+    for (size_t s = 0; s < index.size(); ++s) {
+        int64_t pixel = SkyIndex::pixelId(index.ra[s], index.dec[s]);
+        const Candidate* match = assigned[s];
+        if (!match) {
+            if (candidates[s].count > 0) shared++;
+            unmatched.push_back({-static_cast<long long>(index.sao[s]), index.sao[s], index.ra[s],
+                                 index.dec[s], index.mag[s],
+                                 std::numeric_limits<double>::quiet_NaN(), pixel});
+            continue;
+        }
+        matches.push_back({match->gaiaId, index.sao[s], index.ra[s], index.dec[s],
+                           match->magnitude < 99.0f ? match->magnitude : index.mag[s],
+                           match->separation, pixel});
+    }
+    std::sort(matches.begin(), matches.end(),
+              [](const Match& a, const Match& b) { return a.gaiaId < b.gaiaId; });
+    size_t matched = matches.size();
+    // Chiave -SAO unica anche con numeri SAO ripetuti nel file di ingresso
+    std::sort(unmatched.begin(), unmatched.end(),
+              [](const Match& a, const Match& b) { return a.gaiaId < b.gaiaId; });
+    unmatched.erase(std::unique(unmatched.begin(), unmatched.end(),
+                                [](const Match& a, const Match& b) { return a.gaiaId == b.gaiaId; }),
+                    unmatched.end());
+    const Match sample = matches.empty() ? Match{} : matches.front();
+    matches.insert(matches.end(), unmatched.begin(), unmatched.end());
+
+    std::cout << "Match: " << matched << "/" << index.size() << " ("
+              << std::fixed << std::setprecision(1) << (100.0 * matched / index.size())
+              << "%), " << fallbacks << " con il candidato successivo, " << shared
+              << " SAO senza sorgente Gaia libera\n"
+              << std::defaultfloat << std::setprecision(6);
+
+    // 4. Caricamento in blocco
+    start = Clock::now();
+    if (!writeDatabase(options, matches)) return 1;
+    std::cout << "Database scritto: "
+              << std::chrono::duration<double>(Clock::now() - start).count() << " s\n";
+
+    std::cout << "\nTotale: " << std::chrono::duration<double>(Clock::now() - total).count()
+              << " s\n\n";
+
+    // Verifica: il database si apre con GaiaSAODatabase
+    catalog::GaiaSAODatabase db(options.output);
+    if (!db.isAvailable()) {
+        std::cerr << "✗ Il database prodotto non è leggibile\n";
+        return 1;
+    }
+    std::cout << db.getStatistics();
+    if (matched > 0) {
+        auto sao = db.findSAOByGaiaId(sample.gaiaId);
+        std::cout << "Verifica: Gaia " << sample.gaiaId << " -> SAO "
+                  << (sao ? std::to_string(*sao) : "-") << " (atteso " << sample.sao << ")\n";
+        if (!sao || *sao != sample.sao) return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,71 @@
+/**
+ * @file starmap_migrate_xmatch.cpp
+ * @brief Converte un database Gaia-SAO legacy nello schema corrente
+ *
+ * Uso: starmap_migrate_xmatch <legacy.db> <nuovo.db>
+ *
+ * Le tabelle stars e gaia_sao_xmatch vengono riscritte nella tabella
+ * sao_xmatch di GaiaSAOSchema (coordinate intere, indici coprenti); il
+ * database di origine non viene modificato. Al termine i due database
+ * vengono confrontati su un campione di ricerche.
+ */
+
+#include <starmap/catalog/GaiaSAODatabase.h>
+#include <starmap/catalog/GaiaSAOSchema.h>
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+using namespace starmap;
+using Clock = std::chrono::steady_clock;
+
+static double megabytes(const std::string& path) {
+    std::error_code ec;
+    auto size = std::filesystem::file_size(path, ec);
+    return ec ? 0.0 : size / 1024.0 / 1024.0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        std::cerr << "Uso: starmap_migrate_xmatch <legacy.db> <nuovo.db>\n";
+        return 1;
+    }
+    std::string legacyPath = argv[1];
+    std::string outputPath = argv[2];
+
+    std::cout << "=== Migrazione database Gaia-SAO (schema v"
+              << catalog::GaiaSAOSchema::VERSION << ") ===\n\n";
+
+    auto start = Clock::now();
+    if (!catalog::GaiaSAOSchema::migrate(legacyPath, outputPath)) {
+        std::cerr << "✗ Migrazione fallita\n";
+        return 1;
+    }
+    std::cout << "✓ " << outputPath << " scritto in "
+              << std::chrono::duration<double>(Clock::now() - start).count() << " s\n"
+              << "  Dimensione: " << megabytes(legacyPath) << " MB -> "
+              << megabytes(outputPath) << " MB\n\n";
+
+    catalog::GaiaSAODatabase legacy(legacyPath);
+    catalog::GaiaSAODatabase migrated(outputPath);
+    if (!legacy.isAvailable() || !migrated.isAvailable()) {
+        std::cerr << "✗ Impossibile riaprire i database\n";
+        return 1;
+    }
+    std::cout << migrated.getStatistics() << "\n";
+
+    // Confronto su un campione di coni: stessi SAO per le stesse sorgenti
+    size_t checked = 0, mismatches = 0;
+    for (int i = 0; i < 100; ++i) {
+        core::EquatorialCoordinates center(i * 3.6, -80.0 + i * 1.6);
+        for (const auto& entry : legacy.coneSearch(center, 1.0, 100000)) {
+            auto sao = migrated.findSAOByGaiaId(entry.gaiaSourceId);
+            if (!sao || *sao != entry.saoNumber) mismatches++;
+            checked++;
+        }
+    }
+
+    std::cout << "Verifica: " << checked << " entry confrontate, "
+              << mismatches << " differenze\n";
+    return mismatches == 0 ? 0 : 1;
+}
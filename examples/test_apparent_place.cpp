@@ -0,0 +1,190 @@
+/**
+ * @file test_apparent_place.cpp
+ * @brief Verifica e benchmark del motore di posizioni apparenti
+ *
+ * Controlla nutazione e precessione contro gli esempi 22.a, 21.b e 23.a di
+ * Meeus (Astronomical Algorithms), la coerenza tra percorso per punto e
+ * percorsi batch (colonne RA/Dec, versori, StarBlock) e misura il costo
+ * per stella su N stelle (default 1M), contro un motore costruito per ogni
+ * stella.
+ *
+ * Uso: test_apparent_place [stelle]
+ */
+
+#include <starmap/core/ApparentPlace.h>
+#include <starmap/core/EpochPropagation.h>
+#include <starmap/core/StarBlock.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "test_support.h"
+
+using namespace starmap;
+using examples::check;
+using core::ApparentPlace;
+using core::EpochPropagation;
+using Clock = std::chrono::steady_clock;
+
+static constexpr double DEG = M_PI / 180.0;
+
+static double separationArcsec(double ra1, double dec1, double ra2, double dec2) {
+    double dra = (ra1 - ra2) * DEG, d1 = dec1 * DEG, d2 = dec2 * DEG;
+    double s = std::sin((d2 - d1) / 2), t = std::sin(dra / 2);
+    double h = s * s + std::cos(d1) * std::cos(d2) * t * t;
+    return 2.0 * std::asin(std::sqrt(h)) / DEG * 3600.0;
+}
+
+static double hms(int h, int m, double s) { return (h + m / 60.0 + s / 3600.0) * 15.0; }
+static double dms(int d, int m, double s) { return d + m / 60.0 + s / 3600.0; }
+
+static void testMeeus() {
+    std::cout << "\n[Meeus]\n";
+
+    // Esempio 22.a: 1987 aprile 10, 0h TD
+    ApparentPlace nutation1987(2446895.5);
+    check(std::abs(nutation1987.nutationLongitude() - (-3.788)) < 0.01 &&
+          std::abs(nutation1987.nutationObliquity() - 9.443) < 0.01,
+          "nutazione 1987-04-10: Δψ = -3.788\", Δε = +9.443\"");
+    check(std::abs(nutation1987.trueObliquity() - dms(23, 26, 36.850) * 3600.0) < 0.01,
+          "obliquità vera 23°26'36.850\"");
+
+    // Esempi 21.b e 23.a: θ Persei, 2028 novembre 13.19 TD
+    ApparentPlace place(2462088.69);
+    check(std::abs(place.nutationLongitude() - 14.861) < 0.01 &&
+          std::abs(place.nutationObliquity() - 2.705) < 0.01,
+          "nutazione 2028-11-13: Δψ = +14.861\", Δε = +2.705\"");
+
+    double ra = hms(2, 44, 11.986), dec = dms(49, 13, 42.48);
+    float pmRA = static_cast<float>(0.03425 * 15.0 * std::cos(dec * DEG) * 1000.0);
+    float pmDec = -89.5f;
+    EpochPropagation::propagate(&ra, &dec, &pmRA, &pmDec, 1, place.epoch() - 2000.0);
+
+    // Posizione media di data: sola precessione
+    double x[1], y[1], z[1];
+    ApparentPlace::toUnitVectors(&ra, &dec, 1, x, y, z);
+    const auto& p = place.precession();
+    double px = p[0][0] * x[0] + p[0][1] * y[0] + p[0][2] * z[0];
+    double py = p[1][0] * x[0] + p[1][1] * y[0] + p[1][2] * z[0];
+    double pz = p[2][0] * x[0] + p[2][1] * y[0] + p[2][2] * z[0];
+    double meanRA, meanDec;
+    ApparentPlace::fromUnitVectors(&px, &py, &pz, 1, &meanRA, &meanDec);
+    double meanError = separationArcsec(meanRA, meanDec, hms(2, 46, 11.331), dms(49, 20, 54.54));
+    std::cout << "  Posizione media: scarto " << meanError << "\"\n";
+    check(meanError < 0.02, "posizione media di data (21.b) entro 0.02\"");
+
+    auto apparent = place.apply(core::EquatorialCoordinates(ra, dec));
+    double apparentError = separationArcsec(apparent.getRightAscension(),
+                                            apparent.getDeclination(),
+                                            hms(2, 46, 14.390), dms(49, 21, 7.45));
+    std::cout << "  Posizione apparente: " << apparent.toHMSString() << " "
+              << apparent.toDMSString() << ", scarto " << apparentError << "\"\n";
+    check(apparentError < 0.05, "posizione apparente (23.a) entro 0.05\"");
+
+    auto parsed = ApparentPlace::at("2028-11-13T04:33:36Z");
+    check(parsed && std::abs(parsed->julianDate() - 2462088.69) < 1e-6,
+          "istante ISO 8601 -> data giuliana");
+    check(!ApparentPlace::at("non-una-data").has_value(), "istante non valido rifiutato");
+}
+
+static void testBatchConsistency() {
+    std::cout << "\n[Batch]\n";
+    auto place = *ApparentPlace::at("2025-12-15T22:34:12.5Z");
+
+    std::mt19937_64 rng(7);
+    std::uniform_real_distribution<double> raDist(0.0, 360.0), zDist(-1.0, 1.0);
+    const size_t n = 5000;
+    core::StarBlock block;
+    std::vector<double> ra(n), dec(n);
+    for (size_t i = 0; i < n; ++i) {
+        ra[i] = raDist(rng);
+        dec[i] = std::asin(zDist(rng)) / DEG;
+        block.append(ra[i], dec[i], 10.0);
+    }
+
+    std::vector<double> x(n), y(n), z(n);
+    ApparentPlace::toUnitVectors(ra.data(), dec.data(), n, x.data(), y.data(), z.data());
+    place.apply(x.data(), y.data(), z.data(), n);
+    std::vector<double> vra(n), vdec(n);
+    ApparentPlace::fromUnitVectors(x.data(), y.data(), z.data(), n, vra.data(), vdec.data());
+
+    place.apply(block);
+
+    double worst = 0.0, shift = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        auto single = place.apply(core::EquatorialCoordinates(ra[i], dec[i]));
+        worst = std::max(worst, separationArcsec(single.getRightAscension(),
+                                                 single.getDeclination(),
+                                                 block.getRightAscension(i),
+                                                 block.getDeclination(i)));
+        worst = std::max(worst, separationArcsec(vra[i], vdec[i],
+                                                 block.getRightAscension(i),
+                                                 block.getDeclination(i)));
+        shift = std::max(shift, separationArcsec(ra[i], dec[i], block.getRightAscension(i),
+                                                 block.getDeclination(i)));
+    }
+    std::cout << "  Spostamento massimo J2000 -> apparente " << shift << "\"\n";
+    check(worst < 1e-6, "punto singolo, versori e StarBlock coincidono");
+    check(shift > 1000.0 && shift < 1500.0, "spostamento compatibile con 26 anni di precessione");
+
+    bool inRange = true;
+    for (size_t i = 0; i < n; ++i) {
+        double r = block.getRightAscension(i);
+        inRange = inRange && r >= 0.0 && r < 360.0;
+    }
+    check(inRange, "RA in [0, 360)");
+}
+
+static void benchmark(size_t n) {
+    std::cout << "\n[Benchmark: " << n << " stelle]\n";
+
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> raDist(0.0, 360.0), zDist(-1.0, 1.0);
+    core::StarBlock source;
+    source.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        source.append(raDist(rng), std::asin(zDist(rng)) / DEG, 15.0);
+    }
+
+    double best = 1e9;
+    for (int rep = 0; rep < 5; ++rep) {
+        core::StarBlock block = source;
+        auto start = Clock::now();
+        ApparentPlace place(2461025.44);
+        place.apply(block);
+        best = std::min(best, std::chrono::duration<double, std::milli>(
+                                  Clock::now() - start).count());
+    }
+
+    // Riferimento: motore (matrici, nutazione, Sole) ricostruito per stella
+    size_t sample = std::min<size_t>(n, 100000);
+    auto start = Clock::now();
+    double checksum = 0.0;
+    for (size_t i = 0; i < sample; ++i) {
+        ApparentPlace place(2461025.44);
+        checksum += place.apply(source.getCoordinates(i)).getDeclination();
+    }
+    double perStarNs = std::chrono::duration<double, std::nano>(Clock::now() - start).count() /
+                       sample;
+
+    std::cout << "  Batch (matrice per epoca): " << best << " ms, "
+              << best * 1e6 / n << " ns/stella\n"
+              << "  Motore per stella:         " << perStarNs << " ns/stella"
+              << " (checksum " << checksum << ")\n";
+    check(best * 1e6 / n < perStarNs, "costo per stella del batch inferiore al percorso per punto");
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    std::cout << "=== Test ApparentPlace ===\n";
+    testMeeus();
+    testBatchConsistency();
+    benchmark(n);
+
+    return examples::testSummary();
+}
@@ -0,0 +1,205 @@
+/**
+ * @file test_async_http.cpp
+ * @brief Verifica di AsyncHttpEngine contro un server locale
+ *
+ * Il server su 127.0.0.1 risponde con un ritardo fisso e conta richieste
+ * e connessioni. Il test controlla: risposte corrette per centinaia di
+ * richieste concorrenti, riuso delle connessioni, limite dei trasferimenti
+ * attivi, limite di richieste al secondo per host, errori HTTP e di
+ * trasporto, cache delle risposte e annullamento alla distruzione.
+ *
+ * Uso: test_async_http [richieste] [ritardo ms]
+ */
+
+#include "loopback_http_server.h"
+#include "test_support.h"
+#include <starmap/utils/AsyncHttpEngine.h>
+#include <starmap/utils/HttpCache.h>
+#include <starmap/utils/HttpClient.h>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace starmap;
+using examples::check;
+using starmap::examples::LoopbackHttpServer;
+using starmap::examples::LoopbackRequest;
+using starmap::examples::LoopbackResponse;
+using Clock = std::chrono::steady_clock;
+
+static double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * @brief Parametro intero della query string ("ms=50" -> 50)
+ */
+static int queryValue(const std::string& target, const std::string& name, int fallback) {
+    size_t pos = target.find(name + "=");
+    if (pos == std::string::npos) return fallback;
+    return std::atoi(target.c_str() + pos + name.size() + 1);
+}
+
+int main(int argc, char* argv[]) {
+    int numRequests = argc > 1 ? std::max(1, std::atoi(argv[1])) : 300;
+    int delayMs = argc > 2 ? std::max(0, std::atoi(argv[2])) : 50;
+
+    // /echo?n=..&ms=..  risponde "echo:n" dopo ms millisecondi
+    // /missing          404
+    LoopbackHttpServer server([](const LoopbackRequest& request) {
+        LoopbackResponse response;
+        if (request.target.rfind("/echo", 0) == 0) {
+            int ms = queryValue(request.target, "ms", 0);
+            if (ms > 0) std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+            response.headers["Cache-Control"] = "max-age=3600";
+            response.body = "echo:" + std::to_string(queryValue(request.target, "n", -1));
+        } else {
+            response.status = 404;
+        }
+        return response;
+    });
+    if (!server.isRunning()) {
+        std::cerr << "Impossibile avviare il server locale\n";
+        return 1;
+    }
+
+    std::cout << "=== Test AsyncHttpEngine ===\n";
+    std::cout << "Richieste: " << numRequests << ", ritardo del server: " << delayMs << " ms\n\n";
+
+    auto echoUrl = [&server, delayMs](int n) {
+        return server.url("/echo?n=" + std::to_string(n) + "&ms=" + std::to_string(delayMs));
+    };
+
+    std::cout << "Richieste concorrenti:\n";
+    {
+        utils::AsyncHttpOptions options;
+        options.maxInFlight = 32;
+        options.maxConnectionsPerHost = 16;
+        utils::AsyncHttpEngine engine(options);
+
+        auto start = Clock::now();
+        std::vector<std::future<std::string>> futures;
+        for (int i = 0; i < numRequests; ++i) {
+            futures.push_back(engine.get(echoUrl(i)));
+        }
+        int correct = 0;
+        for (int i = 0; i < numRequests; ++i) {
+            if (futures[i].get() == "echo:" + std::to_string(i)) correct++;
+        }
+        double elapsed = secondsSince(start);
+        double serial = numRequests * delayMs / 1000.0;
+
+        auto stats = engine.getStatistics();
+        std::cout << "  " << numRequests << " richieste in " << elapsed << " s (in serie almeno "
+                  << serial << " s), " << stats.connections << " connessioni, picco di "
+                  << stats.peakInFlight << " trasferimenti attivi\n";
+        check(correct == numRequests, "ogni future riceve la propria risposta");
+        check(delayMs == 0 || elapsed < serial / 4.0, "richieste eseguite in parallelo");
+        check(stats.connections <= options.maxConnectionsPerHost &&
+              server.connections() <= options.maxConnectionsPerHost,
+              "connessioni riusate (al più maxConnectionsPerHost)");
+        check(stats.peakInFlight <= options.maxInFlight, "trasferimenti attivi entro maxInFlight");
+        check(stats.completed == static_cast<size_t>(numRequests) && stats.failed == 0,
+              "contatori coerenti");
+    }
+
+    std::cout << "Limite per host:\n";
+    {
+        utils::AsyncHttpEngine engine;
+        engine.setHostRateLimit("127.0.0.1", 20.0);
+
+        auto start = Clock::now();
+        std::vector<std::future<std::string>> futures;
+        for (int i = 0; i < 40; ++i) {
+            futures.push_back(engine.get(server.url("/echo?n=" + std::to_string(i))));
+        }
+        for (auto& future : futures) future.get();
+        double elapsed = secondsSince(start);
+
+        // 20 richieste subito (un secondo di credito), le altre 20 a 20/s
+        std::cout << "  40 richieste a 20/s in " << elapsed << " s\n";
+        check(elapsed >= 0.9, "richieste distribuite nel tempo");
+        check(engine.getStatistics().rateLimited > 0, "avvii rimandati contati");
+    }
+
+    std::cout << "Errori:\n";
+    {
+        utils::AsyncHttpEngine engine;
+
+        utils::HttpRequest missing;
+        missing.method = "GET";
+        missing.url = server.url("/missing");
+        auto response = engine.submit(missing).get();
+        check(response.status == 404, "submit() riporta lo stato HTTP senza eccezioni");
+
+        bool httpError = false;
+        try {
+            engine.get(server.url("/missing")).get();
+        } catch (const std::runtime_error& e) {
+            httpError = std::string(e.what()) == "HTTP error: 404";
+        }
+        check(httpError, "get() solleva \"HTTP error\" come HttpClient");
+
+        bool transportError = false;
+        try {
+            engine.get("http://127.0.0.1:1/").get();
+        } catch (const std::runtime_error& e) {
+            transportError = std::string(e.what()).rfind("CURL error", 0) == 0;
+        }
+        check(transportError, "errore di connessione come eccezione del future");
+
+        utils::HttpRequest post;
+        post.method = "POST";
+        post.url = server.url("/echo?n=7");
+        post.body = "a=1";
+        check(engine.submit(post).get().body == "echo:7", "richiesta POST");
+    }
+
+    std::cout << "Cache:\n";
+    {
+        auto directory = std::filesystem::temp_directory_path() / "starmap_test_async_http";
+        std::filesystem::remove_all(directory);
+        auto cache = std::make_shared<utils::HttpCache>(directory.string());
+
+        utils::AsyncHttpEngine engine;
+        std::string url = server.url("/echo?n=42");
+        engine.get(url, {}, cache).get();
+        size_t before = server.requests();
+
+        utils::HttpRequest request;
+        request.url = url;
+        request.cache = cache;
+        auto response = engine.submit(request).get();
+        check(response.fromCache && response.body == "echo:42" && server.requests() == before,
+              "risposta servita da HttpCache senza rete");
+        check(engine.getStatistics().cacheHits == 1, "hit contato dal motore");
+        std::filesystem::remove_all(directory);
+    }
+
+    std::cout << "Distruzione con richieste in corso:\n";
+    {
+        std::vector<std::future<std::string>> futures;
+        {
+            utils::AsyncHttpEngine engine;
+            for (int i = 0; i < 4; ++i) {
+                futures.push_back(engine.get(server.url("/echo?n=0&ms=2000")));
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        }
+        int cancelled = 0;
+        for (auto& future : futures) {
+            try {
+                future.get();
+            } catch (const std::runtime_error&) {
+                cancelled++;
+            }
+        }
+        check(cancelled == 4, "i future non completati ricevono un errore");
+    }
+
+    return examples::testSummary();
+}
@@ -0,0 +1,228 @@
+/**
+ * @file test_catalog_manager.cpp
+ * @brief Test di aggancio, annullamento ed errori delle query di CatalogManager
+ *
+ * Le stelle arrivano da una sorgente sintetica (setStarSource) che può
+ * essere trattenuta da un cancello: così le richieste concorrenti si
+ * sovrappongono in modo deterministico, senza dipendere dai tempi del
+ * catalogo reale. Non serve alcun database.
+ */
+
+#include <starmap/catalog/CatalogManager.h>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test_support.h"
+
+using namespace starmap;
+using examples::check;
+using examples::Gate;
+
+namespace {
+
+constexpr auto TIMEOUT = std::chrono::seconds(10);
+
+/**
+ * @brief Griglia deterministica di stelle attorno al centro della query
+ */
+core::StarBlock syntheticCone(const catalog::GaiaQueryParameters& params) {
+    core::StarBlock block;
+    const double step = params.radiusDegrees / 5.0;
+    long long id = 1;
+    for (int i = -4; i <= 4; ++i) {
+        for (int j = -4; j <= 4; ++j, ++id) {
+            double mag = 6.0 + static_cast<double>((id * 37) % 90) / 10.0;
+            if (mag > params.maxMagnitude) continue;
+            block.append(params.center.getRightAscension() + i * step,
+                         params.center.getDeclination() + j * step, mag, id);
+        }
+    }
+    return block;
+}
+
+catalog::GaiaQueryParameters cone(double ra, double dec) {
+    catalog::GaiaQueryParameters params;
+    params.center = core::EquatorialCoordinates(ra, dec);
+    params.radiusDegrees = 1.0;
+    params.maxMagnitude = 14.0;
+    return params;
+}
+
+bool sameStars(const core::StarBlock& a, const core::StarBlock& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a.getGaiaId(i) != b.getGaiaId(i) || a.getMagnitude(i) != b.getMagnitude(i)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Attende che il contatore di agganci raggiunga il valore atteso
+ */
+bool waitForJoins(const catalog::CatalogManager& manager, size_t expected) {
+    auto deadline = std::chrono::steady_clock::now() + TIMEOUT;
+    while (manager.getStatistics().joinedQueries < expected) {
+        if (std::chrono::steady_clock::now() > deadline) return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+bool ready(const std::shared_future<core::StarBlock>& future) {
+    return future.wait_for(TIMEOUT) == std::future_status::ready;
+}
+
+void testJoin() {
+    std::cout << "\n=== Aggancio a query identiche ===\n";
+    catalog::CatalogManager manager;
+    manager.setCacheEnabled(false);
+
+    Gate gate;
+    std::atomic<int> calls{0};
+    manager.setStarSource([&](const catalog::GaiaQueryParameters& params) {
+        calls++;
+        gate.wait();
+        return syntheticCone(params);
+    });
+
+    auto params = cone(120.0, 20.0);
+    const int asyncCallers = 5;
+    std::vector<std::shared_future<core::StarBlock>> futures;
+    for (int i = 0; i < asyncCallers; ++i) {
+        futures.push_back(manager.queryStarBlockAsync(params, false));
+    }
+
+    core::StarBlock syncResult;
+    std::thread syncCaller([&] { syncResult = manager.queryStarBlock(params, false); });
+    bool joined = waitForJoins(manager, asyncCallers);
+    gate.open();
+    syncCaller.join();
+
+    core::StarBlock expected = syntheticCone(params);
+    bool allMatch = sameStars(syncResult, expected);
+    for (auto& future : futures) {
+        allMatch = allMatch && ready(future) && sameStars(future.get(), expected);
+    }
+
+    auto stats = manager.getStatistics();
+    check(joined, "la chiamata sincrona si aggancia alla query in corso");
+    check(calls == 1 && stats.catalogQueries == 1, "6 richieste identiche, 1 sola lettura del catalogo");
+    check(stats.joinedQueries == asyncCallers, "5 richieste agganciate");
+    check(allMatch, "tutti i chiamanti ricevono lo stesso risultato");
+}
+
+void testCancellation() {
+    std::cout << "\n=== Annullamento ===\n";
+    catalog::CatalogManager manager;
+    manager.setAsyncThreads(1);
+
+    Gate gate;
+    std::atomic<int> calls{0};
+    manager.setStarSource([&](const catalog::GaiaQueryParameters& params) {
+        calls++;
+        gate.wait();
+        return syntheticCone(params);
+    });
+
+    // Il solo thread del pool resta occupato: le query seguenti aspettano in coda
+    auto blocker = manager.queryStarBlockAsync(cone(10.0, 0.0), false);
+
+    auto cancelledParams = cone(50.0, 10.0);
+    auto token = utils::CancellationToken::create();
+    auto cancelled = manager.queryStarBlockAsync(cancelledParams, false, token);
+
+    auto sharedParams = cone(80.0, -10.0);
+    auto first = utils::CancellationToken::create();
+    auto second = utils::CancellationToken::create();
+    auto sharedA = manager.queryStarBlockAsync(sharedParams, false, first);
+    auto sharedB = manager.queryStarBlockAsync(sharedParams, false, second);
+
+    token.cancel();
+    first.cancel();
+    gate.open();
+
+    check(ready(blocker) && !blocker.get().empty(), "la query non annullata termina");
+    check(ready(cancelled) && cancelled.get().empty(), "la query annullata restituisce un blocco vuoto");
+    check(ready(sharedA) && ready(sharedB) &&
+          sameStars(sharedA.get(), syntheticCone(sharedParams)) &&
+          sameStars(sharedB.get(), sharedA.get()),
+          "una query condivisa prosegue finché un chiamante la vuole");
+    check(calls == 2, "la query annullata non legge il catalogo");
+
+    core::StarBlock again = manager.queryStarBlock(cancelledParams, false);
+    check(calls == 3 && sameStars(again, syntheticCone(cancelledParams)),
+          "il risultato annullato non entra in cache");
+}
+
+void testFailure() {
+    std::cout << "\n=== Errori della sorgente ===\n";
+    catalog::CatalogManager manager;
+
+    Gate gate;
+    std::atomic<bool> failing{true};
+    std::atomic<int> calls{0};
+    manager.setStarSource([&](const catalog::GaiaQueryParameters& params) {
+        calls++;
+        gate.wait();
+        if (failing) throw std::runtime_error("catalogo non disponibile");
+        return syntheticCone(params);
+    });
+
+    auto params = cone(200.0, 40.0);
+    auto futureA = manager.queryStarBlockAsync(params, false);
+    auto futureB = manager.queryStarBlockAsync(params, false);
+
+    bool syncThrew = false;
+    std::thread syncCaller([&] {
+        try {
+            manager.queryStarBlock(params, false);
+        } catch (const std::runtime_error& e) {
+            syncThrew = std::string(e.what()) == "catalogo non disponibile";
+        }
+    });
+    waitForJoins(manager, 2);
+    gate.open();
+    syncCaller.join();
+
+    auto rethrows = [](const std::shared_future<core::StarBlock>& future) {
+        if (!ready(future)) return false;
+        try {
+            future.get();
+        } catch (const std::runtime_error& e) {
+            return std::string(e.what()) == "catalogo non disponibile";
+        } catch (...) {
+            return false;
+        }
+        return false;
+    };
+
+    check(rethrows(futureA) && rethrows(futureB), "i future agganciati rilanciano l'eccezione");
+    check(syncThrew, "la chiamata sincrona rilancia l'eccezione");
+    check(calls == 1 && manager.getStatistics().failedQueries == 1, "una sola query fallita");
+
+    // Nessuna richiesta deve agganciarsi alla query fallita
+    failing = false;
+    auto retry = manager.queryStarBlockAsync(params, false);
+    check(ready(retry) && sameStars(retry.get(), syntheticCone(params)),
+          "la query successiva riparte da capo");
+    check(calls == 2, "l'errore non entra in cache");
+}
+
+} // namespace
+
+int main() {
+    std::cout << "=== Test CatalogManager ===\n";
+
+    testJoin();
+    testCancellation();
+    testFailure();
+
+    return examples::testSummary();
+}
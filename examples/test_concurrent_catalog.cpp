@@ -0,0 +1,242 @@
+/**
+ * @file test_concurrent_catalog.cpp
+ * @brief Stress test di CatalogManager usato da più thread insieme
+ *
+ * Calcola un risultato di riferimento per ogni regione con un solo thread,
+ * poi verifica che:
+ * - N richieste identiche simultanee producano una sola lettura del
+ *   catalogo (le altre si agganciano a quella in corso);
+ * - i coni annidati in un cono già in cache siano serviti per contenimento;
+ * - N thread che interrogano la stessa istanza in ordine diverso (sincrono
+ *   e asincrono, con svuotamenti della cache) mentre un altro thread
+ *   modifica la configurazione ottengano sempre il riferimento.
+ *
+ * Uso: test_concurrent_catalog [thread] [iterazioni] [database Gaia-SAO]
+ */
+
+#include <starmap/StarMap.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "test_support.h"
+
+using namespace starmap;
+using examples::check;
+using examples::Gate;
+
+/**
+ * @brief Impronta di un risultato (ID, magnitudini, numeri SAO)
+ *
+ * Le stelle sono ordinate per ID: un risultato servito dalla cache per
+ * contenimento può avere un ordine diverso da quello del catalogo.
+ */
+static uint64_t fingerprint(const std::vector<std::shared_ptr<core::Star>>& stars) {
+    std::vector<std::tuple<long long, long long, int>> rows;
+    rows.reserve(stars.size());
+    for (const auto& star : stars) {
+        rows.emplace_back(star->getGaiaId(), std::llround(star->getMagnitude() * 1000.0),
+                          star->getSAONumber().value_or(0));
+    }
+    std::sort(rows.begin(), rows.end());
+
+    uint64_t hash = 1469598103934665603ULL;
+    auto mix = [&hash](uint64_t value) {
+        hash ^= value;
+        hash *= 1099511628211ULL;
+    };
+    mix(rows.size());
+    for (const auto& [id, mag, sao] : rows) {
+        mix(static_cast<uint64_t>(id));
+        mix(static_cast<uint64_t>(mag));
+        mix(static_cast<uint64_t>(sao));
+    }
+    return hash;
+}
+
+catalog::GaiaQueryParameters cone(double ra, double dec, double radius, double maxMagnitude,
+                                  int maxResults = 0) {
+    catalog::GaiaQueryParameters params;
+    params.center = core::EquatorialCoordinates(ra, dec);
+    params.radiusDegrees = radius;
+    params.maxMagnitude = maxMagnitude;
+    params.maxResults = maxResults;
+    return params;
+}
+
+int main(int argc, char* argv[]) {
+    int numThreads = argc > 1 ? std::atoi(argv[1]) : 8;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 20;
+    numThreads = std::max(1, numThreads);
+    iterations = std::max(1, iterations);
+
+    if (argc > 3) {
+        config::LibraryConfig::getInstance().setGaiaSaoDbPath(argv[3]);
+    }
+
+    std::cout << "=== Stress test CatalogManager concorrente ===\n";
+    std::cout << "Thread: " << numThreads << ", iterazioni per thread: " << iterations << "\n\n";
+
+    // Coni padre completi, ognuno con due coni annidati (più piccoli, uno
+    // anche meno profondo); centri e raggi fuori dai passi tondi perché
+    // nessuna stella cada esattamente sul bordo. I coni con maxResults
+    // sono isolati: nessun altro cono li contiene
+    std::vector<catalog::GaiaQueryParameters> regions;
+    std::vector<size_t> parents;
+    std::vector<size_t> nested;
+    for (int i = 0; i < 4; ++i) {
+        double ra = 30.0131 + 60.0 * i;
+        double dec = -49.9827 + 30.0 * i;
+        parents.push_back(regions.size());
+        regions.push_back(cone(ra, dec, 0.8037 + 0.1 * i, 10.5));
+        nested.push_back(regions.size());
+        regions.push_back(cone(ra + 0.21, dec - 0.17, 0.3113, 10.5));
+        nested.push_back(regions.size());
+        regions.push_back(cone(ra - 0.137, dec + 0.093, 0.4471, 9.5));
+    }
+    regions.push_back(cone(200.0071, 5.0113, 1.2037, 11.0, 200));
+    regions.push_back(cone(250.0123, -30.0171, 1.2037, 11.0, 200));
+
+    catalog::CatalogManager manager;
+
+    // Riferimento: un thread, senza cache
+    manager.setCacheEnabled(false);
+    std::vector<uint64_t> expected;
+    size_t totalStars = 0;
+    for (const auto& params : regions) {
+        auto stars = manager.queryStars(params, true);
+        totalStars += stars.size();
+        expected.push_back(fingerprint(stars));
+    }
+    std::cout << "Riferimento: " << regions.size() << " regioni, " << totalStars << " stelle\n";
+
+    // 1. Richieste identiche simultanee: la lettura resta aperta finché
+    //    tutti i chiamanti non si sono agganciati
+    {
+        std::cout << "\n--- Richieste identiche simultanee ---\n";
+        int callers = std::max(2, numThreads);
+        Gate gate;
+        manager.setStarSource([&](const catalog::GaiaQueryParameters& params) {
+            gate.wait();
+            return manager.getGaiaClient().queryRegionBlock(params);
+        });
+
+        auto before = manager.getStatistics();
+        std::vector<uint64_t> results(callers);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < callers; ++i) {
+            threads.emplace_back([&, i]() {
+                results[i] = fingerprint(manager.queryStars(regions[parents[0]], true));
+            });
+        }
+
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+        while (manager.getStatistics().joinedQueries - before.joinedQueries < size_t(callers - 1) &&
+               std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        gate.open();
+        for (auto& thread : threads) thread.join();
+        manager.setStarSource(nullptr);
+
+        auto after = manager.getStatistics();
+        check(after.joinedQueries - before.joinedQueries == size_t(callers - 1),
+              std::to_string(callers - 1) + " richieste agganciate");
+        check(after.catalogQueries - before.catalogQueries == 1,
+              std::to_string(callers) + " richieste identiche, 1 sola lettura del catalogo");
+        check(std::all_of(results.begin(), results.end(),
+                          [&](uint64_t result) { return result == expected[parents[0]]; }),
+              "tutti i chiamanti ottengono il riferimento");
+    }
+
+    // 2. Coni annidati serviti dal cono padre in cache
+    manager.setCacheEnabled(true);
+    {
+        std::cout << "\n--- Coni annidati ---\n";
+        auto before = manager.getCacheStatistics();
+        bool allMatch = true;
+        for (size_t k : parents) {
+            allMatch = allMatch && fingerprint(manager.queryStars(regions[k], true)) == expected[k];
+        }
+        for (size_t k : nested) {
+            allMatch = allMatch && fingerprint(manager.queryStars(regions[k], true)) == expected[k];
+        }
+        auto after = manager.getCacheStatistics();
+        check(after.containmentHits - before.containmentHits == nested.size(),
+              std::to_string(nested.size()) + " coni annidati serviti per contenimento");
+        check(allMatch, "coni padre e annidati coincidono con il riferimento");
+    }
+
+    // 3. Stress: tutti i thread su tutte le regioni in ordine diverso
+    std::cout << "\n--- Stress ---\n";
+    std::atomic<size_t> queries{0};
+    std::atomic<size_t> mismatches{0};
+    std::atomic<bool> running{true};
+
+    // Modifiche concorrenti della configurazione (stessi valori, nuovi snapshot)
+    std::thread configWriter([&running]() {
+        auto& libConfig = config::LibraryConfig::getInstance();
+        while (running) {
+            libConfig.setGaiaSaoDbPath(libConfig.getGaiaSaoDbPath());
+            libConfig.setTileCacheDirectory(libConfig.getTileCacheDirectory());
+            std::this_thread::yield();
+        }
+    });
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < numThreads; ++t) {
+        workers.emplace_back([&, t]() {
+            std::mt19937 rng(1234u + static_cast<unsigned>(t));
+            std::vector<size_t> order(regions.size());
+            for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+
+            for (int it = 0; it < iterations; ++it) {
+                std::shuffle(order.begin(), order.end(), rng);
+                for (size_t k : order) {
+                    std::vector<std::shared_ptr<core::Star>> stars;
+                    if ((it + t) % 2 == 0) {
+                        stars = manager.queryStars(regions[k], true);
+                    } else {
+                        stars = manager.queryStarsAsync(regions[k], true).get();
+                    }
+                    if (fingerprint(stars) != expected[k]) {
+                        mismatches++;
+                    }
+                    queries++;
+                }
+
+                // Svuotare la cache forza nuove letture mentre gli altri
+                // thread la stanno usando
+                if (t == 0 && it % 5 == 4) {
+                    manager.clearCache();
+                }
+            }
+        });
+    }
+
+    for (auto& worker : workers) worker.join();
+    running = false;
+    configWriter.join();
+
+    auto stats = manager.getCacheStatistics();
+    auto managerStats = manager.getStatistics();
+    std::cout << "Query eseguite: " << queries << " (" << managerStats.catalogQueries
+              << " letture del catalogo, " << managerStats.joinedQueries << " agganciate)\n";
+    std::cout << "Cache: " << stats.hits << " hit, " << stats.containmentHits
+              << " hit per contenimento, " << stats.misses << " miss\n";
+
+    check(mismatches == 0, "tutti i risultati coincidono con il riferimento (" +
+          std::to_string(mismatches.load()) + " diversi)");
+    check(stats.containmentHits > 0, "richieste servite per contenimento");
+
+    return examples::testSummary();
+}
@@ -0,0 +1,230 @@
+/**
+ * @file test_epoch_propagation.cpp
+ * @brief Verifica e benchmark della propagazione del moto proprio
+ *
+ * Controlla: conversione ISO 8601 -> epoca giuliana, confronto del kernel
+ * lineare con la propagazione rigorosa (velocità costante nello spazio
+ * tangente), stella di Barnard, stelle senza moto proprio e passaggio
+ * per 0h. Poi misura il kernel su un blocco di N stelle (default 1M) con
+ * un thread e con tutti i thread, contro la propagazione per oggetto Star.
+ *
+ * Uso: test_epoch_propagation [stelle]
+ */
+
+#include <starmap/core/EpochPropagation.h>
+#include <starmap/core/StarBlock.h>
+#include <starmap/map/MapConfiguration.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+
+#include "test_support.h"
+#endif
+
+using namespace starmap;
+using examples::check;
+using core::EpochPropagation;
+using Clock = std::chrono::steady_clock;
+
+static constexpr double DEG = M_PI / 180.0;
+static constexpr double MAS = DEG / 3.6e6;
+
+/**
+ * @brief Propagazione rigorosa a velocità costante (senza velocità radiale)
+ */
+static void rigorous(double& ra, double& dec, double pmRA, double pmDec, double years) {
+    double a = ra * DEG, d = dec * DEG;
+    double p[3] = {std::cos(d) * std::cos(a), std::cos(d) * std::sin(a), std::sin(d)};
+    double east[3] = {-std::sin(a), std::cos(a), 0.0};
+    double north[3] = {-std::sin(d) * std::cos(a), -std::sin(d) * std::sin(a), std::cos(d)};
+    double v[3];
+    for (int k = 0; k < 3; ++k) {
+        v[k] = p[k] + years * MAS * (pmRA * east[k] + pmDec * north[k]);
+    }
+    double norm = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+    ra = std::atan2(v[1], v[0]) / DEG;
+    if (ra < 0) ra += 360.0;
+    dec = std::asin(v[2] / norm) / DEG;
+}
+
+static double separationMas(double ra1, double dec1, double ra2, double dec2) {
+    double dra = (ra1 - ra2) * DEG, d1 = dec1 * DEG, d2 = dec2 * DEG;
+    double s = std::sin((d2 - d1) / 2), t = std::sin(dra / 2);
+    double h = s * s + std::cos(d1) * std::cos(d2) * t * t;
+    return 2.0 * std::asin(std::sqrt(h)) / MAS;
+}
+
+static void testEpochParsing() {
+    std::cout << "\n[Epoche]\n";
+    check(EpochPropagation::julianDate(2000, 1, 1, 12.0) == EpochPropagation::J2000_JD,
+          "JD(2000-01-01 12h) = 2451545.0");
+
+    auto j2016 = EpochPropagation::parseEpoch("2016-01-01T12:00:00Z");
+    check(j2016 && std::abs(*j2016 - EpochPropagation::GAIA_DR3_EPOCH) < 1e-9,
+          "2016-01-01T12:00:00Z = J2016.0");
+
+    auto event = EpochPropagation::parseEpoch("2025-12-15T22:34:12.5Z");
+    auto local = EpochPropagation::parseEpoch("2025-12-15T23:34:12.5+01:00");
+    check(event && local && std::abs(*event - *local) < 1e-12, "fuso orario +01:00");
+    check(event && std::abs(*event - 2025.95604) < 1e-5, "2025-12-15T22:34:12.5Z ≈ J2025.95604");
+
+    check(EpochPropagation::parseEpoch("2025-12-15").has_value(), "sola data");
+    check(EpochPropagation::parseEpoch("2025-12-15 22:34").has_value(), "ora senza secondi");
+    check(!EpochPropagation::parseEpoch("").has_value(), "stringa vuota rifiutata");
+    check(!EpochPropagation::parseEpoch("15/12/2025").has_value(), "formato non ISO rifiutato");
+    check(!EpochPropagation::parseEpoch("2025-13-01").has_value(), "mese non valido rifiutato");
+    check(!EpochPropagation::parseEpoch("2025-12-15T22:34:12 UTC").has_value(),
+          "suffisso sconosciuto rifiutato");
+
+    map::MapConfiguration config;
+    config.useObservationTime = true;
+    config.observationTime = "2025-12-15T22:34:12Z";
+    check(config.validate(), "MapConfiguration con istante valido");
+    config.observationTime = "domani";
+    check(!config.validate(), "MapConfiguration con istante non valido");
+}
+
+static void testAccuracy() {
+    std::cout << "\n[Accuratezza]\n";
+    const double target = *EpochPropagation::parseEpoch("2025-12-15T22:34:12.5Z");
+    const double years = target - EpochPropagation::GAIA_DR3_EPOCH;
+
+    // Stelle casuali fino a |dec| = 80° e 200 mas/anno
+    std::mt19937_64 rng(2016);
+    std::uniform_real_distribution<double> raDist(0.0, 360.0), decDist(-80.0, 80.0);
+    std::uniform_real_distribution<double> pmDist(-200.0, 200.0);
+
+    core::StarBlock block;
+    const size_t n = 100000;
+    block.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        size_t row = block.append(raDist(rng), decDist(rng), 12.0);
+        block.setProperMotion(row, pmDist(rng), pmDist(rng));
+    }
+    core::StarBlock original = block;
+    EpochPropagation::propagate(block, target);
+
+    double worst = 0.0, moved = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        double ra = original.getRightAscension(i), dec = original.getDeclination(i);
+        rigorous(ra, dec, original.pmRAColumn()[i], original.pmDecColumn()[i], years);
+        worst = std::max(worst, separationMas(ra, dec, block.getRightAscension(i),
+                                              block.getDeclination(i)));
+        moved = std::max(moved, separationMas(original.getRightAscension(i),
+                                              original.getDeclination(i),
+                                              block.getRightAscension(i),
+                                              block.getDeclination(i)));
+    }
+    std::cout << "  Spostamento massimo " << moved / 1000.0 << "\", scarto massimo dalla "
+              << "propagazione rigorosa " << worst << " mas\n";
+    check(moved > 2000.0, "le posizioni si spostano di secondi d'arco");
+    check(worst < 1.0, "scarto < 1 mas su " + std::to_string(n) + " stelle");
+
+    // Stella di Barnard (Gaia DR3 4472832130942575872)
+    core::StarBlock barnard;
+    barnard.append(269.44850252543, 4.73942005, 9.5);
+    barnard.setProperMotion(0, -801.551, 10362.394);
+    double ra = 269.44850252543, dec = 4.73942005;
+    rigorous(ra, dec, -801.551, 10362.394, years);
+    EpochPropagation::propagate(barnard, target);
+    double barnardError = separationMas(ra, dec, barnard.getRightAscension(0),
+                                        barnard.getDeclination(0));
+    std::cout << "  Barnard: dDec = " << (barnard.getDeclination(0) - 4.73942005) * 3600.0
+              << "\", scarto " << barnardError << " mas\n";
+    check(barnardError < 1.0, "stella di Barnard (10\"/anno) entro 1 mas");
+
+    // Senza moto proprio le posizioni non cambiano; passaggio per 0h
+    core::StarBlock still;
+    still.append(10.0, 20.0, 5.0);
+    still.append(0.0000001, 0.0, 5.0);
+    still.setProperMotion(1, -100.0, 0.0);
+    EpochPropagation::propagate(still, target);
+    check(still.getRightAscension(0) == 10.0 && still.getDeclination(0) == 20.0,
+          "stella senza moto proprio invariata");
+    check(still.getRightAscension(1) > 359.9 && still.getRightAscension(1) < 360.0,
+          "RA riportata in [0, 360) al passaggio per 0h");
+}
+
+static void benchmark(size_t n) {
+    std::cout << "\n[Benchmark: " << n << " stelle]\n";
+    const double target = 2025.95;
+
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> raDist(0.0, 360.0), decDist(-89.0, 89.0);
+    std::normal_distribution<double> pmDist(0.0, 20.0);
+
+    core::StarBlock source;
+    source.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        size_t row = source.append(raDist(rng), decDist(rng), 15.0);
+        source.setProperMotion(row, pmDist(rng), pmDist(rng));
+    }
+
+    auto timeKernel = [&](int threads) {
+#ifdef _OPENMP
+        int previous = omp_get_max_threads();
+        omp_set_num_threads(threads);
+#else
+        (void)threads;
+#endif
+        double best = 1e9;
+        for (int rep = 0; rep < 5; ++rep) {
+            core::StarBlock block = source;
+            auto start = Clock::now();
+            EpochPropagation::propagate(block, target);
+            best = std::min(best, std::chrono::duration<double, std::milli>(
+                                      Clock::now() - start).count());
+        }
+#ifdef _OPENMP
+        omp_set_num_threads(previous);
+#endif
+        return best;
+    };
+
+    // Riferimento: propagazione per oggetto sul vettore di Star
+    auto objects = source.toStars();
+    auto start = Clock::now();
+    double years = target - EpochPropagation::GAIA_DR3_EPOCH;
+    for (auto& star : objects) {
+        const auto& c = star->getCoordinates();
+        double dec = c.getDeclination();
+        double ra = c.getRightAscension() +
+                    *star->getProperMotionRA() * years / 3.6e6 / std::cos(dec * DEG);
+        ra = std::fmod(ra + 360.0, 360.0);
+        dec += *star->getProperMotionDec() * years / 3.6e6;
+        star->setCoordinates(core::EquatorialCoordinates(ra, dec));
+    }
+    double objectMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    int threads = 1;
+#ifdef _OPENMP
+    threads = omp_get_max_threads();
+#endif
+    double serialMs = timeKernel(1);
+    double parallelMs = timeKernel(threads);
+
+    std::cout << "  Oggetti Star:         " << objectMs << " ms\n"
+              << "  Kernel, 1 thread:     " << serialMs << " ms ("
+              << n / serialMs / 1000.0 << " M stelle/s)\n"
+              << "  Kernel, " << threads << " thread:     " << parallelMs << " ms ("
+              << n / parallelMs / 1000.0 << " M stelle/s)\n";
+    check(serialMs < objectMs, "kernel colonnare più veloce del percorso ad oggetti");
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    std::cout << "=== Test EpochPropagation ===\n";
+    testEpochParsing();
+    testAccuracy();
+    benchmark(n);
+
+    return examples::testSummary();
+}
@@ -0,0 +1,171 @@
+/**
+ * @file test_http_cache.cpp
+ * @brief Verifica della cache HTTP persistente contro un server locale
+ *
+ * Un server HTTP su 127.0.0.1 sostituisce VizieR/SIMBAD e conta le
+ * richieste ricevute. Il test controlla: memorizzazione e hit senza
+ * traffico, equivalenza delle chiavi normalizzate, rivalidazione con 304,
+ * risposta scaduta servita a server spento, persistenza tra istanze e
+ * limite di spazio su disco.
+ *
+ * Uso: test_http_cache [directory temporanea]
+ */
+
+#include "loopback_http_server.h"
+#include "test_support.h"
+#include <starmap/utils/HttpCache.h>
+#include <starmap/utils/HttpClient.h>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+
+using namespace starmap;
+using examples::check;
+using starmap::examples::LoopbackHttpServer;
+using starmap::examples::LoopbackRequest;
+using starmap::examples::LoopbackResponse;
+
+/**
+ * @brief Risposte del servizio simulato
+ *
+ * /fresh   risposta valida un'ora
+ * /etag    scade subito, rivalidabile con ETag
+ * /nostore non memorizzabile
+ * /big     risposta di 64 KB (per il limite di spazio)
+ */
+static LoopbackResponse handle(const LoopbackRequest& request) {
+    LoopbackResponse response;
+    const std::string& target = request.target;
+
+    if (target.rfind("/fresh", 0) == 0) {
+        response.headers["Cache-Control"] = "max-age=3600";
+        response.body = "fresh:" + target;
+    } else if (target.rfind("/etag", 0) == 0) {
+        response.headers["Cache-Control"] = "max-age=0";
+        response.headers["ETag"] = "\"v1\"";
+        auto match = request.headers.find("if-none-match");
+        if (match != request.headers.end() && match->second == "\"v1\"") {
+            response.status = 304;
+        } else {
+            response.body = "etag-body";
+        }
+    } else if (target.rfind("/nostore", 0) == 0) {
+        response.headers["Cache-Control"] = "no-store";
+        response.body = "nostore";
+    } else if (target.rfind("/big", 0) == 0) {
+        response.headers["Cache-Control"] = "max-age=3600";
+        response.body = std::string(64 * 1024, 'x');
+    } else {
+        response.status = 404;
+    }
+    return response;
+}
+
+int main(int argc, char* argv[]) {
+    namespace fs = std::filesystem;
+    fs::path directory = argc > 1 ? fs::path(argv[1])
+                                  : fs::temp_directory_path() / "starmap_test_http_cache";
+    fs::remove_all(directory);
+
+    std::cout << "=== Test cache HTTP persistente ===\n";
+    std::cout << "Directory: " << directory << "\n\n";
+
+    auto server = std::make_unique<LoopbackHttpServer>(handle);
+    if (!server->isRunning()) {
+        std::cerr << "Impossibile avviare il server locale\n";
+        return 1;
+    }
+
+    auto cache = std::make_shared<utils::HttpCache>(directory.string());
+    utils::HttpClient client;
+    client.setTimeout(5);
+    client.setCache(cache);
+
+    std::cout << "Memorizzazione e hit:\n";
+    std::string url = server->url("/fresh?-source=I/131A&RA=10.5&DEC=-20");
+    std::string first = client.get(url);
+    size_t before = server->requests();
+    std::string second = client.get(url);
+    check(first == second && !first.empty(), "stessa risposta alla seconda richiesta");
+    check(server->requests() == before, "seconda richiesta servita dal disco");
+
+    std::cout << "Chiavi normalizzate:\n";
+    before = server->requests();
+    client.get("HTTP://127.0.0.1:" + std::to_string(server->port()) +
+               "/fresh?DEC=-20&RA=10.5&-source=I%2F131A#frammento");
+    check(server->requests() == before, "parametri riordinati e codificati diversamente");
+
+    std::string adqlA = utils::HttpCache::normalizeKey(
+        "GET", "http://tap.example/sync?QUERY=SELECT+*+FROM+t%0A++WHERE+x%3D1&LANG=ADQL");
+    std::string adqlB = utils::HttpCache::normalizeKey(
+        "GET", "http://tap.example:80/sync?LANG=ADQL&QUERY=SELECT%20*%20FROM%20t%20WHERE%20x=1");
+    check(adqlA == adqlB, "query ADQL che differiscono solo per gli spazi");
+    check(utils::HttpCache::normalizeKey("GET", "http://h/p?a=1") !=
+          utils::HttpCache::normalizeKey("GET", "http://h/p?a=2"),
+          "valori diversi restano chiavi diverse");
+
+    std::cout << "Rivalidazione:\n";
+    std::string etagUrl = server->url("/etag");
+    std::string etagBody = client.get(etagUrl);
+    auto stats = cache->getStatistics();
+    size_t revalidatedBefore = stats.revalidated;
+    std::string etagAgain = client.get(etagUrl);
+    stats = cache->getStatistics();
+    check(etagBody == "etag-body" && etagAgain == etagBody, "corpo conservato dopo il 304");
+    check(stats.revalidated == revalidatedBefore + 1, "risposta confermata con If-None-Match");
+
+    before = server->requests();
+    client.get(server->url("/nostore"));
+    client.get(server->url("/nostore"));
+    check(server->requests() == before + 2, "no-store non viene memorizzato");
+
+    std::cout << "Persistenza:\n";
+    {
+        auto reopened = std::make_shared<utils::HttpCache>(directory.string());
+        utils::HttpClient other;
+        other.setCache(reopened);
+        before = server->requests();
+        check(other.get(url) == first && server->requests() == before,
+              "risposta letta da una nuova istanza della cache");
+    }
+
+    std::cout << "Server non raggiungibile:\n";
+    server.reset();
+    try {
+        check(client.get(etagUrl) == "etag-body", "risposta scaduta servita a server spento");
+    } catch (const std::exception& e) {
+        check(false, std::string("risposta scaduta servita a server spento (") + e.what() + ")");
+    }
+    bool threw = false;
+    try {
+        client.get(etagUrl + "?mai=richiesto");
+    } catch (const std::exception&) {
+        threw = true;
+    }
+    check(threw, "errore se la risposta non è in cache");
+
+    std::cout << "Limite di spazio:\n";
+    server = std::make_unique<LoopbackHttpServer>(handle);
+    cache->clear();
+    cache->setMaxBytes(256 * 1024);
+    for (int i = 0; i < 10; ++i) {
+        client.get(server->url("/big?n=" + std::to_string(i)));
+    }
+    stats = cache->getStatistics();
+    check(stats.diskUsage <= stats.maxBytes, "spazio occupato entro il limite");
+    check(stats.evictions > 0, "risposte meno recenti rimosse");
+    before = server->requests();
+    client.get(server->url("/big?n=9"));
+    check(server->requests() == before, "la risposta più recente resta in cache");
+
+    stats = cache->getStatistics();
+    std::cout << "\nStatistiche: " << stats.hits << " hit, " << stats.stale << " scadute, "
+              << stats.revalidated << " rivalidate, " << stats.misses << " miss, "
+              << stats.evictions << " rimosse, " << stats.entries << " file ("
+              << stats.diskUsage << " byte)\n";
+
+    fs::remove_all(directory);
+
+    return examples::testSummary();
+}
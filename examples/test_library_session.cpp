@@ -0,0 +1,56 @@
+/**
+ * @file test_library_session.cpp
+ * @brief Test del ciclo initialize()/finalize() e della sessione del catalogo Gaia
+ *
+ * Una reinizializzazione con GaiaClient ancora aperti deve fallire senza
+ * toccare la configurazione; rilasciati i client deve applicare i nuovi
+ * path. Il catalogo Gaia non è necessario: la sessione viene creata anche
+ * quando non è disponibile.
+ */
+
+#include <starmap/StarMap.h>
+#include <starmap/catalog/GaiaCatalogSession.h>
+#include <iostream>
+#include <memory>
+
+#include "test_support.h"
+
+using namespace starmap;
+using examples::check;
+
+int main() {
+    std::cout << "=== Test sessione della libreria ===\n";
+
+    config::LibraryConfig::CatalogPaths first;
+    first.gaiaSaoDatabase = "first_gaia_sao.db";
+    check(initialize(first), "prima inizializzazione applicata");
+    check(catalog::GaiaCatalogSession::isActive(), "initialize() apre la sessione");
+
+    auto sessionBefore = catalog::GaiaCatalogSession::acquire();
+    auto client = std::make_unique<catalog::GaiaClient>();
+
+    config::LibraryConfig::CatalogPaths second;
+    second.gaiaSaoDatabase = "second_gaia_sao.db";
+    check(!initialize(second), "reinizializzazione con un GaiaClient aperto: rifiutata");
+    check(config::LibraryConfig::getInstance().getPaths()->gaiaSaoDatabase == "first_gaia_sao.db",
+          "configurazione invariata");
+    check(catalog::GaiaCatalogSession::acquire() == sessionBefore, "stessa sessione");
+
+    client.reset();
+    sessionBefore.reset();
+    check(initialize(second), "rilasciati i client: reinizializzazione applicata");
+    check(config::LibraryConfig::getInstance().getPaths()->gaiaSaoDatabase == "second_gaia_sao.db",
+          "nuovi path in uso");
+
+    // finalize() rilascia il riferimento della libreria, l'ultimo rimasto
+    {
+        std::weak_ptr<catalog::GaiaCatalogSession> session = catalog::GaiaCatalogSession::acquire();
+        finalize();
+        check(session.expired() && !catalog::GaiaCatalogSession::isActive(),
+              "finalize() chiude la sessione");
+    }
+
+    // Senza finalize(): la sessione resta aperta fino all'uscita del processo
+    check(initialize(first), "inizializzazione dopo finalize()");
+    return examples::testSummary();
+}
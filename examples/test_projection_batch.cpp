@@ -0,0 +1,161 @@
+/**
+ * @file test_projection_batch.cpp
+ * @brief Verifica e benchmark della proiezione batch (projectBatch)
+ *
+ * Per le proiezioni stereografica, gnomonica e ortografica controlla che
+ * projectBatch concordi con project()/isVisible() punto per punto (stessa
+ * visibilità, coordinate entro la precisione float), anche con centro
+ * spostato da setCenter() e RA fuori da [0, 360). Poi misura su N stelle
+ * (default 1M) il percorso batch contro isVisible() + project().
+ *
+ * Uso: test_projection_batch [stelle]
+ */
+
+#include <starmap/map/Projection.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "test_support.h"
+
+using namespace starmap;
+using examples::check;
+using map::ProjectionType;
+using Clock = std::chrono::steady_clock;
+
+struct NamedProjection {
+    ProjectionType type;
+    const char* name;
+};
+
+static const NamedProjection PROJECTIONS[] = {
+    {ProjectionType::STEREOGRAPHIC, "stereografica"},
+    {ProjectionType::GNOMONIC, "gnomonica"},
+    {ProjectionType::ORTHOGRAPHIC, "ortografica"},
+};
+
+static void randomSky(size_t n, unsigned seed, std::vector<double>& ra, std::vector<double>& dec) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> raDist(-360.0, 720.0), zDist(-1.0, 1.0);
+    ra.resize(n);
+    dec.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        ra[i] = raDist(rng);
+        dec[i] = std::asin(zDist(rng)) * 180.0 / M_PI;
+    }
+}
+
+static void compare(const map::Projection& projection, const std::vector<double>& ra,
+                    const std::vector<double>& dec, const std::string& description) {
+    size_t n = ra.size();
+    std::vector<float> x(n), y(n);
+    std::vector<uint8_t> visible(n);
+    projection.projectBatch(ra.data(), dec.data(), n, x.data(), y.data(), visible.data());
+
+    size_t mismatches = 0, shown = 0;
+    double worst = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        core::EquatorialCoordinates coord(ra[i], dec[i]);
+        bool expected = projection.isVisible(coord);
+        if (expected != (visible[i] != 0)) {
+            mismatches++;
+            continue;
+        }
+        if (!expected) continue;
+        shown++;
+        auto p = projection.project(coord);
+        worst = std::max({worst, std::abs(p.getX() - x[i]), std::abs(p.getY() - y[i])});
+    }
+    std::cout << "    " << shown << " visibili, scarto massimo " << worst << "\n";
+    check(mismatches == 0 && shown > 0 && worst < 1e-5, description);
+}
+
+static void testEquivalence() {
+    std::cout << "\n[Equivalenza con project/isVisible]\n";
+    std::vector<double> ra, dec;
+    randomSky(200000, 2023, ra, dec);
+
+    for (const auto& entry : PROJECTIONS) {
+        auto projection = map::ProjectionFactory::create(
+            entry.type, core::EquatorialCoordinates(83.8, -5.4), 60.0, 40.0);
+        compare(*projection, ra, dec, std::string(entry.name) + ", campo 60°x40° su Orione");
+
+        projection->setCenter(core::EquatorialCoordinates(12.0, 88.5));
+        compare(*projection, ra, dec, std::string(entry.name) + ", centro spostato vicino al polo");
+
+        projection->setFieldOfView(2.0, 1.5);
+        projection->setCenter(core::EquatorialCoordinates(359.9, 0.0));
+        compare(*projection, ra, dec, std::string(entry.name) + ", campo 2° a cavallo di 0h");
+    }
+
+    // Punto agli antipodi del centro: mai visibile, nessun valore non finito
+    // nelle coordinate dei punti visibili
+    double antiRA[2] = {180.0, 0.0}, antiDec[2] = {0.0, 0.0};
+    for (const auto& entry : PROJECTIONS) {
+        auto projection = map::ProjectionFactory::create(
+            entry.type, core::EquatorialCoordinates(0.0, 0.0), 30.0, 30.0);
+        float x[2], y[2];
+        uint8_t visible[2];
+        projection->projectBatch(antiRA, antiDec, 2, x, y, visible);
+        check(!visible[0] && visible[1] && x[1] == 0.0f && y[1] == 0.0f,
+              std::string(entry.name) + ": antipodi nascosti, centro in (0, 0)");
+    }
+}
+
+static void benchmark(size_t n) {
+    std::cout << "\n[Benchmark: " << n << " stelle]\n";
+    std::vector<double> ra, dec;
+    randomSky(n, 42, ra, dec);
+    std::vector<float> x(n), y(n);
+    std::vector<uint8_t> visible(n);
+
+    for (const auto& entry : PROJECTIONS) {
+        auto projection = map::ProjectionFactory::create(
+            entry.type, core::EquatorialCoordinates(83.8, -5.4), 60.0, 40.0);
+
+        double batchMs = 1e9;
+        size_t batchVisible = 0;
+        for (int rep = 0; rep < 5; ++rep) {
+            auto start = Clock::now();
+            projection->projectBatch(ra.data(), dec.data(), n, x.data(), y.data(), visible.data());
+            batchMs = std::min(batchMs, std::chrono::duration<double, std::milli>(
+                                            Clock::now() - start).count());
+        }
+        for (size_t i = 0; i < n; ++i) batchVisible += visible[i];
+
+        // Riferimento: il percorso precedente di MapRenderer::drawStars
+        auto start = Clock::now();
+        size_t pointVisible = 0;
+        double checksum = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            core::EquatorialCoordinates coord(ra[i], dec[i]);
+            if (!projection->isVisible(coord)) continue;
+            auto p = projection->project(coord);
+            checksum += p.getX();
+            pointVisible++;
+        }
+        double pointMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+        std::cout << "  " << entry.name << ": batch " << batchMs << " ms ("
+                  << batchMs * 1e6 / n << " ns/stella), per punto " << pointMs << " ms ("
+                  << pointMs * 1e6 / n << " ns/stella), " << pointVisible
+                  << " visibili (checksum " << checksum << ")\n";
+        check(batchVisible == pointVisible && batchMs < pointMs,
+              std::string(entry.name) + ": stesse stelle visibili, batch più veloce");
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    std::cout << "=== Test Projection::projectBatch ===\n";
+    testEquivalence();
+    benchmark(n);
+
+    return examples::testSummary();
+}
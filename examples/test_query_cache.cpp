@@ -0,0 +1,194 @@
+/**
+ * @file test_query_cache.cpp
+ * @brief Test della cache delle query a cono (QueryCache)
+ *
+ * Un catalogo sintetico (griglia con magnitudini tutte diverse, in ordine
+ * non ordinato come le tile) fornisce sia i risultati da inserire sia il
+ * riferimento: per ogni richiesta servita dalla cache le stelle devono
+ * essere esattamente le più luminose del cono richiesto.
+ */
+
+#include <starmap/catalog/QueryCache.h>
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <vector>
+
+#include "test_support.h"
+
+using namespace starmap;
+using examples::check;
+
+namespace {
+
+struct CatalogStar {
+    double ra;
+    double dec;
+    double magnitude;
+    long long id;
+};
+
+/**
+ * @brief Griglia di 41x41 stelle a passi di 0.1° attorno a (100°, +30°)
+ *
+ * 7919 è invertibile modulo 1697 (primo): magnitudini distinte, senza pari merito.
+ */
+std::vector<CatalogStar> makeCatalog() {
+    std::vector<CatalogStar> catalog;
+    long long id = 1;
+    for (int i = -20; i <= 20; ++i) {
+        for (int j = -20; j <= 20; ++j, ++id) {
+            double magnitude = 8.0 + static_cast<double>((id * 7919) % 1697) * 0.004;
+            catalog.push_back({100.0 + i * 0.1, 30.0 + j * 0.1, magnitude, id});
+        }
+    }
+    return catalog;
+}
+
+catalog::GaiaQueryParameters cone(double ra, double dec, double radius, double maxMagnitude,
+                                  int maxResults, bool keepBrightest = true) {
+    catalog::GaiaQueryParameters params;
+    params.center = core::EquatorialCoordinates(ra, dec);
+    params.radiusDegrees = radius;
+    params.maxMagnitude = maxMagnitude;
+    params.maxResults = maxResults;
+    params.keepBrightest = keepBrightest;
+    return params;
+}
+
+std::vector<CatalogStar> inCone(const std::vector<CatalogStar>& catalog,
+                                const catalog::GaiaQueryParameters& params) {
+    std::vector<CatalogStar> result;
+    for (const auto& star : catalog) {
+        core::EquatorialCoordinates position(star.ra, star.dec);
+        if (star.magnitude <= params.maxMagnitude &&
+            params.center.angularDistance(position) <= params.radiusDegrees) {
+            result.push_back(star);
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief ID delle stelle più luminose del cono (riferimento)
+ */
+std::set<long long> brightestIds(const std::vector<CatalogStar>& catalog,
+                                 const catalog::GaiaQueryParameters& params) {
+    auto stars = inCone(catalog, params);
+    std::sort(stars.begin(), stars.end(), [](const CatalogStar& a, const CatalogStar& b) {
+        return a.magnitude < b.magnitude;
+    });
+    if (params.maxResults > 0 && stars.size() > static_cast<size_t>(params.maxResults)) {
+        stars.resize(params.maxResults);
+    }
+    std::set<long long> ids;
+    for (const auto& star : stars) ids.insert(star.id);
+    return ids;
+}
+
+/**
+ * @brief Risultato della query come lo restituirebbe il catalogo (ordine della griglia)
+ */
+core::StarBlock catalogResult(const std::vector<CatalogStar>& catalog,
+                              const catalog::GaiaQueryParameters& params) {
+    auto selected = brightestIds(catalog, params);
+    core::StarBlock block;
+    for (const auto& star : catalog) {
+        if (selected.count(star.id)) block.append(star.ra, star.dec, star.magnitude, star.id);
+    }
+    return block;
+}
+
+std::set<long long> ids(const core::StarBlock& block) {
+    std::set<long long> result;
+    for (size_t i = 0; i < block.size(); ++i) result.insert(block.getGaiaId(i));
+    return result;
+}
+
+void testSameKey(const std::vector<CatalogStar>& catalog) {
+    std::cout << "\n=== Stessa chiave, limite più piccolo ===\n";
+    catalog::QueryCache cache;
+
+    auto stored = cone(100.0, 30.0, 1.53, 14.0, 200);
+    cache.insert(stored, false, catalogResult(catalog, stored));
+
+    auto smaller = cone(100.0, 30.0, 1.53, 14.0, 25);
+    auto result = cache.lookup(smaller, false);
+    check(result && cache.getStatistics().hits == 1, "servita dall'entry con la stessa chiave");
+    check(result && ids(*result) == brightestIds(catalog, smaller), "le 25 più luminose del cono");
+
+    auto unordered = cone(100.0, 30.0, 1.53, 14.0, 25, false);
+    check(!(catalog::QueryCache::makeKey(smaller, false) == catalog::QueryCache::makeKey(unordered, false)),
+          "keepBrightest fa parte della chiave");
+    check(catalog::QueryCache::makeKey(cone(100.0, 30.0, 1.53, 14.0, 0, true), false) ==
+          catalog::QueryCache::makeKey(cone(100.0, 30.0, 1.53, 14.0, 0, false), false),
+          "senza limite keepBrightest non cambia la chiave");
+}
+
+void testNestedComplete(const std::vector<CatalogStar>& catalog) {
+    std::cout << "\n=== Cono interno da un'entry completa ===\n";
+    catalog::QueryCache cache;
+
+    auto stored = cone(100.0, 30.0, 1.93, 15.0, 0);
+    cache.insert(stored, false, catalogResult(catalog, stored));
+
+    auto nested = cone(100.27, 30.41, 0.77, 13.5, 12);
+    auto result = cache.lookup(nested, false);
+    check(result && cache.getStatistics().containmentHits == 1, "servita per contenimento");
+    check(result && ids(*result) == brightestIds(catalog, nested), "le 12 più luminose del cono interno");
+
+    auto sameCone = cone(100.0, 30.0, 1.93, 15.0, 40);
+    result = cache.lookup(sameCone, false);
+    check(result && ids(*result) == brightestIds(catalog, sameCone),
+          "stesso cono con limite: le 40 più luminose");
+
+    auto anyStars = cone(100.27, 30.41, 0.77, 13.5, 12, false);
+    result = cache.lookup(anyStars, false);
+    auto allInCone = brightestIds(catalog, cone(100.27, 30.41, 0.77, 13.5, 0));
+    std::set<long long> returned = result ? ids(*result) : std::set<long long>();
+    bool subset = std::all_of(returned.begin(), returned.end(),
+                              [&](long long id) { return allInCone.count(id) > 0; });
+    check(result && result->size() == 12 && subset, "senza keepBrightest: 12 stelle del cono");
+}
+
+void testNestedTruncated(const std::vector<CatalogStar>& catalog) {
+    std::cout << "\n=== Cono interno da un'entry troncata ===\n";
+    catalog::QueryCache cache;
+
+    auto stored = cone(100.0, 30.0, 1.93, 15.0, 300);
+    core::StarBlock block = catalogResult(catalog, stored);
+    cache.insert(stored, false, block);
+    float faintest = *std::max_element(block.magnitudeColumn().begin(), block.magnitudeColumn().end());
+
+    auto enough = cone(100.27, 30.41, 0.77, 15.0, 10);
+    auto result = cache.lookup(enough, false);
+    check(result && ids(*result) == brightestIds(catalog, enough),
+          "il filtro lascia abbastanza stelle: le 10 più luminose");
+
+    auto tooMany = cone(100.27, 30.41, 0.77, 15.0, 5000);
+    check(!cache.lookup(tooMany, false), "limite oltre le stelle rimaste: miss");
+
+    auto belowThreshold = cone(100.27, 30.41, 0.77, faintest - 0.01, 5000);
+    result = cache.lookup(belowThreshold, false);
+    check(result && ids(*result) == brightestIds(catalog, belowThreshold),
+          "magnitudine limite sotto la stella più debole: tutte le stelle");
+
+    catalog::QueryCache unorderedCache;
+    auto unordered = cone(100.0, 30.0, 1.93, 15.0, 300, false);
+    unorderedCache.insert(unordered, false, catalogResult(catalog, unordered));
+    check(!unorderedCache.lookup(enough, false),
+          "un'entry troncata senza keepBrightest non serve coni interni");
+}
+
+} // namespace
+
+int main() {
+    std::cout << "=== Test QueryCache ===\n";
+
+    auto catalog = makeCatalog();
+    testSameKey(catalog);
+    testNestedComplete(catalog);
+    testNestedTruncated(catalog);
+
+    return examples::testSummary();
+}
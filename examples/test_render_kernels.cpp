@@ -0,0 +1,226 @@
+/**
+ * @file test_render_kernels.cpp
+ * @brief Costo per stella del rendering: proiezione virtuale e kernel inline
+ *
+ * Per ogni proiezione standard controlla che projectBatch (una chiamata
+ * virtuale per blocco di stelle, il percorso di MapRenderer) dia lo
+ * stesso risultato del kernel inline di ProjectionKernels.h istanziato
+ * per tipo. Poi misura su N stelle (default 1M) le due proiezioni e il
+ * rendering completo, in un campo largo e in un campo stretto dove quasi
+ * tutte le stelle sono scartate.
+ *
+ * Uso: test_render_kernels [stelle]
+ */
+
+#include <starmap/map/MapRenderer.h>
+#include <starmap/map/Projection.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "test_support.h"
+
+using namespace starmap;
+using examples::check;
+using map::ProjectionType;
+using Clock = std::chrono::steady_clock;
+
+// Stelle per chiamata di proiezione, come in MapRenderer
+constexpr size_t CHUNK = 1024;
+
+struct NamedProjection {
+    ProjectionType type;
+    const char* name;
+};
+
+static const NamedProjection PROJECTIONS[] = {
+    {ProjectionType::STEREOGRAPHIC, "stereografica"},
+    {ProjectionType::GNOMONIC, "gnomonica"},
+    {ProjectionType::ORTHOGRAPHIC, "ortografica"},
+};
+
+/**
+ * @brief Stelle uniformi in una calotta di raggio dato attorno a (ra0, dec0)
+ */
+static core::StarBlock randomStars(size_t n, double ra0, double dec0, double radius,
+                                   unsigned seed) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0), magDist(2.0, 12.0);
+    std::uniform_real_distribution<double> bvDist(-0.3, 2.0);
+    const double deg = M_PI / 180.0;
+    double minCos = std::cos(radius * deg);
+
+    core::StarBlock block;
+    block.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        // Punto nella calotta attorno al polo, poi ruotato sul centro
+        double z = 1.0 - unit(rng) * (1.0 - minCos);
+        double phi = 2.0 * M_PI * unit(rng);
+        double r = std::sqrt(1.0 - z * z);
+        double px = r * std::cos(phi), py = r * std::sin(phi);
+        double s = std::sin(dec0 * deg), c = std::cos(dec0 * deg);
+        double x = -s * px + c * z, zz = c * px + s * z;
+        double ra = ra0 + std::atan2(py, x) / deg;
+        double dec = std::asin(std::max(-1.0, std::min(1.0, zz))) / deg;
+
+        size_t row = block.append(std::fmod(ra + 360.0, 360.0), dec, magDist(rng));
+        if (i % 3 == 0) block.setColorIndex(row, bvDist(rng));
+        if (i % 50 == 0) block.setSAONumber(row, 100000 + static_cast<int>(i));
+        if (i % 500 == 0) block.setName(row, "S" + std::to_string(i));
+    }
+    return block;
+}
+
+struct Projected {
+    std::vector<float> x, y;
+    std::vector<uint8_t> visible;
+
+    explicit Projected(size_t n) : x(n), y(n), visible(n) {}
+};
+
+/**
+ * @brief Proiezione a blocchi tramite l'interfaccia virtuale
+ */
+static void projectVirtual(const map::Projection& projection, const core::StarBlock& stars,
+                           Projected& out) {
+    const double* ra = stars.raColumn().data();
+    const double* dec = stars.decColumn().data();
+    for (size_t chunk = 0; chunk < stars.size(); chunk += CHUNK) {
+        size_t count = std::min(CHUNK, stars.size() - chunk);
+        projection.projectBatch(ra + chunk, dec + chunk, count, out.x.data() + chunk,
+                                out.y.data() + chunk, out.visible.data() + chunk);
+    }
+}
+
+/**
+ * @brief Stessa proiezione con il kernel del tipo concreto espanso nel ciclo
+ */
+template <class ProjectionClass>
+static void projectInline(const map::Projection& projection, const core::StarBlock& stars,
+                          Projected& out) {
+    const auto kernel = static_cast<const ProjectionClass&>(projection).kernel();
+    const double* ra = stars.raColumn().data();
+    const double* dec = stars.decColumn().data();
+    for (size_t chunk = 0; chunk < stars.size(); chunk += CHUNK) {
+        size_t count = std::min(CHUNK, stars.size() - chunk);
+        map::kernels::projectColumns(kernel, ra + chunk, dec + chunk, count, out.x.data() + chunk,
+                                     out.y.data() + chunk, out.visible.data() + chunk);
+    }
+}
+
+static void projectInline(ProjectionType type, const map::Projection& projection,
+                          const core::StarBlock& stars, Projected& out) {
+    switch (type) {
+        case ProjectionType::STEREOGRAPHIC:
+            return projectInline<map::StereographicProjection>(projection, stars, out);
+        case ProjectionType::GNOMONIC:
+            return projectInline<map::GnomonicProjection>(projection, stars, out);
+        default:
+            return projectInline<map::OrthographicProjection>(projection, stars, out);
+    }
+}
+
+static map::MapConfiguration makeConfig(ProjectionType type, double fov) {
+    map::MapConfiguration config;
+    config.center = core::EquatorialCoordinates(83.8, -5.4);
+    config.fieldOfViewWidth = fov;
+    config.fieldOfViewHeight = fov * 9.0 / 16.0;
+    config.imageWidth = 1600;
+    config.imageHeight = 900;
+    config.projection = type;
+    config.gridStyle.enabled = false;
+    config.starStyle.useSpectralColors = true;
+    config.starStyle.showNames = true;
+    config.starStyle.showSAONumbers = true;
+    return config;
+}
+
+template <typename Fn>
+static double bestMs(Fn&& fn) {
+    double best = 1e9;
+    for (int rep = 0; rep < 5; ++rep) {
+        auto start = Clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    return best;
+}
+
+static void testEquivalence() {
+    std::cout << "\n[Kernel inline = projectBatch]\n";
+    auto stars = randomStars(50000, 83.8, -5.4, 60.0, 11);
+
+    for (const auto& entry : PROJECTIONS) {
+        auto config = makeConfig(entry.type, 30.0);
+        auto projection = map::ProjectionFactory::create(entry.type, config.center,
+                                                         config.fieldOfViewWidth,
+                                                         config.fieldOfViewHeight);
+        Projected batch(stars.size()), inlined(stars.size());
+        projectVirtual(*projection, stars, batch);
+        projectInline(entry.type, *projection, stars, inlined);
+
+        size_t visible = 0, mismatches = 0;
+        for (size_t i = 0; i < stars.size(); ++i) {
+            if (batch.visible[i] != inlined.visible[i]) {
+                mismatches++;
+            } else if (batch.visible[i]) {
+                visible++;
+                mismatches += batch.x[i] != inlined.x[i] || batch.y[i] != inlined.y[i];
+            }
+        }
+        check(mismatches == 0 && visible > 1000,
+              std::string(entry.name) + ": stesse coordinate e visibilità (" +
+              std::to_string(visible) + " stelle visibili)");
+    }
+}
+
+static void benchmark(size_t n) {
+    std::cout << "\n[Benchmark: " << n << " stelle, colori spettrali, etichette]\n";
+
+    struct Scene {
+        const char* name;
+        double fov;
+        double radius;
+    };
+    const Scene scenes[] = {
+        {"campo 10°, stelle entro 20°", 10.0, 20.0},
+        {"campo 1°, stelle entro 60°", 1.0, 60.0},
+    };
+
+    for (const auto& scene : scenes) {
+        auto stars = randomStars(n, 83.8, -5.4, scene.radius, 42);
+        Projected out(n);
+        std::cout << "  " << scene.name << " (ns/stella)\n";
+        for (const auto& entry : PROJECTIONS) {
+            auto config = makeConfig(entry.type, scene.fov);
+            auto projection = map::ProjectionFactory::create(entry.type, config.center,
+                                                             config.fieldOfViewWidth,
+                                                             config.fieldOfViewHeight);
+            double virtualMs = bestMs([&] { projectVirtual(*projection, stars, out); });
+            double inlineMs = bestMs([&] { projectInline(entry.type, *projection, stars, out); });
+
+            map::MapRenderer renderer(config);
+            map::ImageBuffer buffer(config.imageWidth, config.imageHeight);
+            double renderMs = bestMs([&] { renderer.renderStarsBatched(buffer, stars); });
+
+            std::cout << "    " << entry.name << ": projectBatch " << virtualMs * 1e6 / n
+                      << ", kernel inline " << inlineMs * 1e6 / n
+                      << ", rendering completo " << renderMs * 1e6 / n << "\n";
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    std::cout << "=== Test costo del rendering per stella ===\n";
+    testEquivalence();
+    benchmark(n);
+
+    return examples::testSummary();
+}
@@ -4,6 +4,8 @@
  */
 
 #include <starmap/StarMap.h>
+#include <starmap/catalog/SAONumberIndex.h>
+#include <cstdint>
 #include <iostream>
 #include <iomanip>
 
@@ -161,6 +163,39 @@ int main(int argc, char* argv[]) {
               << std::fixed << std::setprecision(0)
               << (NUM_QUERIES * 1000000.0 / duration.count()) << "\n";
     
+    // 6. Lookup per numero SAO (tabella in memoria)
+    std::cout << "\n6. Lookup per numero SAO\n";
+    std::cout << "------------------------------------\n";
+    
+    if (auto index = db.getSAONumberIndex()) {
+        std::cout << "Tabella: " << index->size() << " stelle, "
+                  << std::fixed << std::setprecision(2)
+                  << (index->memoryUsage() / 1024.0 / 1024.0) << " MB, caricata in "
+                  << (index->loadSeconds() * 1000.0) << " ms\n";
+        
+        if (sirius_sao) {
+            if (auto entry = db.findBySAONumber(*sirius_sao)) {
+                std::cout << "SAO " << *sirius_sao << " -> Gaia " << entry->gaiaSourceId
+                          << std::setprecision(4) << " (RA " << entry->ra << ", Dec " << entry->dec
+                          << ", mag " << std::setprecision(2) << entry->magnitude << ")\n";
+            }
+        }
+        
+        const int NUM_LOOKUPS = 1000000;
+        int hits = 0;
+        start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < NUM_LOOKUPS; ++i) {
+            int saoNumber = static_cast<int>(1 + (static_cast<int64_t>(i) * 7919) % 260000);
+            if (index->find(saoNumber)) hits++;
+        }
+        end = std::chrono::high_resolution_clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / NUM_LOOKUPS;
+        std::cout << NUM_LOOKUPS << " lookup (" << hits << " trovati): "
+                  << std::setprecision(1) << ns << " ns per lookup\n";
+    } else {
+        std::cout << "Tabella per numero SAO non disponibile\n";
+    }
+    
     std::cout << "\n=== Test completato con successo! ===\n";
     
     return 0;
@@ -0,0 +1,171 @@
+/**
+ * @file test_sao_number_index.cpp
+ * @brief Correttezza della tabella per numero SAO (SAONumberIndex)
+ *
+ * Prima la tabella da sola (numeri presenti e assenti, numeri ripetuti,
+ * numeri non validi, tipi spettrali memorizzati una volta), poi la tabella
+ * caricata da GaiaSAODatabase confrontata numero per numero con la stessa
+ * ricerca fatta in SQL sul file.
+ *
+ * Uso: test_sao_number_index [stelle]
+ */
+
+#include <starmap/catalog/GaiaSAODatabase.h>
+#include <starmap/catalog/SAONumberIndex.h>
+#include <sqlite3.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "test_support.h"
+
+using namespace starmap;
+using examples::check;
+using starmap::catalog::GaiaSAOEntry;
+using starmap::catalog::SAONumberIndex;
+
+static void testIndex() {
+    std::cout << "Tabella in memoria:\n";
+    SAONumberIndex index;
+    check(index.add(10, 1.0, 2.0, 7.5, 111, "K0III"), "numero aggiunto");
+    check(index.add(25, 3.0, 4.0, 6.0, 222, "A0V"), "secondo numero aggiunto");
+    index.add(10, 1.1, 2.1, 6.5, 333, "K0III");     // Più brillante: sostituisce
+    index.add(25, 3.1, 4.1, 8.0, 444, "G2V");       // Più debole: ignorato
+    index.add(40, 5.0, 6.0, 9.0, 0, "K0III");
+    index.add(41, 5.5, 6.5, 9.0);
+    check(!index.add(0, 1.0, 1.0, 5.0), "numero 0 rifiutato");
+    check(!index.add(-7, 1.0, 1.0, 5.0), "numero negativo rifiutato");
+    check(!index.add(SAONumberIndex::MAX_SAO_NUMBER + 1, 1.0, 1.0, 5.0), "numero oltre il massimo rifiutato");
+    check(!index.add(50, std::nan(""), 1.0, 5.0), "posizione non valida rifiutata");
+    index.finish();
+
+    check(index.size() == 4, "4 numeri presenti");
+    const auto* ten = index.find(10);
+    check(ten && ten->gaiaSourceId == 333 && std::abs(ten->magnitude - 6.5f) < 1e-6f &&
+          ten->ra == 1.1 && ten->dec == 2.1, "numero ripetuto: vale la controparte più brillante");
+    const auto* twentyFive = index.find(25);
+    check(twentyFive && twentyFive->gaiaSourceId == 222 && index.spectralType(*twentyFive) == "A0V",
+          "controparte più debole ignorata");
+    check(!index.find(0) && !index.find(-1) && !index.find(11) && !index.find(42) &&
+          !index.find(SAONumberIndex::MAX_SAO_NUMBER), "numeri assenti e fuori intervallo");
+
+    const auto* forty = index.find(40);
+    const auto* fortyOne = index.find(41);
+    check(ten && forty && &index.spectralType(*ten) == &index.spectralType(*forty),
+          "stesso tipo spettrale memorizzato una volta");
+    check(fortyOne && index.spectralType(*fortyOne).empty(), "tipo spettrale assente: stringa vuota");
+}
+
+/**
+ * @brief Database di n numeri SAO (multipli di 3) con doppioni, stelle senza Gaia e tipi spettrali
+ */
+static bool writeDatabase(const std::string& path, int n) {
+    catalog::GaiaSAODatabase database(path);
+    if (!database.createNewDatabase()) return false;
+
+    std::vector<GaiaSAOEntry> entries;
+    for (int i = 1; i <= n; ++i) {
+        int sao = 3 * i;
+        double ra = std::fmod(i * 0.731, 360.0);
+        double dec = -80.0 + std::fmod(i * 0.0379, 160.0);
+        double mag = 5.0 + (i * 37 % 400) / 100.0;
+        // Le stelle senza controparte Gaia hanno chiave -SAO
+        long long sourceId = (i % 50 == 0) ? -sao : 1000000000LL + i * 13LL;
+        entries.push_back({sourceId, sao, ra, dec, mag, 0.5});
+        if (i % 10 == 0 && i % 50 != 0) {
+            double other = (i % 20 == 0) ? mag - 0.5 : mag + 0.5;
+            entries.push_back({sourceId + 7, sao, ra + 0.001, dec, other, 1.5});
+        }
+    }
+    if (database.insertBatch(entries) != entries.size() || !database.createIndices()) return false;
+
+    sqlite3* db = nullptr;
+    if (sqlite3_open(path.c_str(), &db) != SQLITE_OK) return false;
+    bool ok = sqlite3_exec(db, "UPDATE sao_xmatch SET sp_type = CASE sao % 4 "
+                               "WHEN 0 THEN 'K0III' WHEN 1 THEN 'A0V' WHEN 2 THEN 'G2V' END;",
+                           nullptr, nullptr, nullptr) == SQLITE_OK;
+    sqlite3_close(db);
+    return ok;
+}
+
+static void testAgainstSql(const std::string& path, int n) {
+    std::cout << "Tabella caricata dal database (" << n << " numeri):\n";
+    catalog::GaiaSAODatabase database(path);
+    auto index = database.getSAONumberIndex();
+    check(index && index->size() == static_cast<size_t>(n), "tabella caricata con tutti i numeri");
+    if (!index) return;
+
+    sqlite3* db = nullptr;
+    sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READONLY, nullptr);
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(db, "SELECT source_id, ra_udeg / 1000000.0, dec_udeg / 1000000.0, "
+                           "mag_mmag / 1000.0, sp_type FROM sao_xmatch WHERE sao = ? "
+                           "ORDER BY mag_mmag LIMIT 1;", -1, &stmt, nullptr);
+
+    size_t present = 0, absent = 0, mismatches = 0, entryMismatches = 0;
+    std::map<std::string, std::set<const std::string*>> typeStorage;
+    for (int sao = -3; sao <= 3 * n + 5; ++sao) {
+        sqlite3_bind_int(stmt, 1, sao);
+        bool inSql = sao > 0 && sqlite3_step(stmt) == SQLITE_ROW;
+        const auto* star = index->find(sao);
+        auto entry = database.findBySAONumber(sao);
+
+        if (!inSql) {
+            absent++;
+            if (star || entry) mismatches++;
+        } else {
+            present++;
+            long long sourceId = std::max<long long>(0, sqlite3_column_int64(stmt, 0));
+            const char* type = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 4));
+            bool same = star && star->gaiaSourceId == sourceId &&
+                        std::abs(star->ra - sqlite3_column_double(stmt, 1)) < 1e-9 &&
+                        std::abs(star->dec - sqlite3_column_double(stmt, 2)) < 1e-9 &&
+                        std::abs(star->magnitude - sqlite3_column_double(stmt, 3)) < 1e-4 &&
+                        index->spectralType(*star) == (type ? type : "");
+            if (!same) mismatches++;
+            if (star) typeStorage[index->spectralType(*star)].insert(&index->spectralType(*star));
+            if (!entry || !star || entry->gaiaSourceId != star->gaiaSourceId ||
+                entry->ra != star->ra || entry->dec != star->dec) {
+                entryMismatches++;
+            }
+        }
+        sqlite3_reset(stmt);
+    }
+    sqlite3_finalize(stmt);
+    sqlite3_close(db);
+
+    check(mismatches == 0, std::to_string(present) + " numeri presenti e " + std::to_string(absent) +
+                           " assenti come in SQL (" + std::to_string(mismatches) + " diversi)");
+    check(entryMismatches == 0, "findBySAONumber coincide con la tabella");
+    bool interned = typeStorage.size() == 4 &&
+                    std::all_of(typeStorage.begin(), typeStorage.end(),
+                                [](const auto& type) { return type.second.size() == 1; });
+    check(interned, "4 tipi spettrali (vuoto compreso), ognuno memorizzato una volta");
+}
+
+int main(int argc, char* argv[]) {
+    int numStars = argc > 1 ? std::max(100, std::atoi(argv[1])) : 20000;
+
+    auto directory = std::filesystem::temp_directory_path() / "starmap_test_sao_number_index";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    std::string path = (directory / "sao.db").string();
+
+    std::cout << "=== Test tabella per numero SAO ===\n\n";
+    testIndex();
+
+    if (writeDatabase(path, numStars)) {
+        testAgainstSql(path, numStars);
+    } else {
+        check(false, "database di prova scritto");
+    }
+
+    std::filesystem::remove_all(directory);
+    return examples::testSummary();
+}
@@ -0,0 +1,259 @@
+/**
+ * @file test_sao_online_enrichment.cpp
+ * @brief Verifica del fallback online nell'arricchimento SAO dei blocchi colonnari
+ *
+ * Un server locale fa da SIMBAD TAP e da X-Match (SAOCatalog::setServiceUrls).
+ * Con CatalogManager::getSAOCatalog().setOnlineFallback(true) le stelle non
+ * trovate nel database locale devono essere cercate online, sia con
+ * l'arricchimento seriale sia con quello parallelo; senza fallback il
+ * server non deve ricevere richieste.
+ *
+ * Stelle sintetiche (Gaia ID = BASE_ID + i), a seconda di i % 4:
+ *   0: nel database locale     (SAO 100000 + i)
+ *   1: note a SIMBAD per ID    (SAO 200000 + i)
+ *   2: note a X-Match per posizione (SAO 300000 + i)
+ *   3: in nessun catalogo
+ */
+
+#include <starmap/catalog/CatalogManager.h>
+#include <starmap/catalog/GaiaSAODatabase.h>
+#include <starmap/catalog/SAOCatalog.h>
+#include <starmap/config/LibraryConfig.h>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "loopback_http_server.h"
+#include "test_support.h"
+
+using namespace starmap;
+using examples::check;
+using starmap::examples::LoopbackHttpServer;
+using starmap::examples::LoopbackRequest;
+using starmap::examples::LoopbackResponse;
+
+namespace {
+
+// Oltre la soglia dell'arricchimento parallelo (più worker)
+constexpr size_t STAR_COUNT = 6000;
+constexpr long long BASE_ID = 5000000000LL;
+constexpr double STEP_DEG = 0.01;   // 36": oltre il raggio di 5" del cross-match
+
+double magnitudeOf(size_t i) { return i % 5 == 4 ? 11.0 : 6.0 + (i % 30) * 0.1; }
+
+std::optional<int> expectedSAO(size_t i, bool local, bool online) {
+    if (magnitudeOf(i) > 9.0) return std::nullopt;
+    switch (i % 4) {
+        case 0: return local ? std::optional<int>(100000 + static_cast<int>(i)) : std::nullopt;
+        case 1: return online ? std::optional<int>(200000 + static_cast<int>(i)) : std::nullopt;
+        case 2: return online ? std::optional<int>(300000 + static_cast<int>(i)) : std::nullopt;
+        default: return std::nullopt;
+    }
+}
+
+core::StarBlock syntheticStars() {
+    core::StarBlock stars;
+    stars.reserve(STAR_COUNT);
+    for (size_t i = 0; i < STAR_COUNT; ++i) {
+        stars.append(10.0 + i * STEP_DEG, 20.0, magnitudeOf(i), BASE_ID + static_cast<long long>(i));
+    }
+    return stars;
+}
+
+std::string votable(const std::string& fields, const std::string& rows) {
+    return "<?xml version=\"1.0\"?>\n"
+           "<VOTABLE version=\"1.4\" xmlns=\"http://www.ivoa.net/xml/VOTable/v1.3\">"
+           "<RESOURCE type=\"results\"><INFO name=\"QUERY_STATUS\" value=\"OK\"/><TABLE>" +
+           fields + "<DATA><TABLEDATA>\n" + rows + "</TABLEDATA></DATA></TABLE></RESOURCE></VOTABLE>\n";
+}
+
+/**
+ * @brief SIMBAD TAP e X-Match simulati; registra gli indici delle stelle richieste
+ */
+class FakeCDS {
+public:
+    FakeCDS() : server_([this](const LoopbackRequest& request) { return handle(request); }) {}
+
+    catalog::SAOServiceUrls urls() const {
+        catalog::SAOServiceUrls urls;
+        urls.vizier = server_.url("/viz-bin/votable");
+        urls.simbadTap = server_.url("/simbad/sim-tap/sync");
+        urls.xmatch = server_.url("/xmatch/api/v1/sync");
+        return urls;
+    }
+
+    size_t requestCount() const { return server_.requests(); }
+
+    std::set<size_t> asked() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return asked_;
+    }
+
+    void reset() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        asked_.clear();
+    }
+
+private:
+    LoopbackResponse handle(const LoopbackRequest& request) {
+        LoopbackResponse response;
+        response.headers["Content-Type"] = "application/x-votable+xml";
+        if (request.method == "POST") {
+            response.body = xmatch(request.body);
+        } else {
+            response.body = simbad(request.target);
+        }
+        return response;
+    }
+
+    // Gaia ID nella lista IN della query ADQL codificata ('Gaia+DR3+N')
+    std::string simbad(const std::string& target) {
+        const std::string prefix = "Gaia+DR3+";
+        std::ostringstream rows;
+        for (size_t pos = target.find(prefix); pos != std::string::npos;
+             pos = target.find(prefix, pos + 1)) {
+            size_t i = static_cast<size_t>(std::stoll(target.substr(pos + prefix.size())) - BASE_ID);
+            record(i);
+            if (i % 4 == 1) {
+                rows << "<TR><TD>Gaia DR3 " << BASE_ID + static_cast<long long>(i)
+                     << "</TD><TD>SAO " << 200000 + i << "</TD></TR>\n";
+            }
+        }
+        return votable("<FIELD name=\"id\" datatype=\"char\" arraysize=\"*\"/>"
+                       "<FIELD name=\"id2\" datatype=\"char\" arraysize=\"*\"/>", rows.str());
+    }
+
+    // Tabella caricata "idx,ra,dec": la stella si riconosce dall'ascensione retta
+    std::string xmatch(const std::string& body) {
+        const std::string header = "idx,ra,dec\n";
+        std::istringstream csv(body.substr(body.find(header) + header.size()));
+        std::ostringstream rows;
+        std::string line;
+        while (std::getline(csv, line) && line.find(',') != std::string::npos) {
+            long long idx = 0;
+            double ra = 0.0;
+            char comma = 0;
+            std::istringstream(line) >> idx >> comma >> ra;
+            size_t i = static_cast<size_t>(std::lround((ra - 10.0) / STEP_DEG));
+            record(i);
+            if (i % 4 == 2) {
+                rows << "<TR><TD>" << idx << "</TD><TD>" << 300000 + i << "</TD><TD>0.4</TD></TR>\n";
+            }
+        }
+        return votable("<FIELD name=\"idx\" datatype=\"long\"/>"
+                       "<FIELD name=\"SAO\" datatype=\"int\"/>"
+                       "<FIELD name=\"angDist\" datatype=\"double\"/>", rows.str());
+    }
+
+    void record(size_t i) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        asked_.insert(i);
+    }
+
+    mutable std::mutex mutex_;
+    std::set<size_t> asked_;
+    LoopbackHttpServer server_;
+};
+
+bool matchesExpected(const core::StarBlock& stars, bool local, bool online) {
+    if (stars.size() != STAR_COUNT) return false;
+    for (size_t i = 0; i < stars.size(); ++i) {
+        if (stars.getSAONumber(i) != expectedSAO(i, local, online)) {
+            std::cout << "    riga " << i << ": SAO "
+                      << (stars.getSAONumber(i) ? std::to_string(*stars.getSAONumber(i)) : "-")
+                      << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Le righe trovate nel database locale non vanno online; le altre sotto mag 9 sì
+bool askedOnlyUnmatched(const std::set<size_t>& asked) {
+    for (size_t i = 0; i < STAR_COUNT; ++i) {
+        bool shouldAsk = magnitudeOf(i) <= 9.0 && i % 4 != 0;
+        if ((asked.count(i) != 0) != shouldAsk) return false;
+    }
+    return true;
+}
+
+catalog::GaiaQueryParameters cone(double ra) {
+    catalog::GaiaQueryParameters params;
+    params.center = core::EquatorialCoordinates(ra, 20.0);
+    params.radiusDegrees = 1.0;
+    return params;
+}
+
+} // namespace
+
+int main() {
+    std::cout << "=== Test fallback online dell'arricchimento SAO ===\n\n";
+
+    auto directory = std::filesystem::temp_directory_path() / "starmap_test_sao_online";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    std::string dbPath = (directory / "gaia_sao.db").string();
+    {
+        catalog::GaiaSAODatabase database(dbPath);
+        std::vector<catalog::GaiaSAOEntry> entries;
+        for (size_t i = 0; i < STAR_COUNT; i += 4) {
+            entries.push_back({BASE_ID + static_cast<long long>(i), 100000 + static_cast<int>(i),
+                               10.0 + i * STEP_DEG, 20.0, magnitudeOf(i), 0.1});
+        }
+        check(database.createNewDatabase() && database.insertBatch(entries) == entries.size() &&
+              database.createIndices(), "database locale con le stelle i % 4 == 0");
+    }
+    config::LibraryConfig::getInstance().setGaiaSaoDbPath(dbPath);
+
+    FakeCDS cds;
+    catalog::CatalogManager manager;
+    manager.setCacheEnabled(false);
+    manager.setStarSource([](const catalog::GaiaQueryParameters&) { return syntheticStars(); });
+    catalog::SAOCatalog& sao = manager.getSAOCatalog();
+    sao.setServiceUrls(cds.urls());
+    check(sao.hasLocalDatabase(), "database locale aperto da CatalogManager");
+
+    std::cout << "\nFallback disabilitato:\n";
+    {
+        auto stars = manager.queryStarBlock(cone(10.0));
+        check(matchesExpected(stars, true, false), "solo le stelle del database locale");
+        check(cds.requestCount() == 0, "nessuna richiesta online");
+    }
+
+    sao.setOnlineFallback(true);
+    for (bool parallel : {false, true}) {
+        std::cout << "\nFallback abilitato, arricchimento " << (parallel ? "parallelo" : "seriale") << ":\n";
+        cds.reset();
+        size_t before = cds.requestCount();
+        manager.setParallelEnrichment(parallel);
+        auto stars = manager.queryStarBlock(cone(parallel ? 30.0 : 20.0));
+        check(matchesExpected(stars, true, true), "database locale, poi SIMBAD, poi X-Match");
+        check(askedOnlyUnmatched(cds.asked()), "online solo le stelle sotto mag 9 non trovate in locale");
+        // Una query SIMBAD ogni 200 Gaia ID, un solo caricamento X-Match
+        size_t batches = (cds.asked().size() + 199) / 200 + 1;
+        check(cds.requestCount() - before == batches,
+              "richieste batch (" + std::to_string(batches) + ")");
+    }
+
+    std::cout << "\nSenza database locale:\n";
+    {
+        catalog::SAOCatalog online((directory / "missing.db").string());
+        online.setServiceUrls(cds.urls());
+        auto stars = syntheticStars();
+        check(online.enrichWithSAO(stars, 9.0) == 0, "fallback disabilitato: nessun numero SAO");
+        online.setOnlineFallback(true);
+        size_t enriched = online.enrichWithSAOParallel(stars, 9.0);
+        check(matchesExpected(stars, false, true), "SIMBAD e X-Match per tutte le stelle");
+        size_t expected = 0;
+        for (size_t i = 0; i < STAR_COUNT; ++i) expected += expectedSAO(i, false, true).has_value();
+        check(enriched == expected, "conteggio delle stelle arricchite");
+    }
+
+    std::filesystem::remove_all(directory);
+    return examples::testSummary();
+}
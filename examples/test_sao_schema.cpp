@@ -0,0 +1,303 @@
+/**
+ * @file test_sao_schema.cpp
+ * @brief Verifica dello schema del database Gaia-SAO e della migrazione
+ *
+ * Controlla: conversione di un database legacy (stars + gaia_sao_xmatch)
+ * con gli stessi risultati di ricerca, stelle senza Gaia ID e nomi,
+ * database creato con createNewDatabase() e, con EXPLAIN QUERY PLAN, che
+ * ogni query frequente (GaiaSAOSchema::hotQueries) sia servita dalla
+ * chiave primaria o da un indice coprente, senza leggere la tabella.
+ *
+ * Uso: test_sao_schema [stelle]
+ */
+
+#include <starmap/catalog/GaiaSAODatabase.h>
+#include <starmap/catalog/GaiaSAOSchema.h>
+#include <starmap/catalog/SAONumberIndex.h>
+#include <starmap/catalog/SkyIndex.h>
+#include <sqlite3.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "test_support.h"
+
+using namespace starmap;
+using examples::check;
+using starmap::catalog::GaiaSAOEntry;
+using starmap::catalog::GaiaSAOSchema;
+
+static bool exec(sqlite3* db, const std::string& sql) {
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        std::cerr << "SQL: " << (errMsg ? errMsg : "") << "\n";
+        sqlite3_free(errMsg);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Righe di EXPLAIN QUERY PLAN di una query
+ */
+static std::vector<std::string> queryPlan(sqlite3* db, const std::string& sql) {
+    std::vector<std::string> plan;
+    sqlite3_stmt* stmt = nullptr;
+    std::string explain = "EXPLAIN QUERY PLAN " + sql;
+    if (sqlite3_prepare_v2(db, explain.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        plan.push_back(std::string("errore: ") + sqlite3_errmsg(db));
+        return plan;
+    }
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        plan.push_back(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)));
+    }
+    sqlite3_finalize(stmt);
+    return plan;
+}
+
+/**
+ * @brief true se ogni accesso è una ricerca su chiave primaria o indice coprente
+ */
+static bool indexOnly(const std::vector<std::string>& plan) {
+    bool searched = false;
+    for (const auto& step : plan) {
+        if (step.rfind("SCAN", 0) == 0) return false;
+        if (step.rfind("SEARCH", 0) == 0) {
+            if (step.find("COVERING INDEX") == std::string::npos &&
+                step.find("PRIMARY KEY") == std::string::npos) return false;
+            searched = true;
+        }
+    }
+    return searched;
+}
+
+static void checkQueryPlans(const std::string& path) {
+    sqlite3* db = nullptr;
+    sqlite3_open_v2(path.c_str(), &db, SQLITE_OPEN_READONLY, nullptr);
+    for (const auto& sql : GaiaSAOSchema::hotQueries()) {
+        auto plan = queryPlan(db, sql);
+        bool ok = indexOnly(plan);
+        check(ok, sql.substr(0, 72) + (sql.size() > 72 ? "..." : ""));
+        for (const auto& step : plan) {
+            std::cout << "      " << step << "\n";
+        }
+    }
+    sqlite3_close(db);
+}
+
+/**
+ * @brief Database legacy: n stelle SAO in stars (con nomi) e in gaia_sao_xmatch
+ *
+ * Le stelle con i % 50 == 0 non hanno controparte Gaia (solo in stars).
+ */
+static bool writeLegacy(const std::string& path, size_t n) {
+    sqlite3* db = nullptr;
+    if (sqlite3_open(path.c_str(), &db) != SQLITE_OK) return false;
+    bool ok = exec(db, R"(
+        CREATE TABLE stars (id INTEGER PRIMARY KEY AUTOINCREMENT, gaia_dr3 BIGINT, sao INT,
+            bayer TEXT, flamsteed INT, proper_name TEXT, spectral_type TEXT,
+            ra_deg REAL, dec_deg REAL, magnitude REAL);
+        CREATE TABLE gaia_sao_xmatch (gaia_source_id INTEGER PRIMARY KEY,
+            sao_number INTEGER NOT NULL, ra REAL NOT NULL, dec REAL NOT NULL,
+            magnitude REAL, separation REAL, created_at TEXT DEFAULT CURRENT_TIMESTAMP);
+        CREATE TABLE metadata (key TEXT PRIMARY KEY, value TEXT);
+        INSERT INTO metadata VALUES ('version', '1.0'), ('source', 'test');
+        BEGIN;)");
+
+    sqlite3_stmt* star = nullptr;
+    sqlite3_stmt* xmatch = nullptr;
+    sqlite3_prepare_v2(db, "INSERT INTO stars (gaia_dr3, sao, bayer, flamsteed, proper_name, "
+                           "spectral_type, ra_deg, dec_deg, magnitude) VALUES (?,?,?,?,?,?,?,?,?);",
+                       -1, &star, nullptr);
+    sqlite3_prepare_v2(db, "INSERT INTO gaia_sao_xmatch (gaia_source_id, sao_number, ra, dec, "
+                           "magnitude, separation) VALUES (?,?,?,?,?,?);", -1, &xmatch, nullptr);
+
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    for (size_t i = 1; ok && i <= n; ++i) {
+        double ra = 360.0 * u(rng);
+        double dec = std::asin(2.0 * u(rng) - 1.0) * 180.0 / M_PI;
+        double mag = 2.0 + 8.0 * u(rng);
+        long long gaiaId = (i % 50 == 0) ? 0 : 1000000000LL + static_cast<long long>(i) * 7919;
+
+        sqlite3_bind_int64(star, 1, gaiaId);
+        sqlite3_bind_int(star, 2, static_cast<int>(i));
+        if (i % 7 == 0) sqlite3_bind_text(star, 3, "alf Tst", -1, SQLITE_STATIC);
+        if (i % 11 == 0) sqlite3_bind_int(star, 4, static_cast<int>(i % 100) + 1);
+        if (i % 13 == 0) sqlite3_bind_text(star, 5, "Testa", -1, SQLITE_STATIC);
+        sqlite3_bind_text(star, 6, i % 2 ? "K0III" : "A0V", -1, SQLITE_STATIC);
+        sqlite3_bind_double(star, 7, ra);
+        sqlite3_bind_double(star, 8, dec);
+        sqlite3_bind_double(star, 9, mag);
+        ok = sqlite3_step(star) == SQLITE_DONE;
+        sqlite3_reset(star);
+        sqlite3_clear_bindings(star);
+
+        if (ok && gaiaId > 0) {
+            sqlite3_bind_int64(xmatch, 1, gaiaId);
+            sqlite3_bind_int(xmatch, 2, static_cast<int>(i));
+            sqlite3_bind_double(xmatch, 3, ra);
+            sqlite3_bind_double(xmatch, 4, dec);
+            sqlite3_bind_double(xmatch, 5, mag);
+            sqlite3_bind_double(xmatch, 6, 0.25 + (i % 100) / 100.0);
+            ok = sqlite3_step(xmatch) == SQLITE_DONE;
+            sqlite3_reset(xmatch);
+        }
+    }
+    sqlite3_finalize(star);
+    sqlite3_finalize(xmatch);
+    ok = ok && exec(db, "COMMIT;");
+    sqlite3_close(db);
+    return ok;
+}
+
+static bool sameEntry(const GaiaSAOEntry& a, const GaiaSAOEntry& b) {
+    return a.gaiaSourceId == b.gaiaSourceId && a.saoNumber == b.saoNumber &&
+           std::abs(a.ra - b.ra) < 1e-6 && std::abs(a.dec - b.dec) < 1e-6 &&
+           std::abs(a.magnitude - b.magnitude) < 1e-3 &&
+           std::abs(a.separation - b.separation) < 1e-3;
+}
+
+int main(int argc, char* argv[]) {
+    size_t numStars = argc > 1 ? static_cast<size_t>(std::max(100, std::atoi(argv[1]))) : 50000;
+
+    auto directory = std::filesystem::temp_directory_path() / "starmap_test_sao_schema";
+    std::filesystem::remove_all(directory);
+    std::filesystem::create_directories(directory);
+    std::string legacyPath = (directory / "legacy.db").string();
+    std::string migratedPath = (directory / "migrated.db").string();
+    std::string createdPath = (directory / "created.db").string();
+
+    std::cout << "=== Test schema Gaia-SAO v" << GaiaSAOSchema::VERSION << " ===\n\n";
+
+    if (!writeLegacy(legacyPath, numStars)) {
+        std::cerr << "Impossibile scrivere il database legacy\n";
+        return 1;
+    }
+
+    std::cout << "Migrazione:\n";
+    check(GaiaSAOSchema::migrate(legacyPath, migratedPath), "database legacy convertito");
+    check(!GaiaSAOSchema::migrate(legacyPath, migratedPath), "file di destinazione esistente rifiutato");
+    std::cout << "  " << std::filesystem::file_size(legacyPath) / 1024 << " KB -> "
+              << std::filesystem::file_size(migratedPath) / 1024 << " KB\n";
+    {
+        sqlite3* db = nullptr;
+        sqlite3_open_v2(migratedPath.c_str(), &db, SQLITE_OPEN_READONLY, nullptr);
+        check(GaiaSAOSchema::version(db) == GaiaSAOSchema::VERSION, "versione dello schema registrata");
+        sqlite3_close(db);
+    }
+
+    catalog::GaiaSAODatabase legacy(legacyPath);
+    catalog::GaiaSAODatabase migrated(migratedPath);
+    check(legacy.isAvailable() && migrated.isAvailable(), "entrambi i database aperti");
+
+    std::cout << "Stessi risultati:\n";
+    {
+        std::vector<long long> ids;
+        size_t entriesOk = 0, entriesChecked = 0;
+        for (size_t i = 1; i <= numStars; i += 17) {
+            long long gaiaId = (i % 50 == 0) ? 0 : 1000000000LL + static_cast<long long>(i) * 7919;
+            if (gaiaId == 0) continue;
+            ids.push_back(gaiaId);
+            ids.push_back(gaiaId + 1);      // Senza SAO
+            auto a = legacy.getEntry(gaiaId);
+            auto b = migrated.getEntry(gaiaId);
+            entriesChecked++;
+            if (a && b && sameEntry(*a, *b)) entriesOk++;
+        }
+        check(entriesOk == entriesChecked, "getEntry: " + std::to_string(entriesOk) + "/" +
+                                           std::to_string(entriesChecked) + " uguali");
+        check(legacy.findSAOByGaiaIds(ids) == migrated.findSAOByGaiaIds(ids),
+              "findSAOByGaiaIds: " + std::to_string(ids.size()) + " ID");
+
+        size_t cones = 0, conesOk = 0;
+        for (int i = 0; i < 50; ++i) {
+            core::EquatorialCoordinates center(i * 7.2, -85.0 + i * 3.4);
+            auto a = legacy.coneSearch(center, 3.0, 100000);
+            auto b = migrated.coneSearch(center, 3.0, 100000);
+            // Magnitudi in millesimi: a parità l'ordine può cambiare
+            auto byId = [](const GaiaSAOEntry& x, const GaiaSAOEntry& y) {
+                return x.gaiaSourceId < y.gaiaSourceId;
+            };
+            std::sort(a.begin(), a.end(), byId);
+            std::sort(b.begin(), b.end(), byId);
+            cones++;
+            bool same = a.size() == b.size();
+            for (size_t k = 0; same && k < a.size(); ++k) {
+                same = sameEntry(a[k], b[k]);
+            }
+            if (same) conesOk++;
+        }
+        check(conesOk == cones, "coneSearch: " + std::to_string(conesOk) + "/" +
+                                std::to_string(cones) + " coni uguali");
+
+        std::vector<core::EquatorialCoordinates> positions;
+        for (size_t i = 3; i <= numStars; i += 97) {
+            if (auto star = legacy.findBySAONumber(static_cast<int>(i))) {
+                positions.emplace_back(star->ra + 0.5 / 3600.0, star->dec);
+            }
+        }
+        check(legacy.findSAOByCoordinates(positions, 5.0) ==
+              migrated.findSAOByCoordinates(positions, 5.0),
+              "findSAOByCoordinates: " + std::to_string(positions.size()) + " posizioni");
+
+        auto noGaia = migrated.findBySAONumber(50);
+        check(noGaia && noGaia->gaiaSourceId == 0, "stella senza Gaia ID trovata per numero SAO");
+        auto index = migrated.getSAONumberIndex();
+        const auto* star = index ? index->find(7) : nullptr;
+        check(star && index->spectralType(*star) == "K0III", "tipo spettrale migrato");
+    }
+
+    std::cout << "Nomi delle stelle senza Gaia ID:\n";
+    {
+        sqlite3* db = nullptr;
+        sqlite3_open_v2(migratedPath.c_str(), &db, SQLITE_OPEN_READONLY, nullptr);
+        sqlite3_stmt* stmt = nullptr;
+        sqlite3_prepare_v2(db, "SELECT name FROM sao_xmatch WHERE source_id = ?;", -1, &stmt, nullptr);
+        auto nameOf = [&](long long id) {
+            sqlite3_bind_int64(stmt, 1, id);
+            std::string name;
+            if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) == SQLITE_TEXT) {
+                name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+            }
+            sqlite3_reset(stmt);
+            return name;
+        };
+        // SAO 1300: nome proprio (13), Bayer (7) no; SAO 700: Bayer; SAO 550: Flamsteed
+        check(nameOf(-1300) == "Testa", "nome proprio prima di Bayer e Flamsteed");
+        check(nameOf(-700) == "alf Tst", "Bayer se manca il nome proprio");
+        check(nameOf(-550) == std::to_string(550 % 100 + 1), "Flamsteed se mancano gli altri");
+        sqlite3_finalize(stmt);
+        sqlite3_close(db);
+    }
+
+    std::cout << "Database creato con createNewDatabase():\n";
+    {
+        catalog::GaiaSAODatabase created(createdPath);
+        check(created.createNewDatabase(), "schema creato");
+        std::vector<GaiaSAOEntry> entries;
+        for (size_t i = 1; i <= 1000; ++i) {
+            entries.push_back({static_cast<long long>(i) * 1000003LL, static_cast<int>(i),
+                               i * 0.36, -60.0 + i * 0.12, 5.0 + i * 0.004, 0.5});
+        }
+        check(created.insertBatch(entries) == entries.size() && created.createIndices(),
+              "entry inserite e indici creati");
+        auto entry = created.getEntry(entries[499].gaiaSourceId);
+        check(entry && sameEntry(*entry, entries[499]), "entry riletta dalle colonne intere");
+        check(created.findSAOByGaiaId(entries[9].gaiaSourceId) == 10, "SAO per Gaia ID");
+    }
+
+    std::cout << "Piani delle query frequenti (database migrato):\n";
+    checkQueryPlans(migratedPath);
+    std::cout << "Piani delle query frequenti (createNewDatabase):\n";
+    checkQueryPlans(createdPath);
+
+    std::filesystem::remove_all(directory);
+
+    return examples::testSummary();
+}
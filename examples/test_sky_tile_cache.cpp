@@ -0,0 +1,354 @@
+/**
+ * @file test_sky_tile_cache.cpp
+ * @brief Test della cache a tile su disco (SkyTileCache)
+ *
+ * Su una directory temporanea e un catalogo sintetico controlla:
+ * - scrittura e rilettura di una tile (tutti i campi, limite di magnitudine)
+ * - queryCone: prima richiesta dal catalogo, seconda solo dalle tile, con
+ *   lo stesso risultato di una ricerca esaustiva
+ * - cambio di impronta del catalogo: nuova sottodirectory, tile rilette
+ *   dal catalogo, nessuna directory rimossa finché non lo si chiede, e
+ *   removeObsoleteTiles() che non tocca directory non create dalla cache
+ * - tile corrotte o troncate: scartate e rilette dal catalogo
+ * - forEachInCone: stesse stelle e stesso ordine di queryCone, anche con
+ *   una tile corrotta dopo i primi blocchi (nessuna stella visitata due volte)
+ * - GaiaClient con cache a tile: risultato troncato alle più luminose con
+ *   i versori ancora presenti e forEachInCone dalle tile (verifiche
+ *   saltate senza catalogo Gaia)
+ *
+ * Uso: test_sky_tile_cache
+ */
+
+#include <starmap/catalog/GaiaClient.h>
+#include <starmap/catalog/SkyIndex.h>
+#include <starmap/catalog/SkyTileCache.h>
+#include <starmap/config/LibraryConfig.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "test_support.h"
+
+using namespace starmap;
+using examples::check;
+using catalog::SkyTileCache;
+namespace fs = std::filesystem;
+
+/**
+ * @brief Catalogo sintetico: stelle uniformi, source_id = indice + 1
+ */
+static core::StarBlock makeCatalog(size_t n) {
+    std::mt19937_64 rng(17);
+    std::uniform_real_distribution<double> raDist(0.0, 360.0), zDist(-1.0, 1.0);
+    std::uniform_real_distribution<double> magDist(1.0, 15.0), colorDist(-0.3, 2.0);
+
+    core::StarBlock catalog;
+    catalog.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        size_t row = catalog.append(raDist(rng), std::asin(zDist(rng)) * 180.0 / M_PI,
+                                    magDist(rng), static_cast<long long>(i + 1));
+        if (i % 2 == 0) catalog.setColorIndex(row, colorDist(rng));
+        if (i % 5 == 0) catalog.setProperMotion(row, 12.5, -3.25);
+        if (i % 7 == 0) catalog.setParallax(row, 4.5);
+        if (i % 11 == 0) catalog.setSAONumber(row, 100000 + static_cast<int>(i));
+        if (i % 97 == 0) catalog.setName(row, "Star " + std::to_string(i));
+    }
+    return catalog;
+}
+
+/**
+ * @brief Fetcher su catalogo in memoria che conta le richieste
+ */
+struct CountingFetcher {
+    const core::StarBlock& catalog;
+    size_t calls = 0;
+
+    core::StarBlock operator()(double ra, double dec, double radiusDeg, double maxMagnitude) {
+        calls++;
+        std::vector<uint8_t> keep(catalog.size());
+        catalog::SkyIndex::withinCone(catalog.raColumn().data(), catalog.decColumn().data(),
+                                      catalog.size(), ra, dec, radiusDeg, keep.data());
+        for (size_t i = 0; i < keep.size(); ++i) {
+            if (catalog.getMagnitude(i) > maxMagnitude) keep[i] = 0;
+        }
+        core::StarBlock result = catalog;
+        result.retain(keep);
+        return result;
+    }
+};
+
+static std::vector<long long> sortedIds(const core::StarBlock& stars) {
+    std::vector<long long> ids(stars.gaiaIdColumn().begin(), stars.gaiaIdColumn().end());
+    std::sort(ids.begin(), ids.end());
+    return ids;
+}
+
+static core::StarBlock query(SkyTileCache& cache, CountingFetcher& fetcher,
+                             double ra, double dec, double radius, double maxMagnitude) {
+    return cache.queryCone(ra, dec, radius, maxMagnitude,
+        [&fetcher](double r, double d, double rad, double mag) { return fetcher(r, d, rad, mag); });
+}
+
+static void testRoundTrip(const fs::path& root, const core::StarBlock& catalog) {
+    std::cout << "\n[Scrittura e lettura di una tile]\n";
+    SkyTileCache cache(root.string(), 1);
+    check(cache.isEnabled(), "cache abilitata");
+
+    int tile = SkyTileCache::tileId(83.8, -5.4);
+    core::StarBlock stars;
+    for (size_t i = 0; i < catalog.size() && stars.size() < 500; ++i) {
+        // Riporta la stella dentro la tile, campi invariati
+        double raMin = std::floor(83.8 / SkyTileCache::TILE_SIZE) * SkyTileCache::TILE_SIZE;
+        double decMin = std::floor(-5.4 / SkyTileCache::TILE_SIZE) * SkyTileCache::TILE_SIZE;
+        double ra = raMin + std::fmod(catalog.getRightAscension(i), SkyTileCache::TILE_SIZE);
+        double dec = decMin + std::fmod(catalog.getDeclination(i) + 90.0, SkyTileCache::TILE_SIZE);
+        stars.appendRow(catalog, i);
+        stars.raColumn().back() = ra;
+        stars.decColumn().back() = dec;
+    }
+    check(cache.writeTile(tile, 15.0, stars), "writeTile");
+
+    core::StarBlock read;
+    check(cache.readTile(tile, 15.0, read) && read.size() == stars.size(), "readTile: tutte le righe");
+
+    // Confronto riga per riga tramite source_id
+    size_t mismatches = 0;
+    for (size_t r = 0; r < read.size(); ++r) {
+        size_t i = static_cast<size_t>(std::find(stars.gaiaIdColumn().begin(), stars.gaiaIdColumn().end(),
+                                                 read.getGaiaId(r)) - stars.gaiaIdColumn().begin());
+        if (i == stars.size() ||
+            std::abs(read.getRightAscension(r) - stars.getRightAscension(i)) > 1e-9 ||
+            std::abs(read.getDeclination(r) - stars.getDeclination(i)) > 1e-9 ||
+            read.getMagnitude(r) != stars.getMagnitude(i) ||
+            read.flagsColumn()[r] != stars.flagsColumn()[i] ||
+            read.colorColumn()[r] != stars.colorColumn()[i] ||
+            read.parallaxColumn()[r] != stars.parallaxColumn()[i] ||
+            read.pmRAColumn()[r] != stars.pmRAColumn()[i] ||
+            read.pmDecColumn()[r] != stars.pmDecColumn()[i] ||
+            read.saoColumn()[r] != stars.saoColumn()[i] ||
+            read.getName(r) != stars.getName(i)) {
+            mismatches++;
+        }
+    }
+    check(mismatches == 0, "posizioni entro 1e-9°, altri campi identici");
+
+    core::StarBlock bright;
+    size_t expected = 0;
+    for (size_t i = 0; i < stars.size(); ++i) expected += stars.getMagnitude(i) <= 8.0;
+    bool ordered = true;
+    check(cache.readTile(tile, 8.0, bright) && bright.size() == expected,
+          "readTile con limite di magnitudine");
+    for (size_t r = 1; r < bright.size(); ++r) {
+        ordered = ordered && bright.getMagnitude(r - 1) <= bright.getMagnitude(r);
+    }
+    check(ordered, "righe in ordine di magnitudine");
+
+    core::StarBlock deeper;
+    check(!cache.readTile(tile, 16.0, deeper) && deeper.size() == 0,
+          "tile non abbastanza profonda: mancata");
+}
+
+static void testQueryCone(const fs::path& root, const core::StarBlock& catalog) {
+    std::cout << "\n[queryCone e impronta del catalogo]\n";
+    CountingFetcher fetcher{catalog};
+    CountingFetcher reference{catalog};
+
+    fs::path catalogFile = root / "catalog.dat";
+    std::ofstream(catalogFile) << "v1";
+    uint64_t fingerprint = SkyTileCache::fingerprint({catalogFile.string()});
+
+    std::string firstDirectory;
+    {
+        SkyTileCache cache(root.string(), fingerprint);
+        firstDirectory = cache.getTileDirectory();
+
+        auto first = query(cache, fetcher, 120.0, 30.0, 3.0, 11.0);
+        size_t fetches = fetcher.calls;
+        check(fetches > 0 && sortedIds(first) == sortedIds(reference(120.0, 30.0, 3.0, 11.0)),
+              "prima richiesta: dal catalogo, stesso risultato della ricerca esaustiva");
+
+        auto second = query(cache, fetcher, 120.0, 30.0, 3.0, 11.0);
+        check(fetcher.calls == fetches && sortedIds(second) == sortedIds(first),
+              "seconda richiesta: solo dalle tile");
+
+        auto nested = query(cache, fetcher, 121.0, 30.5, 1.0, 9.0);
+        check(fetcher.calls == fetches && sortedIds(nested) == sortedIds(reference(121.0, 30.5, 1.0, 9.0)),
+              "cono interno e meno profondo: solo dalle tile");
+        check(cache.getStatistics().tileHits > 0, "tile lette dal disco contate");
+    }
+
+    // Il catalogo cambia: nuova impronta, tile rilette
+    std::ofstream(catalogFile, std::ios::app) << "v2";
+    uint64_t changed = SkyTileCache::fingerprint({catalogFile.string()});
+    check(changed != fingerprint, "l'impronta cambia con il file del catalogo");
+
+    fs::create_directories(root / "tiles_v1_foreign");
+    std::ofstream(root / "tiles_v1_foreign" / "data.bin") << "not ours";
+
+    SkyTileCache cache(root.string(), changed);
+    check(cache.getTileDirectory() != firstDirectory, "nuova sottodirectory per il nuovo catalogo");
+    check(fs::exists(firstDirectory), "la sottodirectory precedente non viene rimossa all'apertura");
+
+    size_t before = fetcher.calls;
+    auto rebuilt = query(cache, fetcher, 120.0, 30.0, 3.0, 11.0);
+    check(fetcher.calls > before && sortedIds(rebuilt) == sortedIds(reference(120.0, 30.0, 3.0, 11.0)),
+          "tile ricostruite dal catalogo");
+
+    size_t removed = cache.removeObsoleteTiles();
+    check(removed >= 1 && !fs::exists(firstDirectory), "removeObsoleteTiles rimuove le tile obsolete");
+    check(fs::exists(root / "tiles_v1_foreign" / "data.bin") && fs::exists(catalogFile),
+          "directory non create dalla cache lasciate intatte");
+    check(fs::exists(cache.getTileDirectory()), "sottodirectory corrente conservata");
+}
+
+static void testCorruptTiles(const fs::path& root, const core::StarBlock& catalog) {
+    std::cout << "\n[Tile corrotte]\n";
+    CountingFetcher fetcher{catalog};
+    CountingFetcher reference{catalog};
+    SkyTileCache cache(root.string(), 99);
+
+    auto expected = sortedIds(reference(200.0, -40.0, 1.5, 12.0));
+    query(cache, fetcher, 200.0, -40.0, 1.5, 12.0);
+
+    std::vector<fs::path> tiles;
+    for (const auto& entry : fs::directory_iterator(cache.getTileDirectory())) {
+        if (entry.path().extension() == ".tile") tiles.push_back(entry.path());
+    }
+    std::sort(tiles.begin(), tiles.end());
+    check(tiles.size() >= 2, "tile scritte su disco");
+    if (tiles.size() < 2) return;
+
+    // Byte alterati nei dati compressi della prima tile, seconda troncata
+    {
+        std::fstream file(tiles[0], std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-16, std::ios::end);
+        const char garbage[8] = {'\x5a', '\x5a', '\x5a', '\x5a', '\x5a', '\x5a', '\x5a', '\x5a'};
+        file.write(garbage, sizeof(garbage));
+    }
+    fs::resize_file(tiles[1], fs::file_size(tiles[1]) / 2);
+
+    int corruptTile = std::stoi(tiles[0].stem().string());
+    core::StarBlock out;
+    out.append(1.0, 2.0, 3.0);
+    check(!cache.readTile(corruptTile, 12.0, out) && out.size() == 1,
+          "tile corrotta scartata, blocco di uscita ripristinato");
+
+    size_t before = fetcher.calls;
+    auto recovered = query(cache, fetcher, 200.0, -40.0, 1.5, 12.0);
+    check(fetcher.calls >= before + 2 && sortedIds(recovered) == expected,
+          "tile corrotte rilette dal catalogo, risultato corretto");
+
+    before = fetcher.calls;
+    auto again = query(cache, fetcher, 200.0, -40.0, 1.5, 12.0);
+    check(fetcher.calls == before && sortedIds(again) == expected, "tile riscritte e di nuovo valide");
+}
+
+/**
+ * @brief Gaia ID nell'ordine di visita di forEachInCone (versori verificati)
+ */
+static std::vector<long long> visitIds(SkyTileCache& cache, CountingFetcher& fetcher,
+                                       double ra, double dec, double radius, double maxMagnitude,
+                                       bool& vectors) {
+    std::vector<long long> ids;
+    vectors = true;
+    cache.forEachInCone(ra, dec, radius, maxMagnitude,
+        [&fetcher](double r, double d, double rad, double mag) { return fetcher(r, d, rad, mag); },
+        [&](const core::StarBlock& block, size_t row) {
+            vectors = vectors && block.hasUnitVectors() && block.xColumn().size() == block.size();
+            ids.push_back(block.getGaiaId(row));
+        });
+    return ids;
+}
+
+static void testForEachInCone(const fs::path& root, const core::StarBlock& catalog) {
+    std::cout << "\n[forEachInCone]\n";
+    CountingFetcher fetcher{catalog};
+    SkyTileCache cache(root.string(), 7);
+    bool vectors = false;
+
+    auto fromCatalog = visitIds(cache, fetcher, 300.0, 15.0, 2.5, 11.5, vectors);
+    size_t fetches = fetcher.calls;
+    auto block = query(cache, fetcher, 300.0, 15.0, 2.5, 11.5);
+    std::vector<long long> blockIds(block.gaiaIdColumn().begin(), block.gaiaIdColumn().end());
+    check(fetches > 0 && !fromCatalog.empty() && fromCatalog == blockIds && vectors,
+          "dal catalogo: stesse stelle e stesso ordine di queryCone, con i versori");
+
+    auto fromTiles = visitIds(cache, fetcher, 300.0, 15.0, 2.5, 11.5, vectors);
+    check(fetcher.calls == fetches && fromTiles == blockIds && vectors,
+          "dalle tile: nessuna lettura dal catalogo, stesso risultato");
+
+    // Dati alterati in fondo a ogni tile: i primi blocchi sono già visitati
+    // quando l'errore emerge e non devono ripetersi dopo la rilettura
+    for (const auto& entry : fs::directory_iterator(cache.getTileDirectory())) {
+        if (entry.path().extension() != ".tile") continue;
+        std::fstream file(entry.path(), std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(-16, std::ios::end);
+        const char garbage[8] = {'\x5a', '\x5a', '\x5a', '\x5a', '\x5a', '\x5a', '\x5a', '\x5a'};
+        file.write(garbage, sizeof(garbage));
+    }
+    auto recovered = visitIds(cache, fetcher, 300.0, 15.0, 2.5, 11.5, vectors);
+    std::vector<long long> unique = recovered;
+    std::sort(unique.begin(), unique.end());
+    check(fetcher.calls > fetches &&
+          std::adjacent_find(unique.begin(), unique.end()) == unique.end() &&
+          unique == sortedIds(block),
+          "tile corrotte: rilette dal catalogo, nessuna stella ripetuta o persa");
+}
+
+static void testTruncatedClientQuery(const fs::path& root) {
+    std::cout << "\n[GaiaClient: query troncata dalle tile]\n";
+    config::LibraryConfig::getInstance().setTileCacheDirectory(root.string());
+    catalog::GaiaClient client;
+    if (!client.isAvailable()) {
+        std::cout << "  catalogo Gaia non disponibile: verifica saltata\n";
+        return;
+    }
+
+    catalog::GaiaQueryParameters params;
+    params.center = core::EquatorialCoordinates(83.8, -5.4);
+    params.radiusDegrees = 1.5;
+    params.maxMagnitude = 12.0;
+    params.maxResults = 50;
+    params.keepBrightest = true;
+
+    for (const char* pass : {"dal catalogo", "dalle tile"}) {
+        core::StarBlock stars = client.queryRegionBlock(params);
+        bool vectorsMatch = stars.hasUnitVectors();
+        for (size_t i = 0; vectorsMatch && i < stars.size(); ++i) {
+            double ra = stars.getRightAscension(i) * M_PI / 180.0;
+            double dec = stars.getDeclination(i) * M_PI / 180.0;
+            vectorsMatch = std::abs(stars.xColumn()[i] - std::cos(dec) * std::cos(ra)) < 1e-6 &&
+                           std::abs(stars.yColumn()[i] - std::cos(dec) * std::sin(ra)) < 1e-6 &&
+                           std::abs(stars.zColumn()[i] - std::sin(dec)) < 1e-6;
+        }
+        check(stars.size() == 50 && vectorsMatch,
+              std::string(pass) + ": 50 stelle con i versori delle tile");
+    }
+
+    params.maxResults = 1000000;
+    size_t expected = client.queryRegionBlock(params).size();
+    size_t visited = client.forEachInCone(params, [](const catalog::StarView&) {});
+    check(visited == expected && expected > 50, "forEachInCone dalle tile: tutte le stelle del cono");
+    config::LibraryConfig::getInstance().setTileCacheDirectory("");
+}
+
+int main() {
+    std::cout << "=== Test SkyTileCache ===\n";
+    fs::path root = fs::temp_directory_path() / ("starmap_tile_test_" + std::to_string(::getpid()));
+    fs::remove_all(root);
+
+    auto catalog = makeCatalog(300000);
+    testRoundTrip(root / "roundtrip", catalog);
+    testQueryCone(root / "query", catalog);
+    testCorruptTiles(root / "corrupt", catalog);
+    testForEachInCone(root / "visit", catalog);
+    testTruncatedClientQuery(root / "client");
+
+    fs::remove_all(root);
+    return examples::testSummary();
+}
@@ -0,0 +1,78 @@
+/**
+ * @file test_support.h
+ * @brief Verifiche e riepilogo comuni ai programmi di test degli esempi
+ *
+ * check() stampa ✓/✗ con la descrizione e conta i fallimenti;
+ * testSummary() stampa l'esito finale e restituisce il codice di uscita
+ * del programma (0 se tutte le verifiche sono passate). Gate trattiene
+ * i thread di un test finché non viene aperto.
+ */
+
+#ifndef STARMAP_EXAMPLES_TEST_SUPPORT_H
+#define STARMAP_EXAMPLES_TEST_SUPPORT_H
+
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <string>
+
+namespace starmap {
+namespace examples {
+
+/**
+ * @brief Numero di verifiche fallite finora
+ */
+inline int& testFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+inline void check(bool condition, const std::string& description) {
+    std::cout << (condition ? "  ✓ " : "  ✗ ") << description << "\n";
+    if (!condition) testFailures()++;
+}
+
+/**
+ * @brief Stampa l'esito finale
+ * @return Codice di uscita: 0 se tutte le verifiche sono passate, 1 altrimenti
+ */
+inline int testSummary() {
+    if (testFailures() > 0) {
+        std::cout << "\n✗ " << testFailures() << " verifiche fallite\n";
+        return 1;
+    }
+    std::cout << "\n✓ Tutti i test superati\n";
+    return 0;
+}
+
+/**
+ * @brief Cancello che trattiene i thread finché non viene aperto
+ *
+ * Usato per far sovrapporre in modo deterministico richieste concorrenti
+ * (ad es. tenendo aperta una query mentre altre vi si agganciano).
+ */
+class Gate {
+public:
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return open_; });
+    }
+
+    void open() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            open_ = true;
+        }
+        cv_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool open_ = false;
+};
+
+} // namespace examples
+} // namespace starmap
+
+#endif // STARMAP_EXAMPLES_TEST_SUPPORT_H
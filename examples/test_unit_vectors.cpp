@@ -0,0 +1,445 @@
+/**
+ * @file test_unit_vectors.cpp
+ * @brief Verifica e benchmark della rappresentazione a versori
+ *
+ * Controlla la separazione angolare dalla corda (contro un riferimento in
+ * long double, anche per coppie a 1 mas e quasi agli antipodi), le calotte
+ * sferiche contro SkyIndex::withinCone, il mantenimento dei versori in
+ * StarBlock (append, appendRow, retain, truncate, invalidazione), i versori
+ * scritti nello snapshot Gaia-SAO e la proiezione dai versori contro
+ * projectBatch. Poi misura su N stelle
+ * (default 1M) separazioni, filtro del cono e proiezione con e senza
+ * versori precalcolati.
+ *
+ * Uso: test_unit_vectors [stelle]
+ */
+
+#include <starmap/core/UnitVector.h>
+#include <starmap/core/StarBlock.h>
+#include <starmap/catalog/GaiaSAOSnapshot.h>
+#include <starmap/catalog/SkyIndex.h>
+#include <starmap/map/MapRenderer.h>
+#include <starmap/map/Projection.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "test_support.h"
+
+using namespace starmap;
+using examples::check;
+using core::UnitVector;
+using map::ProjectionType;
+using Clock = std::chrono::steady_clock;
+
+struct NamedProjection {
+    ProjectionType type;
+    const char* name;
+};
+
+static const NamedProjection PROJECTIONS[] = {
+    {ProjectionType::STEREOGRAPHIC, "stereografica"},
+    {ProjectionType::GNOMONIC, "gnomonica"},
+    {ProjectionType::ORTHOGRAPHIC, "ortografica"},
+};
+
+static void randomSky(size_t n, unsigned seed, std::vector<double>& ra, std::vector<double>& dec) {
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> raDist(0.0, 360.0), zDist(-1.0, 1.0);
+    ra.resize(n);
+    dec.resize(n);
+    for (size_t i = 0; i < n; ++i) {
+        ra[i] = raDist(rng);
+        dec[i] = std::asin(zDist(rng)) * 180.0 / M_PI;
+    }
+}
+
+/**
+ * @brief Separazione di riferimento (gradi), haversine in long double
+ */
+static double referenceSeparation(double ra1, double dec1, double ra2, double dec2) {
+    const long double deg = 3.14159265358979323846264338327950288L / 180.0L;
+    long double sinDDec = std::sin((dec2 - dec1) * deg / 2.0L);
+    long double sinDRa = std::sin((ra2 - ra1) * deg / 2.0L);
+    long double a = sinDDec * sinDDec +
+                    std::cos(dec1 * deg) * std::cos(dec2 * deg) * sinDRa * sinDRa;
+    return static_cast<double>(2.0L * std::atan2(std::sqrt(a), std::sqrt(1.0L - a)) / deg);
+}
+
+static void testSeparation() {
+    std::cout << "\n[Separazione angolare]\n";
+
+    struct Pair {
+        double ra1, dec1, ra2, dec2;
+        const char* name;
+    };
+    const double mas = 1.0 / 3.6e6;
+    const Pair pairs[] = {
+        {83.8, -5.4, 83.8, -5.4 + mas, "1 mas in declinazione"},
+        {10.0, 60.0, 10.0 + mas / std::cos(60.0 * M_PI / 180.0), 60.0, "1 mas in RA a +60°"},
+        {359.9999, 0.0, 0.0001, 0.0, "0.72 arcsec a cavallo di 0h"},
+        {0.0, 89.9999, 180.0, 89.9999, "attraverso il polo nord"},
+        {0.0, 0.0, 180.0, 0.0, "antipodi"},
+        {0.0, 0.0, 179.9999, 0.0, "quasi agli antipodi"},
+    };
+    for (const auto& p : pairs) {
+        double expected = referenceSeparation(p.ra1, p.dec1, p.ra2, p.dec2);
+        double actual = core::angularSeparation(UnitVector::fromRaDec(p.ra1, p.dec1),
+                                                UnitVector::fromRaDec(p.ra2, p.dec2));
+        double error = std::abs(actual - expected) * 3.6e6;
+        std::cout << "    " << p.name << ": " << expected * 3600.0 << " arcsec, errore "
+                  << error << " mas\n";
+        check(error < 1e-3, std::string(p.name) + ": errore sotto 1 µas");
+    }
+
+    // Coppie casuali: separazioni batch contro il riferimento e contro
+    // la corda al quadrato (stesso ordinamento)
+    std::vector<double> ra, dec;
+    randomSky(100000, 7, ra, dec);
+    std::vector<double> x(ra.size()), y(ra.size()), z(ra.size()), degrees(ra.size());
+    UnitVector::fromRaDec(ra.data(), dec.data(), ra.size(), x.data(), y.data(), z.data());
+    auto from = UnitVector::fromRaDec(123.4, -56.7);
+    core::angularSeparations(from, x.data(), y.data(), z.data(), ra.size(), degrees.data());
+
+    double worst = 0.0;
+    size_t misordered = 0;
+    for (size_t i = 0; i < ra.size(); ++i) {
+        worst = std::max(worst, std::abs(degrees[i] - referenceSeparation(123.4, -56.7, ra[i], dec[i])));
+        double chord = from.chordSquared({x[i], y[i], z[i]});
+        misordered += std::abs(chord - core::chordSquaredForSeparation(degrees[i])) > 1e-12;
+    }
+    std::cout << "    100000 coppie casuali, scarto massimo " << worst * 3.6e6 << " mas\n";
+    check(worst * 3.6e6 < 1e-3 && misordered == 0,
+          "separazioni batch e corde coerenti con il riferimento");
+
+    // Andata e ritorno RA/Dec
+    std::vector<double> ra2(ra.size()), dec2(ra.size());
+    UnitVector::toRaDec(x.data(), y.data(), z.data(), ra.size(), ra2.data(), dec2.data());
+    double roundTrip = 0.0;
+    for (size_t i = 0; i < ra.size(); ++i) {
+        roundTrip = std::max(roundTrip, referenceSeparation(ra[i], dec[i], ra2[i], dec2[i]));
+    }
+    check(roundTrip * 3.6e6 < 1e-3, "RA/Dec -> versore -> RA/Dec sotto 1 µas");
+}
+
+static void testCaps() {
+    std::cout << "\n[Calotte sferiche]\n";
+    std::vector<double> ra, dec;
+    randomSky(200000, 11, ra, dec);
+    size_t n = ra.size();
+    std::vector<double> x(n), y(n), z(n);
+    UnitVector::fromRaDec(ra.data(), dec.data(), n, x.data(), y.data(), z.data());
+
+    struct Cone {
+        double ra, dec, radius;
+        const char* name;
+    };
+    const Cone cones[] = {
+        {83.8, -5.4, 2.0, "cono di 2° su Orione"},
+        {0.2, 10.0, 15.0, "cono di 15° a cavallo di 0h"},
+        {45.0, 89.0, 5.0, "cono che contiene il polo nord"},
+        {200.0, -30.0, 90.0, "emisfero"},
+        {10.0, 10.0, 180.0, "tutto il cielo"},
+    };
+    std::vector<uint8_t> viaCap(n), viaIndex(n);
+    for (const auto& c : cones) {
+        auto cap = core::SphericalCap::cone(c.ra, c.dec, c.radius);
+        cap.contains(x.data(), y.data(), z.data(), n, viaCap.data());
+        catalog::SkyIndex::withinCone(ra.data(), dec.data(), n, c.ra, c.dec, c.radius,
+                                      viaIndex.data());
+        size_t inside = 0, scalarMismatches = 0;
+        for (size_t i = 0; i < n; ++i) {
+            inside += viaCap[i];
+            scalarMismatches += (cap.contains(UnitVector{x[i], y[i], z[i]}) != (viaCap[i] != 0));
+        }
+        check(viaCap == viaIndex && scalarMismatches == 0 && inside > 0,
+              std::string(c.name) + ": " + std::to_string(inside) + " stelle, come withinCone");
+    }
+
+    auto a = core::SphericalCap::cone(0.0, 0.0, 1.0);
+    check(a.intersects(core::SphericalCap::cone(1.9, 0.0, 1.0)) &&
+          !a.intersects(core::SphericalCap::cone(2.1, 0.0, 1.0)) &&
+          a.intersects(core::SphericalCap::cone(180.0, 0.0, 179.5)),
+          "intersezione tra calotte");
+}
+
+static bool vectorsMatch(const core::StarBlock& block) {
+    if (!block.hasUnitVectors() || block.xColumn().size() != block.size()) return false;
+    for (size_t i = 0; i < block.size(); ++i) {
+        auto expected = UnitVector::fromRaDec(block.getRightAscension(i), block.getDeclination(i));
+        UnitVector actual{block.xColumn()[i], block.yColumn()[i], block.zColumn()[i]};
+        if (expected.chordSquared(actual) > 1e-28) return false;
+    }
+    return true;
+}
+
+static void testStarBlock() {
+    std::cout << "\n[Versori in StarBlock]\n";
+    core::StarBlock block;
+    for (int i = 0; i < 100; ++i) block.append(i * 3.6, -45.0 + i * 0.9, 5.0 + i * 0.05);
+    check(!block.hasUnitVectors(), "nessun versore finché non richiesto");
+
+    block.computeUnitVectors();
+    check(vectorsMatch(block), "computeUnitVectors");
+
+    block.append(12.0, 34.0, 6.0);
+    core::StarBlock source;
+    source.append(56.0, -78.0, 7.0);
+    source.computeUnitVectors();
+    block.appendRow(source, 0);
+    core::StarBlock plain;
+    plain.append(90.0, 10.0, 8.0);
+    block.appendRow(plain, 0);
+    check(vectorsMatch(block) && block.size() == 103, "append e appendRow (con e senza versori)");
+
+    std::vector<uint8_t> keep(block.size());
+    for (size_t i = 0; i < keep.size(); ++i) keep[i] = i % 3 != 0;
+    block.retain(keep);
+    block.truncate(40);
+    check(vectorsMatch(block) && block.size() == 40, "retain e truncate");
+
+    core::StarBlock copy = block;
+    check(vectorsMatch(copy), "copia del blocco");
+
+    block.raColumn()[0] += 1.0;
+    check(!block.hasUnitVectors(), "accesso in scrittura a raColumn() invalida i versori");
+    block.computeUnitVectors();
+    check(vectorsMatch(block), "ricalcolo dopo la modifica");
+
+    block.clear();
+    block.append(1.0, 2.0, 3.0);
+    check(!block.hasUnitVectors(), "clear azzera i versori");
+}
+
+/**
+ * @brief Stereografica con la proiezione dai versori dell'implementazione di base
+ */
+class BaseVectorProjection : public map::StereographicProjection {
+public:
+    using StereographicProjection::StereographicProjection;
+
+    void projectUnitVectors(const double* vx, const double* vy, const double* vz, size_t count,
+                            float* x, float* y, uint8_t* visible) const override {
+        Projection::projectUnitVectors(vx, vy, vz, count, x, y, visible);
+    }
+};
+
+static void testSnapshot() {
+    std::cout << "\n[Versori nello snapshot Gaia-SAO]\n";
+    std::vector<double> ra, dec;
+    randomSky(50000, 17, ra, dec);
+    std::vector<catalog::GaiaSAOEntry> entries;
+    for (size_t i = 0; i < ra.size(); ++i) {
+        entries.push_back({static_cast<long long>(i) + 1, static_cast<int>(i) + 1,
+                           ra[i], dec[i], 4.0 + (i % 50) * 0.1, 0.2});
+    }
+
+    auto path = (std::filesystem::temp_directory_path() / "starmap_test_unit_vectors.snapshot").string();
+    check(catalog::GaiaSAOSnapshot::write(path, entries), "snapshot scritto");
+    {
+        catalog::GaiaSAOSnapshot snapshot(path);
+        check(snapshot.isOpen() && snapshot.size() == entries.size(), "snapshot mappato");
+
+        size_t mismatches = 0;
+        for (size_t row = 0; row < snapshot.size(); ++row) {
+            double x, y, z;
+            double rowRa = snapshot.ra(row), rowDec = snapshot.dec(row);
+            UnitVector::fromRaDec(&rowRa, &rowDec, 1, &x, &y, &z);
+            auto v = snapshot.unitVector(row);
+            mismatches += (v.x != x || v.y != y || v.z != z);
+        }
+        check(mismatches == 0, "versori letti dal file, uguali a quelli calcolati");
+
+        std::vector<uint8_t> keep(ra.size());
+        catalog::SkyIndex::withinCone(ra.data(), dec.data(), ra.size(), 120.0, -35.0, 8.0, keep.data());
+        size_t expected = 0;
+        for (uint8_t k : keep) expected += k;
+        size_t visited = snapshot.forEachInCone(120.0, -35.0, 8.0, [](size_t) {});
+        check(visited == expected && expected > 0,
+              "cono di 8°: " + std::to_string(visited) + " righe, come withinCone");
+    }
+
+    // Snapshot della versione precedente (senza versori): rifiutato
+    {
+        std::fstream file(path, std::ios::in | std::ios::out | std::ios::binary);
+        uint32_t oldVersion = 1;
+        file.seekp(8);
+        file.write(reinterpret_cast<const char*>(&oldVersion), sizeof(oldVersion));
+    }
+    check(!catalog::GaiaSAOSnapshot(path).isOpen(), "snapshot versione 1 rifiutato");
+    std::filesystem::remove(path);
+}
+
+static void compareProjection(const map::Projection& projection, const std::vector<double>& ra,
+                              const std::vector<double>& dec, const std::vector<double>& vx,
+                              const std::vector<double>& vy, const std::vector<double>& vz,
+                              const std::string& description) {
+    size_t n = ra.size();
+    std::vector<float> x1(n), y1(n), x2(n), y2(n);
+    std::vector<uint8_t> visible1(n), visible2(n);
+    projection.projectBatch(ra.data(), dec.data(), n, x1.data(), y1.data(), visible1.data());
+    projection.projectUnitVectors(vx.data(), vy.data(), vz.data(), n,
+                                  x2.data(), y2.data(), visible2.data());
+
+    size_t mismatches = 0, shown = 0;
+    double worst = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+        if (visible1[i] != visible2[i]) {
+            mismatches++;
+            continue;
+        }
+        if (!visible1[i]) continue;
+        shown++;
+        worst = std::max({worst, static_cast<double>(std::abs(x1[i] - x2[i])),
+                          static_cast<double>(std::abs(y1[i] - y2[i]))});
+    }
+    std::cout << "    " << shown << " visibili, scarto massimo " << worst << "\n";
+    check(mismatches == 0 && shown > 0 && worst < 1e-5, description);
+}
+
+static void testProjection() {
+    std::cout << "\n[Proiezione dai versori]\n";
+    std::vector<double> ra, dec;
+    randomSky(200000, 2025, ra, dec);
+    size_t n = ra.size();
+    std::vector<double> vx(n), vy(n), vz(n);
+    UnitVector::fromRaDec(ra.data(), dec.data(), n, vx.data(), vy.data(), vz.data());
+
+    for (const auto& entry : PROJECTIONS) {
+        auto projection = map::ProjectionFactory::create(
+            entry.type, core::EquatorialCoordinates(83.8, -5.4), 60.0, 40.0);
+        compareProjection(*projection, ra, dec, vx, vy, vz,
+                          std::string(entry.name) + ", campo 60°x40° su Orione");
+
+        projection->setCenter(core::EquatorialCoordinates(12.0, 88.5));
+        compareProjection(*projection, ra, dec, vx, vy, vz,
+                          std::string(entry.name) + ", centro vicino al polo");
+
+        projection->setFieldOfView(2.0, 1.5);
+        projection->setCenter(core::EquatorialCoordinates(359.9, 0.0));
+        compareProjection(*projection, ra, dec, vx, vy, vz,
+                          std::string(entry.name) + ", campo 2° a cavallo di 0h");
+    }
+
+    BaseVectorProjection base(core::EquatorialCoordinates(200.0, 30.0), 40.0, 30.0);
+    compareProjection(base, ra, dec, vx, vy, vz, "implementazione di base (da RA/Dec)");
+
+    // Mappa disegnata da un blocco con e senza versori
+    std::mt19937_64 rng(5);
+    std::uniform_real_distribution<double> raDist(73.8, 93.8), decDist(-15.4, 4.6), magDist(2.0, 12.0);
+    core::StarBlock stars;
+    for (int i = 0; i < 20000; ++i) stars.append(raDist(rng), decDist(rng), magDist(rng));
+    core::StarBlock withVectors = stars;
+    withVectors.computeUnitVectors();
+
+    for (const auto& entry : PROJECTIONS) {
+        map::MapConfiguration config;
+        config.center = core::EquatorialCoordinates(83.8, -5.4);
+        config.fieldOfViewWidth = 16.0;
+        config.fieldOfViewHeight = 9.0;
+        config.imageWidth = 1600;
+        config.imageHeight = 900;
+        config.projection = entry.type;
+        config.gridStyle.enabled = false;
+
+        map::MapRenderer renderer(config);
+        auto fromAngles = renderer.render(stars);
+        auto fromVectors = renderer.render(withVectors);
+        size_t different = 0;
+        for (size_t i = 0; i < fromAngles.data.size(); ++i) {
+            different += fromAngles.data[i] != fromVectors.data[i];
+        }
+        check(different * 10000 < fromAngles.data.size(),
+              std::string(entry.name) + ": stessa mappa dai versori (" +
+              std::to_string(different) + " byte diversi)");
+    }
+}
+
+template <typename Fn>
+static double bestMs(Fn&& fn) {
+    double best = 1e9;
+    for (int rep = 0; rep < 5; ++rep) {
+        auto start = Clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    return best;
+}
+
+static void benchmark(size_t n) {
+    std::cout << "\n[Benchmark: " << n << " stelle]\n";
+    std::vector<double> ra, dec;
+    randomSky(n, 42, ra, dec);
+    std::vector<double> vx(n), vy(n), vz(n), degrees(n);
+    double convertMs = bestMs([&] {
+        UnitVector::fromRaDec(ra.data(), dec.data(), n, vx.data(), vy.data(), vz.data());
+    });
+    std::cout << "  conversione in versori (una volta): " << convertMs * 1e6 / n << " ns/stella\n";
+
+    // Separazioni da un punto: haversine per stella contro corda
+    core::EquatorialCoordinates center(83.8, -5.4);
+    auto from = UnitVector::fromEquatorial(center);
+    double checksum = 0.0;
+    double haversineMs = bestMs([&] {
+        for (size_t i = 0; i < n; ++i) {
+            degrees[i] = center.angularDistance(core::EquatorialCoordinates(ra[i], dec[i]));
+        }
+    });
+    checksum += degrees[n / 2];
+    double chordMs = bestMs([&] {
+        core::angularSeparations(from, vx.data(), vy.data(), vz.data(), n, degrees.data());
+    });
+    checksum += degrees[n / 2];
+    std::cout << "  separazioni: haversine " << haversineMs * 1e6 / n << " ns/stella, versori "
+              << chordMs * 1e6 / n << " ns/stella\n";
+
+    // Filtro del cono
+    std::vector<uint8_t> keep(n);
+    auto cap = core::SphericalCap::cone(83.8, -5.4, 10.0);
+    double withinMs = bestMs([&] {
+        catalog::SkyIndex::withinCone(ra.data(), dec.data(), n, 83.8, -5.4, 10.0, keep.data());
+    });
+    double capMs = bestMs([&] {
+        cap.contains(vx.data(), vy.data(), vz.data(), n, keep.data());
+    });
+    std::cout << "  cono di 10°: withinCone " << withinMs * 1e6 / n << " ns/stella, calotta "
+              << capMs * 1e6 / n << " ns/stella\n";
+
+    // Proiezione e culling del campo
+    std::vector<float> x(n), y(n);
+    for (const auto& entry : PROJECTIONS) {
+        auto projection = map::ProjectionFactory::create(entry.type, center, 60.0, 40.0);
+        double anglesMs = bestMs([&] {
+            projection->projectBatch(ra.data(), dec.data(), n, x.data(), y.data(), keep.data());
+        });
+        double vectorsMs = bestMs([&] {
+            projection->projectUnitVectors(vx.data(), vy.data(), vz.data(), n,
+                                           x.data(), y.data(), keep.data());
+        });
+        checksum += x[n / 2];
+        std::cout << "  " << entry.name << ": da RA/Dec " << anglesMs * 1e6 / n
+                  << " ns/stella, dai versori " << vectorsMs * 1e6 / n << " ns/stella\n";
+    }
+    std::cout << "  (checksum " << checksum << ")\n";
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+
+    std::cout << "=== Test versori (UnitVector) ===\n";
+    testSeparation();
+    testCaps();
+    testStarBlock();
+    testSnapshot();
+    testProjection();
+    benchmark(n);
+
+    return examples::testSummary();
+}
@@ -0,0 +1,262 @@
+/**
+ * @file test_votable.cpp
+ * @brief Verifica di VOTableReader e della lettura in streaming delle risposte
+ *
+ * Controlla: decodifica TABLEDATA e BINARY2 (stessi valori, nulli
+ * compresi), lettura a frammenti di un byte, consegna a blocchi di righe,
+ * documenti di errore e, contro un server locale, risposte passate al
+ * lettore da AsyncHttpEngine senza accumulare il corpo (anche dalla cache).
+ *
+ * Uso: test_votable [righe]
+ */
+
+#include "loopback_http_server.h"
+#include "test_support.h"
+#include <starmap/catalog/VOTableReader.h>
+#include <starmap/utils/AsyncHttpEngine.h>
+#include <starmap/utils/HttpCache.h>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace starmap;
+using examples::check;
+using starmap::catalog::VOTableColumns;
+using starmap::catalog::VOTableReader;
+using starmap::examples::LoopbackHttpServer;
+using starmap::examples::LoopbackRequest;
+using starmap::examples::LoopbackResponse;
+using Clock = std::chrono::steady_clock;
+
+static const char* FIELDS =
+    "<FIELD name=\"id\" datatype=\"long\"/>"
+    "<FIELD name=\"ra\" datatype=\"double\" unit=\"deg\"/>"
+    "<FIELD name=\"SAO\" datatype=\"int\"><VALUES null=\"-1\"/></FIELD>"
+    "<FIELD name=\"name\" datatype=\"char\" arraysize=\"*\"/>";
+
+static std::string document(const std::string& data) {
+    return std::string("<?xml version=\"1.0\"?>\n"
+                       "<VOTABLE version=\"1.4\" xmlns=\"http://www.ivoa.net/xml/VOTable/v1.3\">"
+                       "<RESOURCE type=\"results\"><INFO name=\"QUERY_STATUS\" value=\"OK\"/>"
+                       "<TABLE>") + FIELDS + "<DATA>" + data + "</DATA></TABLE></RESOURCE></VOTABLE>\n";
+}
+
+/**
+ * @brief Tabella TABLEDATA di n righe: id = i, ra = i / 4, SAO = 1000 + i (nullo se i % 3 == 1)
+ */
+static std::string tableData(size_t n) {
+    std::ostringstream rows;
+    rows.precision(12);
+    rows << "<TABLEDATA>\n";
+    for (size_t i = 0; i < n; ++i) {
+        rows << "<TR><TD>" << i << "</TD><TD>" << i / 4.0 << "</TD><TD>"
+             << (i % 3 == 1 ? std::string() : std::to_string(1000 + i))
+             << "</TD><TD>star &lt;" << i << "&gt;</TD></TR>\n";
+    }
+    rows << "</TABLEDATA>";
+    return document(rows.str());
+}
+
+static std::string base64(const std::string& bytes) {
+    static const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string out;
+    size_t i = 0;
+    for (; i + 2 < bytes.size(); i += 3) {
+        uint32_t v = (uint8_t(bytes[i]) << 16) | (uint8_t(bytes[i + 1]) << 8) | uint8_t(bytes[i + 2]);
+        for (int k = 3; k >= 0; --k) out += alphabet[(v >> (6 * k)) & 63];
+        if (out.size() % 77 == 76) out += '\n';
+    }
+    if (i < bytes.size()) {
+        uint32_t v = uint8_t(bytes[i]) << 16;
+        if (i + 1 < bytes.size()) v |= uint8_t(bytes[i + 1]) << 8;
+        out += alphabet[(v >> 18) & 63];
+        out += alphabet[(v >> 12) & 63];
+        out += i + 1 < bytes.size() ? alphabet[(v >> 6) & 63] : '=';
+        out += '=';
+    }
+    return out;
+}
+
+static void bigEndian(std::string& out, uint64_t value, int bytes) {
+    for (int k = bytes - 1; k >= 0; --k) out += static_cast<char>((value >> (8 * k)) & 0xFF);
+}
+
+/**
+ * @brief Stessa tabella di tableData() serializzata in BINARY2
+ */
+static std::string binary2(size_t n) {
+    std::string stream;
+    for (size_t i = 0; i < n; ++i) {
+        bool saoNull = (i % 3 == 1);
+        stream += static_cast<char>(saoNull ? 0x20 : 0x00);    // Flag di nullità, colonna 2
+        bigEndian(stream, i, 8);
+        double ra = i / 4.0;
+        uint64_t raBits;
+        std::memcpy(&raBits, &ra, sizeof(ra));
+        bigEndian(stream, raBits, 8);
+        bigEndian(stream, saoNull ? 0 : 1000 + i, 4);
+        std::string name = "star <" + std::to_string(i) + ">";
+        bigEndian(stream, name.size(), 4);
+        stream += name;
+    }
+    return document("<BINARY2><STREAM encoding=\"base64\">" + base64(stream) + "</STREAM></BINARY2>");
+}
+
+/**
+ * @brief Confronta le righe di un blocco con i valori attesi di tableData()
+ */
+static bool rowsMatch(const VOTableColumns& columns, size_t firstRow) {
+    int id = columns.columnIndex("id");
+    int ra = columns.columnIndex("ra");
+    int sao = columns.columnIndex("SAO");
+    int name = columns.columnIndex("name");
+    if (id < 0 || ra < 0 || sao < 0 || name < 0) return false;
+    for (size_t row = 0; row < columns.rowCount(); ++row) {
+        size_t i = firstRow + row;
+        if (columns.getInteger(id, row) != static_cast<long long>(i)) return false;
+        if (columns.getReal(ra, row) != i / 4.0) return false;
+        if (i % 3 == 1) {
+            if (!columns.isNull(sao, row) || columns.getInteger(sao, row)) return false;
+        } else if (columns.getInteger(sao, row) != static_cast<long long>(1000 + i)) {
+            return false;
+        }
+        if (columns.getText(name, row) != "star <" + std::to_string(i) + ">") return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Lettore che verifica ogni blocco e conta righe e blocchi
+ */
+struct CheckedReader {
+    size_t rows = 0;
+    size_t blocks = 0;
+    bool valid = true;
+    VOTableReader reader;
+
+    explicit CheckedReader(size_t blockRows)
+        : reader([this](size_t, const VOTableColumns& columns) {
+              valid = valid && rowsMatch(columns, rows);
+              rows += columns.rowCount();
+              blocks++;
+          }, blockRows) {}
+};
+
+int main(int argc, char* argv[]) {
+    size_t numRows = argc > 1 ? static_cast<size_t>(std::max(1, std::atoi(argv[1]))) : 200000;
+
+    std::cout << "=== Test VOTableReader ===\n\n";
+
+    std::cout << "Serializzazioni:\n";
+    {
+        VOTableReader text;
+        check(text.parse(tableData(10)) && text.columns().rowCount() == 10 &&
+              rowsMatch(text.columns(), 0), "TABLEDATA: valori, nulli ed entità");
+
+        VOTableReader binary;
+        check(binary.parse(binary2(10)) && binary.columns().rowCount() == 10 &&
+              rowsMatch(binary.columns(), 0), "BINARY2: stessi valori di TABLEDATA");
+
+        const auto& fields = text.columns().fields();
+        check(fields.size() == 4 && fields[1].unit == "deg" && fields[2].nullValue == "-1",
+              "attributi dei campi");
+    }
+
+    std::cout << "Streaming:\n";
+    {
+        std::string doc = binary2(5000);
+        CheckedReader checked(1000);
+        bool ok = true;
+        for (char c : doc) ok = ok && checked.reader.feed(&c, 1);
+        ok = ok && checked.reader.finish();
+        check(ok && checked.valid && checked.rows == 5000, "frammenti di un byte (BINARY2)");
+        check(checked.blocks == 5, "righe consegnate a blocchi di blockRows");
+
+        std::string big = tableData(numRows);
+        CheckedReader timed(VOTableReader::DEFAULT_BLOCK_ROWS);
+        auto start = Clock::now();
+        for (size_t pos = 0; pos < big.size(); pos += 16384) {
+            timed.reader.feed(big.data() + pos, std::min<size_t>(16384, big.size() - pos));
+        }
+        bool finished = timed.reader.finish();
+        double elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+        std::cout << "  " << numRows << " righe TABLEDATA (" << big.size() / 1048576.0
+                  << " MB) in " << elapsed << " s\n";
+        check(finished && timed.valid && timed.rows == numRows, "documento grande a frammenti di 16 KB");
+    }
+
+    std::cout << "Errori:\n";
+    {
+        VOTableReader error;
+        std::string doc = "<VOTABLE><RESOURCE><INFO name=\"QUERY_STATUS\" value=\"ERROR\">"
+                          "Table not found</INFO></RESOURCE></VOTABLE>";
+        check(!error.parse(doc) && !error.getError().empty(), "QUERY_STATUS=ERROR rifiutato");
+
+        VOTableReader html;
+        check(!html.parse("<html><body>503</body></html>"), "documento non VOTable rifiutato");
+
+        VOTableReader truncated;
+        std::string doc2 = tableData(100);
+        check(!truncated.parse(doc2.substr(0, doc2.size() / 2)), "documento troncato rifiutato");
+    }
+
+    std::cout << "Risposte HTTP in streaming:\n";
+    {
+        std::string body = tableData(numRows);
+        LoopbackHttpServer server([&body](const LoopbackRequest&) {
+            LoopbackResponse response;
+            response.headers["Content-Type"] = "application/x-votable+xml";
+            response.headers["Cache-Control"] = "max-age=3600";
+            response.body = body;
+            return response;
+        });
+        if (!server.isRunning()) {
+            std::cerr << "Impossibile avviare il server locale\n";
+            return 1;
+        }
+
+        auto directory = std::filesystem::temp_directory_path() / "starmap_test_votable";
+        std::filesystem::remove_all(directory);
+        auto cache = std::make_shared<utils::HttpCache>(directory.string());
+        utils::AsyncHttpEngine engine;
+
+        auto fetch = [&](std::shared_ptr<utils::HttpCache> withCache, size_t& fragments) {
+            auto checked = std::make_shared<CheckedReader>(VOTableReader::DEFAULT_BLOCK_ROWS);
+            utils::HttpRequest request;
+            request.url = server.url("/votable");
+            request.cache = withCache;
+            request.onData = [checked, &fragments](const char* data, size_t size) {
+                fragments++;
+                return checked->reader.feed(data, size);
+            };
+            auto response = engine.submit(request).get();
+            bool ok = response.ok() && checked->reader.finish() && checked->valid &&
+                      checked->rows == numRows;
+            return std::make_pair(ok, response);
+        };
+
+        size_t fragments = 0;
+        auto [streamed, response] = fetch(nullptr, fragments);
+        check(streamed && response.body.empty(), "righe lette durante il trasferimento, corpo non accumulato");
+        std::cout << "  " << fragments << " frammenti ricevuti\n";
+        check(fragments > 1, "il lettore riceve il corpo a frammenti");
+
+        fragments = 0;
+        auto [stored, first] = fetch(cache, fragments);
+        size_t before = server.requests();
+        fragments = 0;
+        auto [replayed, second] = fetch(cache, fragments);
+        check(stored && replayed && second.fromCache && server.requests() == before,
+              "risposta in cache passata al lettore senza rete");
+
+        std::filesystem::remove_all(directory);
+    }
+
+    return examples::testSummary();
+}
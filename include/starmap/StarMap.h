@@ -12,6 +12,7 @@
 // Core components
 #include "starmap/core/Coordinates.h"
 #include "starmap/core/CelestialObject.h"
+#include "starmap/core/StarBlock.h"
 
 // Catalog access
 #include "starmap/catalog/GaiaClient.h"
@@ -91,8 +92,15 @@ private:
  * @brief Inizializza la libreria con configurazione opzionale
  * 
  * Configura i path ai database e cataloghi. Se non chiamata, usa path di default.
+ * Apre la sessione condivisa del catalogo Gaia, che resta aperta (con la
+ * sua cache dei chunk) fino a finalize().
+ * 
+ * Può essere richiamata per cambiare i path solo quando nessun GaiaClient
+ * (né CatalogManager o ChartGenerator in uso) tiene aperta la sessione:
+ * altrimenti la configurazione resta invariata e restituisce false.
  * 
  * @param catalogPaths Path ai cataloghi (opzionale)
+ * @return true se la configurazione è stata applicata
  * 
  * Esempio:
  * @code
@@ -101,11 +109,23 @@ private:
  * starmap::initialize(paths);
  * @endcode
  */
-void initialize(const config::LibraryConfig::CatalogPaths& catalogPaths = config::LibraryConfig::CatalogPaths());
+bool initialize(const config::LibraryConfig::CatalogPaths& catalogPaths = config::LibraryConfig::CatalogPaths());
+
+/**
+ * @brief Precarica l'indice dei chunk del catalogo Gaia
+ * 
+ * Da chiamare dopo initialize() perché la prima carta non paghi
+ * l'apertura a freddo del catalogo.
+ * @return true se il catalogo è disponibile
+ */
+bool warmUpCatalog();
 
 /**
  * @brief Finalizza la libreria (opzionale)
- * Rilascia risorse globali
+ * Rilascia risorse globali (chiude la sessione del catalogo Gaia quando
+ * nessun GaiaClient la usa più). Senza finalize() la sessione resta aperta
+ * fino all'uscita del processo e non viene chiusa durante la distruzione
+ * degli oggetti statici.
  */
 void finalize();
 
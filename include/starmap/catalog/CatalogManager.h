@@ -3,15 +3,54 @@
 
 #include "GaiaClient.h"
 #include "SAOCatalog.h"
+#include "QueryCache.h"
 #include "starmap/core/CelestialObject.h"
+#include "starmap/core/StarBlock.h"
+#include "starmap/utils/ThreadPool.h"
+#include <atomic>
+#include <functional>
+#include <future>
 #include <memory>
 #include <vector>
 
 namespace starmap {
 namespace catalog {
 
+/**
+ * @brief Contatori delle query di CatalogManager
+ */
+struct CatalogManagerStatistics {
+    size_t catalogQueries = 0;   // Letture del catalogo (né cache né aggancio)
+    size_t joinedQueries = 0;    // Richieste agganciate a una query identica in corso
+    size_t failedQueries = 0;    // Query terminate con un'eccezione
+};
+
 /**
  * @brief Manager unificato per gestire query a cataloghi multipli
+ * 
+ * Le query possono essere sincrone o asincrone (varianti *Async, eseguite
+ * da un pool di thread di I/O). Una query identica a una già in corso, sia
+ * sincrona sia asincrona, si aggancia a quella invece di ripeterla.
+ *
+ * Concorrenza: tutte le funzioni di query possono essere chiamate da più
+ * thread sulla stessa istanza.
+ * - Cache (QueryCache) e richieste in corso sono protette da mutex brevi.
+ * - Le letture del catalogo Gaia sono serializzate (IOC_GaiaLib non
+ *   garantisce accessi concorrenti); una query identica a una in corso
+ *   non le ripete.
+ * - L'arricchimento SAO procede in parallelo: ogni ricerca prende una
+ *   connessione dal pool in sola lettura (SQLiteConnectionPool).
+ * - Le query online usano un handle CURL per thread (HttpClient).
+ * - La configurazione globale è letta da snapshot immutabili (LibraryConfig).
+ * Le funzioni di configurazione (setCacheEnabled, setAsyncThreads, ...)
+ * sono thread-safe ma hanno effetto sulle query avviate dopo la chiamata.
+ *
+ * Errori: un'eccezione sollevata dalla lettura del catalogo o
+ * dall'arricchimento SAO viene rilanciata da queryStarBlock() e dal future
+ * di tutti i chiamanti agganciati alla stessa query; il risultato non
+ * entra in cache e la richiesta successiva riparte da capo.
+ * getGaiaClient()/getSAOCatalog() espongono gli oggetti interni senza
+ * queste garanzie.
  */
 class CatalogManager {
 public:
@@ -28,6 +67,20 @@ public:
         const GaiaQueryParameters& params,
         bool enrichWithSAO = true);
 
+    /**
+     * @brief Query unificata con risultato colonnare
+     * 
+     * Percorso principale: nessuna allocazione per stella. queryStars()
+     * è un adattatore su questa funzione.
+     * 
+     * @param params Parametri query GAIA
+     * @param enrichWithSAO Se true, cerca numeri SAO per le stelle sotto mag 9
+     * @return Blocco colonnare con le stelle trovate
+     */
+    core::StarBlock queryStarBlock(
+        const GaiaQueryParameters& params,
+        bool enrichWithSAO = true);
+
     /**
      * @brief Query per regione rettangolare
      */
@@ -38,6 +91,68 @@ public:
         double maxMagnitude = 15.0,
         bool enrichWithSAO = true);
 
+    /**
+     * @brief Variante asincrona di queryStarBlock()
+     * 
+     * La query viene eseguita dal pool di I/O. Se il token viene annullato
+     * prima che la query termini, il risultato è un blocco vuoto (e non
+     * entra in cache); una query condivisa con altri chiamanti viene
+     * interrotta solo quando tutti l'hanno annullata, e mai se vi si è
+     * agganciata una chiamata sincrona.
+     * 
+     * @param params Parametri query GAIA
+     * @param enrichWithSAO Se true, cerca numeri SAO per le stelle sotto mag 9
+     * @param cancel Token di annullamento (default: non annullabile)
+     * @return Future condiviso con il risultato
+     */
+    std::shared_future<core::StarBlock> queryStarBlockAsync(
+        const GaiaQueryParameters& params,
+        bool enrichWithSAO = true,
+        utils::CancellationToken cancel = utils::CancellationToken());
+
+    /**
+     * @brief Variante asincrona di queryStars()
+     * 
+     * La conversione in oggetti Star avviene nel thread che chiama get().
+     */
+    std::future<std::vector<std::shared_ptr<core::Star>>> queryStarsAsync(
+        const GaiaQueryParameters& params,
+        bool enrichWithSAO = true,
+        utils::CancellationToken cancel = utils::CancellationToken());
+
+    /**
+     * @brief Variante asincrona di queryRectangularRegion()
+     */
+    std::future<std::vector<std::shared_ptr<core::Star>>> queryRectangularRegionAsync(
+        const core::EquatorialCoordinates& center,
+        double widthDeg,
+        double heightDeg,
+        double maxMagnitude = 15.0,
+        bool enrichWithSAO = true,
+        utils::CancellationToken cancel = utils::CancellationToken());
+
+    /**
+     * @brief Numero di thread del pool di I/O (default 2)
+     * 
+     * Ha effetto solo se chiamata prima della prima query asincrona.
+     */
+    void setAsyncThreads(size_t threads);
+
+    /**
+     * @brief Sorgente delle stelle al posto del catalogo Gaia
+     *
+     * Riceve gli stessi parametri di GaiaClient::queryRegionBlock (default
+     * se vuota) e passa per cache, aggancio, annullamento e gestione degli
+     * errori come il catalogo: serve per cataloghi sintetici e per i test.
+     */
+    using StarSource = std::function<core::StarBlock(const GaiaQueryParameters&)>;
+    void setStarSource(StarSource source);
+
+    /**
+     * @brief Contatori di letture, agganci ed errori
+     */
+    CatalogManagerStatistics getStatistics() const;
+
     /**
      * @brief Accesso ai client individuali
      */
@@ -46,15 +161,54 @@ public:
 
     /**
      * @brief Imposta opzioni di caching e performance
+     * 
+     * Con la cache attiva i risultati di queryStarBlock() sono memorizzati
+     * in una cache LRU (vedi QueryCache); disattivarla la svuota. Con
+     * l'arricchimento parallelo la ricerca SAO è divisa tra più thread.
      */
     void setCacheEnabled(bool enabled);
     void setParallelEnrichment(bool enabled);
 
+    /**
+     * @brief Budget di memoria della cache delle query (byte)
+     */
+    void setCacheMemoryBudget(size_t bytes);
+
+    /**
+     * @brief Svuota la cache delle query
+     */
+    void clearCache();
+
+    /**
+     * @brief Contatori della cache (hit, miss, eviction, memoria)
+     */
+    QueryCacheStatistics getCacheStatistics() const;
+
 private:
+    class Impl;
+
+    /**
+     * @brief Avvia una query o si aggancia a quella identica in corso
+     * @param runInline true per eseguirla nel thread chiamante (query sincrone)
+     */
+    std::shared_future<core::StarBlock> startQuery(
+        const GaiaQueryParameters& params,
+        bool enrichWithSAO,
+        utils::CancellationToken cancel,
+        bool runInline);
+
+    static GaiaQueryParameters rectangleParameters(
+        const core::EquatorialCoordinates& center,
+        double widthDeg,
+        double heightDeg,
+        double maxMagnitude);
+
     GaiaClient gaiaClient_;
     SAOCatalog saoCatalog_;
-    bool cacheEnabled_;
-    bool parallelEnrichment_;
+    QueryCache queryCache_;
+    std::atomic<bool> cacheEnabled_;
+    std::atomic<bool> parallelEnrichment_;
+    std::unique_ptr<Impl> pImpl_;   // Ultimo membro: distrutto per primo
 };
 
 } // namespace catalog
@@ -0,0 +1,89 @@
+#ifndef STARMAP_GAIA_CATALOG_SESSION_H
+#define STARMAP_GAIA_CATALOG_SESSION_H
+
+#include "starmap/catalog/SkyTileCache.h"
+#include "starmap/core/Coordinates.h"
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace starmap {
+namespace catalog {
+
+/**
+ * @brief Sessione condivisa del catalogo Gaia (UnifiedGaiaCatalog)
+ *
+ * Il catalogo è un singleton di IOC_GaiaLib: la sessione lo inizializza
+ * alla prima acquire() e lo chiude quando viene rilasciato l'ultimo
+ * riferimento. starmap::initialize() tiene un riferimento fino a
+ * starmap::finalize(), quindi i GaiaClient creati nel frattempo (ad es.
+ * uno per ogni carta di ChartGenerator) condividono la stessa sessione e
+ * la cache dei chunk resta calda tra una carta e l'altra.
+ *
+ * La configurazione (path dei cataloghi, cache a tile) viene letta da
+ * LibraryConfig alla creazione della sessione.
+ */
+class GaiaCatalogSession {
+public:
+    ~GaiaCatalogSession();
+
+    GaiaCatalogSession(const GaiaCatalogSession&) = delete;
+    GaiaCatalogSession& operator=(const GaiaCatalogSession&) = delete;
+
+    /**
+     * @brief Sessione corrente, creata se non ne esiste una attiva
+     */
+    static std::shared_ptr<GaiaCatalogSession> acquire();
+
+    /**
+     * @brief true se esiste una sessione attiva
+     */
+    static bool isActive();
+
+    /**
+     * @brief true se il catalogo è stato inizializzato correttamente
+     */
+    bool isAvailable() const { return available_; }
+
+    /**
+     * @brief Directory del catalogo multifile
+     */
+    const std::string& getCatalogDirectory() const { return catalogDirectory_; }
+
+    /**
+     * @brief Cache a tile su disco (nullptr se non configurata)
+     */
+    SkyTileCache* getTileCache() const { return tileCache_.get(); }
+
+    /**
+     * @brief Carica l'indice dei chunk con una query minima
+     *
+     * Da chiamare all'avvio perché la prima carta non paghi l'apertura a
+     * freddo del catalogo.
+     * @return true se il catalogo ha risposto
+     */
+    bool warmUp();
+
+    /**
+     * @brief Precarica i chunk di una regione nella cache del catalogo
+     * @return Numero di stelle lette
+     */
+    size_t warmUp(const core::EquatorialCoordinates& center, double radiusDeg,
+                  double maxMagnitude);
+
+private:
+    GaiaCatalogSession();
+
+    bool available_ = false;
+    std::string catalogDirectory_;
+    std::unique_ptr<SkyTileCache> tileCache_;
+
+    static std::mutex mutex_;
+    static std::weak_ptr<GaiaCatalogSession> current_;
+    static int liveSessions_;   // Sessioni non ancora distrutte (protetto da mutex_)
+};
+
+} // namespace catalog
+} // namespace starmap
+
+#endif // STARMAP_GAIA_CATALOG_SESSION_H
@@ -3,10 +3,20 @@
 
 #include "starmap/core/CelestialObject.h"
 #include "starmap/core/Coordinates.h"
+#include "starmap/core/StarBlock.h"
+#include "starmap/catalog/SkyTileCache.h"
+#include <functional>
+#include <optional>
 #include <vector>
 #include <memory>
 #include <string>
 
+namespace ioc {
+namespace gaia {
+struct GaiaStar;
+}
+}
+
 namespace starmap {
 namespace catalog {
 
@@ -18,6 +28,7 @@ struct GaiaQueryParameters {
     double radiusDegrees = 1.0;
     double maxMagnitude = 15.0;
     int maxResults = 50000;  // Aumentato da 10000, ma gestito dinamicamente
+    bool keepBrightest = true;  // Oltre maxResults tiene le più luminose (false: ordine del catalogo)
     
     /**
      * @brief Calcola automaticamente maxResults basato su area e magnitudine
@@ -35,9 +46,66 @@ struct GaiaQueryParameters {
     }
 };
 
+/**
+ * @brief Vista non proprietaria su una stella restituita dal catalogo
+ * 
+ * Valida solo durante la callback di GaiaClient::forEachInCone(). Posizione,
+ * magnitudine e source_id sono copiati nella vista; designazione, numero
+ * SAO e colore vengono calcolati solo se richiesti.
+ */
+class StarView {
+public:
+    explicit StarView(const ioc::gaia::GaiaStar& record);
+    StarView(const core::StarBlock& block, size_t row);
+
+    double getRightAscension() const { return ra_; }
+    double getDeclination() const { return dec_; }
+    double getMagnitude() const { return magnitude_; }
+    long long getGaiaId() const { return gaiaId_; }
+    core::EquatorialCoordinates getCoordinates() const {
+        return core::EquatorialCoordinates(ra_, dec_);
+    }
+
+    std::optional<double> getParallax() const;
+    std::optional<double> getProperMotionRA() const;
+    std::optional<double> getProperMotionDec() const;
+    std::optional<double> getColorIndex() const;
+
+    /**
+     * @brief Designazione IAU/Bayer/Flamsteed (stringa vuota se assente)
+     */
+    std::string getDesignation() const;
+
+    /**
+     * @brief Numero SAO dalla designazione del catalogo (parsing su richiesta)
+     */
+    std::optional<int> getSAONumber() const;
+
+    /**
+     * @brief Copia la stella in coda a un blocco
+     * @return Indice della nuova riga
+     */
+    size_t appendTo(core::StarBlock& block) const;
+
+private:
+    double ra_;
+    double dec_;
+    double magnitude_;
+    long long gaiaId_;
+
+    // Sorgente: record del catalogo oppure riga di un blocco (cache a tile)
+    const ioc::gaia::GaiaStar* record_ = nullptr;
+    const core::StarBlock* block_ = nullptr;
+    size_t row_ = 0;
+};
+
 /**
  * @brief Client per catalogo Gaia usando IOC_GaiaLib UnifiedGaiaCatalog
  * 
+ * Il client è un handle leggero sulla sessione condivisa del catalogo
+ * (GaiaCatalogSession): crearne uno per ogni carta non reinizializza il
+ * catalogo né svuota la cache dei chunk.
+ * 
  * Utilizza il catalogo multifile V2 per performance ottimali:
  * - Cone search 0.5°: ~0.001 ms
  * - Cone search 5°: ~13 ms
@@ -56,6 +124,42 @@ public:
     std::vector<std::shared_ptr<core::Star>> queryRegion(
         const GaiaQueryParameters& params);
 
+    /**
+     * @brief Query a cono con risultato colonnare
+     * 
+     * Come queryRegion() ma riempie direttamente uno StarBlock, senza
+     * allocare un oggetto per stella. È il percorso usato da
+     * CatalogManager, ChartGenerator e MapRenderer.
+     * 
+     * Se LibraryConfig indica una directory per la cache a tile, il cono
+     * viene composto dalle tile su disco (vedi SkyTileCache) e il catalogo
+     * viene letto solo per le tile mancanti.
+     * 
+     * Con keepBrightest (default) e più di maxResults stelle nel cono si
+     * tengono le maxResults più luminose, selezionate in streaming: solo le
+     * stelle tenute vengono convertite e copiate nel blocco.
+     * 
+     * @param params Parametri della query (centro, raggio, magnitudine max)
+     * @return Blocco colonnare con le stelle trovate
+     */
+    core::StarBlock queryRegionBlock(const GaiaQueryParameters& params);
+
+    /**
+     * @brief Visita le stelle di un cono senza materializzarle
+     * 
+     * La callback riceve una StarView per ogni stella con magnitudine
+     * valida e <= params.maxMagnitude; maxResults e keepBrightest sono
+     * ignorati. Con la cache a tile attiva le stelle vengono decodificate
+     * dalle tile blocco per blocco (SkyTileCache::forEachInCone), senza
+     * costruire il blocco del risultato.
+     * 
+     * @param params Parametri della query (centro, raggio, magnitudine max)
+     * @param visit Callback chiamata per ogni stella
+     * @return Numero di stelle visitate
+     */
+    size_t forEachInCone(const GaiaQueryParameters& params,
+                         const std::function<void(const StarView&)>& visit);
+
     /**
      * @brief Query per Gaia source_id
      * @param gaiaId Il source_id Gaia DR3
@@ -82,6 +186,21 @@ public:
      */
     bool isAvailable() const;
 
+    /**
+     * @brief Carica l'indice dei chunk del catalogo (vedi GaiaCatalogSession::warmUp)
+     */
+    bool warmUp();
+
+    /**
+     * @brief true se le query passano dalla cache a tile su disco
+     */
+    bool hasTileCache() const;
+
+    /**
+     * @brief Contatori della cache a tile (vuoti se non attiva)
+     */
+    SkyTileCacheStatistics getTileCacheStatistics() const;
+
 private:
     class Impl;
     std::unique_ptr<Impl> pImpl_;
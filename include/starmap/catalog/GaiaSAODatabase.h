@@ -10,6 +10,8 @@
 namespace starmap {
 namespace catalog {
 
+class SAONumberIndex;
+
 /**
  * @brief Entry nel database di cross-match Gaia-SAO
  */
@@ -30,11 +32,28 @@ struct GaiaSAOEntry {
  * scaricati da VizieR/SIMBAD per evitare query online ripetute.
  * 
  * Il database contiene circa 258,997 stelle SAO con cross-match verificato.
+ *
+ * Lo schema è quello di GaiaSAOSchema (tabella sao_xmatch con indici
+ * coprenti, creata da createNewDatabase() e da starmap_build_xmatch); i
+ * database legacy con le tabelle stars e gaia_sao_xmatch restano
+ * leggibili e si convertono con starmap_migrate_xmatch.
  * 
  * Performance tipiche:
  * - Query per Gaia ID: < 0.1 ms
- * - Query per coordinate: < 1 ms (con indice spaziale)
+ * - Query per coordinate: < 1 ms (con indice spaziale sky_pix, vedi SkyIndex)
+ * - Query per numero SAO: accesso diretto alla tabella in memoria (~8 MB)
  * - Dimensione database: ~15 MB
+ *
+ * Se dbPath punta a uno snapshot binario (vedi GaiaSAOSnapshot ed
+ * exportSnapshot()) le ricerche vengono servite dal file mappato in
+ * memoria invece che da SQLite; le funzioni di costruzione non sono
+ * disponibili in questa modalità.
+ *
+ * Le ricerche usano connessioni in sola lettura prese in prestito da
+ * SQLiteConnectionPool, condiviso da tutte le istanze aperte sullo stesso
+ * file: le funzioni di lettura possono essere chiamate da più thread e
+ * creare un'istanza per ogni carta non riapre il database. Le funzioni di
+ * costruzione usano una connessione separata in scrittura.
  */
 class GaiaSAODatabase {
 public:
@@ -52,8 +71,28 @@ public:
      */
     bool isAvailable() const;
 
+    /**
+     * @brief true se il backend è uno snapshot binario mappato in memoria
+     */
+    bool isSnapshot() const;
+
+    /**
+     * @brief Esporta il cross-match in uno snapshot binario mappabile
+     *
+     * Legge le entry con Gaia ID (nei database legacy gaia_sao_xmatch o,
+     * se vuota, le stelle con SAO della tabella stars) e scrive il file con
+     * GaiaSAOSnapshot::write(). Aprendo il file
+     * con il costruttore le ricerche non passano più da SQLite.
+     * @param snapshotPath Path del file da creare
+     * @return true se esportato con successo
+     */
+    bool exportSnapshot(const std::string& snapshotPath) const;
+
     /**
      * @brief Cerca numero SAO per Gaia source_id
+     *
+     * Gli ID senza numero SAO (la grande maggioranza) vengono scartati dal
+     * filtro in memoria costruito all'apertura, senza query SQLite.
      * @param gaiaSourceId Source ID Gaia DR3
      * @return Numero SAO se trovato nel database
      */
@@ -69,6 +108,51 @@ public:
         const core::EquatorialCoordinates& coords,
         double radiusArcsec = 5.0) const;
 
+    /**
+     * @brief Cerca i numeri SAO per un insieme di Gaia source_id
+     *
+     * Esegue una query IN (...) preparata una sola volta per blocchi di
+     * ID, invece di una query per stella.
+     * @param gaiaSourceIds Array di source ID Gaia DR3
+     * @param count Numero di ID
+     * @return Un risultato per ogni ID, nello stesso ordine
+     */
+    std::vector<std::optional<int>> findSAOByGaiaIds(
+        const long long* gaiaSourceIds, size_t count) const;
+
+    std::vector<std::optional<int>> findSAOByGaiaIds(
+        const std::vector<long long>& gaiaSourceIds) const;
+
+    /**
+     * @brief Cross-match posizionale di più coordinate in un'unica query
+     *
+     * Legge una sola volta le stelle SAO della regione che contiene tutte
+     * le posizioni ed esegue il match in memoria.
+     * @param coords Coordinate equatoriali J2000
+     * @param radiusArcsec Raggio di ricerca in arcsec (default 5")
+     * @return Un risultato per ogni posizione, nello stesso ordine
+     */
+    std::vector<std::optional<int>> findSAOByCoordinates(
+        const std::vector<core::EquatorialCoordinates>& coords,
+        double radiusArcsec = 5.0) const;
+
+    /**
+     * @brief Cerca una stella per numero SAO
+     *
+     * Servita dalla tabella SAONumberIndex caricata all'apertura: accesso
+     * diretto in memoria, senza query.
+     * @param saoNumber Numero SAO
+     * @return Entry (separazione 0) se il numero è nel database
+     */
+    std::optional<GaiaSAOEntry> findBySAONumber(int saoNumber) const;
+
+    /**
+     * @brief Tabella delle stelle SAO per numero (nullptr se non disponibile)
+     *
+     * Include il tipo spettrale quando il database lo fornisce.
+     */
+    std::shared_ptr<const SAONumberIndex> getSAONumberIndex() const;
+
     /**
      * @brief Ottieni entry completa per Gaia ID
      * @param gaiaSourceId Source ID Gaia DR3
@@ -90,7 +174,9 @@ public:
 
     /**
      * @brief Ottieni statistiche del database
-     * @return Stringa con informazioni (numero entry, versione, etc.)
+     * @return Stringa con informazioni (numero entry, dimensione, memoria e
+     *         tasso di falsi positivi del filtro dei Gaia ID, memoria e tempo
+     *         di caricamento della tabella per numero SAO, etc.)
      */
     std::string getStatistics() const;
 
@@ -103,7 +189,7 @@ public:
     // ========== Funzioni per costruzione database (uso interno) ==========
 
     /**
-     * @brief Crea nuovo database vuoto con schema
+     * @brief Crea nuovo database vuoto con lo schema corrente (GaiaSAOSchema)
      * @return true se creato con successo
      */
     bool createNewDatabase();
@@ -124,6 +210,13 @@ public:
 
     /**
      * @brief Crea indici per performance (da chiamare dopo inserimento dati)
+     *
+     * Con lo schema corrente crea gli indici coprenti di GaiaSAOSchema. Sui
+     * database legacy aggiunge agli indici classici la colonna sky_pix
+     * (pixel di SkyIndex) con un indice coprente alle tabelle
+     * gaia_sao_xmatch e stars: da quel momento le ricerche per cono e per
+     * box usano gli intervalli di pixel invece dei box RA/Dec. I database
+     * senza sky_pix continuano a funzionare con la ricerca per box.
      * @return true se indici creati con successo
      */
     bool createIndices();
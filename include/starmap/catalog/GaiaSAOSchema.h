@@ -0,0 +1,168 @@
+#ifndef STARMAP_GAIA_SAO_SCHEMA_H
+#define STARMAP_GAIA_SAO_SCHEMA_H
+
+#include <sqlite3.h>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace starmap {
+namespace catalog {
+
+/**
+ * @brief Schema versionato del database di cross-match Gaia-SAO
+ *
+ * Versione 2: un'unica tabella sao_xmatch WITHOUT ROWID con chiave
+ * source_id (le stelle SAO senza controparte Gaia hanno source_id = -SAO)
+ * e coordinate intere in microgradi, magnitudine in millesimi e
+ * separazione in mas, più piccole dei REAL e quindi più righe per pagina:
+ *
+ * - SAO per Gaia ID: ricerca sulla chiave primaria, che contiene la riga;
+ * - ricerche per cono e per box: indice coprente idx_sao_xmatch_sky_pix;
+ * - stelle luminose di una regione: indice parziale coprente
+ *   idx_sao_xmatch_bright (mag_mmag < 6000).
+ *
+ * Versione 1 (legacy): tabelle stars e/o gaia_sao_xmatch con coordinate
+ * REAL, ancora leggibili da GaiaSAODatabase e convertibili con migrate()
+ * (strumento starmap_migrate_xmatch).
+ */
+class GaiaSAOSchema {
+public:
+    static constexpr int VERSION = 2;
+    static constexpr const char* TABLE = "sao_xmatch";
+
+    // Fattori di scala delle colonne intere
+    static constexpr double ANGLE_SCALE = 1e6;      // gradi -> microgradi
+    static constexpr double MILLI_SCALE = 1e3;      // mag -> mmag, arcsec -> mas
+
+    // Stelle luminose senza controparte Gaia (ChartGenerator): colonne
+    // magnitudine, SAO, nome e condizione servite da idx_sao_xmatch_bright
+    static constexpr const char* BRIGHT_COLUMNS = "mag_mmag / 1000.0, sao, name";
+    static constexpr const char* BRIGHT_CONDITION = "mag_mmag < 6000 AND source_id < 0";
+
+    /**
+     * @brief Tabella e colonne da cui leggere il cross-match
+     *
+     * Le colonne sono espressioni SQL in unità naturali (gradi, mag,
+     * arcsec), così le query sono le stesse per tutte le versioni.
+     */
+    struct Layout {
+        std::string table;
+        std::string sourceId;
+        std::string sao;
+        std::string ra;
+        std::string dec;
+        std::string magnitude;
+        std::string separation;
+        std::string condition;      // Righe con numero SAO
+
+        /**
+         * @brief Numero SAO di un Gaia ID (un parametro)
+         */
+        std::string saoBySourceIdSql() const;
+
+        /**
+         * @brief Coppie (Gaia ID, SAO) per count Gaia ID: "IN (?, ?, ...)"
+         */
+        std::string saoBySourceIdsSql(size_t count) const;
+
+        /**
+         * @brief Entry completa di un Gaia ID (un parametro)
+         */
+        std::string entryBySourceIdSql() const;
+
+        /**
+         * @brief Tutti i Gaia ID con numero SAO
+         */
+        std::string sourceIdsSql() const;
+
+        /**
+         * @brief Tutte le entry con Gaia ID: id, SAO, ra, dec, mag, separazione
+         */
+        std::string entriesSql() const;
+
+        /**
+         * @brief Colonne aggiuntive delle ricerche per cono (dopo ra e dec)
+         */
+        std::string entryColumns() const;
+
+        /**
+         * @brief Condizione delle ricerche per cono: solo righe con Gaia ID
+         */
+        std::string entryCondition() const;
+    };
+
+    /**
+     * @brief Layout della versione corrente (tabella sao_xmatch)
+     */
+    static Layout current();
+
+    /**
+     * @brief Layout legacy della tabella stars
+     */
+    static Layout legacyStars();
+
+    /**
+     * @brief Layout legacy della tabella gaia_sao_xmatch
+     */
+    static Layout legacyXMatch();
+
+    /**
+     * @brief Versione dello schema di un database aperto
+     * @return VERSION (o superiore) per sao_xmatch, 1 per le sole tabelle
+     *         legacy, 0 se non è un database di cross-match
+     */
+    static int version(sqlite3* db);
+
+    /**
+     * @brief Crea tabelle e metadati della versione corrente (senza indici)
+     */
+    static bool create(sqlite3* db);
+
+    /**
+     * @brief Crea gli indici coprenti e aggiorna le statistiche (ANALYZE)
+     *
+     * Da chiamare a dati caricati.
+     */
+    static bool createIndices(sqlite3* db);
+
+    /**
+     * @brief Registra la funzione SQL starmap_sky_pix(ra, dec) sulla connessione
+     */
+    static bool registerFunctions(sqlite3* db);
+
+    /**
+     * @brief Converte un database legacy nella versione corrente
+     *
+     * Legge gaia_sao_xmatch e le stelle con SAO della tabella stars
+     * (con nome proprio, Bayer o Flamsteed e tipo spettrale se presenti)
+     * e scrive un nuovo file; il database di origine non viene modificato.
+     * @param legacyPath Database di origine (versione 1)
+     * @param outputPath File da creare (non deve esistere)
+     * @return true se convertito con successo
+     */
+    static bool migrate(const std::string& legacyPath, const std::string& outputPath);
+
+    /**
+     * @brief Testo delle query frequenti sulla versione corrente
+     *
+     * Le stesse preparate da GaiaSAODatabase e ChartGenerator: tutte devono
+     * essere servite dalla chiave primaria o da un indice coprente.
+     */
+    static std::vector<std::string> hotQueries();
+
+    static int64_t scaledAngle(double degrees) {
+        return std::llround(degrees * ANGLE_SCALE);
+    }
+
+    static int64_t scaledMilli(double value) {
+        return std::llround(value * MILLI_SCALE);
+    }
+};
+
+} // namespace catalog
+} // namespace starmap
+
+#endif // STARMAP_GAIA_SAO_SCHEMA_H
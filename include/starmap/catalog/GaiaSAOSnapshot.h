@@ -0,0 +1,173 @@
+#ifndef STARMAP_GAIA_SAO_SNAPSHOT_H
+#define STARMAP_GAIA_SAO_SNAPSHOT_H
+
+#include "starmap/catalog/GaiaSAODatabase.h"
+#include "starmap/catalog/SkyIndex.h"
+#include "starmap/core/UnitVector.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace starmap {
+namespace catalog {
+
+/**
+ * @brief Snapshot binario in sola lettura del cross-match Gaia-SAO
+ *
+ * Il file viene mappato in memoria (mmap) e letto direttamente: l'apertura
+ * non legge dati e le pagine sono condivise tra tutti i processi che usano
+ * lo stesso file.
+ *
+ * Contenuto (colonne contigue, allineate a 64 byte):
+ * - righe ordinate per pixel di SkyIndex e, nel pixel, per magnitudine:
+ *   RA, Dec, versore (x, y, z), source_id, numero SAO, magnitudine,
+ *   separazione
+ * - offset di inizio di ogni pixel (NUM_PIXELS + 1 valori)
+ * - source_id ordinati con la riga corrispondente
+ * - numeri SAO ordinati con la riga corrispondente
+ *
+ * Le ricerche restituiscono indici di riga o visitano le righe senza
+ * copie né allocazioni. Il file si crea con write() o
+ * GaiaSAODatabase::exportSnapshot().
+ *
+ * I versori delle righe (core::UnitVector) sono scritti da write(): la
+ * verifica del cono è un prodotto scalare per riga sulle colonne mappate.
+ */
+class GaiaSAOSnapshot {
+public:
+    /**
+     * @brief Apre e mappa uno snapshot
+     * @param path Path al file snapshot
+     */
+    explicit GaiaSAOSnapshot(const std::string& path);
+    ~GaiaSAOSnapshot();
+
+    GaiaSAOSnapshot(const GaiaSAOSnapshot&) = delete;
+    GaiaSAOSnapshot& operator=(const GaiaSAOSnapshot&) = delete;
+
+    /**
+     * @brief true se il file è stato mappato e validato
+     */
+    bool isOpen() const { return base_ != nullptr; }
+
+    /**
+     * @brief Numero di righe
+     */
+    size_t size() const { return count_; }
+
+    /**
+     * @brief Verifica se un file è uno snapshot (controlla il magic number)
+     */
+    static bool isSnapshotFile(const std::string& path);
+
+    /**
+     * @brief Scrive uno snapshot a partire da un insieme di entry
+     * @param path File di output (sovrascritto)
+     * @param entries Entry del cross-match (ordine qualsiasi)
+     * @return true se scritto con successo
+     */
+    static bool write(const std::string& path, const std::vector<GaiaSAOEntry>& entries);
+
+    // Accesso per riga (dati mappati, nessuna copia)
+    double ra(size_t row) const { return ra_[row]; }
+    double dec(size_t row) const { return dec_[row]; }
+    long long sourceId(size_t row) const { return sourceId_[row]; }
+    int saoNumber(size_t row) const { return sao_[row]; }
+    float magnitude(size_t row) const { return mag_[row]; }
+    float separation(size_t row) const { return separation_[row]; }
+    core::UnitVector unitVector(size_t row) const { return {x_[row], y_[row], z_[row]}; }
+
+    /**
+     * @brief Entry completa della riga
+     */
+    GaiaSAOEntry entry(size_t row) const;
+
+    /**
+     * @brief Riga per Gaia source_id (ricerca binaria)
+     */
+    std::optional<size_t> findBySourceId(long long gaiaSourceId) const;
+
+    /**
+     * @brief Riga per numero SAO (ricerca binaria)
+     */
+    std::optional<size_t> findBySAONumber(int saoNumber) const;
+
+    /**
+     * @brief Visita le righe entro un cono (verifica esatta inclusa)
+     *
+     * Nessuna allocazione: gli intervalli di pixel e la maschera della
+     * verifica esatta usano buffer sullo stack.
+     * @param fn Chiamata come fn(size_t row) per ogni riga nel cono, in
+     *           ordine di pixel e, nel pixel, di magnitudine crescente
+     * @return Numero di righe visitate
+     */
+    template<typename Fn>
+    size_t forEachInCone(double ra, double dec, double radiusDeg, Fn&& fn) const;
+
+    /**
+     * @brief Statistiche dello snapshot (righe, dimensione, sezioni)
+     */
+    std::string getStatistics() const;
+
+private:
+    static constexpr size_t MASK_CHUNK = 256;
+
+    const uint8_t* base_ = nullptr;
+    size_t fileSize_ = 0;
+    size_t count_ = 0;
+    std::string path_;
+
+    // Viste sulle sezioni mappate
+    const double* ra_ = nullptr;
+    const double* dec_ = nullptr;
+    const double* x_ = nullptr;
+    const double* y_ = nullptr;
+    const double* z_ = nullptr;
+    const int64_t* sourceId_ = nullptr;
+    const int32_t* sao_ = nullptr;
+    const float* mag_ = nullptr;
+    const float* separation_ = nullptr;
+    const uint32_t* pixelStart_ = nullptr;
+    const int64_t* idSorted_ = nullptr;
+    const uint32_t* idRow_ = nullptr;
+    const int32_t* saoSorted_ = nullptr;
+    const uint32_t* saoRow_ = nullptr;
+};
+
+template<typename Fn>
+size_t GaiaSAOSnapshot::forEachInCone(double ra, double dec, double radiusDeg, Fn&& fn) const {
+    if (!isOpen()) return 0;
+
+    PixelRange ranges[SkyIndex::MAX_COVER_RANGES];
+    size_t numRanges = SkyIndex::coverCone(ra, dec, radiusDeg, ranges, SkyIndex::MAX_COVER_RANGES);
+
+    const auto cap = core::SphericalCap::cone(ra, dec, radiusDeg);
+
+    uint8_t keep[MASK_CHUNK];
+    size_t visited = 0;
+    for (size_t r = 0; r < numRanges; ++r) {
+        size_t begin = pixelStart_[ranges[r].first];
+        size_t end = pixelStart_[ranges[r].last + 1];
+
+        // Verifica esatta a blocchi sui versori delle righe
+        for (size_t chunk = begin; chunk < end; chunk += MASK_CHUNK) {
+            size_t n = std::min(MASK_CHUNK, end - chunk);
+            cap.contains(x_ + chunk, y_ + chunk, z_ + chunk, n, keep);
+            for (size_t i = 0; i < n; ++i) {
+                if (keep[i]) {
+                    fn(chunk + i);
+                    visited++;
+                }
+            }
+        }
+    }
+    return visited;
+}
+
+} // namespace catalog
+} // namespace starmap
+
+#endif // STARMAP_GAIA_SAO_SNAPSHOT_H
@@ -0,0 +1,135 @@
+#ifndef STARMAP_QUERY_CACHE_H
+#define STARMAP_QUERY_CACHE_H
+
+#include "GaiaClient.h"
+#include "starmap/core/StarBlock.h"
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace starmap {
+namespace catalog {
+
+/**
+ * @brief Contatori della cache delle query
+ */
+struct QueryCacheStatistics {
+    size_t hits = 0;              // Richieste servite da un'entry con la stessa chiave
+    size_t containmentHits = 0;   // Richieste servite filtrando un cono più ampio/profondo
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t entries = 0;
+    size_t memoryUsage = 0;       // Byte occupati dai blocchi in cache
+    size_t memoryBudget = 0;
+};
+
+/**
+ * @brief Cache LRU dei risultati delle query a cono
+ *
+ * La chiave è il cono quantizzato (centro, raggio, magnitudine limite) più
+ * i flag di arricchimento SAO e keepBrightest. Una richiesta senza entry
+ * identica può essere servita da un cono in cache che la contiene (centro
+ * vicino, raggio maggiore, magnitudine più debole) filtrando in memoria.
+ * Un cono troncato da maxResults è utilizzabile solo se teneva le stelle
+ * più luminose e il filtro ne lascia abbastanza (vedi lookup()).
+ *
+ * Quando il risultato va ridotto a maxResults, con keepBrightest si
+ * tengono le stelle più luminose, come GaiaClient::queryRegionBlock.
+ *
+ * La memoria occupata dai blocchi è limitata da un budget: le entry meno
+ * usate di recente vengono rimosse finché il totale non rientra.
+ * Thread-safe.
+ */
+class QueryCache {
+public:
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 64 * 1024 * 1024;
+
+    /**
+     * @brief Chiave quantizzata di una query (usata anche per le richieste in corso)
+     */
+    struct Key {
+        int64_t ra;
+        int64_t dec;
+        int64_t radius;
+        int64_t magnitude;
+        bool enriched;
+        bool keepBrightest;   // false se la query non ha limite (il flag non conta)
+
+        bool operator==(const Key& other) const {
+            return ra == other.ra && dec == other.dec && radius == other.radius &&
+                   magnitude == other.magnitude && enriched == other.enriched &&
+                   keepBrightest == other.keepBrightest;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    static Key makeKey(const GaiaQueryParameters& params, bool enriched);
+
+    explicit QueryCache(size_t memoryBudgetBytes = DEFAULT_MEMORY_BUDGET);
+
+    /**
+     * @brief Cerca un risultato utilizzabile per la query
+     *
+     * Un'entry troncata con keepBrightest contiene tutte le stelle del suo
+     * cono più luminose della sua stella più debole: serve un cono interno
+     * se il filtro lascia almeno maxResults stelle o se la magnitudine
+     * limite richiesta è sotto quella soglia.
+     *
+     * @param params Parametri della query
+     * @param enriched true se il chiamante richiede le stelle arricchite con SAO
+     * @return Copia del blocco (già filtrata e troncata) o std::nullopt
+     */
+    std::optional<core::StarBlock> lookup(const GaiaQueryParameters& params, bool enriched);
+
+    /**
+     * @brief Inserisce il risultato di una query
+     *
+     * I blocchi più grandi dell'intero budget non vengono memorizzati.
+     */
+    void insert(const GaiaQueryParameters& params, bool enriched, const core::StarBlock& stars);
+
+    /**
+     * @brief Svuota la cache (i contatori restano)
+     */
+    void clear();
+
+    /**
+     * @brief Imposta il budget di memoria ed esegue subito l'eviction
+     */
+    void setMemoryBudget(size_t bytes);
+
+    QueryCacheStatistics getStatistics() const;
+
+private:
+    struct Entry {
+        Key key;
+        GaiaQueryParameters params;
+        core::StarBlock stars;
+        size_t bytes;
+        bool complete;            // false se il risultato è stato troncato da maxResults
+        float faintestMagnitude;  // Stella più debole del blocco
+    };
+
+    using EntryList = std::list<Entry>;
+
+    static bool contains(const Entry& entry, const GaiaQueryParameters& params, bool enriched);
+    void evictLocked();
+
+    mutable std::mutex mutex_;
+    EntryList entries_;   // Dalla più recente alla meno recente
+    std::unordered_map<Key, EntryList::iterator, KeyHash> index_;
+    size_t memoryBudget_;
+    size_t memoryUsage_ = 0;
+    QueryCacheStatistics stats_;
+};
+
+} // namespace catalog
+} // namespace starmap
+
+#endif // STARMAP_QUERY_CACHE_H
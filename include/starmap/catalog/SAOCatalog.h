@@ -2,19 +2,36 @@
 #define STARMAP_SAO_CATALOG_H
 
 #include "starmap/core/CelestialObject.h"
+#include "starmap/core/StarBlock.h"
 #include "GaiaSAODatabase.h"
+#include "starmap/utils/HttpClient.h"
+#include <map>
 #include <memory>
 #include <string>
 #include <optional>
+#include <vector>
 
 namespace starmap {
 namespace catalog {
 
+/**
+ * @brief Indirizzi dei servizi CDS usati dalle query online
+ */
+struct SAOServiceUrls {
+    std::string vizier = "https://vizier.cds.unistra.fr/viz-bin/votable";
+    std::string simbadTap = "https://simbad.cds.unistra.fr/simbad/sim-tap/sync";
+    std::string xmatch = "https://cdsxmatch.cds.unistra.fr/xmatch/api/v1/sync";
+};
+
 /**
  * @brief Gestione del catalogo SAO (Smithsonian Astrophysical Observatory)
  * 
  * Il catalogo SAO contiene circa 259,000 stelle con magnitudine < 9.
  * Fornisce cross-reference con altri cataloghi e numeri SAO storicamente importanti.
+ *
+ * Le funzioni di ricerca e arricchimento sono thread-safe: il database
+ * locale usa connessioni in prestito dal pool, le query online un handle
+ * CURL per thread o il motore asincrono condiviso (AsyncHttpEngine).
  */
 class SAOCatalog {
 public:
@@ -37,6 +54,10 @@ public:
 
     /**
      * @brief Cerca stella per numero SAO
+     *
+     * Servita dalla tabella in memoria del database locale (vedi
+     * GaiaSAODatabase::getSAONumberIndex()); VizieR viene interrogato solo
+     * con il fallback online abilitato.
      * @param saoNumber Numero SAO
      * @return Stella con dati SAO se trovata
      */
@@ -59,6 +80,30 @@ public:
         const core::EquatorialCoordinates& coords,
         double radiusArcsec = 10.0);
 
+    /**
+     * @brief Versione batch di querySIMBADForSAO()
+     *
+     * Una query ADQL con lista IN ogni 200 Gaia ID; i blocchi partono in
+     * parallelo e ogni risposta (TSV) viene letta una sola volta.
+     * @param gaiaIds ID sorgente GAIA (duplicati e valori <= 0 ignorati)
+     * @return Numero SAO per ogni Gaia ID trovato
+     */
+    std::map<long long, int> querySIMBADForSAO(const std::vector<long long>& gaiaIds);
+
+    /**
+     * @brief Versione batch di crossMatchVizieR()
+     *
+     * Le posizioni vengono caricate come tabella nel servizio X-Match del
+     * CDS e confrontate con il catalogo SAO di VizieR (I/131A), a blocchi
+     * di 10000 righe.
+     * @param coords Coordinate equatoriali
+     * @param radiusArcsec Raggio di ricerca
+     * @return Numero SAO della controparte più vicina, per indice in coords
+     */
+    std::map<size_t, int> crossMatchVizieR(
+        const std::vector<core::EquatorialCoordinates>& coords,
+        double radiusArcsec = 10.0);
+
     /**
      * @brief Arricchisce una stella GAIA con il numero SAO
      * @param star Puntatore a stella da arricchire
@@ -66,6 +111,89 @@ public:
      */
     bool enrichWithSAO(std::shared_ptr<core::Star> star);
 
+    /**
+     * @brief Arricchisce con il numero SAO le stelle di un blocco colonnare
+     *
+     * Usa le ricerche batch del database locale: una query IN per blocchi
+     * di Gaia ID e un unico cross-match posizionale per le stelle restanti.
+     * Con setOnlineFallback(true) le righe non trovate (tutte, senza
+     * database locale) passano a enrichOnline().
+     * @param stars Blocco di stelle da arricchire
+     * @param maxMagnitude Arricchisce solo stelle con magnitudine <= maxMagnitude
+     * @return Numero di stelle che hanno un numero SAO dopo l'arricchimento
+     */
+    size_t enrichWithSAO(core::StarBlock& stars, double maxMagnitude = 99.0);
+
+    /**
+     * @brief Come enrichWithSAO(StarBlock&), ma divide le stelle tra più thread
+     *
+     * Ogni thread prende in prestito una connessione dal pool in sola
+     * lettura del database locale (SQLiteConnectionPool). Con pochi
+     * candidati ricade sul percorso seriale. Il fallback online avviene
+     * dopo i thread, in un solo passaggio per tutte le righe non trovate.
+     * @param stars Blocco di stelle da arricchire
+     * @param maxMagnitude Arricchisce solo stelle con magnitudine <= maxMagnitude
+     * @param numThreads Numero di thread (0 = default OpenMP)
+     * @return Numero di stelle che hanno un numero SAO dopo l'arricchimento
+     */
+    size_t enrichWithSAOParallel(core::StarBlock& stars, double maxMagnitude = 99.0,
+                                 int numThreads = 0);
+
+    /**
+     * @brief Arricchisce con il numero SAO un vettore di stelle (versione batch)
+     * @param stars Stelle da arricchire
+     * @param maxMagnitude Arricchisce solo stelle con magnitudine <= maxMagnitude
+     * @return Numero di stelle che hanno un numero SAO dopo l'arricchimento
+     */
+    size_t enrichWithSAO(std::vector<std::shared_ptr<core::Star>>& stars,
+                         double maxMagnitude = 99.0);
+
+    /**
+     * @brief Abilita le query online (SIMBAD, poi VizieR) per le stelle
+     *        non trovate nel database locale
+     *
+     * Disabilitate di default. Valgono per tutte le versioni di
+     * enrichWithSAO() e per enrichWithSAOParallel(); quelle batch usano
+     * enrichOnline(). Con
+     * LibraryConfig::setHttpCacheDirectory() le risposte restano su disco
+     * e le query ripetute non vanno in rete.
+     */
+    void setOnlineFallback(bool enabled);
+    bool isOnlineFallbackEnabled() const;
+
+    /**
+     * @brief Cerca online (SIMBAD, poi VizieR) i numeri SAO delle stelle che ne sono prive
+     *
+     * Usa le versioni batch di querySIMBADForSAO() e crossMatchVizieR():
+     * poche richieste, in parallelo sul motore HTTP condiviso
+     * (utils::AsyncHttpEngine::shared()), con al più 20 richieste al
+     * secondo verso ciascun servizio CDS. Non richiede setOnlineFallback().
+     * @param stars Stelle da arricchire
+     * @return Numero di stelle a cui è stato assegnato un numero SAO
+     */
+    size_t enrichOnline(std::vector<std::shared_ptr<core::Star>>& stars);
+
+    /**
+     * @brief Come enrichOnline() su vettore, per le righe indicate di un blocco colonnare
+     * @param stars Blocco di stelle da arricchire
+     * @param rows Righe da cercare (quelle che hanno già un numero SAO sono saltate)
+     * @return Numero di righe a cui è stato assegnato un numero SAO
+     */
+    size_t enrichOnline(core::StarBlock& stars, const std::vector<size_t>& rows);
+
+    /**
+     * @brief Indirizzi di VizieR, SIMBAD TAP e X-Match (default: servizi CDS)
+     *
+     * Servono per mirror dei servizi e per i test con un server locale.
+     */
+    void setServiceUrls(const SAOServiceUrls& urls);
+    SAOServiceUrls getServiceUrls() const;
+
+    /**
+     * @brief Client HTTP usato per le query online (ad es. per impostare la cache)
+     */
+    utils::HttpClient& getHttpClient();
+
     /**
      * @brief Verifica se database locale è disponibile
      * @return true se database locale può essere usato
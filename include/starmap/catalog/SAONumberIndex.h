@@ -0,0 +1,99 @@
+#ifndef STARMAP_SAO_NUMBER_INDEX_H
+#define STARMAP_SAO_NUMBER_INDEX_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace starmap {
+namespace catalog {
+
+/**
+ * @brief Tabella densa delle stelle SAO indicizzata per numero SAO
+ *
+ * Un elemento di 32 byte per ogni numero da 0 al massimo presente (il
+ * catalogo arriva a 258997): la ricerca per numero è un accesso diretto
+ * all'array, senza hash né query. I tipi spettrali sono memorizzati una
+ * sola volta e referenziati da un indice a 16 bit.
+ *
+ * Si costruisce con add() e si chiude con finish(); da quel momento è in
+ * sola lettura e può essere condivisa tra thread.
+ */
+class SAONumberIndex {
+public:
+    /**
+     * @brief Dati di una stella SAO
+     */
+    struct Star {
+        double ra;                  // J2000 in gradi (NaN = numero assente)
+        double dec;                 // J2000 in gradi
+        long long gaiaSourceId;     // 0 se non noto
+        float magnitude;
+        uint16_t spectralType;      // Indice in spectralType() (0 = non noto)
+        uint16_t reserved;
+    };
+
+    // Numeri oltre questo valore non sono SAO (evita array enormi da dati errati)
+    static constexpr int MAX_SAO_NUMBER = 1000000;
+
+    SAONumberIndex();
+
+    /**
+     * @brief Aggiunge una stella; per numeri ripetuti vale la più brillante
+     * @return false se il numero non è valido
+     */
+    bool add(int saoNumber, double ra, double dec, double magnitude,
+             long long gaiaSourceId = 0, const std::string& spectralType = "");
+
+    /**
+     * @brief Termina la costruzione e libera la memoria in eccesso
+     */
+    void finish();
+
+    /**
+     * @brief Stella con il numero indicato, nullptr se assente
+     */
+    const Star* find(int saoNumber) const {
+        if (saoNumber <= 0 || static_cast<size_t>(saoNumber) >= stars_.size()) return nullptr;
+        const Star& star = stars_[static_cast<size_t>(saoNumber)];
+        return std::isnan(star.ra) ? nullptr : &star;
+    }
+
+    /**
+     * @brief Tipo spettrale della stella (stringa vuota se non noto)
+     */
+    const std::string& spectralType(const Star& star) const {
+        return spectralTypes_[star.spectralType];
+    }
+
+    /**
+     * @brief Numero di stelle presenti
+     */
+    size_t size() const { return count_; }
+
+    /**
+     * @brief Memoria occupata in byte (array e tipi spettrali)
+     */
+    size_t memoryUsage() const;
+
+    /**
+     * @brief Tempo di caricamento registrato da chi ha costruito l'indice
+     */
+    double loadSeconds() const { return loadSeconds_; }
+    void setLoadSeconds(double seconds) { loadSeconds_ = seconds; }
+
+private:
+    std::vector<Star> stars_;
+    std::vector<std::string> spectralTypes_;
+    std::unordered_map<std::string, uint16_t> spectralTypeIds_;     // Solo in costruzione
+    size_t count_ = 0;
+    double loadSeconds_ = 0.0;
+};
+
+} // namespace catalog
+} // namespace starmap
+
+#endif // STARMAP_SAO_NUMBER_INDEX_H
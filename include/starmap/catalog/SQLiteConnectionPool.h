@@ -0,0 +1,236 @@
+#ifndef STARMAP_SQLITE_CONNECTION_POOL_H
+#define STARMAP_SQLITE_CONNECTION_POOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace starmap {
+namespace catalog {
+
+class SpatialQuery;
+
+/**
+ * @brief Statement preparato in cache, resettato automaticamente a fine uso
+ *
+ * Lo statement resta di proprietà della connessione: il guard si limita a
+ * chiamare sqlite3_reset/sqlite3_clear_bindings per rilasciare i lock di
+ * lettura e renderlo riutilizzabile.
+ */
+class CachedStatement {
+public:
+    explicit CachedStatement(sqlite3_stmt* stmt) : stmt_(stmt) {}
+    ~CachedStatement();
+    CachedStatement(const CachedStatement&) = delete;
+    CachedStatement& operator=(const CachedStatement&) = delete;
+    CachedStatement(CachedStatement&& other) noexcept : stmt_(other.stmt_) { other.stmt_ = nullptr; }
+
+    sqlite3_stmt* get() const { return stmt_; }
+    explicit operator bool() const { return stmt_ != nullptr; }
+
+private:
+    sqlite3_stmt* stmt_;
+};
+
+/**
+ * @brief Contatori del pool di connessioni
+ */
+struct SQLitePoolStatistics {
+    size_t opened = 0;        // Connessioni aperte dall'avvio
+    size_t open = 0;          // Connessioni aperte ora
+    size_t idle = 0;          // Connessioni libere
+    size_t checkouts = 0;     // Richieste servite
+    size_t waits = 0;         // Richieste che hanno atteso una connessione libera
+    size_t maxConnections = 0;
+};
+
+/**
+ * @brief Pool di connessioni SQLite in sola lettura, una per file
+ *
+ * Le connessioni sono aperte con SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX
+ * e configurate con mmap_size e cache_size ampi: ogni connessione è usata
+ * da un solo thread alla volta, quindi il mutex interno di SQLite non
+ * serve. Ogni connessione tiene i propri statement preparati e le proprie
+ * SpatialQuery, che sopravvivono tra un prestito e l'altro.
+ *
+ * forPath() restituisce sempre lo stesso pool per lo stesso file, così
+ * SAOCatalog, GaiaSAODatabase e ChartGenerator non riaprono il database a
+ * ogni carta; i pool restano aperti fino a closeAll() (chiamata da
+ * starmap::finalize()).
+ *
+ * Uso tipico:
+ * @code
+ * auto lease = SQLiteConnectionPool::forPath(path)->acquire();
+ * if (!lease) return;   // database non disponibile
+ * auto stmt = lease->statement("SELECT ...");
+ * @endcode
+ *
+ * Le scritture non passano dal pool: chi modifica il file (ad es.
+ * GaiaSAODatabase::createIndices) chiama invalidate() perché le connessioni
+ * e i dati condivisi vengano ricreati con il nuovo schema.
+ */
+class SQLiteConnectionPool : public std::enable_shared_from_this<SQLiteConnectionPool> {
+public:
+    static constexpr int64_t DEFAULT_MMAP_SIZE = 256LL * 1024 * 1024;
+    static constexpr int DEFAULT_CACHE_SIZE_KB = 16 * 1024;
+
+    /**
+     * @brief Connessione del pool con i suoi statement in cache
+     */
+    class Connection {
+    public:
+        ~Connection();
+        Connection(const Connection&) = delete;
+        Connection& operator=(const Connection&) = delete;
+
+        sqlite3* handle() const { return db_; }
+
+        /**
+         * @brief Statement preparato per sql (preparato alla prima chiamata)
+         */
+        CachedStatement statement(const std::string& sql);
+
+        /**
+         * @brief Query spaziale su una tabella (creata alla prima chiamata)
+         *
+         * Gli argomenti sono quelli del costruttore di SpatialQuery e fanno
+         * da chiave della cache.
+         */
+        SpatialQuery& spatialQuery(const std::string& table,
+                                   const std::string& raColumn,
+                                   const std::string& decColumn,
+                                   const std::string& columns,
+                                   const std::string& condition = "");
+
+    private:
+        friend class SQLiteConnectionPool;
+        Connection(sqlite3* db, uint64_t generation);
+
+        sqlite3* db_;
+        uint64_t generation_;
+        std::unordered_map<std::string, sqlite3_stmt*> statements_;
+        std::unordered_map<std::string, std::unique_ptr<SpatialQuery>> spatialQueries_;
+    };
+
+    /**
+     * @brief Connessione in prestito, restituita al pool alla distruzione
+     */
+    class Lease {
+    public:
+        Lease() = default;
+        ~Lease() { release(); }
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        explicit operator bool() const { return connection_ != nullptr; }
+        Connection* operator->() const { return connection_.get(); }
+        Connection& operator*() const { return *connection_; }
+
+        /**
+         * @brief Restituisce subito la connessione al pool
+         */
+        void release();
+
+    private:
+        friend class SQLiteConnectionPool;
+        Lease(std::shared_ptr<SQLiteConnectionPool> pool, std::unique_ptr<Connection> connection)
+            : pool_(std::move(pool)), connection_(std::move(connection)) {}
+
+        std::shared_ptr<SQLiteConnectionPool> pool_;
+        std::unique_ptr<Connection> connection_;
+    };
+
+    ~SQLiteConnectionPool();
+
+    SQLiteConnectionPool(const SQLiteConnectionPool&) = delete;
+    SQLiteConnectionPool& operator=(const SQLiteConnectionPool&) = delete;
+
+    /**
+     * @brief Pool condiviso per il file indicato (creato alla prima richiesta)
+     */
+    static std::shared_ptr<SQLiteConnectionPool> forPath(const std::string& path);
+
+    /**
+     * @brief Rilascia i pool registrati (le connessioni in prestito restano valide)
+     */
+    static void closeAll();
+
+    /**
+     * @brief Prende una connessione libera, aprendone una nuova se serve
+     *
+     * Se sono già in prestito maxConnections connessioni attende che una
+     * venga restituita.
+     * @return Lease vuoto se il file non esiste o non è un database SQLite
+     */
+    Lease acquire();
+
+    /**
+     * @brief Chiude le connessioni libere e scarta i dati condivisi
+     *
+     * Le connessioni in prestito vengono chiuse al rientro.
+     */
+    void invalidate();
+
+    /**
+     * @brief Dato condiviso tra le connessioni del pool (costruito una volta)
+     *
+     * Serve per strutture derivate dal contenuto del file, come il filtro
+     * dei Gaia ID di GaiaSAODatabase; viene scartato da invalidate().
+     * @param name Nome del dato
+     * @param connection Connessione in prestito usata per costruirlo
+     * @param build Costruisce il dato (nullptr se non disponibile)
+     */
+    template <typename T>
+    std::shared_ptr<const T> shared(const std::string& name, Connection& connection,
+                                    const std::function<std::shared_ptr<T>(Connection&)>& build) {
+        return std::static_pointer_cast<const T>(sharedData(name, connection,
+            [&build](Connection& c) -> std::shared_ptr<const void> { return build(c); }));
+    }
+
+    void setMaxConnections(size_t maxConnections);
+    size_t getMaxConnections() const;
+
+    const std::string& getPath() const { return path_; }
+
+    SQLitePoolStatistics getStatistics() const;
+
+private:
+    explicit SQLiteConnectionPool(const std::string& path);
+
+    std::unique_ptr<Connection> open();
+    void giveBack(std::unique_ptr<Connection> connection);
+    std::shared_ptr<const void> sharedData(
+        const std::string& name, Connection& connection,
+        const std::function<std::shared_ptr<const void>(Connection&)>& build);
+
+    std::string path_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    std::vector<std::unique_ptr<Connection>> idle_;
+    size_t open_ = 0;
+    size_t maxConnections_;
+    uint64_t generation_ = 0;
+    SQLitePoolStatistics stats_;
+
+    std::mutex sharedMutex_;
+    std::unordered_map<std::string, std::shared_ptr<const void>> shared_;
+
+    static std::mutex registryMutex_;
+    static std::unordered_map<std::string, std::shared_ptr<SQLiteConnectionPool>> registry_;
+};
+
+} // namespace catalog
+} // namespace starmap
+
+#endif // STARMAP_SQLITE_CONNECTION_POOL_H
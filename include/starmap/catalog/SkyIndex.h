@@ -0,0 +1,211 @@
+#ifndef STARMAP_SKY_INDEX_H
+#define STARMAP_SKY_INDEX_H
+
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+struct sqlite3;
+struct sqlite3_stmt;
+
+namespace starmap {
+namespace catalog {
+
+/**
+ * @brief Intervallo chiuso di identificativi di pixel [first, last]
+ */
+struct PixelRange {
+    int64_t first;
+    int64_t last;
+};
+
+/**
+ * @brief Box in coordinate equatoriali (gradi), senza attraversamento di 0h
+ */
+struct SkyBox {
+    double raMin;
+    double raMax;
+    double decMin;
+    double decMax;
+};
+
+/**
+ * @brief Pixelizzazione del cielo a zone di declinazione
+ *
+ * Il cielo è diviso in fasce di declinazione da ZONE_HEIGHT gradi, ognuna
+ * divisa in RA_CELLS celle di RA. L'identificativo del pixel è
+ * zona * RA_CELLS + cella, quindi i pixel di una zona sono contigui e un
+ * cono o un box si coprono con al più due intervalli per zona (uno solo
+ * per le zone interamente coperte, come le calotte polari).
+ */
+class SkyIndex {
+public:
+    static constexpr double ZONE_HEIGHT = 0.5;   // gradi
+    static constexpr int NUM_ZONES = 360;        // 180° / ZONE_HEIGHT
+    static constexpr int RA_CELLS = 720;         // 360° / ZONE_HEIGHT
+    static constexpr int64_t NUM_PIXELS = static_cast<int64_t>(NUM_ZONES) * RA_CELLS;
+
+    // Numero massimo di intervalli prodotti da una copertura (2 per zona)
+    static constexpr size_t MAX_COVER_RANGES = 2 * NUM_ZONES;
+
+    /**
+     * @brief Identificativo del pixel che contiene la posizione
+     */
+    static int64_t pixelId(double ra, double dec);
+
+    /**
+     * @brief Intervalli di pixel che coprono un cono
+     * @param ra RA del centro (gradi)
+     * @param dec Dec del centro (gradi)
+     * @param radiusDeg Raggio (gradi)
+     * @return Intervalli ordinati e non sovrapposti
+     */
+    static std::vector<PixelRange> coverCone(double ra, double dec, double radiusDeg);
+
+    /**
+     * @brief Come coverCone, ma scrive in un buffer del chiamante
+     * @param out Buffer di almeno MAX_COVER_RANGES elementi
+     * @return Numero di intervalli scritti
+     */
+    static size_t coverCone(double ra, double dec, double radiusDeg,
+                            PixelRange* out, size_t capacity);
+
+    /**
+     * @brief Intervalli di pixel che coprono un box RA/Dec
+     *
+     * raMin può essere negativo o raMax maggiore di 360 per box a cavallo
+     * di 0h; un'ampiezza >= 360° copre tutte le RA.
+     */
+    static std::vector<PixelRange> coverBox(double raMin, double raMax,
+                                            double decMin, double decMax);
+
+    /**
+     * @brief Box RA/Dec (al più due, divisi a 0h) che contengono un cono
+     *
+     * Usa la semi-ampiezza esatta in RA del cono (asin(sin r / cos dec))
+     * e passa a tutte le RA quando il cono contiene un polo.
+     */
+    static std::vector<SkyBox> coneBoxes(double ra, double dec, double radiusDeg);
+
+    /**
+     * @brief Normalizza un box RA/Dec dividendolo a 0h se necessario
+     */
+    static std::vector<SkyBox> splitBox(double raMin, double raMax,
+                                        double decMin, double decMax);
+
+    /**
+     * @brief Verifica esatta di appartenenza a un cono su array di coordinate
+     * @param ra Array di RA (gradi)
+     * @param dec Array di Dec (gradi)
+     * @param count Numero di posizioni
+     * @param keep Output: 1 se la posizione è entro il raggio, 0 altrimenti
+     */
+    static void withinCone(const double* ra, const double* dec, size_t count,
+                           double centerRa, double centerDec, double radiusDeg,
+                           uint8_t* keep);
+
+    /**
+     * @brief Verifica esatta di appartenenza a un box (con wrap a 0h)
+     */
+    static void withinBox(const double* ra, const double* dec, size_t count,
+                          double raMin, double raMax, double decMin, double decMax,
+                          uint8_t* keep);
+};
+
+/**
+ * @brief Query spaziale su una tabella SQLite con colonne RA/Dec
+ *
+ * Se la tabella ha la colonna sky_pix con il relativo indice (creati da
+ * GaiaSAODatabase::createIndices) la query scorre gli intervalli di pixel
+ * di SkyIndex; altrimenti ricade su box RA/Dec divisi a 0h e allargati
+ * a tutte le RA sulle calotte polari.
+ *
+ * Lo statement seleziona sempre RA e Dec come colonne 0 e 1, seguite dalle
+ * colonne richieste (a partire da FIRST_COLUMN). Gli statement restano
+ * preparati per tutta la vita dell'oggetto.
+ */
+class SpatialQuery {
+public:
+    static constexpr int FIRST_COLUMN = 2;
+
+    using RowCallback = std::function<void(sqlite3_stmt*)>;
+
+    /**
+     * @param db Connessione aperta (non di proprietà)
+     * @param table Nome della tabella
+     * @param raColumn Colonna RA in gradi (o espressione, es. "ra_udeg / 1000000.0")
+     * @param decColumn Colonna Dec in gradi (o espressione)
+     * @param columns Colonne aggiuntive da selezionare (es. "sao, magnitude")
+     * @param condition Condizione SQL aggiuntiva (opzionale)
+     */
+    SpatialQuery(sqlite3* db,
+                 const std::string& table,
+                 const std::string& raColumn,
+                 const std::string& decColumn,
+                 const std::string& columns,
+                 const std::string& condition = "");
+    ~SpatialQuery();
+
+    SpatialQuery(const SpatialQuery&) = delete;
+    SpatialQuery& operator=(const SpatialQuery&) = delete;
+
+    /**
+     * @brief true se la tabella ha l'indice a pixel
+     */
+    bool usesPixelIndex() const { return usePixels_; }
+
+    /**
+     * @brief Righe candidate di un cono
+     *
+     * onRow viene chiamato per ogni riga candidata, nell'ordine di lettura.
+     * @return Maschera esatta (1 = entro il raggio) allineata ai candidati
+     */
+    std::vector<uint8_t> cone(double ra, double dec, double radiusDeg,
+                              const RowCallback& onRow);
+
+    /**
+     * @brief Righe entro un box RA/Dec (raMin > raMax o fuori [0, 360) per il wrap)
+     *
+     * onRow viene chiamato solo per le righe effettivamente nel box.
+     * @return Numero di righe restituite
+     */
+    size_t box(double raMin, double raMax, double decMin, double decMax,
+               const RowCallback& onRow);
+
+    /**
+     * @brief Nome dell'indice a pixel di una tabella
+     */
+    static std::string pixelIndexName(const std::string& table);
+
+    /**
+     * @brief Testo SQL della query preparata dal costruttore
+     * @param pixels true per la variante sull'indice a pixel (sky_pix BETWEEN ? AND ?),
+     *               false per quella sul box RA/Dec
+     */
+    static std::string selectSql(const std::string& table,
+                                 const std::string& raColumn,
+                                 const std::string& decColumn,
+                                 const std::string& columns,
+                                 const std::string& condition,
+                                 bool pixels);
+
+private:
+    size_t scanPixels(const std::vector<PixelRange>& ranges, const RowCallback& onRow);
+    size_t scanBoxes(const std::vector<SkyBox>& boxes, const RowCallback& onRow);
+
+    sqlite3* db_;
+    sqlite3_stmt* pixelStmt_ = nullptr;
+    sqlite3_stmt* boxStmt_ = nullptr;
+    bool usePixels_ = false;
+
+    // Coordinate dei candidati dell'ultima query (per la verifica esatta)
+    std::vector<double> candidateRa_;
+    std::vector<double> candidateDec_;
+};
+
+} // namespace catalog
+} // namespace starmap
+
+#endif // STARMAP_SKY_INDEX_H
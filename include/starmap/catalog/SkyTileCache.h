@@ -0,0 +1,183 @@
+#ifndef STARMAP_SKY_TILE_CACHE_H
+#define STARMAP_SKY_TILE_CACHE_H
+
+#include "starmap/core/StarBlock.h"
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace starmap {
+namespace catalog {
+
+/**
+ * @brief Contatori della cache a tile
+ */
+struct SkyTileCacheStatistics {
+    size_t tileHits = 0;       // Tile lette dal disco
+    size_t tileMisses = 0;     // Tile assenti o non abbastanza profonde
+    size_t tilesWritten = 0;
+    size_t bytesRead = 0;      // Byte compressi letti
+};
+
+/**
+ * @brief Cache persistente su disco dei risultati del catalogo, per tile
+ *
+ * Il cielo è diviso in tile da TILE_SIZE x TILE_SIZE gradi allineate ai
+ * pixel di SkyIndex (ogni tile raggruppa 4 x 4 pixel). Ogni tile è un
+ * file con le stelle ordinate per magnitudine e divise in blocchi da una
+ * magnitudine: ogni blocco è codificato a delta (posizioni relative
+ * all'angolo della tile, source_id e magnitudini rispetto alla riga
+ * precedente) e compresso con zlib. Una query legge solo i blocchi fino
+ * alla magnitudine richiesta.
+ *
+ * Le tile sono scritte in una sottodirectory che dipende dalla versione
+ * del formato e dall'impronta del catalogo: quando il catalogo cambia la
+ * cache viene ricostruita in una nuova sottodirectory. Le sottodirectory
+ * obsolete restano su disco (possono appartenere a un'altra versione
+ * che condivide la directory) finché non si chiama removeObsoleteTiles().
+ *
+ * Le posizioni sono quantizzate a 1e-9 gradi (3.6 µas); gli altri campi
+ * sono conservati senza perdita.
+ */
+class SkyTileCache {
+public:
+    static constexpr double TILE_SIZE = 2.0;   // gradi (4 pixel di SkyIndex)
+    static constexpr int TILE_ZONES = 90;      // 180° / TILE_SIZE
+    static constexpr int TILE_CELLS = 180;     // 360° / TILE_SIZE
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    /**
+     * @brief Legge dal catalogo le stelle di un cono fino a una magnitudine
+     */
+    using Fetcher = std::function<core::StarBlock(double ra, double dec,
+                                                  double radiusDeg, double maxMagnitude)>;
+
+    /**
+     * @brief Riceve una stella di forEachInCone(): riga row del blocco
+     */
+    using Visitor = std::function<void(const core::StarBlock& block, size_t row)>;
+
+    /**
+     * @param directory Directory radice della cache (creata se manca;
+     *                  stringa vuota = cache disabilitata)
+     * @param catalogFingerprint Impronta del catalogo sorgente
+     */
+    SkyTileCache(const std::string& directory, uint64_t catalogFingerprint);
+
+    SkyTileCache(const SkyTileCache&) = delete;
+    SkyTileCache& operator=(const SkyTileCache&) = delete;
+
+    /**
+     * @brief true se la directory della cache è utilizzabile
+     */
+    bool isEnabled() const { return enabled_; }
+
+    /**
+     * @brief Directory delle tile per la versione corrente
+     */
+    const std::string& getTileDirectory() const { return tileDirectory_; }
+
+    /**
+     * @brief Rimuove le sottodirectory di tile diverse da quella corrente
+     *
+     * Sono rimosse solo le directory tiles_v* che contengono il marcatore
+     * scritto da SkyTileCache; da chiamare quando nessun'altra versione o
+     * catalogo usa la stessa directory radice.
+     * @return Numero di sottodirectory rimosse
+     */
+    size_t removeObsoleteTiles();
+
+    /**
+     * @brief Stelle entro un cono, lette dalle tile o dal catalogo
+     *
+     * Le tile mancanti (o lette a una magnitudine inferiore) vengono
+     * richieste a fetch e salvate su disco.
+     * @return Stelle entro il cono con magnitudine <= maxMagnitude, per
+     *         tile e, nella tile, per magnitudine crescente
+     */
+    core::StarBlock queryCone(double ra, double dec, double radiusDeg,
+                              double maxMagnitude, const Fetcher& fetch);
+
+    /**
+     * @brief Come queryCone(), ma senza costruire il blocco del risultato
+     *
+     * Ogni blocco di magnitudine di una tile viene decodificato in un
+     * blocco di lavoro riusato, verificato sul cono dai versori e passato
+     * a visit riga per riga, nello stesso ordine di queryCone(). Il blocco
+     * ricevuto da visit ha i versori ed è valido solo durante la chiamata.
+     * @return Numero di stelle visitate
+     */
+    size_t forEachInCone(double ra, double dec, double radiusDeg, double maxMagnitude,
+                         const Fetcher& fetch, const Visitor& visit);
+
+    /**
+     * @brief Accoda le stelle di una tile fino a maxMagnitude
+     * @return false se la tile manca o non arriva a maxMagnitude
+     */
+    bool readTile(int tileId, double maxMagnitude, core::StarBlock& out);
+
+    /**
+     * @brief Scrive una tile (file temporaneo e rename)
+     * @param depth Magnitudine fino alla quale la tile è completa
+     * @param stars Stelle della tile (ordine qualsiasi)
+     */
+    bool writeTile(int tileId, double depth, const core::StarBlock& stars);
+
+    /**
+     * @brief Tile che contiene la posizione
+     */
+    static int tileId(double ra, double dec);
+
+    /**
+     * @brief Tile che intersecano un cono (ordinate, senza duplicati)
+     */
+    static std::vector<int> coverCone(double ra, double dec, double radiusDeg);
+
+    /**
+     * @brief Cono che contiene interamente una tile
+     */
+    static void tileCone(int tileId, double& ra, double& dec, double& radiusDeg);
+
+    /**
+     * @brief Impronta di file e directory (path, dimensione, data di modifica)
+     *
+     * Le directory sono visitate ricorsivamente; i path inesistenti
+     * contribuiscono solo con il nome.
+     */
+    static uint64_t fingerprint(const std::vector<std::string>& paths);
+
+    SkyTileCacheStatistics getStatistics() const;
+
+private:
+    std::string tilePath(int tileId) const;
+
+    /**
+     * @brief Decodifica in out i blocchi di una tile fino a maxMagnitude
+     *
+     * Dopo ogni blocco chiama onChunk (se presente) con la sua magnitudine
+     * massima. Su errore out torna alla dimensione iniziale.
+     */
+    bool readChunks(int tileId, double maxMagnitude, core::StarBlock& out,
+                    const std::function<void(float chunkMaxMagnitude)>& onChunk);
+
+    /**
+     * @brief Legge una tile dal catalogo e la salva su disco
+     * @return Stelle della tile fino a depth (ordine del catalogo)
+     */
+    core::StarBlock fetchTile(int tileId, double depth, const Fetcher& fetch);
+
+    std::string tileDirectory_;
+    bool enabled_ = false;
+
+    std::atomic<size_t> tileHits_{0};
+    std::atomic<size_t> tileMisses_{0};
+    std::atomic<size_t> tilesWritten_{0};
+    std::atomic<size_t> bytesRead_{0};
+};
+
+} // namespace catalog
+} // namespace starmap
+
+#endif // STARMAP_SKY_TILE_CACHE_H
@@ -0,0 +1,168 @@
+#ifndef STARMAP_VOTABLE_READER_H
+#define STARMAP_VOTABLE_READER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace starmap {
+namespace catalog {
+
+/**
+ * @brief Tipo di memorizzazione di una colonna VOTable
+ */
+enum class VOTableType {
+    Boolean,    // boolean (0/1)
+    Integer,    // bit, unsignedByte, short, int, long scalari
+    Real,       // float, double scalari
+    Text        // char, unicodeChar e array (testo come nel documento)
+};
+
+/**
+ * @brief Descrizione di un campo (<FIELD>) VOTable
+ */
+struct VOTableField {
+    std::string name;
+    std::string id;
+    std::string datatype;
+    std::string arraysize;
+    std::string unit;
+    std::string ucd;
+    std::string nullValue;      // <VALUES null="..."> (vuoto se assente)
+    VOTableType type = VOTableType::Text;
+};
+
+/**
+ * @brief Colonne tipizzate di un blocco di righe VOTable
+ *
+ * Ogni colonna è un buffer contiguo del suo tipo (interi, reali o testo
+ * con offset), più un flag di nullità per riga. Il lettore riusa gli
+ * stessi buffer tra un blocco e il successivo: i consumatori leggono
+ * direttamente dalle colonne senza copie per riga.
+ */
+class VOTableColumns {
+public:
+    const std::vector<VOTableField>& fields() const { return fields_; }
+    size_t columnCount() const { return fields_.size(); }
+    size_t rowCount() const { return rows_; }
+
+    /**
+     * @brief Indice della colonna con il nome (o ID) indicato, -1 se assente
+     */
+    int columnIndex(const std::string& name) const;
+
+    bool isNull(size_t column, size_t row) const;
+
+    /**
+     * @brief Valore intero (colonne Integer e Boolean; Real troncato; Text convertito)
+     */
+    std::optional<long long> getInteger(size_t column, size_t row) const;
+
+    /**
+     * @brief Valore reale (colonne Real e Integer; Text convertito)
+     */
+    std::optional<double> getReal(size_t column, size_t row) const;
+
+    /**
+     * @brief Valore come testo (per le colonne numeriche il valore formattato)
+     */
+    std::string getText(size_t column, size_t row) const;
+
+private:
+    friend class VOTableReader;
+
+    struct Column {
+        std::vector<int64_t> integers;      // Integer, Boolean
+        std::vector<double> reals;          // Real
+        std::vector<uint32_t> offsets;      // Text: inizio di ogni riga in chars (+1)
+        std::string chars;                  // Text
+        std::vector<uint8_t> nulls;
+    };
+
+    void reset(std::vector<VOTableField> fields);
+    void clearRows();
+
+    std::vector<VOTableField> fields_;
+    std::vector<Column> columns_;
+    size_t rows_ = 0;
+};
+
+/**
+ * @brief Lettore VOTable in streaming (parser SAX push di libxml2)
+ *
+ * I byte vengono passati a feed() man mano che arrivano (ad esempio dal
+ * callback di scrittura di curl, vedi utils::HttpRequest::onData): ogni
+ * riga è decodificata subito nelle colonne tipizzate e, ogni blockRows
+ * righe, il blocco viene passato al callback e le colonne svuotate. Il
+ * documento non viene mai tenuto in memoria per intero.
+ *
+ * Supporta le serializzazioni TABLEDATA, BINARY e BINARY2 (base64).
+ * Più tabelle nello stesso documento vengono lette in sequenza: il
+ * callback riceve l'indice della tabella. Un <INFO name="QUERY_STATUS"
+ * value="ERROR"> rende il documento non valido.
+ *
+ * Non thread-safe: un lettore per documento.
+ */
+class VOTableReader {
+public:
+    /**
+     * @param table Indice della tabella (0 = prima del documento)
+     * @param columns Righe del blocco; valide solo durante la chiamata
+     */
+    using RowsCallback = std::function<void(size_t table, const VOTableColumns& columns)>;
+
+    static constexpr size_t DEFAULT_BLOCK_ROWS = 4096;
+
+    /**
+     * @param onRows Callback per ogni blocco di righe (nullptr = le righe
+     *               restano in columns() fino alla fine del documento)
+     * @param blockRows Righe per blocco
+     */
+    explicit VOTableReader(RowsCallback onRows = nullptr, size_t blockRows = DEFAULT_BLOCK_ROWS);
+    ~VOTableReader();
+
+    VOTableReader(const VOTableReader&) = delete;
+    VOTableReader& operator=(const VOTableReader&) = delete;
+
+    /**
+     * @brief Passa al parser il prossimo frammento del documento
+     * @return false se il documento non è valido (vedi getError())
+     */
+    bool feed(const char* data, size_t size);
+
+    /**
+     * @brief Chiude il documento e consegna l'ultimo blocco di righe
+     * @return true se il documento è completo e valido
+     */
+    bool finish();
+
+    /**
+     * @brief Legge un documento già in memoria (feed() + finish())
+     */
+    bool parse(const std::string& document);
+
+    /**
+     * @brief Righe non ancora consegnate (tutte, se manca il callback)
+     */
+    const VOTableColumns& columns() const;
+
+    /**
+     * @brief Righe decodificate in tutto il documento
+     */
+    size_t totalRows() const;
+
+    const std::string& getError() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl_;
+};
+
+} // namespace catalog
+} // namespace starmap
+
+#endif // STARMAP_VOTABLE_READER_H
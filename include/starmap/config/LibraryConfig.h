@@ -3,6 +3,9 @@
 
 #include <string>
 #include <memory>
+#include <atomic>
+#include <mutex>
+#include <shared_mutex>
 
 namespace starmap {
 namespace config {
@@ -12,6 +15,12 @@ namespace config {
  * 
  * Gestisce i path ai database e le configurazioni globali della libreria.
  * Deve essere inizializzata prima dell'uso tramite LibraryConfig::initialize().
+ *
+ * Thread-safe: i path sono tenuti in uno snapshot immutabile sostituito
+ * per intero a ogni modifica (copy-on-write sotto un lock esclusivo). I
+ * getter restituiscono copie, quindi un valore letto resta valido anche
+ * se un altro thread cambia la configurazione; getPaths() fornisce uno
+ * snapshot coerente di tutti i path.
  */
 class LibraryConfig {
 public:
@@ -22,11 +31,15 @@ public:
         std::string gaiaSaoDatabase;
         std::string iauCatalog;
         std::string starNamesDatabase;
+        std::string tileCacheDirectory;   // Cache a tile su disco ("" = disabilitata)
+        std::string httpCacheDirectory;   // Cache delle risposte VizieR/SIMBAD ("" = disabilitata)
         
         CatalogPaths() 
             : gaiaSaoDatabase("gaia_sao_xmatch.db")
             , iauCatalog("data/IAU-CSN.json")
-            , starNamesDatabase("data/common_star_names.csv") {}
+            , starNamesDatabase("data/common_star_names.csv")
+            , tileCacheDirectory("")
+            , httpCacheDirectory("") {}
     };
 
     /**
@@ -50,7 +63,7 @@ public:
     /**
      * @brief Ottieni il path al database Gaia-SAO
      */
-    const std::string& getGaiaSaoDbPath() const;
+    std::string getGaiaSaoDbPath() const;
 
     /**
      * @brief Imposta il path al catalogo IAU
@@ -61,7 +74,7 @@ public:
     /**
      * @brief Ottieni il path al catalogo IAU
      */
-    const std::string& getIauCatalogPath() const;
+    std::string getIauCatalogPath() const;
 
     /**
      * @brief Imposta il path al database nomi stelle
@@ -72,7 +85,39 @@ public:
     /**
      * @brief Ottieni il path al database nomi stelle
      */
-    const std::string& getStarNamesDbPath() const;
+    std::string getStarNamesDbPath() const;
+
+    /**
+     * @brief Imposta la directory della cache a tile del catalogo Gaia
+     * @param path Directory (creata se manca); stringa vuota per disabilitare
+     * 
+     * Vale per la sessione del catalogo Gaia aperta dopo la chiamata
+     * (vedi GaiaCatalogSession).
+     */
+    void setTileCacheDirectory(const std::string& path);
+
+    /**
+     * @brief Ottieni la directory della cache a tile ("" se disabilitata)
+     */
+    std::string getTileCacheDirectory() const;
+
+    /**
+     * @brief Imposta la directory della cache delle risposte HTTP
+     * @param path Directory (creata se manca); stringa vuota per disabilitare
+     * 
+     * Vale per i SAOCatalog creati dopo la chiamata (vedi utils::HttpCache).
+     */
+    void setHttpCacheDirectory(const std::string& path);
+
+    /**
+     * @brief Ottieni la directory della cache HTTP ("" se disabilitata)
+     */
+    std::string getHttpCacheDirectory() const;
+
+    /**
+     * @brief Snapshot immutabile di tutti i path correnti
+     */
+    std::shared_ptr<const CatalogPaths> getPaths() const;
 
     /**
      * @brief Verifica se la libreria è stata inizializzata
@@ -80,15 +125,29 @@ public:
     static bool isInitialized();
 
 private:
-    LibraryConfig() = default;
+    LibraryConfig();
     
     // Non copiabile
     LibraryConfig(const LibraryConfig&) = delete;
     LibraryConfig& operator=(const LibraryConfig&) = delete;
 
-    CatalogPaths paths_;
+    /**
+     * @brief Sostituisce lo snapshot con una copia modificata da update
+     */
+    template <typename Update>
+    void modify(Update update) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        auto paths = std::make_shared<CatalogPaths>(*paths_);
+        update(*paths);
+        paths_ = std::move(paths);
+    }
+
+    mutable std::shared_mutex mutex_;
+    std::shared_ptr<const CatalogPaths> paths_;
+
     static std::unique_ptr<LibraryConfig> instance_;
-    static bool initialized_;
+    static std::once_flag instanceOnce_;
+    static std::atomic<bool> initialized_;
 };
 
 } // namespace config
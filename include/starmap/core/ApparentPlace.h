@@ -0,0 +1,125 @@
+#ifndef STARMAP_APPARENT_PLACE_H
+#define STARMAP_APPARENT_PLACE_H
+
+#include "Coordinates.h"
+#include <array>
+#include <cstddef>
+#include <optional>
+#include <string>
+
+namespace starmap {
+namespace core {
+
+class StarBlock;
+
+/**
+ * @brief Posizioni apparenti di stelle a un'epoca (precessione, nutazione,
+ *        aberrazione annua, deflessione della luce)
+ *
+ * Tutto ciò che dipende solo dall'istante è calcolato una volta nel
+ * costruttore: matrice di precessione IAU 1976 per nutazione IAU 1980
+ * (30 termini principali, ~0.01"), velocità della Terra (v/c) e
+ * direzione Sole -> Terra. Per ogni stella restano poche operazioni sul
+ * versore: deflessione, aberrazione relativistica e un prodotto
+ * matrice 3x3 per vettore, eseguiti a blocchi su colonne x/y/z contigue.
+ *
+ * Le posizioni di ingresso sono nel riferimento J2000/ICRS (il frame bias
+ * di ~20 mas è trascurato) e già propagate all'epoca con il moto proprio
+ * (EpochPropagation). Il tempo UTC è usato come TT: lo scarto di ~70 s
+ * non è apprezzabile alla scala delle carte.
+ */
+class ApparentPlace {
+public:
+    using Matrix3 = std::array<std::array<double, 3>, 3>;
+    using Vector3 = std::array<double, 3>;
+
+    // Righe per blocco di versori (buffer sullo stack)
+    static constexpr size_t CHUNK_ROWS = 1024;
+
+    // Sotto questa soglia il lavoro resta su un solo thread
+    static constexpr size_t PARALLEL_MIN_ROWS = 65536;
+
+    /**
+     * @param jd Data giuliana (TT) dell'osservazione
+     */
+    explicit ApparentPlace(double jd);
+
+    /**
+     * @brief Motore per un istante ISO 8601 (vedi EpochPropagation::parseEpoch)
+     * @return std::nullopt se l'istante non è valido
+     */
+    static std::optional<ApparentPlace> at(const std::string& isoTime);
+
+    double julianDate() const { return jd_; }
+
+    /**
+     * @brief Epoca giuliana (anni) dell'osservazione
+     */
+    double epoch() const;
+
+    // Matrici di rotazione (J2000 medio -> medio di data -> vero di data)
+    const Matrix3& precession() const { return precession_; }
+    const Matrix3& nutation() const { return nutation_; }
+    const Matrix3& matrix() const { return matrix_; }
+
+    // Nutazione in longitudine e obliquità, obliquità vera (arcsec)
+    double nutationLongitude() const { return deltaPsi_; }
+    double nutationObliquity() const { return deltaEpsilon_; }
+    double trueObliquity() const { return trueObliquity_; }
+
+    /**
+     * @brief Velocità baricentrica approssimata della Terra in unità di c
+     *        (equatoriale J2000)
+     */
+    const Vector3& earthVelocity() const { return velocity_; }
+
+    /**
+     * @brief Posizione apparente di un singolo punto
+     */
+    EquatorialCoordinates apply(const EquatorialCoordinates& position) const;
+
+    /**
+     * @brief Posizioni apparenti in place su versori (riferimento J2000 in
+     *        ingresso, vero di data in uscita)
+     */
+    void apply(double* x, double* y, double* z, size_t count) const;
+
+    /**
+     * @brief Posizioni apparenti in place su colonne RA/Dec (gradi)
+     */
+    void apply(double* ra, double* dec, size_t count) const;
+
+    /**
+     * @brief Posizioni apparenti di tutte le righe di un blocco
+     */
+    void apply(StarBlock& stars) const;
+
+    // Conversioni batch RA/Dec (gradi) <-> versori
+    static void toUnitVectors(const double* ra, const double* dec, size_t count,
+                              double* x, double* y, double* z);
+    static void fromUnitVectors(const double* x, const double* y, const double* z,
+                                size_t count, double* ra, double* dec);
+
+private:
+    void deflect(double* x, double* y, double* z, size_t count) const;
+    void aberrate(double* x, double* y, double* z, size_t count) const;
+    void rotate(double* x, double* y, double* z, size_t count) const;
+
+    double jd_;
+    Matrix3 precession_;
+    Matrix3 nutation_;
+    Matrix3 matrix_;
+    double deltaPsi_ = 0.0;
+    double deltaEpsilon_ = 0.0;
+    double trueObliquity_ = 0.0;
+
+    Vector3 velocity_;          // v/c
+    double inverseLorentz_;     // sqrt(1 - v²/c²)
+    Vector3 sunToEarth_;        // versore
+    double deflection_;         // 2GM/(c² r), r = distanza Sole-Terra
+};
+
+} // namespace core
+} // namespace starmap
+
+#endif // STARMAP_APPARENT_PLACE_H
@@ -0,0 +1,87 @@
+#ifndef STARMAP_BRIGHTEST_SELECTOR_H
+#define STARMAP_BRIGHTEST_SELECTOR_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace starmap {
+namespace core {
+
+/**
+ * @brief Selezione in streaming delle K stelle più luminose
+ *
+ * Le righe vengono offerte una alla volta con magnitudine e indice; un
+ * max-heap di K elementi tiene le più luminose viste finora, quindi la
+ * memoria è O(K) indipendentemente dal numero di righe. A parità di
+ * magnitudine vince la riga offerta prima.
+ *
+ * Uso tipico: offrire tutte le righe di una sorgente, poi materializzare
+ * solo le righe di indices().
+ */
+class BrightestSelector {
+public:
+    /**
+     * @param k Numero massimo di righe da tenere
+     */
+    explicit BrightestSelector(size_t k) : k_(k) {
+        heap_.reserve(std::min<size_t>(k, 1 << 20));
+    }
+
+    /**
+     * @brief true se una riga con questa magnitudine verrebbe tenuta
+     */
+    bool accepts(float magnitude) const {
+        return heap_.size() < k_ || magnitude < heap_.front().first;
+    }
+
+    /**
+     * @brief Offre una riga
+     */
+    void offer(float magnitude, uint32_t index) {
+        if (heap_.size() < k_) {
+            heap_.emplace_back(magnitude, index);
+            std::push_heap(heap_.begin(), heap_.end(), Compare());
+        } else if (k_ > 0 && magnitude < heap_.front().first) {
+            std::pop_heap(heap_.begin(), heap_.end(), Compare());
+            heap_.back() = Entry(magnitude, index);
+            std::push_heap(heap_.begin(), heap_.end(), Compare());
+        }
+    }
+
+    /**
+     * @brief Numero di righe tenute finora
+     */
+    size_t size() const { return heap_.size(); }
+
+    /**
+     * @brief Indici delle righe tenute, nell'ordine in cui sono state offerte
+     */
+    std::vector<uint32_t> indices() const {
+        std::vector<uint32_t> result;
+        result.reserve(heap_.size());
+        for (const auto& entry : heap_) result.push_back(entry.second);
+        std::sort(result.begin(), result.end());
+        return result;
+    }
+
+private:
+    using Entry = std::pair<float, uint32_t>;
+
+    // In cima la riga "peggiore": più debole e, a pari magnitudine, offerta dopo
+    struct Compare {
+        bool operator()(const Entry& a, const Entry& b) const {
+            return a.first < b.first || (a.first == b.first && a.second < b.second);
+        }
+    };
+
+    size_t k_;
+    std::vector<Entry> heap_;
+};
+
+} // namespace core
+} // namespace starmap
+
+#endif // STARMAP_BRIGHTEST_SELECTOR_H
@@ -29,7 +29,8 @@ class CelestialObject {
 public:
     CelestialObject() 
         : type_(ObjectType::UNKNOWN), magnitude_(99.0), 
-          gaiaId_(0), saoNumber_(0) {}
+          gaiaId_(0), saoNumber_(0),
+          parallax_(0.0), pmRA_(0.0), pmDec_(0.0) {}
     
     virtual ~CelestialObject() = default;
 
@@ -107,7 +108,7 @@ protected:
  */
 class Star : public CelestialObject {
 public:
-    Star() { type_ = ObjectType::STAR; }
+    Star() : colorIndex_(0.0) { type_ = ObjectType::STAR; }
     
     // Colore B-V, B-R, ecc.
     std::optional<double> getColorIndex() const {
@@ -0,0 +1,85 @@
+#ifndef STARMAP_EPOCH_PROPAGATION_H
+#define STARMAP_EPOCH_PROPAGATION_H
+
+#include <cstddef>
+#include <optional>
+#include <string>
+
+namespace starmap {
+namespace core {
+
+class StarBlock;
+
+/**
+ * @brief Propagazione del moto proprio all'epoca di osservazione
+ *
+ * Le posizioni Gaia DR3 sono all'epoca J2016.0; per le carte di dettaglio
+ * delle occultazioni (scala di secondi d'arco) vanno riportate all'istante
+ * dell'evento. Il modello è lineare sulla sfera:
+ *
+ *   dec' = dec + pmDec * t
+ *   ra'  = ra  + pmRA* * t / cos(dec)
+ *
+ * con pmRA* = pmRA cos(dec) come nei cataloghi Gaia. Su qualche decina
+ * di anni l'errore rispetto alla propagazione rigorosa è sotto il mas,
+ * tranne a pochi secondi d'arco dai poli.
+ *
+ * Il kernel lavora su colonne contigue (StarBlock) senza diramazioni per
+ * riga: le stelle senza moto proprio hanno pm = 0 e restano ferme. Sopra
+ * PARALLEL_MIN_ROWS righe il lavoro è diviso tra i thread OpenMP.
+ */
+class EpochPropagation {
+public:
+    static constexpr double GAIA_DR3_EPOCH = 2016.0;     // anno giuliano
+    static constexpr double J2000_JD = 2451545.0;
+    static constexpr double JULIAN_YEAR_DAYS = 365.25;
+
+    // Sotto questa soglia il costo di avvio dei thread supera il guadagno
+    static constexpr size_t PARALLEL_MIN_ROWS = 65536;
+
+    /**
+     * @brief Data giuliana di una data di calendario gregoriano (UTC)
+     * @param hours Ora del giorno in ore decimali
+     */
+    static double julianDate(int year, int month, int day, double hours = 0.0);
+
+    /**
+     * @brief Epoca giuliana (anni, es. 2025.95) di una data giuliana
+     */
+    static double julianEpoch(double jd) {
+        return 2000.0 + (jd - J2000_JD) / JULIAN_YEAR_DAYS;
+    }
+
+    /**
+     * @brief Epoca giuliana di un istante ISO 8601
+     *
+     * Formati accettati: "2025-12-15", "2025-12-15T22:34",
+     * "2025-12-15T22:34:12.5Z", "2025-12-15 22:34:12+01:00".
+     * @return std::nullopt se la stringa non è valida
+     */
+    static std::optional<double> parseEpoch(const std::string& isoTime);
+
+    /**
+     * @brief Propaga in place count posizioni di years anni
+     * @param ra RA (gradi), riportata in [0, 360)
+     * @param dec Dec (gradi)
+     * @param pmRA Moto proprio in RA, pmRA* = pmRA cos(dec) (mas/anno)
+     * @param pmDec Moto proprio in Dec (mas/anno)
+     * @param years Intervallo di tempo (epoca finale - epoca iniziale)
+     */
+    static void propagate(double* ra, double* dec,
+                          const float* pmRA, const float* pmDec,
+                          size_t count, double years);
+
+    /**
+     * @brief Propaga tutte le righe di un blocco all'epoca targetEpoch
+     * @param sourceEpoch Epoca delle posizioni del blocco (Gaia DR3)
+     */
+    static void propagate(StarBlock& stars, double targetEpoch,
+                          double sourceEpoch = GAIA_DR3_EPOCH);
+};
+
+} // namespace core
+} // namespace starmap
+
+#endif // STARMAP_EPOCH_PROPAGATION_H
@@ -0,0 +1,225 @@
+#ifndef STARMAP_STAR_BLOCK_H
+#define STARMAP_STAR_BLOCK_H
+
+#include "CelestialObject.h"
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace starmap {
+namespace core {
+
+/**
+ * @brief Bit dei campi opzionali di una riga di StarBlock
+ */
+enum StarField : uint8_t {
+    FIELD_COLOR         = 1 << 0,  // Indice di colore presente
+    FIELD_PARALLAX      = 1 << 1,  // Parallasse presente
+    FIELD_PROPER_MOTION = 1 << 2,  // Moto proprio presente
+    FIELD_SAO           = 1 << 3,  // Numero SAO presente
+    FIELD_NAME          = 1 << 4   // Nome/designazione presente
+};
+
+/**
+ * @brief Contenitore colonnare (structure-of-arrays) di stelle
+ *
+ * Sostituisce std::vector<std::shared_ptr<Star>> nel percorso
+ * catalogo -> rendering: ogni campo è una colonna contigua, quindi una
+ * query da decine di migliaia di stelle costa poche allocazioni invece
+ * di una per stella, e i loop di proiezione/rendering scorrono memoria
+ * sequenziale.
+ *
+ * I campi opzionali sono indicati dal bitmask per riga (StarField).
+ * I nomi sono rari e vengono tenuti in un pool separato.
+ *
+ * Il blocco può tenere in cache i versori di direzione (colonne x/y/z,
+ * vedi computeUnitVectors) per i filtri a prodotto scalare.
+ *
+ * Per il codice che usa ancora l'API ad oggetti sono disponibili gli
+ * adattatori toStar()/toStars() e fromStars().
+ */
+class StarBlock {
+public:
+    StarBlock() = default;
+
+    // Dimensioni
+    size_t size() const { return ra_.size(); }
+    bool empty() const { return ra_.empty(); }
+    void reserve(size_t n);
+    void clear();
+
+    /**
+     * @brief Aggiunge una stella con i soli campi obbligatori
+     * @return Indice della nuova riga
+     */
+    size_t append(double ra, double dec, double magnitude, long long gaiaId = 0);
+
+    /**
+     * @brief Aggiunge una stella da oggetto Star (adattatore)
+     */
+    size_t append(const Star& star);
+
+    /**
+     * @brief Copia la riga index di un altro blocco in coda a questo
+     */
+    size_t appendRow(const StarBlock& other, size_t index);
+
+    /**
+     * @brief Accoda tutte le righe di un altro blocco
+     */
+    void appendBlock(const StarBlock& other);
+
+    // Setter campi opzionali
+    void setColorIndex(size_t i, double colorIndex) {
+        color_[i] = static_cast<float>(colorIndex);
+        flags_[i] |= FIELD_COLOR;
+    }
+    void setParallax(size_t i, double parallax) {
+        parallax_[i] = static_cast<float>(parallax);
+        flags_[i] |= FIELD_PARALLAX;
+    }
+    void setProperMotion(size_t i, double pmRA, double pmDec) {
+        pmRA_[i] = static_cast<float>(pmRA);
+        pmDec_[i] = static_cast<float>(pmDec);
+        flags_[i] |= FIELD_PROPER_MOTION;
+    }
+    void setSAONumber(size_t i, int sao) {
+        sao_[i] = sao;
+        if (sao > 0) flags_[i] |= FIELD_SAO;
+        else flags_[i] &= static_cast<uint8_t>(~FIELD_SAO);
+    }
+    void setGaiaId(size_t i, long long id) { gaiaId_[i] = id; }
+    void setName(size_t i, const std::string& name);
+
+    // Getter per riga
+    double getRightAscension(size_t i) const { return ra_[i]; }
+    double getDeclination(size_t i) const { return dec_[i]; }
+    EquatorialCoordinates getCoordinates(size_t i) const {
+        return EquatorialCoordinates(ra_[i], dec_[i]);
+    }
+    double getMagnitude(size_t i) const { return mag_[i]; }
+    long long getGaiaId(size_t i) const { return gaiaId_[i]; }
+    bool has(size_t i, StarField field) const { return (flags_[i] & field) != 0; }
+
+    std::optional<double> getColorIndex(size_t i) const {
+        return has(i, FIELD_COLOR) ? std::optional<double>(color_[i]) : std::nullopt;
+    }
+    std::optional<double> getParallax(size_t i) const {
+        return has(i, FIELD_PARALLAX) ? std::optional<double>(parallax_[i]) : std::nullopt;
+    }
+    std::optional<double> getProperMotionRA(size_t i) const {
+        return has(i, FIELD_PROPER_MOTION) ? std::optional<double>(pmRA_[i]) : std::nullopt;
+    }
+    std::optional<double> getProperMotionDec(size_t i) const {
+        return has(i, FIELD_PROPER_MOTION) ? std::optional<double>(pmDec_[i]) : std::nullopt;
+    }
+    std::optional<int> getSAONumber(size_t i) const {
+        return has(i, FIELD_SAO) ? std::optional<int>(sao_[i]) : std::nullopt;
+    }
+    const std::string& getName(size_t i) const;
+
+    // Accesso diretto alle colonne (per kernel batch)
+    const std::vector<double>& raColumn() const { return ra_; }
+    const std::vector<double>& decColumn() const { return dec_; }
+    const std::vector<float>& magnitudeColumn() const { return mag_; }
+    const std::vector<float>& colorColumn() const { return color_; }
+    const std::vector<float>& pmRAColumn() const { return pmRA_; }
+    const std::vector<float>& pmDecColumn() const { return pmDec_; }
+    const std::vector<float>& parallaxColumn() const { return parallax_; }
+    const std::vector<long long>& gaiaIdColumn() const { return gaiaId_; }
+    const std::vector<int>& saoColumn() const { return sao_; }
+    const std::vector<uint8_t>& flagsColumn() const { return flags_; }
+
+    // L'accesso in scrittura a RA/Dec invalida i versori
+    std::vector<double>& raColumn() { hasUnitVectors_ = false; return ra_; }
+    std::vector<double>& decColumn() { hasUnitVectors_ = false; return dec_; }
+
+    /**
+     * @brief Calcola i versori di direzione di tutte le righe
+     *
+     * Da quel momento append, appendRow, retain e truncate li mantengono
+     * allineati alle righe; l'accesso non const a raColumn()/decColumn()
+     * li invalida.
+     */
+    void computeUnitVectors();
+
+    /**
+     * @brief true se le colonne x/y/z sono valide
+     */
+    bool hasUnitVectors() const { return hasUnitVectors_; }
+
+    // Versori (significativi solo se hasUnitVectors())
+    const std::vector<double>& xColumn() const { return x_; }
+    const std::vector<double>& yColumn() const { return y_; }
+    const std::vector<double>& zColumn() const { return z_; }
+
+    /**
+     * @brief Mantiene solo le righe con keep[i] != 0 (compattazione stabile)
+     */
+    void retain(const std::vector<uint8_t>& keep);
+
+    /**
+     * @brief Tronca il blocco alle prime n righe
+     */
+    void truncate(size_t n);
+
+    /**
+     * @brief Indici delle righe ordinati per magnitudine
+     * @param faintFirst Se true, le stelle più deboli vengono prima
+     *                   (ordine di disegno: le luminose restano sopra)
+     */
+    std::vector<uint32_t> sortedByMagnitude(bool faintFirst = false) const;
+
+    /**
+     * @brief Memoria occupata dalle colonne (byte, stima)
+     */
+    size_t memoryUsage() const;
+
+    // ========== Adattatori verso l'API ad oggetti ==========
+
+    /**
+     * @brief Crea un oggetto Star per la riga i
+     */
+    std::shared_ptr<Star> toStar(size_t i) const;
+
+    /**
+     * @brief Converte l'intero blocco in vettore di Star
+     */
+    std::vector<std::shared_ptr<Star>> toStars() const;
+
+    /**
+     * @brief Costruisce un blocco da un vettore di Star
+     */
+    static StarBlock fromStars(const std::vector<std::shared_ptr<Star>>& stars);
+
+private:
+    // Accoda una riga a tutte le colonne tranne i versori
+    size_t appendColumns(double ra, double dec, double magnitude, long long gaiaId);
+
+    std::vector<double> ra_;          // gradi
+    std::vector<double> dec_;         // gradi
+    std::vector<float> mag_;          // magnitudine G
+    std::vector<float> color_;        // BP-RP / B-V
+    std::vector<float> pmRA_;         // mas/yr
+    std::vector<float> pmDec_;        // mas/yr
+    std::vector<float> parallax_;     // mas
+    std::vector<long long> gaiaId_;   // source_id Gaia DR3 (0 se assente)
+    std::vector<int> sao_;            // numero SAO (0 se assente)
+    std::vector<uint8_t> flags_;      // bitmask StarField
+    std::vector<uint32_t> nameRef_;   // 0 = nessun nome, altrimenti indice+1 in names_
+    std::vector<std::string> names_;  // pool dei nomi
+
+    // Versori di direzione in cache (vedi computeUnitVectors)
+    std::vector<double> x_;
+    std::vector<double> y_;
+    std::vector<double> z_;
+    bool hasUnitVectors_ = false;
+};
+
+} // namespace core
+} // namespace starmap
+
+#endif // STARMAP_STAR_BLOCK_H
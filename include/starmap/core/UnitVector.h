@@ -0,0 +1,118 @@
+#ifndef STARMAP_UNIT_VECTOR_H
+#define STARMAP_UNIT_VECTOR_H
+
+#include "Coordinates.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace starmap {
+namespace core {
+
+/**
+ * @brief Versore di direzione sulla sfera celeste
+ *
+ * x verso RA 0h, z verso il polo nord. Con i versori già calcolati
+ * (StarBlock::computeUnitVectors) appartenenza a un cono, soglie di
+ * separazione e culling del campo si riducono a prodotti scalari, senza
+ * trigonometria per stella.
+ */
+struct UnitVector {
+    double x = 1.0;
+    double y = 0.0;
+    double z = 0.0;
+
+    static UnitVector fromRaDec(double raDeg, double decDeg);
+    static UnitVector fromEquatorial(const EquatorialCoordinates& coords) {
+        return fromRaDec(coords.getRightAscension(), coords.getDeclination());
+    }
+
+    double dot(const UnitVector& other) const {
+        return x * other.x + y * other.y + z * other.z;
+    }
+
+    /**
+     * @brief Quadrato della corda |a - b|
+     *
+     * Crescente con la separazione e, a differenza del prodotto scalare,
+     * preciso anche per stelle a meno di un mas: è il confronto da usare
+     * per scegliere la più vicina tra candidati molto stretti.
+     */
+    double chordSquared(const UnitVector& other) const {
+        double dx = x - other.x, dy = y - other.y, dz = z - other.z;
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    /**
+     * @brief RA in [0, 360) e Dec (gradi)
+     */
+    EquatorialCoordinates toEquatorial() const;
+
+    // Conversioni batch RA/Dec (gradi) <-> versori, corpo vettorizzabile
+    static void fromRaDec(const double* ra, const double* dec, size_t count,
+                          double* x, double* y, double* z);
+    static void toRaDec(const double* x, const double* y, const double* z,
+                        size_t count, double* ra, double* dec);
+};
+
+/**
+ * @brief Separazione angolare (gradi) tra due versori
+ *
+ * Dalla corda (2 asin(|a - b| / 2), oltre 90° dalla corda verso -b):
+ * a differenza di acos(a·b) resta precisa anche per separazioni sotto
+ * il mas e vicino agli antipodi.
+ */
+double angularSeparation(const UnitVector& a, const UnitVector& b);
+
+/**
+ * @brief Quadrato della corda corrispondente a una separazione (gradi)
+ */
+double chordSquaredForSeparation(double degrees);
+
+/**
+ * @brief Separazioni (gradi) da un versore verso colonne x/y/z
+ */
+void angularSeparations(const UnitVector& from, const double* x, const double* y,
+                        const double* z, size_t count, double* degrees);
+
+/**
+ * @brief Calotta sferica: i punti entro un raggio da un asse
+ *
+ * L'appartenenza è a·v >= cos(raggio), con il coseno calcolato una volta.
+ */
+class SphericalCap {
+public:
+    SphericalCap(const UnitVector& axis, double radiusDeg);
+
+    /**
+     * @brief Calotta di un cono in coordinate equatoriali (gradi)
+     */
+    static SphericalCap cone(double raDeg, double decDeg, double radiusDeg);
+
+    const UnitVector& axis() const { return axis_; }
+    double radius() const { return radiusDeg_; }
+    double cosRadius() const { return cosRadius_; }
+
+    bool contains(const UnitVector& v) const { return axis_.dot(v) >= cosRadius_; }
+
+    /**
+     * @brief Appartenenza su colonne di versori
+     * @param keep Output: 1 se entro la calotta, 0 altrimenti
+     */
+    void contains(const double* x, const double* y, const double* z, size_t count,
+                  uint8_t* keep) const;
+
+    /**
+     * @brief true se le due calotte hanno punti in comune
+     */
+    bool intersects(const SphericalCap& other) const;
+
+private:
+    UnitVector axis_;
+    double radiusDeg_;
+    double cosRadius_;
+};
+
+} // namespace core
+} // namespace starmap
+
+#endif // STARMAP_UNIT_VECTOR_H
@@ -7,6 +7,7 @@
 
 #include "starmap/core/Coordinates.h"
 #include "starmap/core/CelestialObject.h"
+#include "starmap/core/StarBlock.h"
 #include <string>
 #include <vector>
 #include <memory>
@@ -268,8 +269,8 @@ private:
     std::string lastError_;
     std::string outputPath_;
     
-    // Stelle caricate
-    std::vector<std::shared_ptr<core::Star>> stars_;
+    // Stelle caricate (colonnare)
+    core::StarBlock stars_;
     
     // Metodi interni
     bool loadStars();
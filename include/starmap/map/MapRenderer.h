@@ -5,6 +5,7 @@
 #include "Projection.h"
 #include "GridRenderer.h"
 #include "starmap/core/CelestialObject.h"
+#include "starmap/core/StarBlock.h"
 #include <vector>
 #include <memory>
 #include <string>
@@ -45,6 +46,17 @@ public:
      * @return Buffer immagine
      */
     ImageBuffer render(const std::vector<std::shared_ptr<core::Star>>& stars);
+
+    /**
+     * @brief Renderizza una mappa completa da un blocco colonnare
+     *
+     * Se la configurazione ha un istante di osservazione
+     * (useObservationTime), le posizioni vengono prima propagate dal
+     * moto proprio a quell'epoca (EpochPropagation).
+     * @param stars Blocco di stelle da renderizzare (epoca J2016.0)
+     * @return Buffer immagine
+     */
+    ImageBuffer render(const core::StarBlock& stars);
     
     /**
      * @brief Renderizza stelle su un buffer esistente in batch
@@ -57,6 +69,16 @@ public:
                            const std::vector<std::shared_ptr<core::Star>>& stars,
                            int batchSize = 0);
 
+    /**
+     * @brief Renderizza in batch le stelle di un blocco colonnare
+     * @param buffer Buffer su cui disegnare
+     * @param stars Blocco di stelle da renderizzare
+     * @param batchSize Numero di stelle per batch (default da config)
+     */
+    void renderStarsBatched(ImageBuffer& buffer,
+                           const core::StarBlock& stars,
+                           int batchSize = 0);
+
     /**
      * @brief Renderizza solo lo sfondo e la griglia
      */
@@ -78,13 +100,15 @@ private:
     std::unique_ptr<GridRenderer> gridRenderer_;
     
     // Helper per rendering
+    ImageBuffer renderStars(const core::StarBlock& stars);
     void drawBackground(ImageBuffer& buffer);
     void drawGrid(ImageBuffer& buffer);
     void drawStars(ImageBuffer& buffer, 
-                   const std::vector<std::shared_ptr<core::Star>>& stars);
+                   const core::StarBlock& stars,
+                   size_t begin, size_t end);
     void drawStar(ImageBuffer& buffer, 
                   const core::CartesianCoordinates& pos,
-                  const core::Star& star);
+                  const core::StarBlock& stars, size_t index);
     void drawLine(ImageBuffer& buffer, 
                   const MapLine& line);
     void drawLabel(ImageBuffer& buffer, 
@@ -107,7 +131,7 @@ private:
     float calculateStarSize(double magnitude) const;
     
     // Calcola colore stella basato su indice colore o tipo spettrale
-    uint32_t calculateStarColor(const core::Star& star) const;
+    uint32_t calculateStarColor(const core::StarBlock& stars, size_t index) const;
     
     // Antialiasing per cerchi
     void drawCircleAA(ImageBuffer& buffer, int cx, int cy, 
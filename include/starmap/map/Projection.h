@@ -3,6 +3,9 @@
 
 #include "starmap/core/Coordinates.h"
 #include "MapConfiguration.h"
+#include "ProjectionKernels.h"
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 
 namespace starmap {
@@ -36,6 +39,34 @@ public:
      */
     virtual bool isVisible(const core::EquatorialCoordinates& celestial) const = 0;
 
+    /**
+     * @brief Proietta un blocco di punti da colonne RA/Dec contigue
+     *
+     * Equivale a isVisible() + project() per ogni punto, in un solo
+     * passaggio: la trigonometria del centro è calcolata una volta e la
+     * visibilità viene dalla stessa proiezione. Le proiezioni standard
+     * hanno kernel senza diramazioni, vettorizzabili (AVX2/NEON); questa
+     * implementazione di base ricade sul percorso per punto.
+     * @param ra RA (gradi)
+     * @param dec Dec (gradi)
+     * @param x Coordinata x normalizzata (come project(); significativa
+     *          solo per i punti visibili)
+     * @param y Coordinata y normalizzata
+     * @param visible 1 se il punto è visibile (come isVisible()), altrimenti 0
+     */
+    virtual void projectBatch(const double* ra, const double* dec, size_t count,
+                              float* x, float* y, uint8_t* visible) const;
+
+    /**
+     * @brief Come projectBatch, dai versori di direzione (core::UnitVector)
+     *
+     * Con i versori già calcolati (StarBlock::computeUnitVectors) le
+     * proiezioni standard non usano funzioni trigonometriche: proiezione
+     * e visibilità sono prodotti scalari con la terna del centro.
+     */
+    virtual void projectUnitVectors(const double* vx, const double* vy, const double* vz,
+                                    size_t count, float* x, float* y, uint8_t* visible) const;
+
     /**
      * @brief Imposta il centro della proiezione
      */
@@ -75,11 +106,23 @@ public:
     
     bool isVisible(const core::EquatorialCoordinates& celestial) const override;
     
+    void projectBatch(const double* ra, const double* dec, size_t count,
+                      float* x, float* y, uint8_t* visible) const override;
+    void projectUnitVectors(const double* vx, const double* vy, const double* vz,
+                            size_t count, float* x, float* y, uint8_t* visible) const override;
+    
     void setCenter(const core::EquatorialCoordinates& center) override;
     void setFieldOfView(double widthDeg, double heightDeg) override;
+    
+    /**
+     * @brief Parametri correnti per il kernel inline (vedi ProjectionKernels.h)
+     */
+    kernels::Stereographic kernel() const;
 
 private:
     core::EquatorialCoordinates center_;
+    double sinDec0_;    // Trigonometria del centro, aggiornata da setCenter()
+    double cosDec0_;
     double fovWidth_;
     double fovHeight_;
     double scale_;
@@ -101,11 +144,23 @@ public:
     
     bool isVisible(const core::EquatorialCoordinates& celestial) const override;
     
+    void projectBatch(const double* ra, const double* dec, size_t count,
+                      float* x, float* y, uint8_t* visible) const override;
+    void projectUnitVectors(const double* vx, const double* vy, const double* vz,
+                            size_t count, float* x, float* y, uint8_t* visible) const override;
+    
     void setCenter(const core::EquatorialCoordinates& center) override;
     void setFieldOfView(double widthDeg, double heightDeg) override;
+    
+    /**
+     * @brief Parametri correnti per il kernel inline (vedi ProjectionKernels.h)
+     */
+    kernels::Gnomonic kernel() const;
 
 private:
     core::EquatorialCoordinates center_;
+    double sinDec0_;    // Trigonometria del centro, aggiornata da setCenter()
+    double cosDec0_;
     double fovWidth_;
     double fovHeight_;
 };
@@ -126,11 +181,23 @@ public:
     
     bool isVisible(const core::EquatorialCoordinates& celestial) const override;
     
+    void projectBatch(const double* ra, const double* dec, size_t count,
+                      float* x, float* y, uint8_t* visible) const override;
+    void projectUnitVectors(const double* vx, const double* vy, const double* vz,
+                            size_t count, float* x, float* y, uint8_t* visible) const override;
+    
     void setCenter(const core::EquatorialCoordinates& center) override;
     void setFieldOfView(double widthDeg, double heightDeg) override;
+    
+    /**
+     * @brief Parametri correnti per il kernel inline (vedi ProjectionKernels.h)
+     */
+    kernels::Orthographic kernel() const;
 
 private:
     core::EquatorialCoordinates center_;
+    double sinDec0_;    // Trigonometria del centro, aggiornata da setCenter()
+    double cosDec0_;
     double fovWidth_;
     double fovHeight_;
 };
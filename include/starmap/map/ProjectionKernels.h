@@ -0,0 +1,211 @@
+#ifndef STARMAP_PROJECTION_KERNELS_H
+#define STARMAP_PROJECTION_KERNELS_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace starmap {
+namespace map {
+
+/**
+ * @brief Kernel inline delle proiezioni standard
+ *
+ * Ogni kernel è una struttura di soli valori (centro, trigonometria del
+ * centro, scala) con un project() inline e senza diramazioni: lo usano
+ * projectBatch() e projectUnitVectors() delle proiezioni standard, così
+ * la matematica della proiezione si espande nel ciclo sul blocco invece
+ * di passare da una funzione virtuale per stella.
+ *
+ * project() restituisce la visibilità con gli stessi criteri di
+ * Projection::isVisible(); x e y sono significativi solo se visibile.
+ * projectVector() fa lo stesso partendo dal versore della stella
+ * (core::UnitVector): solo prodotti scalari con la terna del centro,
+ * nessuna funzione trigonometrica.
+ */
+namespace kernels {
+
+constexpr double DEG_TO_RAD = M_PI / 180.0;
+
+/**
+ * @brief sin e cos senza chiamate di libreria, vettorizzabili
+ *
+ * Riduzione a [-π/4, π/4] (Cody-Waite su π/2) e polinomi di Cephes;
+ * il quadrante sceglie e cambia segno con selezioni, senza salti.
+ * Errore < 1e-15 per gli angoli di una mappa (|x| < qualche giro).
+ */
+inline void sinCos(double x, double& s, double& c) {
+    constexpr double TWO_OVER_PI = 0.63661977236758134308;
+    constexpr double PIO2_HI = 1.57079632673412561417e+00;
+    constexpr double PIO2_LO = 6.07710050650619224932e-11;
+    constexpr double ROUND = 6755399441055744.0;   // 1.5 * 2^52
+
+    double q = (x * TWO_OVER_PI + ROUND) - ROUND;
+    int quadrant = static_cast<int>(q);
+    double r = (x - q * PIO2_HI) - q * PIO2_LO;
+    double z = r * r;
+
+    double ps = r + r * z * (-1.66666666666666307295e-1 + z * (8.33333333332211858878e-3 +
+                z * (-1.98412698295895385996e-4 + z * (2.75573136213857245213e-6 +
+                z * (-2.50507477628578072866e-8 + z * 1.58962301576546568060e-10)))));
+    double pc = 1.0 - 0.5 * z + z * z * (4.16666666666665929218e-2 +
+                z * (-1.38888888888730564116e-3 + z * (2.48015872888517045348e-5 +
+                z * (-2.75573141792967388112e-7 + z * (2.08757008419747316778e-9 +
+                z * -1.13585365213876817300e-11)))));
+
+    double sv = (quadrant & 1) ? pc : ps;
+    double cv = (quadrant & 1) ? ps : pc;
+    s = (quadrant & 2) ? -sv : sv;
+    c = ((quadrant + 1) & 2) ? -cv : cv;
+}
+
+/**
+ * @brief Terna locale del centro di proiezione: est, nord, centro
+ *
+ * Per un versore v: v·est = cos δ sin Δα, v·nord = cos δ0 sin δ -
+ * sin δ0 cos δ cos Δα, v·centro = cos c (distanza dal centro).
+ */
+struct Frame {
+    double ex, ey;          // est (componente z nulla)
+    double nx, ny, nz;      // nord
+    double cx, cy, cz;      // centro
+
+    static Frame at(double ra0, double sinDec0, double cosDec0) {
+        double sinRa0 = std::sin(ra0), cosRa0 = std::cos(ra0);
+        return {-sinRa0, cosRa0,
+                -sinDec0 * cosRa0, -sinDec0 * sinRa0, cosDec0,
+                cosDec0 * cosRa0, cosDec0 * sinRa0, sinDec0};
+    }
+
+    void local(double vx, double vy, double vz,
+               double& east, double& north, double& cosC) const {
+        east = ex * vx + ey * vy;
+        north = nx * vx + ny * vy + nz * vz;
+        cosC = cx * vx + cy * vy + cz * vz;
+    }
+};
+
+struct Stereographic {
+    double ra0;             // radianti
+    double sinDec0;
+    double cosDec0;
+    double scale;
+    double aspectRatio;
+    Frame frame;
+
+    bool project(double ra, double dec, double& x, double& y) const {
+        double sinDec, cosDec, sinDRA, cosDRA;
+        sinCos(dec * DEG_TO_RAD, sinDec, cosDec);
+        sinCos(ra * DEG_TO_RAD - ra0, sinDRA, cosDRA);
+
+        double k = scale / (1.0 + sinDec0 * sinDec + cosDec0 * cosDec * cosDRA);
+        x = k * cosDec * sinDRA;
+        y = k * (cosDec0 * sinDec - sinDec0 * cosDec * cosDRA);
+        return (std::abs(x) <= aspectRatio) & (std::abs(y) <= 1.0);
+    }
+
+    bool projectVector(double vx, double vy, double vz, double& x, double& y) const {
+        double east, north, cosC;
+        frame.local(vx, vy, vz, east, north, cosC);
+        double k = scale / (1.0 + cosC);
+        x = k * east;
+        y = k * north;
+        return (std::abs(x) <= aspectRatio) & (std::abs(y) <= 1.0);
+    }
+};
+
+struct Gnomonic {
+    double ra0;
+    double sinDec0;
+    double cosDec0;
+    double scale;
+    double aspectRatio;
+    Frame frame;
+
+    bool project(double ra, double dec, double& x, double& y) const {
+        double sinDec, cosDec, sinDRA, cosDRA;
+        sinCos(dec * DEG_TO_RAD, sinDec, cosDec);
+        sinCos(ra * DEG_TO_RAD - ra0, sinDRA, cosDRA);
+
+        // Dietro il piano (cosC <= 0) x e y non sono significativi
+        double cosC = sinDec0 * sinDec + cosDec0 * cosDec * cosDRA;
+        double k = scale / cosC;
+        x = k * cosDec * sinDRA;
+        y = k * (cosDec0 * sinDec - sinDec0 * cosDec * cosDRA);
+        return (cosC > 0.0) & (std::abs(x) <= aspectRatio) & (std::abs(y) <= 1.0);
+    }
+
+    bool projectVector(double vx, double vy, double vz, double& x, double& y) const {
+        double east, north, cosC;
+        frame.local(vx, vy, vz, east, north, cosC);
+        double k = scale / cosC;
+        x = k * east;
+        y = k * north;
+        return (cosC > 0.0) & (std::abs(x) <= aspectRatio) & (std::abs(y) <= 1.0);
+    }
+};
+
+struct Orthographic {
+    double ra0;
+    double sinDec0;
+    double cosDec0;
+    double scale;
+    Frame frame;
+
+    bool project(double ra, double dec, double& x, double& y) const {
+        double sinDec, cosDec, sinDRA, cosDRA;
+        sinCos(dec * DEG_TO_RAD, sinDec, cosDec);
+        sinCos(ra * DEG_TO_RAD - ra0, sinDRA, cosDRA);
+
+        double cosC = sinDec0 * sinDec + cosDec0 * cosDec * cosDRA;
+        x = scale * cosDec * sinDRA;
+        y = scale * (cosDec0 * sinDec - sinDec0 * cosDec * cosDRA);
+        return cosC > 0.0;
+    }
+
+    bool projectVector(double vx, double vy, double vz, double& x, double& y) const {
+        double east, north, cosC;
+        frame.local(vx, vy, vz, east, north, cosC);
+        x = scale * east;
+        y = scale * north;
+        return cosC > 0.0;
+    }
+};
+
+/**
+ * @brief Proietta colonne RA/Dec con un kernel (corpo del ciclo vettorizzabile)
+ */
+template <class Kernel>
+inline void projectColumns(const Kernel& kernel, const double* ra, const double* dec,
+                           size_t count, float* x, float* y, uint8_t* visible) {
+    #pragma omp simd
+    for (size_t i = 0; i < count; ++i) {
+        double px, py;
+        visible[i] = kernel.project(ra[i], dec[i], px, py);
+        x[i] = static_cast<float>(px);
+        y[i] = static_cast<float>(py);
+    }
+}
+
+/**
+ * @brief Come projectColumns, dai versori (colonne x/y/z)
+ */
+template <class Kernel>
+inline void projectVectorColumns(const Kernel& kernel, const double* vx, const double* vy,
+                                 const double* vz, size_t count,
+                                 float* x, float* y, uint8_t* visible) {
+    #pragma omp simd
+    for (size_t i = 0; i < count; ++i) {
+        double px, py;
+        visible[i] = kernel.projectVector(vx[i], vy[i], vz[i], px, py);
+        x[i] = static_cast<float>(px);
+        y[i] = static_cast<float>(py);
+    }
+}
+
+} // namespace kernels
+
+} // namespace map
+} // namespace starmap
+
+#endif // STARMAP_PROJECTION_KERNELS_H
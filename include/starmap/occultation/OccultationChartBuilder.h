@@ -199,6 +199,8 @@ private:
                          const OccultationChartConfig& chartConfig);
     void addInfoOverlay(map::MapConfiguration& mapConfig,
                         const OccultationChartConfig& chartConfig);
+    bool toEventEpoch(map::MapConfiguration& mapConfig, core::StarBlock& stars);
+    bool toApparentFrame(map::MapConfiguration& mapConfig, core::StarBlock& stars);
     std::string generateAutoFilename(ChartType type) const;
     std::string generateTitle(ChartType type) const;
 };
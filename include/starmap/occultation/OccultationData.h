@@ -190,6 +190,12 @@ struct OccultationChartConfig {
     bool showScale = true;
     bool showCompass = true;
     
+    // Riferimento apparente all'istante dell'evento (precessione, nutazione,
+    // aberrazione, deflessione): stelle, centro e overlay sono trasformati
+    // e la griglia è nel sistema vero di data. Il moto proprio è applicato
+    // alle stelle e al bersaglio, se ha una controparte nel catalogo
+    bool apparentPositions = false;
+    
     // Traccia asteroide
     double pathDurationHours = 2.0;  // Ore prima/dopo evento
     int pathSteps = 60;              // Numero di punti sulla traccia
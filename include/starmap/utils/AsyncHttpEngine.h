@@ -0,0 +1,138 @@
+#ifndef STARMAP_ASYNC_HTTP_ENGINE_H
+#define STARMAP_ASYNC_HTTP_ENGINE_H
+
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <map>
+#include <memory>
+#include <string>
+
+namespace starmap {
+namespace utils {
+
+class HttpCache;
+
+/**
+ * @brief Richiesta HTTP per AsyncHttpEngine
+ */
+struct HttpRequest {
+    std::string method = "GET";
+    std::string url;
+    std::string body;                               // Dati POST
+    std::map<std::string, std::string> headers;
+    long timeoutSeconds = 0;                        // 0 = timeout del motore
+    std::shared_ptr<HttpCache> cache;               // Cache delle GET (nullptr = nessuna)
+
+    /**
+     * @brief Consumatore del corpo in streaming (opzionale)
+     *
+     * Se impostato riceve il corpo delle risposte 2xx a frammenti, man mano
+     * che arrivano (dal thread del motore); false interrompe il
+     * trasferimento. HttpResponse::body resta vuoto. Una risposta servita
+     * dalla cache viene passata in un unico frammento.
+     */
+    std::function<bool(const char* data, size_t size)> onData;
+};
+
+/**
+ * @brief Risposta HTTP di AsyncHttpEngine
+ */
+struct HttpResponse {
+    long status = 0;
+    std::string body;
+    std::map<std::string, std::string> headers;     // Nomi in minuscolo
+    bool fromCache = false;                         // Corpo servito da HttpCache
+
+    bool ok() const { return status >= 200 && status < 300; }
+};
+
+/**
+ * @brief Parametri di AsyncHttpEngine
+ */
+struct AsyncHttpOptions {
+    size_t maxInFlight = 64;                // Trasferimenti attivi insieme
+    size_t maxConnectionsPerHost = 8;
+    double requestsPerSecondPerHost = 0.0;  // Limite di default per host (0 = nessuno)
+    long timeoutSeconds = 30;
+    bool http2 = true;                      // HTTP/2 su TLS quando il server lo supporta
+};
+
+/**
+ * @brief Contatori di AsyncHttpEngine
+ */
+struct AsyncHttpStatistics {
+    size_t submitted = 0;
+    size_t completed = 0;       // Risposte ricevute (qualsiasi stato HTTP)
+    size_t failed = 0;          // Errori di trasporto
+    size_t cacheHits = 0;       // Risposte valide servite da HttpCache senza rete
+    size_t connections = 0;     // Connessioni aperte (le altre richieste le riusano)
+    size_t rateLimited = 0;     // Avvii rimandati dal limite per host
+    size_t queued = 0;
+    size_t inFlight = 0;
+    size_t peakInFlight = 0;
+};
+
+/**
+ * @brief Motore HTTP asincrono su curl multi
+ *
+ * Un thread dedicato esegue tutti i trasferimenti con un unico handle
+ * multi: le connessioni restano aperte e vengono riusate, sessioni TLS e
+ * DNS sono condivisi tra le richieste e, con HTTP/2, più richieste allo
+ * stesso host viaggiano sulla stessa connessione.
+ *
+ * Al più maxInFlight trasferimenti sono attivi insieme, gli altri
+ * restano in coda nell'ordine di arrivo. Per ogni host si può fissare un
+ * numero massimo di richieste al secondo (token bucket).
+ *
+ * Thread-safe: submit() e get() possono essere chiamate da qualsiasi
+ * thread. Il distruttore annulla le richieste non completate (i future
+ * ricevono un'eccezione).
+ */
+class AsyncHttpEngine {
+public:
+    explicit AsyncHttpEngine(const AsyncHttpOptions& options = AsyncHttpOptions());
+    ~AsyncHttpEngine();
+
+    AsyncHttpEngine(const AsyncHttpEngine&) = delete;
+    AsyncHttpEngine& operator=(const AsyncHttpEngine&) = delete;
+
+    /**
+     * @brief Motore condiviso dal processo (creato al primo uso)
+     */
+    static AsyncHttpEngine& shared();
+
+    /**
+     * @brief Accoda una richiesta
+     * @return Future della risposta; errori di trasporto come std::runtime_error.
+     *         Gli stati HTTP di errore non sollevano eccezioni.
+     */
+    std::future<HttpResponse> submit(HttpRequest request);
+
+    /**
+     * @brief Accoda una GET con la semantica di HttpClient::get()
+     * @return Future del corpo; std::runtime_error per errori di trasporto e stati >= 400
+     */
+    std::future<std::string> get(const std::string& url,
+                                 const std::map<std::string, std::string>& headers = {},
+                                 std::shared_ptr<HttpCache> cache = nullptr);
+
+    /**
+     * @brief Limite di richieste al secondo per un host (0 = nessun limite)
+     * @param host Nome dell'host, senza schema né porta
+     */
+    void setHostRateLimit(const std::string& host, double requestsPerSecond);
+
+    AsyncHttpStatistics getStatistics() const;
+
+    const AsyncHttpOptions& getOptions() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> pImpl_;
+};
+
+} // namespace utils
+} // namespace starmap
+
+#endif // STARMAP_ASYNC_HTTP_ENGINE_H
@@ -0,0 +1,96 @@
+#ifndef STARMAP_BLOOM_FILTER_H
+#define STARMAP_BLOOM_FILTER_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+namespace starmap {
+namespace utils {
+
+/**
+ * @brief Bloom filter a blocchi per chiavi intere a 64 bit
+ *
+ * Ogni chiave imposta un bit in ciascuna delle 8 parole di un singolo
+ * blocco da 512 bit (una linea di cache): un test costa un solo accesso
+ * a memoria. Nessun falso negativo; i falsi positivi dipendono dai bit
+ * per chiave scelti in build().
+ */
+class BlockedBloomFilter {
+public:
+    BlockedBloomFilter() = default;
+
+    /**
+     * @brief Costruisce il filtro per un insieme di chiavi
+     * @param keys Chiavi da inserire
+     * @param count Numero di chiavi
+     * @param bitsPerKey Bit di filtro per chiave (16 -> FPR ~0.1%)
+     */
+    void build(const int64_t* keys, size_t count, size_t bitsPerKey = 16);
+
+    /**
+     * @brief Verifica se la chiave può appartenere all'insieme
+     * @return false se la chiave sicuramente non è presente
+     */
+    bool mayContain(int64_t key) const {
+        if (blocks_.empty()) return true;
+
+        uint64_t h = hash(static_cast<uint64_t>(key));
+        const Block& block = blocks_[blockIndex(h)];
+        uint32_t h2 = static_cast<uint32_t>(h);
+        for (int i = 0; i < WORDS_PER_BLOCK; ++i) {
+            if (!(block.words[i] & bitMask(h2, i))) return false;
+        }
+        return true;
+    }
+
+    bool empty() const { return blocks_.empty(); }
+    void clear() { blocks_.clear(); count_ = 0; }
+
+    // Numero di chiavi inserite
+    size_t size() const { return count_; }
+
+    // Memoria occupata dal filtro (byte)
+    size_t memoryUsage() const { return blocks_.size() * sizeof(Block); }
+
+    /**
+     * @brief Stima teorica del tasso di falsi positivi
+     */
+    double estimatedFalsePositiveRate() const;
+
+private:
+    static constexpr int WORDS_PER_BLOCK = 8;
+
+    struct alignas(64) Block {
+        uint64_t words[WORDS_PER_BLOCK];
+    };
+
+    static uint64_t hash(uint64_t x) {
+        // Finalizzatore splitmix64
+        x += 0x9E3779B97F4A7C15ULL;
+        x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+
+    size_t blockIndex(uint64_t h) const {
+        // Riduzione moltiplicativa dei 32 bit alti sul numero di blocchi
+        return static_cast<size_t>(((h >> 32) * blocks_.size()) >> 32);
+    }
+
+    static uint64_t bitMask(uint32_t h2, int word) {
+        static constexpr uint32_t SALT[WORDS_PER_BLOCK] = {
+            0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+            0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+        };
+        return 1ULL << ((h2 * SALT[word]) >> 26);
+    }
+
+    std::vector<Block> blocks_;
+    size_t count_ = 0;
+};
+
+} // namespace utils
+} // namespace starmap
+
+#endif // STARMAP_BLOOM_FILTER_H
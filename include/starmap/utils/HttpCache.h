@@ -0,0 +1,197 @@
+#ifndef STARMAP_HTTP_CACHE_H
+#define STARMAP_HTTP_CACHE_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace starmap {
+namespace utils {
+
+/**
+ * @brief Contatori della cache HTTP
+ */
+struct HttpCacheStatistics {
+    size_t hits = 0;          // Risposte ancora valide servite dal disco
+    size_t stale = 0;         // Risposte scadute trovate (da rivalidare)
+    size_t revalidated = 0;   // Risposte scadute confermate dal server (304)
+    size_t misses = 0;
+    size_t stores = 0;
+    size_t evictions = 0;
+    size_t entries = 0;
+    size_t diskUsage = 0;     // Byte occupati dai file della cache
+    size_t maxBytes = 0;
+};
+
+/**
+ * @brief Risposta HTTP memorizzata
+ */
+struct HttpCacheEntry {
+    std::string body;
+    std::string etag;           // Header ETag (vuoto se assente)
+    std::string lastModified;   // Header Last-Modified (vuoto se assente)
+    int64_t storedAt = 0;       // Secondi Unix
+    int64_t expiresAt = 0;      // Secondi Unix
+
+    bool isFresh(int64_t now) const { return now < expiresAt; }
+    bool canRevalidate() const { return !etag.empty() || !lastModified.empty(); }
+};
+
+/**
+ * @brief Cache persistente su disco delle risposte HTTP (usata da HttpClient)
+ *
+ * La chiave è la richiesta normalizzata (vedi normalizeKey()): schema e
+ * host in minuscolo, porta di default e frammento rimossi, parametri
+ * decodificati, spazi compressi (le query ADQL che differiscono solo per
+ * la formattazione coincidono) e ordinati. Ogni risposta è un file
+ * nominato con l'hash della chiave, che contiene anche la chiave completa
+ * per riconoscere le collisioni.
+ *
+ * Una risposta resta valida per il max-age indicato dal server
+ * (Cache-Control) o, in mancanza, per il TTL di default. Scaduta, viene
+ * rivalidata con If-None-Match / If-Modified-Since se il server aveva
+ * fornito ETag o Last-Modified. Lo spazio su disco è limitato: superato
+ * il limite vengono rimosse le risposte usate meno di recente.
+ *
+ * Thread-safe; i file sono scritti su un file temporaneo e rinominati,
+ * quindi più processi possono condividere la stessa directory.
+ */
+class HttpCache {
+public:
+    static constexpr int64_t DEFAULT_TTL_SECONDS = 7 * 24 * 3600;
+    static constexpr size_t DEFAULT_MAX_BYTES = 256 * 1024 * 1024;
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    /**
+     * @param directory Directory radice della cache (creata se manca;
+     *                  stringa vuota = cache disabilitata)
+     * @param defaultTtlSeconds Validità delle risposte senza max-age
+     * @param maxBytes Spazio massimo su disco
+     */
+    explicit HttpCache(const std::string& directory,
+                       int64_t defaultTtlSeconds = DEFAULT_TTL_SECONDS,
+                       size_t maxBytes = DEFAULT_MAX_BYTES);
+
+    HttpCache(const HttpCache&) = delete;
+    HttpCache& operator=(const HttpCache&) = delete;
+
+    /**
+     * @brief Cache condivisa per la directory indicata (creata alla prima richiesta)
+     */
+    static std::shared_ptr<HttpCache> open(const std::string& directory);
+
+    /**
+     * @brief true se la directory della cache è utilizzabile
+     */
+    bool isEnabled() const { return enabled_; }
+
+    /**
+     * @brief Directory dei file per la versione corrente del formato
+     */
+    const std::string& getEntryDirectory() const { return entryDirectory_; }
+
+    /**
+     * @brief Chiave normalizzata di una richiesta
+     * @param method Metodo HTTP ("GET", "POST")
+     * @param url URL completo
+     * @param body Corpo della richiesta (form-urlencoded, normalizzato come la query)
+     */
+    static std::string normalizeKey(const std::string& method, const std::string& url,
+                                    const std::string& body = "");
+
+    /**
+     * @brief Risposta memorizzata per la chiave (anche se scaduta)
+     */
+    std::optional<HttpCacheEntry> lookup(const std::string& key);
+
+    /**
+     * @brief Memorizza (o sostituisce) la risposta per la chiave
+     */
+    bool store(const std::string& key, const HttpCacheEntry& entry);
+
+    /**
+     * @brief Rinnova la scadenza di una risposta confermata dal server (304)
+     */
+    bool revalidated(const std::string& key, HttpCacheEntry entry, int64_t expiresAt);
+
+    /**
+     * @brief Aggiunge If-None-Match / If-Modified-Since per rivalidare una risposta
+     */
+    static void addConditionalHeaders(const HttpCacheEntry& entry,
+                                      std::map<std::string, std::string>& headers);
+
+    /**
+     * @brief Aggiorna la cache con la risposta del server a una richiesta
+     *        preceduta da lookup()
+     *
+     * Con 304, o 5xx e una copia disponibile, restituisce la copia
+     * memorizzata (status diventa 200); una risposta 2xx memorizzabile
+     * viene salvata.
+     * @param cached Risultato di lookup() per la stessa chiave
+     * @param status [in/out] Stato HTTP della risposta
+     * @param headers Header della risposta (nomi in minuscolo)
+     * @param body [in/out] Corpo della risposta
+     * @return true se il corpo restituito viene dalla cache
+     */
+    bool update(const std::string& key, const std::optional<HttpCacheEntry>& cached,
+                long& status, const std::map<std::string, std::string>& headers,
+                std::string& body);
+
+    /**
+     * @brief Scadenza di una risposta in base agli header
+     * @param headers Header della risposta (nomi in minuscolo)
+     * @param now Istante della risposta (secondi Unix)
+     * @return Scadenza, o std::nullopt se la risposta non va memorizzata (no-store)
+     */
+    std::optional<int64_t> expiryFor(const std::map<std::string, std::string>& headers,
+                                     int64_t now) const;
+
+    /**
+     * @brief Rimuove tutte le risposte (i contatori restano)
+     */
+    void clear();
+
+    void setDefaultTtl(int64_t seconds);
+    void setMaxBytes(size_t bytes);
+
+    HttpCacheStatistics getStatistics() const;
+
+    /**
+     * @brief Istante corrente in secondi Unix
+     */
+    static int64_t now();
+
+private:
+    struct FileInfo {
+        size_t size;
+        uint64_t lastAccess;   // Valore di accessClock_ all'ultimo uso
+    };
+
+    std::string pathFor(const std::string& key) const;
+    static std::string fileNameFor(const std::string& key);
+    void scanDirectory();
+    void evictLocked();
+
+    bool enabled_ = false;
+    std::string entryDirectory_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, FileInfo> files_;   // Nome file -> dimensione e ultimo uso
+    size_t diskUsage_ = 0;
+    uint64_t accessClock_ = 0;   // Ordine d'uso per l'eviction LRU
+    int64_t defaultTtl_;
+    size_t maxBytes_;
+    HttpCacheStatistics stats_;
+
+    static std::mutex registryMutex_;
+    static std::unordered_map<std::string, std::weak_ptr<HttpCache>> registry_;
+};
+
+} // namespace utils
+} // namespace starmap
+
+#endif // STARMAP_HTTP_CACHE_H
@@ -3,12 +3,22 @@
 
 #include <string>
 #include <map>
+#include <memory>
 
 namespace starmap {
 namespace utils {
 
+class HttpCache;
+
 /**
  * @brief Client HTTP per query ai servizi online
+ *
+ * Thread-safe: ogni thread usa un proprio handle CURL (thread_local),
+ * quindi lo stesso client può eseguire richieste da più thread insieme.
+ *
+ * Con una HttpCache impostata le GET vengono servite dal disco finché la
+ * risposta è valida, rivalidate con richieste condizionali quando scade
+ * e, se il servizio non risponde, servite comunque dalla copia scaduta.
  */
 class HttpClient {
 public:
@@ -41,6 +51,23 @@ public:
      */
     void setTimeout(long seconds);
 
+    /**
+     * @brief Imposta la cache delle risposte (nullptr per disattivarla)
+     */
+    void setCache(std::shared_ptr<HttpCache> cache);
+
+    /**
+     * @brief Cache delle risposte in uso (nullptr se disattivata)
+     */
+    std::shared_ptr<HttpCache> getCache() const;
+
+    /**
+     * @brief Inizializza libcurl una sola volta per processo
+     *
+     * Chiamata automaticamente da HttpClient e AsyncHttpEngine.
+     */
+    static void globalInit();
+
 private:
     class Impl;
     Impl* pImpl_;
@@ -0,0 +1,112 @@
+#ifndef STARMAP_THREAD_POOL_H
+#define STARMAP_THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace starmap {
+namespace utils {
+
+/**
+ * @brief Flag di annullamento condiviso tra chi avvia un'operazione e chi la esegue
+ *
+ * Un token costruito di default non è annullabile (valid() == false).
+ * Le copie condividono lo stesso stato.
+ */
+class CancellationToken {
+public:
+    CancellationToken() = default;
+
+    /**
+     * @brief Crea un token annullabile
+     */
+    static CancellationToken create() {
+        CancellationToken token;
+        token.state_ = std::make_shared<std::atomic<bool>>(false);
+        return token;
+    }
+
+    bool valid() const { return state_ != nullptr; }
+
+    void cancel() {
+        if (state_) state_->store(true);
+    }
+
+    bool isCancelled() const {
+        return state_ && state_->load();
+    }
+
+private:
+    std::shared_ptr<std::atomic<bool>> state_;
+};
+
+/**
+ * @brief Pool di thread a dimensione fissa con coda limitata
+ *
+ * Pensato per operazioni di I/O (query ai cataloghi): pochi thread, e
+ * post() si blocca quando la coda è piena invece di accumulare lavoro.
+ * Il distruttore completa i task in coda e attende i thread.
+ * Non chiamare post()/submit() da un task del pool con la coda piena.
+ */
+class ThreadPool {
+public:
+    /**
+     * @param numThreads Numero di thread (minimo 1)
+     * @param maxQueued Task in attesa oltre i quali post() si blocca (0 = illimitati)
+     */
+    explicit ThreadPool(size_t numThreads, size_t maxQueued = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Accoda un task
+     */
+    void post(std::function<void()> task);
+
+    /**
+     * @brief Accoda una funzione e restituisce il future del suo risultato
+     */
+    template<typename Fn>
+    std::future<typename std::invoke_result<Fn>::type> submit(Fn&& fn) {
+        using Result = typename std::invoke_result<Fn>::type;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Fn>(fn));
+        std::future<Result> future = task->get_future();
+        post([task]() { (*task)(); });
+        return future;
+    }
+
+    size_t size() const { return workers_.size(); }
+
+    /**
+     * @brief Task in coda non ancora avviati
+     */
+    size_t pending() const;
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> queue_;
+    size_t maxQueued_;
+    bool stopping_ = false;
+
+    mutable std::mutex mutex_;
+    std::condition_variable taskAvailable_;
+    std::condition_variable spaceAvailable_;
+};
+
+} // namespace utils
+} // namespace starmap
+
+#endif // STARMAP_THREAD_POOL_H
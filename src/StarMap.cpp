@@ -1,15 +1,69 @@
 #include <iostream>
 #include <cmath>
+#include <mutex>
 #include "starmap/StarMap.h"
+#include "starmap/catalog/GaiaCatalogSession.h"
+#include "starmap/catalog/SQLiteConnectionPool.h"
 
 namespace starmap {
 
-void initialize(const config::LibraryConfig::CatalogPaths& catalogPaths) {
+namespace {
+
+/**
+ * @brief Riferimento della libreria alla sessione del catalogo Gaia
+ *
+ * La tiene aperta tra initialize() e finalize(). Allocato e mai distrutto:
+ * senza finalize() la sessione non viene chiusa durante la distruzione
+ * degli statici, quando i singleton da cui dipende (catalogo, mutex della
+ * sessione) potrebbero essere già stati distrutti.
+ */
+struct LibrarySession {
+    std::mutex mutex;
+    std::shared_ptr<catalog::GaiaCatalogSession> session;
+};
+
+LibrarySession& librarySession() {
+    static LibrarySession* owner = new LibrarySession();
+    return *owner;
+}
+
+} // namespace
+
+bool initialize(const config::LibraryConfig::CatalogPaths& catalogPaths) {
+    LibrarySession& owner = librarySession();
+    std::lock_guard<std::mutex> lock(owner.mutex);
+    
+    // La sessione legge i path solo alla creazione: se altri GaiaClient la
+    // tengono aperta, i nuovi path non potrebbero valere per il catalogo
+    owner.session.reset();
+    if (catalog::GaiaCatalogSession::isActive()) {
+        owner.session = catalog::GaiaCatalogSession::acquire();
+        std::cerr << "starmap::initialize: sessione del catalogo Gaia ancora in uso, "
+                  << "configurazione invariata (rilasciare i GaiaClient prima di reinizializzare)\n";
+        return false;
+    }
+    
     config::LibraryConfig::initialize(catalogPaths);
+    owner.session = catalog::GaiaCatalogSession::acquire();
+    return true;
+}
+
+bool warmUpCatalog() {
+    LibrarySession& owner = librarySession();
+    std::lock_guard<std::mutex> lock(owner.mutex);
+    if (!owner.session) {
+        owner.session = catalog::GaiaCatalogSession::acquire();
+    }
+    return owner.session->warmUp();
 }
 
 void finalize() {
-    // Cleanup se necessario in futuro
+    {
+        LibrarySession& owner = librarySession();
+        std::lock_guard<std::mutex> lock(owner.mutex);
+        owner.session.reset();
+    }
+    catalog::SQLiteConnectionPool::closeAll();
 }
 
 } // namespace starmap
@@ -1,41 +1,252 @@
 #include "starmap/catalog/CatalogManager.h"
 #include <algorithm>
+#include <cmath>
 
 namespace starmap {
 namespace catalog {
 
+// Il catalogo SAO non contiene stelle più deboli di mag ~9.5
+constexpr double SAO_MAGNITUDE_LIMIT = 9.0;
+
+// Pool di I/O: pochi thread, coda limitata
+constexpr size_t DEFAULT_ASYNC_THREADS = 2;
+constexpr size_t MAX_QUEUED_QUERIES = 64;
+
+class CatalogManager::Impl {
+public:
+    /**
+     * @brief Query in corso, condivisa da tutti i chiamanti con la stessa chiave
+     */
+    struct InFlight {
+        QueryCache::Key key;
+        int maxResults = 0;
+        std::shared_future<core::StarBlock> result;
+        std::vector<utils::CancellationToken> tokens;
+        bool pinned = false;      // Agganciata da un chiamante non annullabile
+        bool abandoned = false;   // Annullata: nessuno può più agganciarsi
+        
+        void attach(const utils::CancellationToken& token) {
+            if (token.valid()) tokens.push_back(token);
+            else pinned = true;
+        }
+        
+        bool isCancelled() const {
+            if (pinned || tokens.empty()) return false;
+            return std::all_of(tokens.begin(), tokens.end(),
+                               [](const utils::CancellationToken& t) { return t.isCancelled(); });
+        }
+    };
+    
+    utils::ThreadPool& pool() {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (!pool_) {
+            pool_ = std::make_unique<utils::ThreadPool>(asyncThreads, MAX_QUEUED_QUERIES);
+        }
+        return *pool_;
+    }
+    
+    /**
+     * @brief true se la query va interrotta; in tal caso la marca come abbandonata
+     */
+    bool checkCancelled(InFlight& entry) {
+        std::lock_guard<std::mutex> lock(inflightMutex);
+        if (shuttingDown || entry.isCancelled()) {
+            entry.abandoned = true;
+        }
+        return entry.abandoned;
+    }
+    
+    /**
+     * @brief Rimuove la query dalle richieste in corso (su ogni percorso di uscita)
+     */
+    void finish(const std::shared_ptr<InFlight>& entry) {
+        std::lock_guard<std::mutex> lock(inflightMutex);
+        inflight.erase(std::remove(inflight.begin(), inflight.end(), entry), inflight.end());
+    }
+    
+    StarSource starSource() {
+        std::lock_guard<std::mutex> lock(sourceMutex);
+        return source;
+    }
+    
+    // Il catalogo Gaia (singleton di IOC_GaiaLib) non garantisce accessi
+    // concorrenti: le letture sono serializzate. L'arricchimento SAO usa il
+    // pool di connessioni in sola lettura e non richiede lock
+    std::mutex gaiaMutex;
+    
+    std::mutex inflightMutex;
+    std::vector<std::shared_ptr<InFlight>> inflight;
+    std::atomic<bool> shuttingDown{false};
+    
+    std::mutex poolMutex;
+    size_t asyncThreads = DEFAULT_ASYNC_THREADS;
+    std::unique_ptr<utils::ThreadPool> pool_;
+    
+    std::mutex sourceMutex;
+    StarSource source;
+    
+    std::atomic<size_t> catalogQueries{0};
+    std::atomic<size_t> joinedQueries{0};
+    std::atomic<size_t> failedQueries{0};
+};
+
 CatalogManager::CatalogManager() 
     : cacheEnabled_(true)
-    , parallelEnrichment_(false) {
+    , parallelEnrichment_(false)
+    , pImpl_(std::make_unique<Impl>()) {
 }
 
-CatalogManager::~CatalogManager() = default;
+CatalogManager::~CatalogManager() {
+    // Le query in coda terminano subito; si attendono quelle in esecuzione
+    pImpl_->shuttingDown = true;
+    std::lock_guard<std::mutex> lock(pImpl_->poolMutex);
+    pImpl_->pool_.reset();
+}
 
 std::vector<std::shared_ptr<core::Star>> CatalogManager::queryStars(
     const GaiaQueryParameters& params,
     bool enrichWithSAO) {
     
-    auto stars = gaiaClient_.queryRegion(params);
+    return queryStarBlock(params, enrichWithSAO).toStars();
+}
+
+core::StarBlock CatalogManager::queryStarBlock(
+    const GaiaQueryParameters& params,
+    bool enrichWithSAO) {
     
-    if (!enrichWithSAO || stars.empty()) {
-        return stars;
+    if (cacheEnabled_) {
+        auto cached = queryCache_.lookup(params, enrichWithSAO);
+        if (cached) {
+            return std::move(*cached);
+        }
     }
     
-    for (auto& star : stars) {
-        if (star->getMagnitude() < 9.0) {
-            saoCatalog_.enrichWithSAO(star);
+    return startQuery(params, enrichWithSAO, utils::CancellationToken(), true).get();
+}
+
+std::shared_future<core::StarBlock> CatalogManager::startQuery(
+    const GaiaQueryParameters& params,
+    bool enrichWithSAO,
+    utils::CancellationToken cancel,
+    bool runInline) {
+    
+    auto key = QueryCache::makeKey(params, enrichWithSAO);
+    auto promise = std::make_shared<std::promise<core::StarBlock>>();
+    std::shared_ptr<Impl::InFlight> entry;
+    {
+        std::lock_guard<std::mutex> lock(pImpl_->inflightMutex);
+        for (const auto& other : pImpl_->inflight) {
+            if (!other->abandoned && other->key == key && other->maxResults == params.maxResults) {
+                other->attach(cancel);
+                pImpl_->joinedQueries++;
+                return other->result;
+            }
         }
+        
+        entry = std::make_shared<Impl::InFlight>();
+        entry->key = key;
+        entry->maxResults = params.maxResults;
+        entry->result = promise->get_future().share();
+        entry->attach(cancel);
+        pImpl_->inflight.push_back(entry);
     }
     
-    return stars;
+    auto task = [this, params, enrichWithSAO, entry, promise]() {
+        Impl& impl = *pImpl_;
+        
+        // Su eccezione la query esce dalle richieste in corso e l'errore
+        // arriva a tutti i chiamanti agganciati (nessun future orfano)
+        try {
+            core::StarBlock stars;
+            
+            if (!impl.checkCancelled(*entry)) {
+                StarSource source = impl.starSource();
+                std::lock_guard<std::mutex> lock(impl.gaiaMutex);
+                impl.catalogQueries++;
+                stars = source ? source(params) : gaiaClient_.queryRegionBlock(params);
+            }
+            
+            if (enrichWithSAO && !stars.empty() && !impl.checkCancelled(*entry)) {
+                // Solo stelle sotto mag 9 (limite del catalogo SAO)
+                if (parallelEnrichment_) {
+                    saoCatalog_.enrichWithSAOParallel(stars, SAO_MAGNITUDE_LIMIT);
+                } else {
+                    saoCatalog_.enrichWithSAO(stars, SAO_MAGNITUDE_LIMIT);
+                }
+            }
+            
+            bool abandoned = impl.checkCancelled(*entry);
+            if (abandoned) {
+                stars.clear();
+            } else if (cacheEnabled_) {
+                queryCache_.insert(params, enrichWithSAO, stars);
+            }
+            
+            impl.finish(entry);
+            promise->set_value(std::move(stars));
+        } catch (...) {
+            impl.failedQueries++;
+            impl.finish(entry);
+            promise->set_exception(std::current_exception());
+        }
+    };
+    
+    if (runInline) {
+        task();
+    } else {
+        pImpl_->pool().post(std::move(task));
+    }
+    return entry->result;
 }
 
-std::vector<std::shared_ptr<core::Star>> CatalogManager::queryRectangularRegion(
+std::shared_future<core::StarBlock> CatalogManager::queryStarBlockAsync(
+    const GaiaQueryParameters& params,
+    bool enrichWithSAO,
+    utils::CancellationToken cancel) {
+    
+    if (cacheEnabled_) {
+        auto cached = queryCache_.lookup(params, enrichWithSAO);
+        if (cached) {
+            std::promise<core::StarBlock> ready;
+            ready.set_value(std::move(*cached));
+            return ready.get_future().share();
+        }
+    }
+    
+    return startQuery(params, enrichWithSAO, std::move(cancel), false);
+}
+
+std::future<std::vector<std::shared_ptr<core::Star>>> CatalogManager::queryStarsAsync(
+    const GaiaQueryParameters& params,
+    bool enrichWithSAO,
+    utils::CancellationToken cancel) {
+    
+    auto block = queryStarBlockAsync(params, enrichWithSAO, std::move(cancel));
+    return std::async(std::launch::deferred, [block]() { return block.get().toStars(); });
+}
+
+std::future<std::vector<std::shared_ptr<core::Star>>> CatalogManager::queryRectangularRegionAsync(
     const core::EquatorialCoordinates& center,
     double widthDeg,
     double heightDeg,
     double maxMagnitude,
-    bool enrichWithSAO) {
+    bool enrichWithSAO,
+    utils::CancellationToken cancel) {
+    
+    return queryStarsAsync(rectangleParameters(center, widthDeg, heightDeg, maxMagnitude),
+                           enrichWithSAO, std::move(cancel));
+}
+
+void CatalogManager::setAsyncThreads(size_t threads) {
+    std::lock_guard<std::mutex> lock(pImpl_->poolMutex);
+    pImpl_->asyncThreads = std::max<size_t>(1, threads);
+}
+
+GaiaQueryParameters CatalogManager::rectangleParameters(
+    const core::EquatorialCoordinates& center,
+    double widthDeg,
+    double heightDeg,
+    double maxMagnitude) {
     
     // Usa query circolare con raggio che contiene il rettangolo
     double radius = std::sqrt(widthDeg * widthDeg + heightDeg * heightDeg) / 2.0;
@@ -47,17 +258,55 @@ std::vector<std::shared_ptr<core::Star>> CatalogManager::queryRectangularRegion(
     
     // Calcola automaticamente il limite ottimale
     params.calculateOptimalMaxResults();
+    return params;
+}
+
+std::vector<std::shared_ptr<core::Star>> CatalogManager::queryRectangularRegion(
+    const core::EquatorialCoordinates& center,
+    double widthDeg,
+    double heightDeg,
+    double maxMagnitude,
+    bool enrichWithSAO) {
     
-    return queryStars(params, enrichWithSAO);
+    return queryStars(rectangleParameters(center, widthDeg, heightDeg, maxMagnitude),
+                      enrichWithSAO);
 }
 
 void CatalogManager::setCacheEnabled(bool enabled) {
     cacheEnabled_ = enabled;
+    if (!enabled) {
+        queryCache_.clear();
+    }
+}
+
+void CatalogManager::setStarSource(StarSource source) {
+    std::lock_guard<std::mutex> lock(pImpl_->sourceMutex);
+    pImpl_->source = std::move(source);
+}
+
+CatalogManagerStatistics CatalogManager::getStatistics() const {
+    CatalogManagerStatistics stats;
+    stats.catalogQueries = pImpl_->catalogQueries;
+    stats.joinedQueries = pImpl_->joinedQueries;
+    stats.failedQueries = pImpl_->failedQueries;
+    return stats;
 }
 
 void CatalogManager::setParallelEnrichment(bool enabled) {
     parallelEnrichment_ = enabled;
 }
 
+void CatalogManager::setCacheMemoryBudget(size_t bytes) {
+    queryCache_.setMemoryBudget(bytes);
+}
+
+void CatalogManager::clearCache() {
+    queryCache_.clear();
+}
+
+QueryCacheStatistics CatalogManager::getCacheStatistics() const {
+    return queryCache_.getStatistics();
+}
+
 } // namespace catalog
 } // namespace starmap
@@ -0,0 +1,108 @@
+#include "starmap/catalog/GaiaCatalogSession.h"
+#include "starmap/config/LibraryConfig.h"
+#include <ioc_gaialib/unified_gaia_catalog.h>
+#include <ioc_gaialib/types.h>
+#include <cstdlib>
+#include <iostream>
+
+namespace starmap {
+namespace catalog {
+
+std::mutex GaiaCatalogSession::mutex_;
+std::weak_ptr<GaiaCatalogSession> GaiaCatalogSession::current_;
+int GaiaCatalogSession::liveSessions_ = 0;
+
+GaiaCatalogSession::GaiaCatalogSession() {
+    const char* homeEnv = getenv("HOME");
+    std::string home = homeEnv ? homeEnv : "";
+    // Snapshot coerente dei path, anche se un altro thread li modifica
+    auto paths = config::LibraryConfig::getInstance().getPaths();
+    catalogDirectory_ = home + "/.catalog/gaia_mag18_v2_multifile";
+
+    // Configurazione corretta per UnifiedGaiaCatalog
+    std::string config = R"({
+        "catalog_type": "multifile_v2",
+        "multifile_directory": ")" + catalogDirectory_ + R"(",
+        "max_cached_chunks": 100,
+        "log_level": "info",
+        "iau_catalog_path": ")" + paths->iauCatalog + R"(",
+        "common_star_names_path": ")" + paths->starNamesDatabase + R"("
+    })";
+
+    // Se gaiaSaoDbPath non è impostato, usa il default (ma LibraryConfig dovrebbe averlo)
+    if (paths->gaiaSaoDatabase.empty()) {
+         // Fallback to default if somehow empty
+         config = R"({
+            "catalog_type": "multifile_v2",
+            "multifile_directory": ")" + catalogDirectory_ + R"(",
+            "max_cached_chunks": 100,
+            "log_level": "info"
+        })";
+    }
+
+    available_ = ioc::gaia::UnifiedGaiaCatalog::initialize(config);
+
+    // Cache a tile: invalidata quando cambiano i file del catalogo o
+    // i cataloghi dei nomi usati per le designazioni
+    if (available_ && !paths->tileCacheDirectory.empty()) {
+        uint64_t fingerprint = SkyTileCache::fingerprint({
+            catalogDirectory_, paths->iauCatalog, paths->starNamesDatabase});
+        tileCache_ = std::make_unique<SkyTileCache>(paths->tileCacheDirectory, fingerprint);
+        if (!tileCache_->isEnabled()) tileCache_.reset();
+    }
+}
+
+GaiaCatalogSession::~GaiaCatalogSession() {
+    // Una nuova sessione può essere stata creata mentre questa veniva
+    // rilasciata: in quel caso il catalogo resta aperto
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--liveSessions_ == 0) {
+        ioc::gaia::UnifiedGaiaCatalog::shutdown();
+    }
+}
+
+std::shared_ptr<GaiaCatalogSession> GaiaCatalogSession::acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto session = current_.lock();
+    if (!session) {
+        session = std::shared_ptr<GaiaCatalogSession>(new GaiaCatalogSession());
+        current_ = session;
+        liveSessions_++;
+    }
+    return session;
+}
+
+bool GaiaCatalogSession::isActive() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return !current_.expired();
+}
+
+bool GaiaCatalogSession::warmUp() {
+    if (!available_) return false;
+
+    // Una query minima forza l'apertura del catalogo e il caricamento
+    // dell'indice dei chunk
+    ioc::gaia::QueryParams qp;
+    qp.ra_center = 0.0;
+    qp.dec_center = 0.0;
+    qp.radius = 0.001;
+    qp.max_magnitude = 6.0;
+    ioc::gaia::UnifiedGaiaCatalog::getInstance().queryCone(qp);
+    return true;
+}
+
+size_t GaiaCatalogSession::warmUp(const core::EquatorialCoordinates& center, double radiusDeg,
+                                  double maxMagnitude) {
+    if (!available_) return 0;
+
+    ioc::gaia::QueryParams qp;
+    qp.ra_center = center.getRightAscension();
+    qp.dec_center = center.getDeclination();
+    qp.radius = radiusDeg;
+    qp.max_magnitude = maxMagnitude;
+    return ioc::gaia::UnifiedGaiaCatalog::getInstance().queryCone(qp).size();
+}
+
+} // namespace catalog
+} // namespace starmap
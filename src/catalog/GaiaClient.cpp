@@ -1,48 +1,186 @@
 #include "starmap/catalog/GaiaClient.h"
+#include "starmap/catalog/GaiaCatalogSession.h"
+#include "starmap/catalog/SkyTileCache.h"
 #include "starmap/config/LibraryConfig.h"
+#include "starmap/core/BrightestSelector.h"
 #include <ioc_gaialib/unified_gaia_catalog.h>
 #include <ioc_gaialib/types.h>
+#include <algorithm>
 #include <cmath>
-#include <cstdlib>
 
 namespace starmap {
 namespace catalog {
 
+/**
+ * @brief Numero SAO da una designazione del catalogo ("SAO 123456" o "123456")
+ */
+static std::optional<int> parseSAODesignation(const std::string& designation) {
+    if (designation.empty()) return std::nullopt;
+    
+    // Rimuovi prefisso "SAO " se presente
+    size_t start = designation.compare(0, 4, "SAO ") == 0 ? 4 : 0;
+    try {
+        return std::stoi(designation.substr(start));
+    } catch (...) {
+        return std::nullopt;
+    }
+}
+
+/**
+ * @brief Accoda una stella Gaia a un blocco (nome IAU e SAO se disponibili)
+ */
+static size_t appendGaiaStar(core::StarBlock& stars, const ioc::gaia::GaiaStar& gs) {
+    size_t i = stars.append(gs.ra, gs.dec, gs.phot_g_mean_mag,
+                            static_cast<long long>(gs.source_id));
+    if (gs.parallax > 0) stars.setParallax(i, gs.parallax);
+    stars.setProperMotion(i, gs.pmra, gs.pmdec);
+    double bpRp = gs.getBpRpColor();
+    if (!std::isnan(bpRp)) stars.setColorIndex(i, bpRp);
+    
+    // Imposta il nome IAU se disponibile (usa getDesignation())
+    std::string designation = gs.getDesignation();
+    if (!designation.empty()) {
+        stars.setName(i, designation);
+    }
+    
+    auto sao = parseSAODesignation(gs.sao_designation);
+    if (sao) {
+        stars.setSAONumber(i, *sao);
+    }
+    return i;
+}
+
+// ========== StarView ==========
+
+StarView::StarView(const ioc::gaia::GaiaStar& record)
+    : ra_(record.ra)
+    , dec_(record.dec)
+    , magnitude_(record.phot_g_mean_mag)
+    , gaiaId_(static_cast<long long>(record.source_id))
+    , record_(&record) {
+}
+
+StarView::StarView(const core::StarBlock& block, size_t row)
+    : ra_(block.getRightAscension(row))
+    , dec_(block.getDeclination(row))
+    , magnitude_(block.getMagnitude(row))
+    , gaiaId_(block.getGaiaId(row))
+    , block_(&block)
+    , row_(row) {
+}
+
+std::optional<double> StarView::getParallax() const {
+    if (block_) return block_->getParallax(row_);
+    return record_->parallax > 0 ? std::optional<double>(record_->parallax) : std::nullopt;
+}
+
+std::optional<double> StarView::getProperMotionRA() const {
+    if (block_) return block_->getProperMotionRA(row_);
+    return record_->pmra;
+}
+
+std::optional<double> StarView::getProperMotionDec() const {
+    if (block_) return block_->getProperMotionDec(row_);
+    return record_->pmdec;
+}
+
+std::optional<double> StarView::getColorIndex() const {
+    if (block_) return block_->getColorIndex(row_);
+    double bpRp = record_->getBpRpColor();
+    return std::isnan(bpRp) ? std::nullopt : std::optional<double>(bpRp);
+}
+
+std::string StarView::getDesignation() const {
+    if (block_) return block_->getName(row_);
+    return record_->getDesignation();
+}
+
+std::optional<int> StarView::getSAONumber() const {
+    if (block_) return block_->getSAONumber(row_);
+    return parseSAODesignation(record_->sao_designation);
+}
+
+size_t StarView::appendTo(core::StarBlock& block) const {
+    if (block_) return block.appendRow(*block_, row_);
+    return appendGaiaStar(block, *record_);
+}
+
 class GaiaClient::Impl {
 public:
-    Impl() {
-        std::string home = getenv("HOME");
-        auto& libConfig = config::LibraryConfig::getInstance();
+    Impl() : session_(GaiaCatalogSession::acquire()) {
+        available_ = session_->isAvailable();
+        tileCache_ = session_->getTileCache();
+    }
+    
+    /**
+     * @brief Query a cono diretta al catalogo (stelle con magnitudine valida)
+     */
+    core::StarBlock queryCatalog(double ra, double dec, double radius,
+                                 double maxMagnitude, size_t limit, bool keepBrightest) {
+        core::StarBlock stars;
+        auto& catalog = ioc::gaia::UnifiedGaiaCatalog::getInstance();
+        
+        // Usa QueryParams (API corretta da types.h)
+        ioc::gaia::QueryParams qp;
+        qp.ra_center = ra;
+        qp.dec_center = dec;
+        qp.radius = radius;
+        qp.max_magnitude = maxMagnitude;
         
-        // Configurazione corretta per UnifiedGaiaCatalog
-        std::string config = R"({
-            "catalog_type": "multifile_v2",
-            "multifile_directory": ")" + home + R"(/.catalog/gaia_mag18_v2_multifile",
-            "max_cached_chunks": 100,
-            "log_level": "info",
-            "iau_catalog_path": ")" + libConfig.getIauCatalogPath() + R"(",
-            "common_star_names_path": ")" + libConfig.getStarNamesDbPath() + R"("
-        })";
+        auto gaiaStars = catalog.queryCone(qp);
         
-        // Se gaiaSaoDbPath non è impostato, usa il default (ma LibraryConfig dovrebbe averlo)
-        if (libConfig.getGaiaSaoDbPath().empty()) {
-             // Fallback to default if somehow empty
-             config = R"({
-                "catalog_type": "multifile_v2",
-                "multifile_directory": ")" + home + R"(/.catalog/gaia_mag18_v2_multifile",
-                "max_cached_chunks": 100,
-                "log_level": "info"
-            })";
+        if (keepBrightest && gaiaStars.size() > limit) {
+            // Top-K per magnitudine: si convertono solo le stelle selezionate
+            core::BrightestSelector selector(limit);
+            for (size_t i = 0; i < gaiaStars.size(); ++i) {
+                float mag = static_cast<float>(gaiaStars[i].phot_g_mean_mag);
+                if (gaiaStars[i].phot_g_mean_mag > 0 && selector.accepts(mag)) {
+                    selector.offer(mag, static_cast<uint32_t>(i));
+                }
+            }
+            
+            auto selected = selector.indices();
+            stars.reserve(selected.size());
+            for (uint32_t i : selected) {
+                appendGaiaStar(stars, gaiaStars[i]);
+            }
+            return stars;
         }
-
-        available_ = ioc::gaia::UnifiedGaiaCatalog::initialize(config);
+        
+        stars.reserve(std::min(limit, gaiaStars.size()));
+        for (const auto& gs : gaiaStars) {
+            if (stars.size() >= limit) break;
+            
+            // Salta stelle con magnitudine non valida (0 o negativa)
+            if (gs.phot_g_mean_mag <= 0) continue;
+            
+            appendGaiaStar(stars, gs);
+        }
+        
+        return stars;
+    }
+    
+    /**
+     * @brief Cono composto dalle tile su disco (le mancanti lette dal catalogo)
+     */
+    core::StarBlock queryTiles(const GaiaQueryParameters& params) {
+        return tileCache_->queryCone(
+            params.center.getRightAscension(), params.center.getDeclination(),
+            params.radiusDegrees, params.maxMagnitude, tileFetcher());
     }
     
-    ~Impl() {
-        ioc::gaia::UnifiedGaiaCatalog::shutdown();
+    // Tile mancanti: lette dal catalogo per intero, senza limite di righe
+    SkyTileCache::Fetcher tileFetcher() {
+        return [this](double tileRa, double tileDec, double tileRadius, double depth) {
+            return queryCatalog(tileRa, tileDec, tileRadius, depth,
+                                static_cast<size_t>(-1), false);
+        };
     }
     
+    // La sessione chiude il catalogo quando l'ultimo riferimento viene rilasciato
+    std::shared_ptr<GaiaCatalogSession> session_;
     bool available_ = false;
+    SkyTileCache* tileCache_ = nullptr;
 };
 
 GaiaClient::GaiaClient() : pImpl_(std::make_unique<Impl>()) {}
@@ -54,64 +192,88 @@ bool GaiaClient::isAvailable() const {
 
 std::vector<std::shared_ptr<core::Star>> GaiaClient::queryRegion(
     const GaiaQueryParameters& params) {
+    return queryRegionBlock(params).toStars();
+}
+
+core::StarBlock GaiaClient::queryRegionBlock(const GaiaQueryParameters& params) {
+    if (!pImpl_->available_) return core::StarBlock();
     
-    std::vector<std::shared_ptr<core::Star>> stars;
+    size_t limit = params.maxResults > 0 ? static_cast<size_t>(params.maxResults)
+                                         : static_cast<size_t>(-1);
+    double ra = params.center.getRightAscension();
+    double dec = params.center.getDeclination();
     
-    if (!pImpl_->available_) return stars;
+    if (!pImpl_->tileCache_) {
+        return pImpl_->queryCatalog(ra, dec, params.radiusDegrees, params.maxMagnitude,
+                                    limit, params.keepBrightest);
+    }
     
-    auto& catalog = ioc::gaia::UnifiedGaiaCatalog::getInstance();
+    // Unione delle tile su disco; quelle mancanti vengono lette dal catalogo
+    core::StarBlock stars = pImpl_->queryTiles(params);
+    
+    if (stars.size() <= limit) return stars;
+    
+    // Le tile sono già ordinate per magnitudine, ma il limite vale sull'unione
+    if (params.keepBrightest) {
+        core::BrightestSelector selector(limit);
+        for (size_t i = 0; i < stars.size(); ++i) {
+            selector.offer(static_cast<float>(stars.getMagnitude(i)), static_cast<uint32_t>(i));
+        }
+        core::StarBlock brightest;
+        brightest.computeUnitVectors();   // Blocco vuoto: appendRow copia i versori delle tile
+        auto selected = selector.indices();
+        brightest.reserve(selected.size());
+        for (uint32_t i : selected) {
+            brightest.appendRow(stars, i);
+        }
+        return brightest;
+    }
+    
+    stars.truncate(limit);
+    return stars;
+}
+
+size_t GaiaClient::forEachInCone(const GaiaQueryParameters& params,
+                                 const std::function<void(const StarView&)>& visit) {
+    if (!pImpl_->available_) return 0;
+    
+    // Le tile vengono decodificate blocco per blocco direttamente nella callback
+    if (pImpl_->tileCache_) {
+        return pImpl_->tileCache_->forEachInCone(
+            params.center.getRightAscension(), params.center.getDeclination(),
+            params.radiusDegrees, params.maxMagnitude, pImpl_->tileFetcher(),
+            [&visit](const core::StarBlock& stars, size_t i) { visit(StarView(stars, i)); });
+    }
     
-    // Usa QueryParams (API corretta da types.h)
     ioc::gaia::QueryParams qp;
     qp.ra_center = params.center.getRightAscension();
     qp.dec_center = params.center.getDeclination();
     qp.radius = params.radiusDegrees;
     qp.max_magnitude = params.maxMagnitude;
     
-    auto gaiaStars = catalog.queryCone(qp);
+    auto gaiaStars = ioc::gaia::UnifiedGaiaCatalog::getInstance().queryCone(qp);
     
+    size_t visited = 0;
     for (const auto& gs : gaiaStars) {
         // Salta stelle con magnitudine non valida (0 o negativa)
         if (gs.phot_g_mean_mag <= 0) continue;
         
-        auto star = std::make_shared<core::Star>();
-        star->setGaiaId(gs.source_id);
-        star->setCoordinates(core::EquatorialCoordinates(gs.ra, gs.dec));
-        star->setMagnitude(gs.phot_g_mean_mag);
-        if (gs.parallax > 0) star->setParallax(gs.parallax);
-        star->setProperMotionRA(gs.pmra);
-        star->setProperMotionDec(gs.pmdec);
-        double bpRp = gs.getBpRpColor();
-        if (!std::isnan(bpRp)) star->setColorIndex(bpRp);
-        
-        // Imposta il nome IAU se disponibile (usa getDesignation())
-        std::string designation = gs.getDesignation();
-        if (!designation.empty()) {
-            star->setName(designation);
-        }
-        
-        // Estrai numero SAO se disponibile
-        if (!gs.sao_designation.empty()) {
-            // sao_designation è tipo "SAO 123456" o solo "123456"
-            std::string saoStr = gs.sao_designation;
-            // Rimuovi prefisso "SAO " se presente
-            if (saoStr.substr(0, 4) == "SAO ") {
-                saoStr = saoStr.substr(4);
-            }
-            try {
-                int saoNum = std::stoi(saoStr);
-                star->setSAONumber(saoNum);
-            } catch (...) {}
-        }
-        
-        stars.push_back(star);
+        visit(StarView(gs));
+        visited++;
     }
-    
-    if (params.maxResults > 0 && stars.size() > static_cast<size_t>(params.maxResults)) {
-        stars.resize(params.maxResults);
-    }
-    
-    return stars;
+    return visited;
+}
+
+bool GaiaClient::warmUp() {
+    return pImpl_->session_->warmUp();
+}
+
+bool GaiaClient::hasTileCache() const {
+    return pImpl_->tileCache_ != nullptr;
+}
+
+SkyTileCacheStatistics GaiaClient::getTileCacheStatistics() const {
+    return pImpl_->tileCache_ ? pImpl_->tileCache_->getStatistics() : SkyTileCacheStatistics();
 }
 
 std::shared_ptr<core::Star> GaiaClient::queryById(long long gaiaId) {
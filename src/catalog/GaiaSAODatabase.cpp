@@ -1,47 +1,416 @@
 #include "starmap/catalog/GaiaSAODatabase.h"
+#include "starmap/core/UnitVector.h"
+#include "starmap/catalog/GaiaSAOSchema.h"
+#include "starmap/catalog/GaiaSAOSnapshot.h"
+#include "starmap/catalog/SAONumberIndex.h"
+#include "starmap/catalog/SkyIndex.h"
+#include "starmap/catalog/SQLiteConnectionPool.h"
+#include "starmap/utils/BloomFilter.h"
 #include <sqlite3.h>
+#include <algorithm>
+#include <chrono>
 #include <cmath>
 #include <sstream>
 #include <stdexcept>
 #include <iostream>
+#include <unordered_map>
 
 namespace starmap {
 namespace catalog {
 
 // Costanti per conversione coordinate
 constexpr double DEG_TO_RAD = M_PI / 180.0;
-constexpr double RAD_TO_DEG = 180.0 / M_PI;
+
+// Numero di parametri per ogni query IN (...) della ricerca batch per Gaia ID
+constexpr size_t GAIA_ID_BATCH_SIZE = 256;
+
+// Inserimento condiviso da insertEntry/insertBatch (stesso statement in cache)
+constexpr const char* INSERT_SQL =
+    "INSERT OR REPLACE INTO sao_xmatch "
+    "(source_id, sao, ra_udeg, dec_udeg, mag_mmag, sep_mas, sky_pix) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?);";
+
+// Database legacy (versione 1): tabella gaia_sao_xmatch con coordinate REAL
+constexpr const char* INSERT_XMATCH_SQL =
+    "INSERT OR REPLACE INTO gaia_sao_xmatch "
+    "(gaia_source_id, sao_number, ra, dec, magnitude, separation) "
+    "VALUES (?, ?, ?, ?, ?, ?);";
+
+// Variante per tabelle con colonna sky_pix (schema creato da createNewDatabase)
+constexpr const char* INSERT_XMATCH_PIX_SQL =
+    "INSERT OR REPLACE INTO gaia_sao_xmatch "
+    "(gaia_source_id, sao_number, ra, dec, magnitude, separation, sky_pix) "
+    "VALUES (?, ?, ?, ?, ?, ?, ?);";
+
+/**
+ * @brief Gaia ID con numero SAO: Bloom a blocchi davanti a un array ordinato
+ *
+ * Costruito una volta per file e condiviso, tramite il pool, da tutte le
+ * istanze di GaiaSAODatabase aperte sullo stesso database.
+ */
+struct SaoIdIndex {
+    utils::BlockedBloomFilter filter;
+    std::vector<int64_t> ids;
+    
+    /**
+     * @brief true se il Gaia ID sicuramente non ha un numero SAO
+     */
+    bool hasNoSAO(long long gaiaSourceId) const {
+        if (!filter.mayContain(gaiaSourceId)) return true;
+        return !std::binary_search(ids.begin(), ids.end(), static_cast<int64_t>(gaiaSourceId));
+    }
+};
 
 /**
  * @brief Implementazione privata usando PIMPL pattern
  */
 class GaiaSAODatabase::Impl {
 public:
+    // Connessioni in sola lettura condivise per tutte le ricerche
+    std::shared_ptr<SQLiteConnectionPool> pool;
+    
+    // Connessione in scrittura, aperta solo dalle funzioni di costruzione
     sqlite3* db = nullptr;
     
+    // Backend alternativo: snapshot binario mappato in memoria
+    std::unique_ptr<GaiaSAOSnapshot> snapshot;
+    
+    // Stelle SAO per numero, caricate all'apertura (condivise dal pool)
+    std::shared_ptr<const SAONumberIndex> saoNumbers;
+    
+    // Cache degli statement preparati della connessione in scrittura
+    std::unordered_map<std::string, sqlite3_stmt*> statements;
+    
+    // Versione dello schema (GaiaSAOSchema) e tabelle da cui leggere: nella
+    // versione corrente entrambe sono sao_xmatch, nei database legacy le
+    // ricerche per SAO usano stars e le entry complete gaia_sao_xmatch
+    int schemaVersion = 0;
+    GaiaSAOSchema::Layout lookup;
+    GaiaSAOSchema::Layout entries;
+    
+    // -1 = non ancora verificato
+    int xmatchHasSkyPix = -1;
+    
     ~Impl() {
+        close();
+    }
+    
+    /**
+     * @brief Connessione in lettura dal pool (vuota se il database non è aperto)
+     */
+    SQLiteConnectionPool::Lease reader() const {
+        return pool ? pool->acquire() : SQLiteConnectionPool::Lease();
+    }
+    
+    /**
+     * @brief Apre la connessione in scrittura se non è già aperta
+     */
+    bool writer(const std::string& dbPath) {
+        if (db) return true;
+        if (snapshot || !pool) return false;
+        if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK) {
+            std::cerr << "Cannot open Gaia-SAO database for writing: " << sqlite3_errmsg(db) << std::endl;
+            closeWriter();
+            return false;
+        }
+        return true;
+    }
+    
+    /**
+     * @brief Restituisce lo statement preparato per sql sulla connessione in scrittura
+     */
+    CachedStatement statement(const std::string& sql) {
+        if (!db) return CachedStatement(nullptr);
+        
+        auto it = statements.find(sql);
+        if (it != statements.end()) {
+            return CachedStatement(it->second);
+        }
+        
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v3(db, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT,
+                               &stmt, nullptr) != SQLITE_OK) {
+            return CachedStatement(nullptr);
+        }
+        statements.emplace(sql, stmt);
+        return CachedStatement(stmt);
+    }
+    
+    /**
+     * @brief Finalizza gli statement in cache e chiude la connessione in scrittura
+     */
+    void closeWriter() {
+        for (auto& entry : statements) {
+            sqlite3_finalize(entry.second);
+        }
+        statements.clear();
+        xmatchHasSkyPix = -1;
+        
         if (db) {
             sqlite3_close(db);
+            db = nullptr;
         }
     }
     
+    void close() {
+        snapshot.reset();
+        closeWriter();
+        pool.reset();
+    }
+    
+    /**
+     * @brief Dopo una modifica dello schema le connessioni in lettura vanno rifatte
+     */
+    void schemaChanged() {
+        xmatchHasSkyPix = -1;
+        if (pool) pool->invalidate();
+    }
+    
     /**
-     * @brief Calcola distanza angolare tra due punti sulla sfera celeste
+     * @brief Sceglie le tabelle da leggere in base alla versione dello schema
+     * @return false se il database non contiene tabelle di cross-match
      */
-    static double angularSeparation(double ra1, double dec1, double ra2, double dec2) {
-        // Formula dell'haversine
-        double dRa = (ra2 - ra1) * DEG_TO_RAD;
-        double dDec = (dec2 - dec1) * DEG_TO_RAD;
-        double dec1Rad = dec1 * DEG_TO_RAD;
-        double dec2Rad = dec2 * DEG_TO_RAD;
+    bool selectLayouts(sqlite3* handle, int version) {
+        schemaVersion = version;
+        if (version >= GaiaSAOSchema::VERSION) {
+            lookup = entries = GaiaSAOSchema::current();
+            return true;
+        }
+        if (version <= 0) return false;
         
-        double a = std::sin(dDec / 2.0) * std::sin(dDec / 2.0) +
-                   std::cos(dec1Rad) * std::cos(dec2Rad) *
-                   std::sin(dRa / 2.0) * std::sin(dRa / 2.0);
+        bool hasStars = tableExists(handle, "stars");
+        bool hasXMatch = tableExists(handle, "gaia_sao_xmatch");
+        lookup = hasStars ? GaiaSAOSchema::legacyStars() : GaiaSAOSchema::legacyXMatch();
+        entries = hasXMatch ? GaiaSAOSchema::legacyXMatch() : GaiaSAOSchema::legacyStars();
+        return true;
+    }
+    
+    SpatialQuery& saoPositions(SQLiteConnectionPool::Connection& connection) const {
+        return connection.spatialQuery(lookup.table, lookup.ra, lookup.dec, lookup.sao,
+                                       lookup.condition);
+    }
+    
+    SpatialQuery& entryPositions(SQLiteConnectionPool::Connection& connection) const {
+        return connection.spatialQuery(entries.table, entries.ra, entries.dec,
+                                       entries.entryColumns(), entries.entryCondition());
+    }
+    
+    /**
+     * @brief Verifica se una tabella ha una certa colonna
+     */
+    static bool hasColumn(sqlite3* handle, const std::string& table, const std::string& column) {
+        std::string query = "PRAGMA table_info(" + table + ");";
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(handle, query.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+            return false;
+        }
+        bool found = false;
+        while (!found && sqlite3_step(stmt) == SQLITE_ROW) {
+            const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+            found = name && column == name;
+        }
+        sqlite3_finalize(stmt);
+        return found;
+    }
+    
+    static bool tableExists(sqlite3* handle, const std::string& table) {
+        sqlite3_stmt* stmt = nullptr;
+        const char* query = "SELECT 1 FROM sqlite_master WHERE type='table' AND name=?;";
+        if (sqlite3_prepare_v2(handle, query, -1, &stmt, nullptr) != SQLITE_OK) {
+            return false;
+        }
+        sqlite3_bind_text(stmt, 1, table.c_str(), -1, SQLITE_TRANSIENT);
+        bool exists = (sqlite3_step(stmt) == SQLITE_ROW);
+        sqlite3_finalize(stmt);
+        return exists;
+    }
+    
+    /**
+     * @brief true se gaia_sao_xmatch ha la colonna sky_pix (verifica una volta)
+     */
+    bool xmatchSkyPixColumn() {
+        if (xmatchHasSkyPix < 0) {
+            xmatchHasSkyPix = hasColumn(db, "gaia_sao_xmatch", "sky_pix") ? 1 : 0;
+        }
+        return xmatchHasSkyPix == 1;
+    }
+    
+    /**
+     * @brief Lega una entry a INSERT_SQL (colonne intere della versione corrente)
+     */
+    static void bindScaledEntry(sqlite3_stmt* stmt, const GaiaSAOEntry& entry) {
+        sqlite3_bind_int64(stmt, 1, entry.gaiaSourceId);
+        sqlite3_bind_int(stmt, 2, entry.saoNumber);
+        sqlite3_bind_int64(stmt, 3, GaiaSAOSchema::scaledAngle(entry.ra));
+        sqlite3_bind_int64(stmt, 4, GaiaSAOSchema::scaledAngle(entry.dec));
+        sqlite3_bind_int64(stmt, 5, GaiaSAOSchema::scaledMilli(entry.magnitude));
+        sqlite3_bind_int64(stmt, 6, GaiaSAOSchema::scaledMilli(entry.separation));
+        sqlite3_bind_int64(stmt, 7, SkyIndex::pixelId(entry.ra, entry.dec));
+    }
+    
+    static void bindEntry(sqlite3_stmt* stmt, const GaiaSAOEntry& entry, bool withPixel) {
+        sqlite3_bind_int64(stmt, 1, entry.gaiaSourceId);
+        sqlite3_bind_int(stmt, 2, entry.saoNumber);
+        sqlite3_bind_double(stmt, 3, entry.ra);
+        sqlite3_bind_double(stmt, 4, entry.dec);
+        sqlite3_bind_double(stmt, 5, entry.magnitude);
+        sqlite3_bind_double(stmt, 6, entry.separation);
+        if (withPixel) {
+            sqlite3_bind_int64(stmt, 7, SkyIndex::pixelId(entry.ra, entry.dec));
+        }
+    }
+    
+    /**
+     * @brief Aggiunge e popola la colonna sky_pix con indice coprente
+     * @param coveringColumns Colonne incluse nell'indice dopo (sky_pix, ra, dec)
+     */
+    bool buildPixelIndex(const std::string& table, const std::string& raColumn,
+                         const std::string& decColumn, const std::string& coveringColumns) {
+        if (!tableExists(db, table)) return true;
         
-        double c = 2.0 * std::atan2(std::sqrt(a), std::sqrt(1.0 - a));
+        std::string sql;
+        if (!hasColumn(db, table, "sky_pix")) {
+            sql += "ALTER TABLE " + table + " ADD COLUMN sky_pix INTEGER;";
+        }
+        sql += "UPDATE " + table + " SET sky_pix = starmap_sky_pix(" + raColumn + ", " +
+               decColumn + ") WHERE sky_pix IS NULL;";
+        sql += "CREATE INDEX IF NOT EXISTS " + SpatialQuery::pixelIndexName(table) +
+               " ON " + table + "(sky_pix, " + raColumn + ", " + decColumn +
+               (coveringColumns.empty() ? "" : ", " + coveringColumns) + ");";
         
-        return c * RAD_TO_DEG * 3600.0; // Ritorna in arcsec
+        char* errMsg = nullptr;
+        if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+            std::cerr << "SQL error creating sky pixel index on " << table << ": "
+                      << errMsg << std::endl;
+            sqlite3_free(errMsg);
+            return false;
+        }
+        return true;
+    }
+    
+    /**
+     * @brief Carica in memoria i Gaia ID che hanno un numero SAO
+     *
+     * Se la tabella non è leggibile il filtro resta disattivato (nullptr)
+     * e le ricerche vanno sempre al database.
+     */
+    static std::shared_ptr<SaoIdIndex> loadSaoIdIndex(SQLiteConnectionPool::Connection& connection,
+                                                      const GaiaSAOSchema::Layout& layout) {
+        sqlite3_stmt* stmt = nullptr;
+        std::string query = layout.sourceIdsSql();
+        if (sqlite3_prepare_v2(connection.handle(), query.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+            return nullptr;
+        }
+        auto index = std::make_shared<SaoIdIndex>();
+        auto& ids = index->ids;
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            ids.push_back(sqlite3_column_int64(stmt, 0));
+        }
+        sqlite3_finalize(stmt);
+        
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        ids.shrink_to_fit();
+        
+        index->filter.build(ids.data(), ids.size());
+        return index;
+    }
+    
+    /**
+     * @brief Carica la tabella delle stelle SAO per numero
+     *
+     * Il tipo spettrale viene letto se la tabella ha una colonna
+     * spectral_type (o sp_type).
+     */
+    static std::shared_ptr<SAONumberIndex> loadSaoNumberIndex(SQLiteConnectionPool::Connection& connection,
+                                                              const GaiaSAOSchema::Layout& layout) {
+        auto start = std::chrono::steady_clock::now();
+        
+        std::string spectralColumn;
+        sqlite3_stmt* stmt = nullptr;
+        std::string tableInfo = "PRAGMA table_info(" + layout.table + ");";
+        if (sqlite3_prepare_v2(connection.handle(), tableInfo.c_str(), -1, &stmt,
+                               nullptr) == SQLITE_OK) {
+            while (sqlite3_step(stmt) == SQLITE_ROW) {
+                const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+                if (name && (std::string(name) == "spectral_type" || std::string(name) == "sp_type")) {
+                    spectralColumn = name;
+                }
+            }
+            sqlite3_finalize(stmt);
+        }
+        
+        std::string query = "SELECT " + layout.sao + ", " + layout.ra + ", " + layout.dec + ", " +
+                            layout.magnitude + ", " + layout.sourceId +
+                            (spectralColumn.empty() ? std::string() : ", " + spectralColumn) +
+                            " FROM " + layout.table + " WHERE " + layout.condition + ";";
+        if (sqlite3_prepare_v2(connection.handle(), query.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+            return nullptr;
+        }
+        
+        auto index = std::make_shared<SAONumberIndex>();
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            if (sqlite3_column_type(stmt, 1) == SQLITE_NULL ||
+                sqlite3_column_type(stmt, 2) == SQLITE_NULL) continue;
+            
+            double magnitude = sqlite3_column_type(stmt, 3) == SQLITE_NULL
+                ? 99.0 : sqlite3_column_double(stmt, 3);
+            const char* spectralType = spectralColumn.empty() ? nullptr
+                : reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5));
+            // Le stelle senza controparte Gaia hanno chiave -SAO
+            index->add(sqlite3_column_int(stmt, 0),
+                       sqlite3_column_double(stmt, 1),
+                       sqlite3_column_double(stmt, 2),
+                       magnitude,
+                       std::max<long long>(0, sqlite3_column_int64(stmt, 4)),
+                       spectralType ? spectralType : "");
+        }
+        sqlite3_finalize(stmt);
+        
+        index->finish();
+        index->setLoadSeconds(std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count());
+        return index;
+    }
+    
+    /**
+     * @brief Tabella delle stelle SAO costruita dalle righe dello snapshot
+     */
+    static std::shared_ptr<SAONumberIndex> loadSaoNumberIndex(const GaiaSAOSnapshot& snapshot) {
+        auto start = std::chrono::steady_clock::now();
+        auto index = std::make_shared<SAONumberIndex>();
+        for (size_t row = 0; row < snapshot.size(); ++row) {
+            index->add(snapshot.saoNumber(row), snapshot.ra(row), snapshot.dec(row),
+                       snapshot.magnitude(row), snapshot.sourceId(row));
+        }
+        index->finish();
+        index->setLoadSeconds(std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count());
+        return index;
+    }
+    
+    /**
+     * @brief Descrizione di dimensione, memoria e tempo di caricamento della tabella
+     */
+    std::string saoNumberStatistics() const {
+        std::ostringstream stats;
+        if (saoNumbers) {
+            stats << "SAO number index: " << saoNumbers->size() << " stars, "
+                  << (saoNumbers->memoryUsage() / 1024.0 / 1024.0) << " MB, loaded in "
+                  << (saoNumbers->loadSeconds() * 1000.0) << " ms\n";
+        } else {
+            stats << "SAO number index: not loaded\n";
+        }
+        return stats.str();
+    }
+    
+    /**
+     * @brief Filtro dei Gaia ID condiviso dal pool (nullptr se non disponibile)
+     */
+    std::shared_ptr<const SaoIdIndex> saoIdIndex(SQLiteConnectionPool::Connection& connection) const {
+        const auto& layout = lookup;
+        return pool->shared<SaoIdIndex>("gaia_sao_ids", connection,
+            [&layout](SQLiteConnectionPool::Connection& c) { return loadSaoIdIndex(c, layout); });
     }
 };
 
@@ -50,65 +419,157 @@ GaiaSAODatabase::GaiaSAODatabase(const std::string& dbPath)
     , dbPath_(dbPath)
     , available_(false) {
     
-    // Prova ad aprire il database
-    int rc = sqlite3_open(dbPath_.c_str(), &pImpl_->db);
-    
-    if (rc != SQLITE_OK) {
-        std::cerr << "Cannot open Gaia-SAO database: " << sqlite3_errmsg(pImpl_->db) << std::endl;
-        if (pImpl_->db) {
-            sqlite3_close(pImpl_->db);
-            pImpl_->db = nullptr;
+    // Snapshot binario: nessun accesso SQLite
+    if (GaiaSAOSnapshot::isSnapshotFile(dbPath_)) {
+        pImpl_->snapshot = std::make_unique<GaiaSAOSnapshot>(dbPath_);
+        available_ = pImpl_->snapshot->isOpen();
+        if (available_) {
+            pImpl_->saoNumbers = Impl::loadSaoNumberIndex(*pImpl_->snapshot);
+            std::cout << "Gaia-SAO snapshot recognized in: " << dbPath_ << std::endl;
         }
         return;
     }
     
-    // Verifica che la tabella esista
-    const char* checkQuery = "SELECT name FROM sqlite_master WHERE type='table' AND name='stars';";
-    sqlite3_stmt* stmt;
+    // Connessioni in sola lettura dal pool condiviso per questo file
+    pImpl_->pool = SQLiteConnectionPool::forPath(dbPath_);
+    auto lease = pImpl_->reader();
     
-    if (sqlite3_prepare_v2(pImpl_->db, checkQuery, -1, &stmt, nullptr) == SQLITE_OK) {
-        if (sqlite3_step(stmt) == SQLITE_ROW) {
-            available_ = true;
-        }
-        sqlite3_finalize(stmt);
-    } else {
-        std::cerr << "Failed to prepare table check query: " << sqlite3_errmsg(pImpl_->db) << std::endl;
+    if (!lease) {
+        std::cerr << "Cannot open Gaia-SAO database: " << dbPath_ << std::endl;
+        return;
     }
     
+    // Versione dello schema: la corrente o le tabelle legacy stars/gaia_sao_xmatch
+    int version = GaiaSAOSchema::version(lease->handle());
+    if (version > GaiaSAOSchema::VERSION) {
+        std::cerr << "Gaia-SAO database schema version " << version
+                  << " is newer than supported (" << GaiaSAOSchema::VERSION << "): "
+                  << dbPath_ << std::endl;
+        return;
+    }
+    available_ = pImpl_->selectLayouts(lease->handle(), version);
+    
     if (!available_) {
-        std::cerr << "Stellar crossref database table 'stars' not found in: " << dbPath_ << std::endl;
+        std::cerr << "Gaia-SAO cross-match tables not found in: " << dbPath_ << std::endl;
     } else {
-        std::cout << "Gaia-SAO local database recognized in: " << dbPath_ << std::endl;
+        // Filtro e tabella SAO sono condivisi: solo la prima istanza sul
+        // file li costruisce
+        pImpl_->saoIdIndex(*lease);
+        const auto& layout = pImpl_->lookup;
+        pImpl_->saoNumbers = pImpl_->pool->shared<SAONumberIndex>(
+            "sao_numbers", *lease, [&layout](SQLiteConnectionPool::Connection& connection) {
+                return Impl::loadSaoNumberIndex(connection, layout);
+            });
+        std::cout << "Gaia-SAO local database recognized in: " << dbPath_;
+        if (version < GaiaSAOSchema::VERSION) {
+            std::cout << " (legacy schema, convert with starmap_migrate_xmatch)";
+        }
+        std::cout << std::endl;
     }
 }
 
 GaiaSAODatabase::~GaiaSAODatabase() = default;
 
 bool GaiaSAODatabase::isAvailable() const {
-    return available_ && pImpl_->db != nullptr;
+    return available_ && (pImpl_->pool != nullptr || pImpl_->snapshot != nullptr);
 }
 
 std::optional<int> GaiaSAODatabase::findSAOByGaiaId(long long gaiaSourceId) const {
     if (!isAvailable()) return std::nullopt;
     
-    const char* query = "SELECT sao FROM stars WHERE gaia_dr3 = ? AND sao IS NOT NULL AND sao > 0 LIMIT 1;";
-    sqlite3_stmt* stmt;
-    
-    if (sqlite3_prepare_v2(pImpl_->db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-        return std::nullopt;
+    if (pImpl_->snapshot) {
+        auto row = pImpl_->snapshot->findBySourceId(gaiaSourceId);
+        if (!row) return std::nullopt;
+        return pImpl_->snapshot->saoNumber(*row);
     }
     
-    sqlite3_bind_int64(stmt, 1, gaiaSourceId);
+    auto lease = pImpl_->reader();
+    if (!lease) return std::nullopt;
+    
+    // La maggior parte delle sorgenti Gaia non ha un numero SAO:
+    // i miss vengono risolti in memoria senza interrogare SQLite
+    auto saoIds = pImpl_->saoIdIndex(*lease);
+    if (saoIds && saoIds->hasNoSAO(gaiaSourceId)) return std::nullopt;
+    
+    auto stmt = lease->statement(pImpl_->lookup.saoBySourceIdSql());
+    if (!stmt) return std::nullopt;
+    
+    sqlite3_bind_int64(stmt.get(), 1, gaiaSourceId);
     
     std::optional<int> result;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
-        result = sqlite3_column_int(stmt, 0);
+    if (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+        result = sqlite3_column_int(stmt.get(), 0);
     }
     
-    sqlite3_finalize(stmt);
     return result;
 }
 
+std::vector<std::optional<int>> GaiaSAODatabase::findSAOByGaiaIds(
+    const long long* gaiaSourceIds, size_t count) const {
+    
+    std::vector<std::optional<int>> results(count);
+    if (!isAvailable() || count == 0) return results;
+    
+    if (pImpl_->snapshot) {
+        for (size_t i = 0; i < count; ++i) {
+            results[i] = findSAOByGaiaId(gaiaSourceIds[i]);
+        }
+        return results;
+    }
+    
+    // Un solo statement "IN (?, ?, ...)" a dimensione fissa, riusato per
+    // ogni blocco: l'ultimo blocco viene completato con ID inesistenti (-1)
+    const std::string query = pImpl_->lookup.saoBySourceIdsSql(GAIA_ID_BATCH_SIZE);
+    
+    auto lease = pImpl_->reader();
+    if (!lease) return results;
+    
+    // Solo gli ID che superano il filtro in memoria vanno al database
+    auto saoIds = pImpl_->saoIdIndex(*lease);
+    std::vector<long long> candidates;
+    candidates.reserve(saoIds ? count / 8 + 16 : count);
+    for (size_t i = 0; i < count; ++i) {
+        if (!saoIds || !saoIds->hasNoSAO(gaiaSourceIds[i])) {
+            candidates.push_back(gaiaSourceIds[i]);
+        }
+    }
+    if (candidates.empty()) return results;
+    
+    std::unordered_map<long long, int> found;
+    found.reserve(candidates.size());
+    
+    const size_t numCandidates = candidates.size();
+    for (size_t start = 0; start < numCandidates; start += GAIA_ID_BATCH_SIZE) {
+        auto stmt = lease->statement(query);
+        if (!stmt) return results;
+        
+        size_t end = std::min(start + GAIA_ID_BATCH_SIZE, numCandidates);
+        for (size_t i = 0; i < GAIA_ID_BATCH_SIZE; ++i) {
+            long long id = (start + i < end) ? candidates[start + i] : -1;
+            sqlite3_bind_int64(stmt.get(), static_cast<int>(i + 1), id);
+        }
+        
+        while (sqlite3_step(stmt.get()) == SQLITE_ROW) {
+            found.emplace(sqlite3_column_int64(stmt.get(), 0),
+                          sqlite3_column_int(stmt.get(), 1));
+        }
+    }
+    
+    for (size_t i = 0; i < count; ++i) {
+        auto it = found.find(gaiaSourceIds[i]);
+        if (it != found.end()) {
+            results[i] = it->second;
+        }
+    }
+    
+    return results;
+}
+
+std::vector<std::optional<int>> GaiaSAODatabase::findSAOByGaiaIds(
+    const std::vector<long long>& gaiaSourceIds) const {
+    return findSAOByGaiaIds(gaiaSourceIds.data(), gaiaSourceIds.size());
+}
+
 std::optional<int> GaiaSAODatabase::findSAOByCoordinates(
     const core::EquatorialCoordinates& coords,
     double radiusArcsec) const {
@@ -118,87 +579,185 @@ std::optional<int> GaiaSAODatabase::findSAOByCoordinates(
     double ra = coords.getRightAscension();
     double dec = coords.getDeclination();
     
-    // Converti raggio in gradi per bounding box approssimato
-    double radiusDeg = radiusArcsec / 3600.0;
-    double raMin = ra - radiusDeg / std::cos(dec * DEG_TO_RAD);
-    double raMax = ra + radiusDeg / std::cos(dec * DEG_TO_RAD);
-    double decMin = dec - radiusDeg;
-    double decMax = dec + radiusDeg;
-    
-    // Query con bounding box
-    const char* query = R"(
-        SELECT sao, ra_deg, dec_deg 
-        FROM stars 
-        WHERE ra_deg BETWEEN ? AND ? 
-          AND dec_deg BETWEEN ? AND ?
-          AND sao IS NOT NULL AND sao > 0
-        ORDER BY magnitude
-        LIMIT 50;
-    )";
-    
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(pImpl_->db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-        return std::nullopt;
+    // La più vicina per corda tra versori: nessuna trigonometria per
+    // candidato, ordinamento identico a quello per separazione
+    const auto target = core::UnitVector::fromRaDec(ra, dec);
+    const double maxChord = core::chordSquaredForSeparation(radiusArcsec / 3600.0);
+    
+    if (pImpl_->snapshot) {
+        const auto& snapshot = *pImpl_->snapshot;
+        std::optional<int> bestMatch;
+        double minChord = maxChord;
+        snapshot.forEachInCone(ra, dec, radiusArcsec / 3600.0, [&](size_t row) {
+            double chord = target.chordSquared(snapshot.unitVector(row));
+            if (chord < minChord) {
+                minChord = chord;
+                bestMatch = snapshot.saoNumber(row);
+            }
+        });
+        return bestMatch;
     }
     
-    sqlite3_bind_double(stmt, 1, raMin);
-    sqlite3_bind_double(stmt, 2, raMax);
-    sqlite3_bind_double(stmt, 3, decMin);
-    sqlite3_bind_double(stmt, 4, decMax);
+    auto lease = pImpl_->reader();
+    if (!lease) return std::nullopt;
+    
+    std::vector<int> saoNumbers;
+    std::vector<double> starRa, starDec;
+    auto keep = pImpl_->saoPositions(*lease).cone(ra, dec, radiusArcsec / 3600.0,
+        [&](sqlite3_stmt* stmt) {
+            starRa.push_back(sqlite3_column_double(stmt, 0));
+            starDec.push_back(sqlite3_column_double(stmt, 1));
+            saoNumbers.push_back(sqlite3_column_int(stmt, SpatialQuery::FIRST_COLUMN));
+        });
     
     std::optional<int> bestMatch;
-    double minSeparation = radiusArcsec;
+    double minChord = maxChord;
     
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        int saoNum = sqlite3_column_int(stmt, 0);
-        double starRa = sqlite3_column_double(stmt, 1);
-        double starDec = sqlite3_column_double(stmt, 2);
+    for (size_t i = 0; i < keep.size(); ++i) {
+        if (!keep[i]) continue;
         
-        double separation = Impl::angularSeparation(ra, dec, starRa, starDec);
-        
-        if (separation < minSeparation) {
-            minSeparation = separation;
-            bestMatch = saoNum;
+        double chord = target.chordSquared(core::UnitVector::fromRaDec(starRa[i], starDec[i]));
+        if (chord < minChord) {
+            minChord = chord;
+            bestMatch = saoNumbers[i];
         }
     }
     
-    sqlite3_finalize(stmt);
     return bestMatch;
 }
 
+std::vector<std::optional<int>> GaiaSAODatabase::findSAOByCoordinates(
+    const std::vector<core::EquatorialCoordinates>& coords,
+    double radiusArcsec) const {
+    
+    std::vector<std::optional<int>> results(coords.size());
+    if (!isAvailable() || coords.empty()) return results;
+    
+    // Con lo snapshot ogni ricerca è già in memoria, senza query
+    if (pImpl_->snapshot) {
+        for (size_t i = 0; i < coords.size(); ++i) {
+            results[i] = findSAOByCoordinates(coords[i], radiusArcsec);
+        }
+        return results;
+    }
+    
+    double radiusDeg = radiusArcsec / 3600.0;
+    
+    // Regione che contiene tutte le posizioni: declinazione min/max e
+    // semi-ampiezza in RA attorno alla prima posizione (gestisce lo 0h)
+    double refRa = coords.front().getRightAscension();
+    double decMin = 90.0, decMax = -90.0, raSpan = 0.0;
+    for (const auto& c : coords) {
+        decMin = std::min(decMin, c.getDeclination());
+        decMax = std::max(decMax, c.getDeclination());
+        double dRa = std::fmod(c.getRightAscension() - refRa + 540.0, 360.0) - 180.0;
+        raSpan = std::max(raSpan, std::abs(dRa));
+    }
+    decMin = std::max(-90.0, decMin - radiusDeg);
+    decMax = std::min(90.0, decMax + radiusDeg);
+    
+    double maxAbsDec = std::max(std::abs(decMin), std::abs(decMax));
+    double raHalf = (maxAbsDec >= 89.9)
+        ? 180.0
+        : raSpan + radiusDeg / std::cos(maxAbsDec * DEG_TO_RAD);
+    
+    struct Candidate {
+        double dec;
+        core::UnitVector position;
+        int sao;
+    };
+    std::vector<Candidate> candidates;
+    {
+        auto lease = pImpl_->reader();
+        if (!lease) return results;
+        pImpl_->saoPositions(*lease).box(refRa - raHalf, refRa + raHalf, decMin, decMax,
+            [&](sqlite3_stmt* stmt) {
+                double starRa = sqlite3_column_double(stmt, 0);
+                double starDec = sqlite3_column_double(stmt, 1);
+                candidates.push_back({starDec, core::UnitVector::fromRaDec(starRa, starDec),
+                                      sqlite3_column_int(stmt, SpatialQuery::FIRST_COLUMN)});
+            });
+    }
+    
+    // Match in memoria: candidati ordinati per declinazione, per ogni
+    // posizione si esamina solo la fascia [dec - r, dec + r]; i versori
+    // dei candidati sono calcolati una volta, il confronto è sulla corda
+    const double maxChord = core::chordSquaredForSeparation(radiusDeg);
+    std::sort(candidates.begin(), candidates.end(),
+              [](const Candidate& a, const Candidate& b) { return a.dec < b.dec; });
+    
+    for (size_t i = 0; i < coords.size(); ++i) {
+        double dec = coords[i].getDeclination();
+        const auto target = core::UnitVector::fromEquatorial(coords[i]);
+        
+        auto it = std::lower_bound(candidates.begin(), candidates.end(), dec - radiusDeg,
+                                   [](const Candidate& c, double d) { return c.dec < d; });
+        
+        double minChord = maxChord;
+        for (; it != candidates.end() && it->dec <= dec + radiusDeg; ++it) {
+            double chord = target.chordSquared(it->position);
+            if (chord < minChord) {
+                minChord = chord;
+                results[i] = it->sao;
+            }
+        }
+    }
+    
+    return results;
+}
+
 std::optional<GaiaSAOEntry> GaiaSAODatabase::getEntry(long long gaiaSourceId) const {
     if (!isAvailable()) return std::nullopt;
     
-    const char* query = R"(
-        SELECT gaia_source_id, sao_number, ra, dec, magnitude, separation
-        FROM gaia_sao_xmatch 
-        WHERE gaia_source_id = ? 
-        LIMIT 1;
-    )";
-    
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(pImpl_->db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-        return std::nullopt;
+    if (pImpl_->snapshot) {
+        auto row = pImpl_->snapshot->findBySourceId(gaiaSourceId);
+        if (!row) return std::nullopt;
+        return pImpl_->snapshot->entry(*row);
     }
     
-    sqlite3_bind_int64(stmt, 1, gaiaSourceId);
+    auto lease = pImpl_->reader();
+    if (!lease) return std::nullopt;
+    
+    auto stmt = lease->statement(pImpl_->entries.entryBySourceIdSql());
+    if (!stmt) return std::nullopt;
+    
+    sqlite3_bind_int64(stmt.get(), 1, gaiaSourceId);
     
     std::optional<GaiaSAOEntry> result;
-    if (sqlite3_step(stmt) == SQLITE_ROW) {
+    if (sqlite3_step(stmt.get()) == SQLITE_ROW) {
         GaiaSAOEntry entry;
-        entry.gaiaSourceId = sqlite3_column_int64(stmt, 0);
-        entry.saoNumber = sqlite3_column_int(stmt, 1);
-        entry.ra = sqlite3_column_double(stmt, 2);
-        entry.dec = sqlite3_column_double(stmt, 3);
-        entry.magnitude = sqlite3_column_double(stmt, 4);
-        entry.separation = sqlite3_column_double(stmt, 5);
+        entry.gaiaSourceId = sqlite3_column_int64(stmt.get(), 0);
+        entry.saoNumber = sqlite3_column_int(stmt.get(), 1);
+        entry.ra = sqlite3_column_double(stmt.get(), 2);
+        entry.dec = sqlite3_column_double(stmt.get(), 3);
+        entry.magnitude = sqlite3_column_double(stmt.get(), 4);
+        entry.separation = sqlite3_column_double(stmt.get(), 5);
         result = entry;
     }
     
-    sqlite3_finalize(stmt);
     return result;
 }
 
+std::optional<GaiaSAOEntry> GaiaSAODatabase::findBySAONumber(int saoNumber) const {
+    if (!isAvailable() || !pImpl_->saoNumbers) return std::nullopt;
+    
+    const auto* star = pImpl_->saoNumbers->find(saoNumber);
+    if (!star) return std::nullopt;
+    
+    GaiaSAOEntry entry;
+    entry.gaiaSourceId = star->gaiaSourceId;
+    entry.saoNumber = saoNumber;
+    entry.ra = star->ra;
+    entry.dec = star->dec;
+    entry.magnitude = star->magnitude;
+    entry.separation = 0.0;
+    return entry;
+}
+
+std::shared_ptr<const SAONumberIndex> GaiaSAODatabase::getSAONumberIndex() const {
+    return isAvailable() ? pImpl_->saoNumbers : nullptr;
+}
+
 std::vector<GaiaSAOEntry> GaiaSAODatabase::coneSearch(
     const core::EquatorialCoordinates& coords,
     double radiusDegrees,
@@ -210,49 +769,42 @@ std::vector<GaiaSAOEntry> GaiaSAODatabase::coneSearch(
     double ra = coords.getRightAscension();
     double dec = coords.getDeclination();
     
-    // Bounding box
-    double raMin = ra - radiusDegrees / std::cos(dec * DEG_TO_RAD);
-    double raMax = ra + radiusDegrees / std::cos(dec * DEG_TO_RAD);
-    double decMin = dec - radiusDegrees;
-    double decMax = dec + radiusDegrees;
-    
-    const char* query = R"(
-        SELECT gaia_source_id, sao_number, ra, dec, magnitude, separation
-        FROM gaia_sao_xmatch 
-        WHERE ra BETWEEN ? AND ? 
-          AND dec BETWEEN ? AND ?
-        ORDER BY magnitude
-        LIMIT ?;
-    )";
-    
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(pImpl_->db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-        return results;
-    }
-    
-    sqlite3_bind_double(stmt, 1, raMin);
-    sqlite3_bind_double(stmt, 2, raMax);
-    sqlite3_bind_double(stmt, 3, decMin);
-    sqlite3_bind_double(stmt, 4, decMax);
-    sqlite3_bind_int(stmt, 5, maxResults);
-    
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        GaiaSAOEntry entry;
-        entry.gaiaSourceId = sqlite3_column_int64(stmt, 0);
-        entry.saoNumber = sqlite3_column_int(stmt, 1);
-        entry.ra = sqlite3_column_double(stmt, 2);
-        entry.dec = sqlite3_column_double(stmt, 3);
-        entry.magnitude = sqlite3_column_double(stmt, 4);
-        entry.separation = sqlite3_column_double(stmt, 5);
+    if (pImpl_->snapshot) {
+        const auto& snapshot = *pImpl_->snapshot;
+        snapshot.forEachInCone(ra, dec, radiusDegrees, [&](size_t row) {
+            results.push_back(snapshot.entry(row));
+        });
+    } else {
+        auto lease = pImpl_->reader();
+        if (!lease) return results;
         
-        // Verifica che sia realmente nel cono
-        double separation = Impl::angularSeparation(ra, dec, entry.ra, entry.dec);
-        if (separation <= radiusDegrees * 3600.0) {
-            results.push_back(entry);
+        std::vector<GaiaSAOEntry> candidates;
+        auto keep = pImpl_->entryPositions(*lease).cone(ra, dec, radiusDegrees,
+            [&](sqlite3_stmt* stmt) {
+                GaiaSAOEntry entry;
+                entry.ra = sqlite3_column_double(stmt, 0);
+                entry.dec = sqlite3_column_double(stmt, 1);
+                entry.gaiaSourceId = sqlite3_column_int64(stmt, SpatialQuery::FIRST_COLUMN);
+                entry.saoNumber = sqlite3_column_int(stmt, SpatialQuery::FIRST_COLUMN + 1);
+                entry.magnitude = sqlite3_column_double(stmt, SpatialQuery::FIRST_COLUMN + 2);
+                entry.separation = sqlite3_column_double(stmt, SpatialQuery::FIRST_COLUMN + 3);
+                candidates.push_back(entry);
+            });
+        
+        for (size_t i = 0; i < candidates.size(); ++i) {
+            if (keep[i]) results.push_back(candidates[i]);
         }
     }
     
-    sqlite3_finalize(stmt);
+    // Le più luminose per prime, come nella query originale
+    std::stable_sort(results.begin(), results.end(),
+                     [](const GaiaSAOEntry& a, const GaiaSAOEntry& b) {
+                         return a.magnitude < b.magnitude;
+                     });
+    if (maxResults >= 0 && results.size() > static_cast<size_t>(maxResults)) {
+        results.resize(maxResults);
+    }
+    
     return results;
 }
 
@@ -261,13 +813,26 @@ std::string GaiaSAODatabase::getStatistics() const {
         return "Database not available";
     }
     
+    if (pImpl_->snapshot) {
+        return pImpl_->snapshot->getStatistics() + pImpl_->saoNumberStatistics();
+    }
+    
+    auto lease = pImpl_->reader();
+    if (!lease) {
+        return "Database not available";
+    }
+    sqlite3* db = lease->handle();
+    
     std::ostringstream stats;
+    const auto& entries = pImpl_->entries;
+    
+    stats << "Schema version: " << pImpl_->schemaVersion << " (table " << entries.table << ")\n";
     
     // Conta totale entry
-    const char* countQuery = "SELECT COUNT(*) FROM gaia_sao_xmatch;";
+    std::string countQuery = "SELECT COUNT(*) FROM " + entries.table + ";";
     sqlite3_stmt* stmt;
     
-    if (sqlite3_prepare_v2(pImpl_->db, countQuery, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (sqlite3_prepare_v2(db, countQuery.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
         if (sqlite3_step(stmt) == SQLITE_ROW) {
             int count = sqlite3_column_int(stmt, 0);
             stats << "Total entries: " << count << "\n";
@@ -276,8 +841,9 @@ std::string GaiaSAODatabase::getStatistics() const {
     }
     
     // Range magnitudini
-    const char* magQuery = "SELECT MIN(magnitude), MAX(magnitude), AVG(magnitude) FROM gaia_sao_xmatch;";
-    if (sqlite3_prepare_v2(pImpl_->db, magQuery, -1, &stmt, nullptr) == SQLITE_OK) {
+    std::string magQuery = "SELECT MIN(" + entries.magnitude + "), MAX(" + entries.magnitude +
+                           "), AVG(" + entries.magnitude + ") FROM " + entries.table + ";";
+    if (sqlite3_prepare_v2(db, magQuery.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
         if (sqlite3_step(stmt) == SQLITE_ROW) {
             double minMag = sqlite3_column_double(stmt, 0);
             double maxMag = sqlite3_column_double(stmt, 1);
@@ -290,7 +856,7 @@ std::string GaiaSAODatabase::getStatistics() const {
     
     // Dimensione database
     const char* sizeQuery = "SELECT page_count * page_size as size FROM pragma_page_count(), pragma_page_size();";
-    if (sqlite3_prepare_v2(pImpl_->db, sizeQuery, -1, &stmt, nullptr) == SQLITE_OK) {
+    if (sqlite3_prepare_v2(db, sizeQuery, -1, &stmt, nullptr) == SQLITE_OK) {
         if (sqlite3_step(stmt) == SQLITE_ROW) {
             long long size = sqlite3_column_int64(stmt, 0);
             stats << "Database size: " << (size / 1024.0 / 1024.0) << " MB\n";
@@ -298,16 +864,34 @@ std::string GaiaSAODatabase::getStatistics() const {
         sqlite3_finalize(stmt);
     }
     
+    // Filtro in memoria dei Gaia ID con SAO
+    if (auto saoIds = pImpl_->saoIdIndex(*lease)) {
+        const auto& filter = saoIds->filter;
+        stats << "Gaia ID filter: " << saoIds->ids.size() << " IDs with SAO, "
+              << "bloom " << (filter.memoryUsage() / 1024.0) << " KB "
+              << "(FPR " << (filter.estimatedFalsePositiveRate() * 100.0) << "%), "
+              << "sorted IDs " << (saoIds->ids.capacity() * sizeof(int64_t) / 1024.0) << " KB\n";
+    } else {
+        stats << "Gaia ID filter: not loaded\n";
+    }
+    stats << pImpl_->saoNumberStatistics();
+    
     return stats.str();
 }
 
 bool GaiaSAODatabase::verifyIntegrity() const {
     if (!isAvailable()) return false;
     
+    // Lo snapshot è validato (header e sezioni) all'apertura
+    if (pImpl_->snapshot) return pImpl_->snapshot->isOpen();
+    
+    auto lease = pImpl_->reader();
+    if (!lease) return false;
+    
     const char* integrityQuery = "PRAGMA integrity_check;";
     sqlite3_stmt* stmt;
     
-    if (sqlite3_prepare_v2(pImpl_->db, integrityQuery, -1, &stmt, nullptr) != SQLITE_OK) {
+    if (sqlite3_prepare_v2(lease->handle(), integrityQuery, -1, &stmt, nullptr) != SQLITE_OK) {
         return false;
     }
     
@@ -321,14 +905,55 @@ bool GaiaSAODatabase::verifyIntegrity() const {
     return isOk;
 }
 
+bool GaiaSAODatabase::isSnapshot() const {
+    return pImpl_->snapshot != nullptr;
+}
+
+bool GaiaSAODatabase::exportSnapshot(const std::string& snapshotPath) const {
+    auto lease = isAvailable() ? pImpl_->reader() : SQLiteConnectionPool::Lease();
+    if (!lease) {
+        std::cerr << "Snapshot export requires an open SQLite database" << std::endl;
+        return false;
+    }
+    
+    // Sorgente: le entry complete se presenti, altrimenti (database legacy
+    // senza gaia_sao_xmatch popolata) le stelle con SAO della tabella stars
+    std::vector<GaiaSAOEntry> entries;
+    for (const auto* layout : {&pImpl_->entries, &pImpl_->lookup}) {
+        std::string query = layout->entriesSql();
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(lease->handle(), query.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+            continue;
+        }
+        while (sqlite3_step(stmt) == SQLITE_ROW) {
+            GaiaSAOEntry entry;
+            entry.gaiaSourceId = sqlite3_column_int64(stmt, 0);
+            entry.saoNumber = sqlite3_column_int(stmt, 1);
+            entry.ra = sqlite3_column_double(stmt, 2);
+            entry.dec = sqlite3_column_double(stmt, 3);
+            entry.magnitude = sqlite3_column_double(stmt, 4);
+            entry.separation = sqlite3_column_double(stmt, 5);
+            entries.push_back(entry);
+        }
+        sqlite3_finalize(stmt);
+        
+        if (!entries.empty()) break;
+    }
+    
+    if (entries.empty()) {
+        std::cerr << "No Gaia-SAO entries to export from: " << dbPath_ << std::endl;
+        return false;
+    }
+    
+    return GaiaSAOSnapshot::write(snapshotPath, entries);
+}
+
 // ========== Funzioni per costruzione database ==========
 
 bool GaiaSAODatabase::createNewDatabase() {
-    // Se il database esiste già, chiudilo
-    if (pImpl_->db) {
-        sqlite3_close(pImpl_->db);
-        pImpl_->db = nullptr;
-    }
+    // Se il database esiste già, chiudilo (insieme agli statement in cache)
+    pImpl_->close();
+    available_ = false;
     
     // Crea nuovo database
     int rc = sqlite3_open(dbPath_.c_str(), &pImpl_->db);
@@ -337,118 +962,85 @@ bool GaiaSAODatabase::createNewDatabase() {
         return false;
     }
     
-    // Schema della tabella
-    const char* createTableSQL = R"(
-        CREATE TABLE IF NOT EXISTS gaia_sao_xmatch (
-            gaia_source_id INTEGER PRIMARY KEY,
-            sao_number INTEGER NOT NULL,
-            ra REAL NOT NULL,
-            dec REAL NOT NULL,
-            magnitude REAL,
-            separation REAL,
-            created_at TEXT DEFAULT CURRENT_TIMESTAMP
-        );
-    )";
-    
-    char* errMsg = nullptr;
-    rc = sqlite3_exec(pImpl_->db, createTableSQL, nullptr, nullptr, &errMsg);
-    
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL error creating table: " << errMsg << std::endl;
-        sqlite3_free(errMsg);
+    // Schema della versione corrente (tabella sao_xmatch e metadata)
+    if (!GaiaSAOSchema::create(pImpl_->db)) {
         return false;
     }
     
-    // Crea tabella metadata
-    const char* createMetaSQL = R"(
-        CREATE TABLE IF NOT EXISTS metadata (
-            key TEXT PRIMARY KEY,
-            value TEXT
-        );
-        INSERT OR REPLACE INTO metadata (key, value) VALUES ('version', '1.0');
-        INSERT OR REPLACE INTO metadata (key, value) VALUES ('created', datetime('now'));
-    )";
-    
-    rc = sqlite3_exec(pImpl_->db, createMetaSQL, nullptr, nullptr, &errMsg);
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL error creating metadata: " << errMsg << std::endl;
-        sqlite3_free(errMsg);
-        return false;
-    }
+    // Le letture ripartono da connessioni aperte sul nuovo schema
+    pImpl_->pool = SQLiteConnectionPool::forPath(dbPath_);
+    pImpl_->schemaChanged();
+    pImpl_->selectLayouts(pImpl_->db, GaiaSAOSchema::VERSION);
     
     available_ = true;
     return true;
 }
 
 bool GaiaSAODatabase::insertEntry(const GaiaSAOEntry& entry) {
-    if (!pImpl_->db) return false;
+    if (!pImpl_->writer(dbPath_)) return false;
     
-    const char* insertSQL = R"(
-        INSERT OR REPLACE INTO gaia_sao_xmatch 
-        (gaia_source_id, sao_number, ra, dec, magnitude, separation)
-        VALUES (?, ?, ?, ?, ?, ?);
-    )";
-    
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(pImpl_->db, insertSQL, -1, &stmt, nullptr) != SQLITE_OK) {
-        return false;
+    if (pImpl_->schemaVersion >= GaiaSAOSchema::VERSION) {
+        auto stmt = pImpl_->statement(INSERT_SQL);
+        if (!stmt) return false;
+        Impl::bindScaledEntry(stmt.get(), entry);
+        return sqlite3_step(stmt.get()) == SQLITE_DONE;
     }
     
-    sqlite3_bind_int64(stmt, 1, entry.gaiaSourceId);
-    sqlite3_bind_int(stmt, 2, entry.saoNumber);
-    sqlite3_bind_double(stmt, 3, entry.ra);
-    sqlite3_bind_double(stmt, 4, entry.dec);
-    sqlite3_bind_double(stmt, 5, entry.magnitude);
-    sqlite3_bind_double(stmt, 6, entry.separation);
+    bool withPixel = pImpl_->xmatchSkyPixColumn();
+    auto stmt = pImpl_->statement(withPixel ? INSERT_XMATCH_PIX_SQL : INSERT_XMATCH_SQL);
+    if (!stmt) return false;
     
-    bool success = (sqlite3_step(stmt) == SQLITE_DONE);
-    sqlite3_finalize(stmt);
+    Impl::bindEntry(stmt.get(), entry, withPixel);
     
-    return success;
+    return sqlite3_step(stmt.get()) == SQLITE_DONE;
 }
 
 size_t GaiaSAODatabase::insertBatch(const std::vector<GaiaSAOEntry>& entries) {
-    if (!pImpl_->db || entries.empty()) return 0;
+    if (entries.empty() || !pImpl_->writer(dbPath_)) return 0;
     
     // Inizia transazione per performance
     sqlite3_exec(pImpl_->db, "BEGIN TRANSACTION;", nullptr, nullptr, nullptr);
     
-    const char* insertSQL = R"(
-        INSERT OR REPLACE INTO gaia_sao_xmatch 
-        (gaia_source_id, sao_number, ra, dec, magnitude, separation)
-        VALUES (?, ?, ?, ?, ?, ?);
-    )";
-    
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(pImpl_->db, insertSQL, -1, &stmt, nullptr) != SQLITE_OK) {
-        sqlite3_exec(pImpl_->db, "ROLLBACK;", nullptr, nullptr, nullptr);
-        return 0;
-    }
-    
     size_t insertedCount = 0;
-    for (const auto& entry : entries) {
-        sqlite3_bind_int64(stmt, 1, entry.gaiaSourceId);
-        sqlite3_bind_int(stmt, 2, entry.saoNumber);
-        sqlite3_bind_double(stmt, 3, entry.ra);
-        sqlite3_bind_double(stmt, 4, entry.dec);
-        sqlite3_bind_double(stmt, 5, entry.magnitude);
-        sqlite3_bind_double(stmt, 6, entry.separation);
-        
-        if (sqlite3_step(stmt) == SQLITE_DONE) {
-            insertedCount++;
+    {
+        bool scaled = pImpl_->schemaVersion >= GaiaSAOSchema::VERSION;
+        bool withPixel = !scaled && pImpl_->xmatchSkyPixColumn();
+        auto stmt = pImpl_->statement(scaled ? INSERT_SQL
+                                             : withPixel ? INSERT_XMATCH_PIX_SQL : INSERT_XMATCH_SQL);
+        if (!stmt) {
+            sqlite3_exec(pImpl_->db, "ROLLBACK;", nullptr, nullptr, nullptr);
+            return 0;
         }
         
-        sqlite3_reset(stmt);
+        for (const auto& entry : entries) {
+            if (scaled) {
+                Impl::bindScaledEntry(stmt.get(), entry);
+            } else {
+                Impl::bindEntry(stmt.get(), entry, withPixel);
+            }
+            
+            if (sqlite3_step(stmt.get()) == SQLITE_DONE) {
+                insertedCount++;
+            }
+            
+            sqlite3_reset(stmt.get());
+        }
     }
     
-    sqlite3_finalize(stmt);
     sqlite3_exec(pImpl_->db, "COMMIT;", nullptr, nullptr, nullptr);
     
     return insertedCount;
 }
 
 bool GaiaSAODatabase::createIndices() {
-    if (!pImpl_->db) return false;
+    if (!pImpl_->writer(dbPath_)) return false;
+    
+    // Versione corrente: indici coprenti di GaiaSAOSchema
+    if (pImpl_->schemaVersion >= GaiaSAOSchema::VERSION) {
+        bool ok = GaiaSAOSchema::createIndices(pImpl_->db);
+        pImpl_->schemaChanged();
+        return ok;
+    }
     
     const char* createIndicesSQL = R"(
         CREATE INDEX IF NOT EXISTS idx_sao_number ON gaia_sao_xmatch(sao_number);
@@ -458,20 +1050,32 @@ bool GaiaSAODatabase::createIndices() {
         CREATE INDEX IF NOT EXISTS idx_ra_dec ON gaia_sao_xmatch(ra, dec);
     )";
     
-    char* errMsg = nullptr;
-    int rc = sqlite3_exec(pImpl_->db, createIndicesSQL, nullptr, nullptr, &errMsg);
-    
-    if (rc != SQLITE_OK) {
-        std::cerr << "SQL error creating indices: " << errMsg << std::endl;
-        sqlite3_free(errMsg);
-        return false;
+    // I database con la sola tabella stars ricevono solo l'indice a pixel
+    if (Impl::tableExists(pImpl_->db, "gaia_sao_xmatch")) {
+        char* errMsg = nullptr;
+        int rc = sqlite3_exec(pImpl_->db, createIndicesSQL, nullptr, nullptr, &errMsg);
+        
+        if (rc != SQLITE_OK) {
+            std::cerr << "SQL error creating indices: " << errMsg << std::endl;
+            sqlite3_free(errMsg);
+            return false;
+        }
     }
     
-    return true;
+    // Indice spaziale a pixel (SkyIndex) con indici coprenti per le query
+    // di cono/box; vale anche per la tabella stars se presente
+    GaiaSAOSchema::registerFunctions(pImpl_->db);
+    
+    bool ok = pImpl_->buildPixelIndex("gaia_sao_xmatch", "ra", "dec",
+                                      "sao_number, magnitude, separation") &&
+              pImpl_->buildPixelIndex("stars", "ra_deg", "dec_deg", "sao, magnitude");
+    pImpl_->schemaChanged();
+    
+    return ok;
 }
 
 bool GaiaSAODatabase::optimize() {
-    if (!pImpl_->db) return false;
+    if (!pImpl_->writer(dbPath_)) return false;
     
     const char* optimizeSQL = "VACUUM; ANALYZE;";
     
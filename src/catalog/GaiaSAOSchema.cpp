@@ -0,0 +1,323 @@
+#include "starmap/catalog/GaiaSAOSchema.h"
+#include "starmap/catalog/SkyIndex.h"
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+
+namespace starmap {
+namespace catalog {
+
+namespace {
+
+/**
+ * @brief Funzione SQL starmap_sky_pix(ra, dec): pixel di SkyIndex
+ */
+void skyPixelFunction(sqlite3_context* context, int argc, sqlite3_value** argv) {
+    if (argc != 2 || sqlite3_value_type(argv[0]) == SQLITE_NULL ||
+        sqlite3_value_type(argv[1]) == SQLITE_NULL) {
+        sqlite3_result_null(context);
+        return;
+    }
+    sqlite3_result_int64(context, SkyIndex::pixelId(sqlite3_value_double(argv[0]),
+                                                    sqlite3_value_double(argv[1])));
+}
+
+bool exec(sqlite3* db, const std::string& sql, const char* what) {
+    char* errMsg = nullptr;
+    if (sqlite3_exec(db, sql.c_str(), nullptr, nullptr, &errMsg) != SQLITE_OK) {
+        std::cerr << "SQL error " << what << ": " << (errMsg ? errMsg : sqlite3_errmsg(db)) << std::endl;
+        sqlite3_free(errMsg);
+        return false;
+    }
+    return true;
+}
+
+bool tableExists(sqlite3* db, const std::string& schema, const std::string& table) {
+    std::string query = "SELECT 1 FROM " + schema + ".sqlite_master WHERE type='table' AND name=?;";
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    sqlite3_bind_text(stmt, 1, table.c_str(), -1, SQLITE_TRANSIENT);
+    bool exists = (sqlite3_step(stmt) == SQLITE_ROW);
+    sqlite3_finalize(stmt);
+    return exists;
+}
+
+bool hasColumn(sqlite3* db, const std::string& schema, const std::string& table,
+               const std::string& column) {
+    std::string query = "PRAGMA " + schema + ".table_info(" + table + ");";
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        return false;
+    }
+    bool found = false;
+    while (!found && sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        found = name && column == name;
+    }
+    sqlite3_finalize(stmt);
+    return found;
+}
+
+std::string scaled(const std::string& column, const char* scale) {
+    return "CAST(round(" + column + " * " + scale + ") AS INTEGER)";
+}
+
+} // namespace
+
+// ========== Layout ==========
+
+std::string GaiaSAOSchema::Layout::saoBySourceIdSql() const {
+    return "SELECT " + sao + " FROM " + table + " WHERE " + sourceId + " = ? AND " +
+           condition + " LIMIT 1;";
+}
+
+std::string GaiaSAOSchema::Layout::saoBySourceIdsSql(size_t count) const {
+    std::ostringstream sql;
+    sql << "SELECT " << sourceId << ", " << sao << " FROM " << table
+        << " WHERE " << sourceId << " IN (";
+    for (size_t i = 0; i < count; ++i) {
+        sql << (i == 0 ? "?" : ",?");
+    }
+    sql << ") AND " << condition << ";";
+    return sql.str();
+}
+
+std::string GaiaSAOSchema::Layout::entryBySourceIdSql() const {
+    return "SELECT " + sourceId + ", " + sao + ", " + ra + ", " + dec + ", " + magnitude +
+           ", " + separation + " FROM " + table + " WHERE " + sourceId + " = ? LIMIT 1;";
+}
+
+std::string GaiaSAOSchema::Layout::sourceIdsSql() const {
+    return "SELECT " + sourceId + " FROM " + table + " WHERE " + sourceId + " > 0 AND " +
+           condition + ";";
+}
+
+std::string GaiaSAOSchema::Layout::entriesSql() const {
+    return "SELECT " + sourceId + ", " + sao + ", " + ra + ", " + dec + ", " + magnitude +
+           ", " + separation + " FROM " + table + " WHERE " + sourceId + " > 0 AND " +
+           condition + ";";
+}
+
+std::string GaiaSAOSchema::Layout::entryColumns() const {
+    return sourceId + ", " + sao + ", " + magnitude + ", " + separation;
+}
+
+std::string GaiaSAOSchema::Layout::entryCondition() const {
+    return sourceId + " > 0";
+}
+
+// ========== GaiaSAOSchema ==========
+
+GaiaSAOSchema::Layout GaiaSAOSchema::current() {
+    return {TABLE, "source_id", "sao", "ra_udeg / 1000000.0", "dec_udeg / 1000000.0",
+            "mag_mmag / 1000.0", "sep_mas / 1000.0", "sao > 0"};
+}
+
+GaiaSAOSchema::Layout GaiaSAOSchema::legacyStars() {
+    return {"stars", "gaia_dr3", "sao", "ra_deg", "dec_deg", "magnitude", "0.0",
+            "sao IS NOT NULL AND sao > 0"};
+}
+
+GaiaSAOSchema::Layout GaiaSAOSchema::legacyXMatch() {
+    return {"gaia_sao_xmatch", "gaia_source_id", "sao_number", "ra", "dec", "magnitude",
+            "separation", "sao_number > 0"};
+}
+
+int GaiaSAOSchema::version(sqlite3* db) {
+    if (!db) return 0;
+
+    if (tableExists(db, "main", TABLE)) {
+        int userVersion = 0;
+        sqlite3_stmt* stmt = nullptr;
+        if (sqlite3_prepare_v2(db, "PRAGMA user_version;", -1, &stmt, nullptr) == SQLITE_OK) {
+            if (sqlite3_step(stmt) == SQLITE_ROW) userVersion = sqlite3_column_int(stmt, 0);
+            sqlite3_finalize(stmt);
+        }
+        return userVersion >= VERSION ? userVersion : VERSION;
+    }
+
+    if (tableExists(db, "main", "stars") || tableExists(db, "main", "gaia_sao_xmatch")) {
+        return 1;
+    }
+    return 0;
+}
+
+bool GaiaSAOSchema::create(sqlite3* db) {
+    // La chiave source_id è anche l'ordine fisico delle righe: la ricerca
+    // per Gaia ID legge una sola pagina foglia, senza tabella a parte
+    const std::string sql = R"(
+        CREATE TABLE IF NOT EXISTS metadata (
+            key TEXT PRIMARY KEY,
+            value TEXT
+        );
+        CREATE TABLE IF NOT EXISTS sao_xmatch (
+            source_id INTEGER PRIMARY KEY,
+            sao INTEGER NOT NULL,
+            ra_udeg INTEGER NOT NULL,
+            dec_udeg INTEGER NOT NULL,
+            mag_mmag INTEGER,
+            sep_mas INTEGER,
+            sky_pix INTEGER NOT NULL,
+            name TEXT,
+            sp_type TEXT
+        ) WITHOUT ROWID;
+        INSERT OR REPLACE INTO metadata (key, value) VALUES ('version', ')" +
+        std::to_string(VERSION) + R"(');
+        INSERT OR REPLACE INTO metadata (key, value) VALUES ('created', datetime('now'));
+        PRAGMA user_version = )" + std::to_string(VERSION) + ";";
+
+    return exec(db, sql, "creating cross-match schema");
+}
+
+bool GaiaSAOSchema::createIndices(sqlite3* db) {
+    // Le colonne della chiave (source_id) fanno parte di ogni indice di una
+    // tabella WITHOUT ROWID: non vanno ripetute
+    const std::string sql =
+        "CREATE INDEX IF NOT EXISTS " + SpatialQuery::pixelIndexName(TABLE) +
+        " ON sao_xmatch(sky_pix, ra_udeg, dec_udeg, sao, mag_mmag, sep_mas);"
+        "CREATE INDEX IF NOT EXISTS idx_sao_xmatch_bright"
+        " ON sao_xmatch(sky_pix, ra_udeg, dec_udeg, mag_mmag, sao, name)"
+        " WHERE mag_mmag < 6000;"
+        "ANALYZE sao_xmatch;";
+
+    return exec(db, sql, "creating cross-match indices");
+}
+
+bool GaiaSAOSchema::registerFunctions(sqlite3* db) {
+    return sqlite3_create_function(db, "starmap_sky_pix", 2,
+                                   SQLITE_UTF8 | SQLITE_DETERMINISTIC, nullptr,
+                                   skyPixelFunction, nullptr, nullptr) == SQLITE_OK;
+}
+
+bool GaiaSAOSchema::migrate(const std::string& legacyPath, const std::string& outputPath) {
+    if (!std::filesystem::exists(legacyPath)) {
+        std::cerr << "Legacy Gaia-SAO database not found: " << legacyPath << std::endl;
+        return false;
+    }
+    if (std::filesystem::exists(outputPath)) {
+        std::cerr << "Migration output already exists: " << outputPath << std::endl;
+        return false;
+    }
+
+    sqlite3* db = nullptr;
+    if (sqlite3_open(outputPath.c_str(), &db) != SQLITE_OK) {
+        std::cerr << "Cannot create database: " << sqlite3_errmsg(db) << std::endl;
+        sqlite3_close(db);
+        return false;
+    }
+
+    // File nuovo scritto in blocco: nessun journal, un'interruzione lascia
+    // un file da rifare e l'originale intatto
+    bool ok = exec(db, "PRAGMA journal_mode = OFF;"
+                       "PRAGMA synchronous = OFF;"
+                       "PRAGMA temp_store = MEMORY;"
+                       "PRAGMA cache_size = -262144;", "configuring migration") &&
+              registerFunctions(db);
+
+    if (ok) {
+        sqlite3_stmt* attach = nullptr;
+        ok = sqlite3_prepare_v2(db, "ATTACH DATABASE ? AS legacy;", -1, &attach, nullptr) == SQLITE_OK;
+        if (ok) {
+            sqlite3_bind_text(attach, 1, legacyPath.c_str(), -1, SQLITE_TRANSIENT);
+            ok = sqlite3_step(attach) == SQLITE_DONE;
+        }
+        sqlite3_finalize(attach);
+        if (!ok) {
+            std::cerr << "Cannot attach legacy database: " << sqlite3_errmsg(db) << std::endl;
+        }
+    }
+
+    bool hasXMatch = ok && tableExists(db, "legacy", "gaia_sao_xmatch");
+    bool hasStars = ok && tableExists(db, "legacy", "stars");
+    if (ok && !hasXMatch && !hasStars) {
+        std::cerr << "No legacy Gaia-SAO tables in: " << legacyPath << std::endl;
+        ok = false;
+    }
+
+    ok = ok && create(db) && exec(db, "BEGIN;", "starting migration");
+
+    // 1. Cross-match con separazione, in ordine di chiave primaria
+    if (ok && hasXMatch) {
+        ok = exec(db,
+            "INSERT OR IGNORE INTO sao_xmatch "
+            "(source_id, sao, ra_udeg, dec_udeg, mag_mmag, sep_mas, sky_pix) "
+            "SELECT gaia_source_id, sao_number, " +
+            scaled("ra", "1e6") + ", " + scaled("dec", "1e6") + ", " +
+            scaled("magnitude", "1e3") + ", " + scaled("separation", "1e3") +
+            ", starmap_sky_pix(ra, dec) FROM legacy.gaia_sao_xmatch "
+            "WHERE sao_number > 0 AND ra IS NOT NULL AND dec IS NOT NULL "
+            "ORDER BY gaia_source_id;", "copying gaia_sao_xmatch");
+    }
+
+    // 2. Stelle con SAO della tabella stars: aggiunge quelle mancanti (le
+    //    stelle senza Gaia ID con chiave -SAO) e completa nome e tipo spettrale
+    if (ok && hasStars) {
+        std::string name;
+        if (hasColumn(db, "legacy", "stars", "proper_name")) name += "NULLIF(proper_name, ''), ";
+        if (hasColumn(db, "legacy", "stars", "bayer")) name += "NULLIF(bayer, ''), ";
+        if (hasColumn(db, "legacy", "stars", "flamsteed")) {
+            name += "CAST(NULLIF(flamsteed, 0) AS TEXT), ";
+        }
+        name = name.empty() ? "NULL" : "COALESCE(" + name + "NULL)";
+
+        std::string spectralType = "NULL";
+        for (const char* column : {"spectral_type", "sp_type"}) {
+            if (hasColumn(db, "legacy", "stars", column)) spectralType = column;
+        }
+
+        ok = exec(db,
+            "INSERT INTO sao_xmatch "
+            "(source_id, sao, ra_udeg, dec_udeg, mag_mmag, sky_pix, name, sp_type) "
+            "SELECT CASE WHEN gaia_dr3 > 0 THEN gaia_dr3 ELSE -sao END, sao, " +
+            scaled("ra_deg", "1e6") + ", " + scaled("dec_deg", "1e6") + ", " +
+            scaled("magnitude", "1e3") + ", starmap_sky_pix(ra_deg, dec_deg), " +
+            name + ", " + spectralType + " FROM legacy.stars "
+            "WHERE sao > 0 AND ra_deg IS NOT NULL AND dec_deg IS NOT NULL "
+            "ON CONFLICT(source_id) DO UPDATE SET "
+            "name = COALESCE(sao_xmatch.name, excluded.name), "
+            "sp_type = COALESCE(sao_xmatch.sp_type, excluded.sp_type);", "copying stars");
+    }
+
+    if (ok && tableExists(db, "legacy", "metadata")) {
+        ok = exec(db, "INSERT OR IGNORE INTO metadata SELECT key, value FROM legacy.metadata;",
+                  "copying metadata");
+    }
+    if (ok) {
+        sqlite3_stmt* stmt = nullptr;
+        ok = sqlite3_prepare_v2(db,
+            "INSERT OR REPLACE INTO metadata (key, value) VALUES "
+            "('migrated_from', ?), ('migrated', datetime('now'));", -1, &stmt, nullptr) == SQLITE_OK;
+        if (ok) {
+            sqlite3_bind_text(stmt, 1, legacyPath.c_str(), -1, SQLITE_TRANSIENT);
+            ok = sqlite3_step(stmt) == SQLITE_DONE;
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    ok = ok && exec(db, "COMMIT; DETACH DATABASE legacy;", "completing migration") &&
+         createIndices(db) && exec(db, "VACUUM;", "compacting database");
+
+    sqlite3_close(db);
+    if (!ok) std::filesystem::remove(outputPath);
+    return ok;
+}
+
+std::vector<std::string> GaiaSAOSchema::hotQueries() {
+    Layout layout = current();
+    return {
+        layout.saoBySourceIdSql(),
+        layout.saoBySourceIdsSql(4),
+        layout.entryBySourceIdSql(),
+        SpatialQuery::selectSql(layout.table, layout.ra, layout.dec, layout.sao,
+                                layout.condition, true),
+        SpatialQuery::selectSql(layout.table, layout.ra, layout.dec, layout.entryColumns(),
+                                layout.entryCondition(), true),
+        SpatialQuery::selectSql(layout.table, layout.ra, layout.dec, BRIGHT_COLUMNS,
+                                BRIGHT_CONDITION, true),
+    };
+}
+
+} // namespace catalog
+} // namespace starmap
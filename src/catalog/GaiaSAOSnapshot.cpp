@@ -0,0 +1,346 @@
+#include "starmap/catalog/GaiaSAOSnapshot.h"
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+
+namespace starmap {
+namespace catalog {
+
+namespace {
+
+constexpr char SNAPSHOT_MAGIC[8] = {'S', 'M', 'G', 'S', 'A', 'O', '0', '1'};
+// Versione 2: versori delle righe (x, y, z) nel file
+constexpr uint32_t SNAPSHOT_VERSION = 2;
+constexpr uint64_t SECTION_ALIGNMENT = 64;
+
+// Sezioni del file, nell'ordine in cui vengono scritte
+enum Section {
+    SEC_RA = 0,
+    SEC_DEC,
+    SEC_X,
+    SEC_Y,
+    SEC_Z,
+    SEC_SOURCE_ID,
+    SEC_SAO,
+    SEC_MAGNITUDE,
+    SEC_SEPARATION,
+    SEC_PIXEL_START,
+    SEC_ID_SORTED,
+    SEC_ID_ROW,
+    SEC_SAO_SORTED,
+    SEC_SAO_ROW,
+    NUM_SECTIONS
+};
+
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t numSections;
+    uint64_t count;
+    uint32_t numZones;
+    uint32_t raCells;
+    double zoneHeight;
+    uint64_t fileSize;
+    uint64_t offsets[NUM_SECTIONS];   // byte dall'inizio del file
+    uint64_t sizes[NUM_SECTIONS];     // byte
+};
+
+uint64_t alignUp(uint64_t value) {
+    return (value + SECTION_ALIGNMENT - 1) / SECTION_ALIGNMENT * SECTION_ALIGNMENT;
+}
+
+/**
+ * @brief Dimensione attesa (byte) di una sezione per count righe
+ */
+uint64_t sectionSize(int section, uint64_t count) {
+    switch (section) {
+        case SEC_RA:
+        case SEC_DEC:
+        case SEC_X:
+        case SEC_Y:
+        case SEC_Z:           return count * sizeof(double);
+        case SEC_SOURCE_ID:
+        case SEC_ID_SORTED:   return count * sizeof(int64_t);
+        case SEC_SAO:
+        case SEC_SAO_SORTED:  return count * sizeof(int32_t);
+        case SEC_MAGNITUDE:
+        case SEC_SEPARATION:  return count * sizeof(float);
+        case SEC_ID_ROW:
+        case SEC_SAO_ROW:     return count * sizeof(uint32_t);
+        case SEC_PIXEL_START: return (SkyIndex::NUM_PIXELS + 1) * sizeof(uint32_t);
+        default:              return 0;
+    }
+}
+
+template<typename T>
+void writeSection(std::ofstream& out, const std::vector<T>& data, uint64_t offset) {
+    // Padding fino all'offset della sezione
+    static const char zeros[SECTION_ALIGNMENT] = {};
+    uint64_t position = static_cast<uint64_t>(out.tellp());
+    if (offset > position) {
+        out.write(zeros, static_cast<std::streamsize>(offset - position));
+    }
+    out.write(reinterpret_cast<const char*>(data.data()),
+              static_cast<std::streamsize>(data.size() * sizeof(T)));
+}
+
+} // anonymous namespace
+
+GaiaSAOSnapshot::GaiaSAOSnapshot(const std::string& path)
+    : path_(path) {
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        std::cerr << "Cannot open Gaia-SAO snapshot: " << path << std::endl;
+        return;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(SnapshotHeader)) {
+        std::cerr << "Invalid Gaia-SAO snapshot: " << path << std::endl;
+        ::close(fd);
+        return;
+    }
+
+    size_t fileSize = static_cast<size_t>(st.st_size);
+    void* mapped = mmap(nullptr, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);  // La mappatura resta valida anche dopo la chiusura
+
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Cannot map Gaia-SAO snapshot: " << path << std::endl;
+        return;
+    }
+
+    const auto* bytes = static_cast<const uint8_t*>(mapped);
+    SnapshotHeader header;
+    std::memcpy(&header, bytes, sizeof(header));
+
+    if (std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0 &&
+        header.version != SNAPSHOT_VERSION) {
+        std::cerr << "Gaia-SAO snapshot version " << header.version << " (expected "
+                  << SNAPSHOT_VERSION << "), re-export it with export_sao_snapshot: "
+                  << path << std::endl;
+        munmap(mapped, fileSize);
+        return;
+    }
+
+    // Validazione: formato, pixelizzazione e limiti delle sezioni
+    bool valid = std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0 &&
+                 header.numSections == NUM_SECTIONS &&
+                 header.numZones == static_cast<uint32_t>(SkyIndex::NUM_ZONES) &&
+                 header.raCells == static_cast<uint32_t>(SkyIndex::RA_CELLS) &&
+                 header.zoneHeight == SkyIndex::ZONE_HEIGHT &&
+                 header.fileSize == fileSize;
+    for (int s = 0; valid && s < NUM_SECTIONS; ++s) {
+        valid = header.sizes[s] == sectionSize(s, header.count) &&
+                header.offsets[s] % sizeof(double) == 0 &&
+                header.offsets[s] + header.sizes[s] <= fileSize;
+    }
+
+    if (!valid) {
+        std::cerr << "Invalid or incompatible Gaia-SAO snapshot: " << path << std::endl;
+        munmap(mapped, fileSize);
+        return;
+    }
+
+    base_ = bytes;
+    fileSize_ = fileSize;
+    count_ = static_cast<size_t>(header.count);
+
+    ra_ = reinterpret_cast<const double*>(base_ + header.offsets[SEC_RA]);
+    dec_ = reinterpret_cast<const double*>(base_ + header.offsets[SEC_DEC]);
+    x_ = reinterpret_cast<const double*>(base_ + header.offsets[SEC_X]);
+    y_ = reinterpret_cast<const double*>(base_ + header.offsets[SEC_Y]);
+    z_ = reinterpret_cast<const double*>(base_ + header.offsets[SEC_Z]);
+    sourceId_ = reinterpret_cast<const int64_t*>(base_ + header.offsets[SEC_SOURCE_ID]);
+    sao_ = reinterpret_cast<const int32_t*>(base_ + header.offsets[SEC_SAO]);
+    mag_ = reinterpret_cast<const float*>(base_ + header.offsets[SEC_MAGNITUDE]);
+    separation_ = reinterpret_cast<const float*>(base_ + header.offsets[SEC_SEPARATION]);
+    pixelStart_ = reinterpret_cast<const uint32_t*>(base_ + header.offsets[SEC_PIXEL_START]);
+    idSorted_ = reinterpret_cast<const int64_t*>(base_ + header.offsets[SEC_ID_SORTED]);
+    idRow_ = reinterpret_cast<const uint32_t*>(base_ + header.offsets[SEC_ID_ROW]);
+    saoSorted_ = reinterpret_cast<const int32_t*>(base_ + header.offsets[SEC_SAO_SORTED]);
+    saoRow_ = reinterpret_cast<const uint32_t*>(base_ + header.offsets[SEC_SAO_ROW]);
+}
+
+GaiaSAOSnapshot::~GaiaSAOSnapshot() {
+    if (base_) {
+        munmap(const_cast<uint8_t*>(base_), fileSize_);
+    }
+}
+
+bool GaiaSAOSnapshot::isSnapshotFile(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    char magic[sizeof(SNAPSHOT_MAGIC)] = {};
+    if (!in.read(magic, sizeof(magic))) return false;
+    return std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0;
+}
+
+bool GaiaSAOSnapshot::write(const std::string& path, const std::vector<GaiaSAOEntry>& entries) {
+    const size_t count = entries.size();
+    if (count > UINT32_MAX) {
+        std::cerr << "Too many entries for Gaia-SAO snapshot: " << count << std::endl;
+        return false;
+    }
+
+    // Ordine delle righe: pixel, poi magnitudine (le più luminose per prime)
+    std::vector<int64_t> pixels(count);
+    for (size_t i = 0; i < count; ++i) {
+        pixels[i] = SkyIndex::pixelId(entries[i].ra, entries[i].dec);
+    }
+    std::vector<uint32_t> order(count);
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        if (pixels[a] != pixels[b]) return pixels[a] < pixels[b];
+        return entries[a].magnitude < entries[b].magnitude;
+    });
+
+    std::vector<double> ra(count), dec(count);
+    std::vector<int64_t> sourceId(count);
+    std::vector<int32_t> sao(count);
+    std::vector<float> magnitude(count), separation(count);
+    std::vector<uint32_t> pixelStart(SkyIndex::NUM_PIXELS + 1, 0);
+
+    for (size_t row = 0; row < count; ++row) {
+        const auto& e = entries[order[row]];
+        ra[row] = e.ra;
+        dec[row] = e.dec;
+        sourceId[row] = e.gaiaSourceId;
+        sao[row] = e.saoNumber;
+        magnitude[row] = static_cast<float>(e.magnitude);
+        separation[row] = static_cast<float>(e.separation);
+        pixelStart[pixels[order[row]] + 1]++;
+    }
+    std::partial_sum(pixelStart.begin(), pixelStart.end(), pixelStart.begin());
+
+    // Versori delle righe: la verifica del cono li legge dalla mappatura
+    std::vector<double> x(count), y(count), z(count);
+    core::UnitVector::fromRaDec(ra.data(), dec.data(), count, x.data(), y.data(), z.data());
+
+    // Indici ordinati per source_id e per numero SAO
+    std::vector<uint32_t> idRow(count), saoRow(count);
+    std::iota(idRow.begin(), idRow.end(), 0u);
+    std::iota(saoRow.begin(), saoRow.end(), 0u);
+    std::sort(idRow.begin(), idRow.end(),
+              [&](uint32_t a, uint32_t b) { return sourceId[a] < sourceId[b]; });
+    std::sort(saoRow.begin(), saoRow.end(),
+              [&](uint32_t a, uint32_t b) { return sao[a] < sao[b]; });
+
+    std::vector<int64_t> idSorted(count);
+    std::vector<int32_t> saoSorted(count);
+    for (size_t i = 0; i < count; ++i) {
+        idSorted[i] = sourceId[idRow[i]];
+        saoSorted[i] = sao[saoRow[i]];
+    }
+
+    SnapshotHeader header{};
+    std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.numSections = NUM_SECTIONS;
+    header.count = count;
+    header.numZones = SkyIndex::NUM_ZONES;
+    header.raCells = SkyIndex::RA_CELLS;
+    header.zoneHeight = SkyIndex::ZONE_HEIGHT;
+
+    uint64_t offset = alignUp(sizeof(SnapshotHeader));
+    for (int s = 0; s < NUM_SECTIONS; ++s) {
+        header.offsets[s] = offset;
+        header.sizes[s] = sectionSize(s, count);
+        offset = alignUp(offset + header.sizes[s]);
+    }
+    header.fileSize = header.offsets[NUM_SECTIONS - 1] + header.sizes[NUM_SECTIONS - 1];
+
+    // Scrittura su file temporaneo e rename: chi ha già mappato il vecchio
+    // file continua a leggerlo senza vedere dati a metà
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "Cannot create snapshot file: " << tmpPath << std::endl;
+            return false;
+        }
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        writeSection(out, ra, header.offsets[SEC_RA]);
+        writeSection(out, dec, header.offsets[SEC_DEC]);
+        writeSection(out, x, header.offsets[SEC_X]);
+        writeSection(out, y, header.offsets[SEC_Y]);
+        writeSection(out, z, header.offsets[SEC_Z]);
+        writeSection(out, sourceId, header.offsets[SEC_SOURCE_ID]);
+        writeSection(out, sao, header.offsets[SEC_SAO]);
+        writeSection(out, magnitude, header.offsets[SEC_MAGNITUDE]);
+        writeSection(out, separation, header.offsets[SEC_SEPARATION]);
+        writeSection(out, pixelStart, header.offsets[SEC_PIXEL_START]);
+        writeSection(out, idSorted, header.offsets[SEC_ID_SORTED]);
+        writeSection(out, idRow, header.offsets[SEC_ID_ROW]);
+        writeSection(out, saoSorted, header.offsets[SEC_SAO_SORTED]);
+        writeSection(out, saoRow, header.offsets[SEC_SAO_ROW]);
+
+        if (!out) {
+            std::cerr << "Error writing snapshot file: " << tmpPath << std::endl;
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "Cannot move snapshot into place: " << path << std::endl;
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+GaiaSAOEntry GaiaSAOSnapshot::entry(size_t row) const {
+    GaiaSAOEntry e;
+    e.gaiaSourceId = sourceId_[row];
+    e.saoNumber = sao_[row];
+    e.ra = ra_[row];
+    e.dec = dec_[row];
+    e.magnitude = mag_[row];
+    e.separation = separation_[row];
+    return e;
+}
+
+std::optional<size_t> GaiaSAOSnapshot::findBySourceId(long long gaiaSourceId) const {
+    if (!isOpen()) return std::nullopt;
+
+    const int64_t* end = idSorted_ + count_;
+    const int64_t* it = std::lower_bound(idSorted_, end, static_cast<int64_t>(gaiaSourceId));
+    if (it == end || *it != gaiaSourceId) return std::nullopt;
+    return idRow_[it - idSorted_];
+}
+
+std::optional<size_t> GaiaSAOSnapshot::findBySAONumber(int saoNumber) const {
+    if (!isOpen()) return std::nullopt;
+
+    const int32_t* end = saoSorted_ + count_;
+    const int32_t* it = std::lower_bound(saoSorted_, end, static_cast<int32_t>(saoNumber));
+    if (it == end || *it != saoNumber) return std::nullopt;
+    return saoRow_[it - saoSorted_];
+}
+
+std::string GaiaSAOSnapshot::getStatistics() const {
+    if (!isOpen()) {
+        return "Snapshot not available";
+    }
+
+    std::ostringstream stats;
+    stats << "Snapshot: " << path_ << "\n";
+    stats << "Total entries: " << count_ << "\n";
+    stats << "Snapshot size: " << (fileSize_ / 1024.0 / 1024.0) << " MB (memory-mapped)\n";
+    stats << "Sky pixels: " << SkyIndex::NUM_PIXELS << " (zones of "
+          << SkyIndex::ZONE_HEIGHT << " deg)\n";
+    return stats.str();
+}
+
+} // namespace catalog
+} // namespace starmap
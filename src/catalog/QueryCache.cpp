@@ -0,0 +1,216 @@
+#include "starmap/catalog/QueryCache.h"
+#include "starmap/catalog/SkyIndex.h"
+#include "starmap/core/BrightestSelector.h"
+#include "starmap/core/UnitVector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace starmap {
+namespace catalog {
+
+// Passi di quantizzazione della chiave: 0.036" in posizione e raggio,
+// 0.01 mag sul limite di magnitudine
+constexpr double POSITION_QUANTUM = 1e-5;
+constexpr double MAGNITUDE_QUANTUM = 0.01;
+
+// Tolleranza sul contenimento dei coni (gradi)
+constexpr double CONTAINMENT_EPSILON = 1e-9;
+
+/**
+ * @brief Riduce la maschera a `limit` righe
+ *
+ * Con keepBrightest restano le righe più luminose, altrimenti le prime
+ * in ordine di blocco (come la troncatura del catalogo).
+ */
+static void limitRows(std::vector<uint8_t>& keep, const std::vector<float>& magnitudes,
+                      size_t limit, bool keepBrightest) {
+    size_t kept = static_cast<size_t>(std::count(keep.begin(), keep.end(), 1));
+    if (kept <= limit) return;
+
+    if (!keepBrightest) {
+        for (size_t i = 0; i < keep.size(); ++i) {
+            if (keep[i] && limit-- == 0) {
+                std::fill(keep.begin() + i, keep.end(), 0);
+                break;
+            }
+        }
+        return;
+    }
+
+    core::BrightestSelector selector(limit);
+    for (size_t i = 0; i < keep.size(); ++i) {
+        if (keep[i]) selector.offer(magnitudes[i], static_cast<uint32_t>(i));
+    }
+    std::fill(keep.begin(), keep.end(), 0);
+    for (uint32_t i : selector.indices()) keep[i] = 1;
+}
+
+QueryCache::QueryCache(size_t memoryBudgetBytes)
+    : memoryBudget_(memoryBudgetBytes) {
+}
+
+size_t QueryCache::KeyHash::operator()(const Key& key) const {
+    uint64_t h = static_cast<uint64_t>(key.ra) * 0x9E3779B97F4A7C15ULL;
+    h ^= static_cast<uint64_t>(key.dec) + 0x632BE59BD9B4E019ULL + (h << 6) + (h >> 2);
+    h ^= static_cast<uint64_t>(key.radius) + 0x85157AF5ULL + (h << 6) + (h >> 2);
+    h ^= static_cast<uint64_t>(key.magnitude) + (key.enriched ? 1 : 0) + (key.keepBrightest ? 2 : 0) +
+         (h << 6) + (h >> 2);
+    return static_cast<size_t>(h);
+}
+
+QueryCache::Key QueryCache::makeKey(const GaiaQueryParameters& params, bool enriched) {
+    double ra = std::fmod(params.center.getRightAscension(), 360.0);
+    if (ra < 0) ra += 360.0;
+
+    Key key;
+    key.ra = std::llround(ra / POSITION_QUANTUM);
+    key.dec = std::llround(params.center.getDeclination() / POSITION_QUANTUM);
+    key.radius = std::llround(params.radiusDegrees / POSITION_QUANTUM);
+    key.magnitude = std::llround(params.maxMagnitude / MAGNITUDE_QUANTUM);
+    key.enriched = enriched;
+    key.keepBrightest = params.keepBrightest && params.maxResults > 0;
+    return key;
+}
+
+bool QueryCache::contains(const Entry& entry, const GaiaQueryParameters& params, bool enriched) {
+    // Un risultato troncato senza keepBrightest è un sottoinsieme arbitrario del suo cono
+    if (!entry.complete && !entry.key.keepBrightest) return false;
+    if (enriched && !entry.key.enriched) return false;
+    if (params.maxMagnitude > entry.params.maxMagnitude) return false;
+
+    double distance = entry.params.center.angularDistance(params.center);
+    return distance + params.radiusDegrees <= entry.params.radiusDegrees + CONTAINMENT_EPSILON;
+}
+
+std::optional<core::StarBlock> QueryCache::lookup(const GaiaQueryParameters& params, bool enriched) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    size_t limit = params.maxResults > 0 ? static_cast<size_t>(params.maxResults)
+                                         : static_cast<size_t>(-1);
+
+    // 1. Stessa chiave: utilizzabile se completa o troncata ad almeno il limite richiesto
+    auto it = index_.find(makeKey(params, enriched));
+    if (it != index_.end()) {
+        Entry& entry = *it->second;
+        if (entry.complete || entry.stars.size() >= limit) {
+            entries_.splice(entries_.begin(), entries_, it->second);
+            stats_.hits++;
+
+            core::StarBlock result = entry.stars;
+            if (result.size() > limit) {
+                std::vector<uint8_t> keep(result.size(), 1);
+                limitRows(keep, result.magnitudeColumn(), limit, params.keepBrightest);
+                result.retain(keep);
+            }
+            return result;
+        }
+    }
+
+    // 2. Cono più ampio o più profondo già in cache: filtro in memoria
+    for (auto entryIt = entries_.begin(); entryIt != entries_.end(); ++entryIt) {
+        if (!contains(*entryIt, params, enriched)) continue;
+
+        const core::StarBlock& cached = entryIt->stars;
+        std::vector<uint8_t> keep(cached.size());
+        if (cached.hasUnitVectors()) {
+            core::SphericalCap(core::UnitVector::fromEquatorial(params.center), params.radiusDegrees)
+                .contains(cached.xColumn().data(), cached.yColumn().data(),
+                          cached.zColumn().data(), cached.size(), keep.data());
+        } else {
+            SkyIndex::withinCone(cached.raColumn().data(), cached.decColumn().data(), cached.size(),
+                                 params.center.getRightAscension(), params.center.getDeclination(),
+                                 params.radiusDegrees, keep.data());
+        }
+
+        const auto& magnitudes = cached.magnitudeColumn();
+        size_t kept = 0;
+        for (size_t i = 0; i < keep.size(); ++i) {
+            if (keep[i] && magnitudes[i] > params.maxMagnitude) keep[i] = 0;
+            kept += keep[i];
+        }
+
+        // Le stelle mancanti di un'entry troncata sono tutte più deboli della sua ultima
+        if (!entryIt->complete && kept < limit &&
+            params.maxMagnitude >= entryIt->faintestMagnitude) {
+            continue;
+        }
+
+        limitRows(keep, magnitudes, limit, params.keepBrightest);
+        core::StarBlock result = cached;
+        result.retain(keep);
+
+        entries_.splice(entries_.begin(), entries_, entryIt);
+        stats_.containmentHits++;
+        return result;
+    }
+
+    stats_.misses++;
+    return std::nullopt;
+}
+
+void QueryCache::insert(const GaiaQueryParameters& params, bool enriched, const core::StarBlock& stars) {
+    size_t bytes = stars.memoryUsage() + sizeof(Entry);
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (bytes > memoryBudget_) return;
+
+    Key key = makeKey(params, enriched);
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        memoryUsage_ -= it->second->bytes;
+        entries_.erase(it->second);
+        index_.erase(it);
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.params = params;
+    entry.stars = stars;
+    entry.bytes = bytes;
+    entry.complete = params.maxResults <= 0 ||
+                     stars.size() < static_cast<size_t>(params.maxResults);
+    const auto& magnitudes = stars.magnitudeColumn();
+    entry.faintestMagnitude = magnitudes.empty()
+        ? 0.0f : *std::max_element(magnitudes.begin(), magnitudes.end());
+
+    entries_.push_front(std::move(entry));
+    index_[key] = entries_.begin();
+    memoryUsage_ += bytes;
+
+    evictLocked();
+}
+
+void QueryCache::evictLocked() {
+    while (memoryUsage_ > memoryBudget_ && !entries_.empty()) {
+        const Entry& last = entries_.back();
+        memoryUsage_ -= last.bytes;
+        index_.erase(last.key);
+        entries_.pop_back();
+        stats_.evictions++;
+    }
+}
+
+void QueryCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    entries_.clear();
+    index_.clear();
+    memoryUsage_ = 0;
+}
+
+void QueryCache::setMemoryBudget(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    memoryBudget_ = bytes;
+    evictLocked();
+}
+
+QueryCacheStatistics QueryCache::getStatistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    QueryCacheStatistics stats = stats_;
+    stats.entries = entries_.size();
+    stats.memoryUsage = memoryUsage_;
+    stats.memoryBudget = memoryBudget_;
+    return stats;
+}
+
+} // namespace catalog
+} // namespace starmap
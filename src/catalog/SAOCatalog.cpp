@@ -1,38 +1,422 @@
 #include "starmap/catalog/SAOCatalog.h"
 #include "starmap/catalog/GaiaSAODatabase.h"
-#include "starmap/config/LibraryConfig.h"
+#include "starmap/catalog/SAONumberIndex.h"
+#include "starmap/catalog/VOTableReader.h"
 #include "starmap/config/LibraryConfig.h"
 #include "starmap/utils/HttpClient.h"
+#include "starmap/utils/HttpCache.h"
+#include "starmap/utils/AsyncHttpEngine.h"
+#include <algorithm>
+#include <atomic>
 #include <sstream>
 #include <cmath>
 #include <map>
+#include <mutex>
+#include <shared_mutex>
 #include <iostream>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace starmap {
 namespace catalog {
 
-// URL del servizio VizieR per query al catalogo SAO
-const std::string VIZIER_SAO_URL = "https://vizier.cds.unistra.fr/viz-bin/votable";
-const std::string SIMBAD_TAP_URL = "https://simbad.cds.unistra.fr/simbad/sim-tap/sync";
+// Sotto questa soglia l'arricchimento parallelo non ripaga l'avvio dei thread
+constexpr size_t PARALLEL_ENRICH_MIN_ROWS = 2048;
+
+// Limite di richieste al secondo verso i servizi CDS (arricchimento online concorrente)
+constexpr double CDS_REQUESTS_PER_SECOND = 20.0;
+
+// Gaia ID per query SIMBAD: la lista IN resta sotto gli 8 KB di URL
+constexpr size_t SIMBAD_BATCH_SIZE = 200;
+
+// Posizioni per tabella caricata nel servizio X-Match
+constexpr size_t XMATCH_BATCH_SIZE = 10000;
+
+/**
+ * @brief Motore HTTP condiviso, con il limite di richieste verso i servizi CDS
+ */
+static utils::AsyncHttpEngine& cdsEngine() {
+    auto& engine = utils::AsyncHttpEngine::shared();
+    static std::once_flag cdsLimits;
+    std::call_once(cdsLimits, [&engine] {
+        engine.setHostRateLimit("simbad.cds.unistra.fr", CDS_REQUESTS_PER_SECOND);
+        engine.setHostRateLimit("vizier.cds.unistra.fr", CDS_REQUESTS_PER_SECOND);
+        engine.setHostRateLimit("cdsxmatch.cds.unistra.fr", CDS_REQUESTS_PER_SECOND);
+    });
+    return engine;
+}
+
+/**
+ * @brief URL della query ADQL sincrona al servizio TAP di SIMBAD
+ */
+static std::string simbadTapUrl(const std::string& serviceUrl, const std::string& adql,
+                                const std::string& format) {
+    std::ostringstream requestUrl;
+    requestUrl << serviceUrl << "?REQUEST=doQuery&LANG=ADQL&FORMAT=" << format << "&QUERY=";
+    
+    // URL-encode
+    std::string encodedQuery;
+    for (char c : adql) {
+        if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+            encodedQuery += c;
+        } else if (c == ' ') {
+            encodedQuery += '+';
+        } else {
+            char hex[4];
+            snprintf(hex, sizeof(hex), "%%%02X", (unsigned char)c);
+            encodedQuery += hex;
+        }
+    }
+    
+    requestUrl << encodedQuery;
+    return requestUrl.str();
+}
+
+/**
+ * @brief Numero che segue il prefisso ("SAO 12345" -> 12345)
+ */
+static std::optional<long long> numberAfter(const std::string& text, const std::string& prefix) {
+    if (text.compare(0, prefix.size(), prefix) != 0) return std::nullopt;
+    size_t pos = text.find_first_not_of(' ', prefix.size());
+    if (pos == std::string::npos || !isdigit(static_cast<unsigned char>(text[pos]))) return std::nullopt;
+    return std::stoll(text.substr(pos));
+}
+
+/**
+ * @brief Coppie (Gaia ID, SAO) di un blocco di righe di simbadBatchQuery
+ */
+static void collectSimbadBatch(const VOTableColumns& columns, std::map<long long, int>& results) {
+    if (columns.columnCount() < 2) return;
+    for (size_t row = 0; row < columns.rowCount(); ++row) {
+        auto gaiaId = numberAfter(columns.getText(0, row), "Gaia DR3");
+        auto sao = numberAfter(columns.getText(1, row), "SAO");
+        if (gaiaId && sao) {
+            // Più identificativi SAO per lo stesso oggetto: vale il primo
+            results.emplace(*gaiaId, static_cast<int>(*sao));
+        }
+    }
+}
+
+/**
+ * @brief Query ADQL con lista IN: identificativi SAO di un blocco di stelle Gaia
+ */
+static std::string simbadBatchQuery(const long long* gaiaIds, size_t count) {
+    std::ostringstream adql;
+    adql << "SELECT g.id, s.id FROM ident AS g JOIN ident AS s ON s.oidref = g.oidref "
+         << "WHERE g.id IN (";
+    for (size_t k = 0; k < count; ++k) {
+        adql << (k ? "," : "") << "'Gaia DR3 " << gaiaIds[k] << "'";
+    }
+    adql << ") AND s.id LIKE 'SAO %'";
+    return adql.str();
+}
+
+/**
+ * @brief Richiesta X-Match: tabella di posizioni caricata e confrontata con VizieR I/131A
+ *
+ * La colonna idx porta l'indice della posizione nel vettore d'ingresso.
+ */
+static utils::HttpRequest xmatchRequest(const std::string& serviceUrl,
+                                        const std::vector<core::EquatorialCoordinates>& coords,
+                                        size_t begin, size_t end, double radiusArcsec) {
+    const std::string boundary = "----starmap-xmatch-boundary";
+    std::ostringstream body;
+    auto field = [&body, &boundary](const std::string& name, const std::string& value) {
+        body << "--" << boundary << "\r\n"
+             << "Content-Disposition: form-data; name=\"" << name << "\"\r\n\r\n"
+             << value << "\r\n";
+    };
+    field("request", "xmatch");
+    field("distMaxArcsec", std::to_string(radiusArcsec));
+    field("RESPONSEFORMAT", "votable");
+    field("cat2", "vizier:I/131A/sao");
+    field("colRA1", "ra");
+    field("colDec1", "dec");
+    
+    body << "--" << boundary << "\r\n"
+         << "Content-Disposition: form-data; name=\"cat1\"; filename=\"targets.csv\"\r\n"
+         << "Content-Type: text/csv\r\n\r\n"
+         << "idx,ra,dec\n";
+    body.precision(9);
+    for (size_t i = begin; i < end; ++i) {
+        body << i << ',' << coords[i].getRightAscension() << ',' << coords[i].getDeclination() << '\n';
+    }
+    body << "\r\n--" << boundary << "--\r\n";
+    
+    utils::HttpRequest request;
+    request.method = "POST";
+    request.url = serviceUrl;
+    request.body = body.str();
+    request.headers["Content-Type"] = "multipart/form-data; boundary=" + boundary;
+    return request;
+}
+
+/**
+ * @brief Controparte SAO più vicina per ogni idx di un blocco di righe X-Match
+ */
+static void collectXMatch(const VOTableColumns& columns, std::map<size_t, int>& results,
+                          std::map<size_t, double>& distances) {
+    int idxCol = columns.columnIndex("idx");
+    int saoCol = columns.columnIndex("SAO");
+    int distCol = columns.columnIndex("angDist");
+    if (idxCol < 0 || saoCol < 0) return;
+    
+    for (size_t row = 0; row < columns.rowCount(); ++row) {
+        auto idx = columns.getInteger(idxCol, row);
+        auto sao = columns.getInteger(saoCol, row);
+        if (!idx || !sao || *idx < 0) continue;
+        double dist = distCol >= 0 ? columns.getReal(distCol, row).value_or(0.0) : 0.0;
+        
+        size_t index = static_cast<size_t>(*idx);
+        auto it = distances.find(index);
+        if (it == distances.end() || dist < it->second) {
+            distances[index] = dist;
+            results[index] = static_cast<int>(*sao);
+        }
+    }
+}
+
+/**
+ * @brief Accoda una richiesta la cui risposta VOTable va direttamente al lettore
+ *
+ * Il corpo non viene accumulato: ogni frammento ricevuto da curl passa a
+ * reader->feed() sul thread del motore. Dopo il future va chiamato
+ * reader->finish() per consegnare l'ultimo blocco di righe.
+ */
+static std::future<utils::HttpResponse> submitVOTable(utils::HttpRequest request,
+                                                      std::shared_ptr<VOTableReader> reader) {
+    request.onData = [reader](const char* data, size_t size) {
+        return reader->feed(data, size);
+    };
+    return cdsEngine().submit(std::move(request));
+}
+
+/**
+ * @brief URL della query TAP SIMBAD che cerca l'identificativo SAO di una stella Gaia
+ */
+static std::string simbadSAOUrl(const std::string& serviceUrl, long long gaiaId) {
+    std::ostringstream adql;
+    adql << "SELECT ident.id FROM ident JOIN ids ON ident.oidref = ids.oidref "
+         << "WHERE ids.id = 'Gaia DR3 " << gaiaId << "' "
+         << "AND ident.id LIKE 'SAO %'";
+    return simbadTapUrl(serviceUrl, adql.str(), "votable");
+}
+
+/**
+ * @brief Numero SAO nella risposta SIMBAD (prima cella "SAO NNNN")
+ */
+static std::optional<int> parseSimbadSAO(const std::string& response) {
+    VOTableReader reader;
+    if (!reader.parse(response)) return std::nullopt;
+    
+    const auto& columns = reader.columns();
+    if (columns.columnCount() == 0) return std::nullopt;
+    for (size_t row = 0; row < columns.rowCount(); ++row) {
+        if (auto sao = numberAfter(columns.getText(0, row), "SAO")) {
+            return static_cast<int>(*sao);
+        }
+    }
+    return std::nullopt;
+}
+
+/**
+ * @brief URL della ricerca conica VizieR nel catalogo SAO
+ */
+static std::string vizierConeUrl(const std::string& serviceUrl,
+                                 const core::EquatorialCoordinates& coords, double radiusArcsec) {
+    std::ostringstream query;
+    query << serviceUrl
+          << "?-source=I/131A/sao"
+          << "&-c=" << coords.getRightAscension() 
+          << "+" << coords.getDeclination()
+          << "&-c.rs=" << (radiusArcsec / 3600.0) // converti in gradi
+          << "&-out.max=1"
+          << "&-out=SAO,_RAJ2000,_DEJ2000,Vmag";
+    return query.str();
+}
+
+/**
+ * @brief Numero SAO della prima riga della risposta VizieR
+ */
+static std::optional<int> parseVizierSAO(const std::string& response) {
+    VOTableReader reader;
+    if (!reader.parse(response)) return std::nullopt;
+    
+    const auto& columns = reader.columns();
+    int saoCol = columns.columnIndex("SAO");
+    if (saoCol < 0 || columns.rowCount() == 0) return std::nullopt;
+    
+    auto sao = columns.getInteger(saoCol, 0);
+    if (!sao) return std::nullopt;
+    return static_cast<int>(*sao);
+}
+
+/**
+ * @brief Voce del catalogo dalla prima riga della risposta VizieR per numero SAO
+ */
+static std::optional<SAOEntry> parseVizierEntry(const std::string& response, int saoNumber) {
+    VOTableReader reader;
+    if (!reader.parse(response)) return std::nullopt;
+    
+    const auto& columns = reader.columns();
+    int raCol = columns.columnIndex("_RAJ2000");
+    int decCol = columns.columnIndex("_DEJ2000");
+    if (raCol < 0 || decCol < 0 || columns.rowCount() == 0) return std::nullopt;
+    
+    auto ra = columns.getReal(raCol, 0);
+    auto dec = columns.getReal(decCol, 0);
+    if (!ra || !dec) return std::nullopt;
+    
+    SAOEntry entry;
+    entry.saoNumber = saoNumber;
+    entry.coordinates = core::EquatorialCoordinates(*ra, *dec);
+    entry.magnitude = 99.0;
+    int magCol = columns.columnIndex("Vmag");
+    if (magCol >= 0) {
+        entry.magnitude = columns.getReal(magCol, 0).value_or(99.0);
+    }
+    int spCol = columns.columnIndex("SpType");
+    if (spCol >= 0 && !columns.isNull(spCol, 0)) {
+        entry.spectralType = columns.getText(spCol, 0);
+    }
+    return entry;
+}
 
 class SAOCatalog::Impl {
 public:
     Impl() {}
     
+    // Thread-safe: un handle CURL per thread (vedi HttpClient)
     utils::HttpClient httpClient_;
-    std::map<int, SAOEntry> localCache_; // Cache locale per performance
+    std::atomic<bool> onlineFallback_{false};
+    
+    mutable std::mutex serviceUrlsMutex_;
+    SAOServiceUrls serviceUrls_;
+    
+    SAOServiceUrls serviceUrls() const {
+        std::lock_guard<std::mutex> lock(serviceUrlsMutex_);
+        return serviceUrls_;
+    }
+    
+    // Cache locale per performance: letture concorrenti, scritture esclusive
+    mutable std::shared_mutex localCacheMutex_;
+    std::map<int, SAOEntry> localCache_;
+    
+    std::optional<SAOEntry> cachedEntry(int saoNumber) const {
+        std::shared_lock<std::shared_mutex> lock(localCacheMutex_);
+        auto it = localCache_.find(saoNumber);
+        if (it == localCache_.end()) return std::nullopt;
+        return it->second;
+    }
 };
 
+/**
+ * @brief Arricchisce le righe indicate usando un database (ID, poi posizione)
+ * @param notFound Se non nullo, riceve le righe rimaste senza numero SAO
+ * @return Numero di righe a cui è stato assegnato un numero SAO
+ */
+static size_t enrichRows(GaiaSAODatabase& database, core::StarBlock& stars,
+                         const size_t* rows, size_t count, std::vector<size_t>* notFound) {
+    if (count == 0) return 0;
+    
+    std::vector<long long> gaiaIds(count);
+    for (size_t k = 0; k < count; ++k) {
+        gaiaIds[k] = stars.getGaiaId(rows[k]);
+    }
+    
+    // PRIORITÀ 1: Gaia ID (query IN a blocchi)
+    auto byId = database.findSAOByGaiaIds(gaiaIds);
+    
+    // PRIORITÀ 2: coordinate, solo per le stelle non trovate per ID
+    size_t enriched = 0;
+    std::vector<size_t> unmatched;
+    std::vector<core::EquatorialCoordinates> coords;
+    for (size_t k = 0; k < count; ++k) {
+        if (byId[k].has_value()) {
+            stars.setSAONumber(rows[k], byId[k].value());
+            enriched++;
+        } else {
+            unmatched.push_back(rows[k]);
+            coords.push_back(stars.getCoordinates(rows[k]));
+        }
+    }
+    
+    if (!coords.empty()) {
+        auto byPosition = database.findSAOByCoordinates(coords, 5.0);
+        for (size_t k = 0; k < unmatched.size(); ++k) {
+            if (byPosition[k].has_value()) {
+                stars.setSAONumber(unmatched[k], byPosition[k].value());
+                enriched++;
+            } else if (notFound) {
+                notFound->push_back(unmatched[k]);
+            }
+        }
+    }
+    
+    return enriched;
+}
+
+/**
+ * @brief Ricerca online (SIMBAD, poi X-Match) comune alle versioni su vettore e su blocco
+ *
+ * gaiaIdOf(k) e coordinatesOf(k) leggono la k-esima di count stelle,
+ * assign(k, sao) le assegna il numero SAO trovato.
+ * @return Numero di stelle a cui è stato assegnato un numero SAO
+ */
+template <typename GaiaIdOf, typename CoordinatesOf, typename Assign>
+static size_t resolveOnline(SAOCatalog& catalog, size_t count, GaiaIdOf gaiaIdOf,
+                            CoordinatesOf coordinatesOf, Assign assign) {
+    // PRIORITÀ 1: SIMBAD per Gaia ID
+    std::vector<long long> gaiaIds;
+    for (size_t k = 0; k < count; ++k) {
+        if (gaiaIdOf(k) > 0) gaiaIds.push_back(gaiaIdOf(k));
+    }
+    auto byId = catalog.querySIMBADForSAO(gaiaIds);
+    
+    size_t enriched = 0;
+    std::vector<size_t> unresolved;
+    std::vector<core::EquatorialCoordinates> coords;
+    for (size_t k = 0; k < count; ++k) {
+        auto it = byId.find(gaiaIdOf(k));
+        if (it != byId.end()) {
+            assign(k, it->second);
+            enriched++;
+        } else {
+            unresolved.push_back(k);
+            coords.push_back(coordinatesOf(k));
+        }
+    }
+    
+    // PRIORITÀ 2: cross-match posizionale con VizieR
+    if (!coords.empty()) {
+        auto byPosition = catalog.crossMatchVizieR(coords, 5.0);
+        for (const auto& [index, sao] : byPosition) {
+            assign(unresolved[index], sao);
+            enriched++;
+        }
+    }
+    
+    return enriched;
+}
+
 SAOCatalog::SAOCatalog(const std::string& localDbPath) 
     : pImpl_(std::make_unique<Impl>())
     , localDatabase_(std::make_unique<GaiaSAODatabase>(
         localDbPath.empty() ? config::LibraryConfig::getInstance().getGaiaSaoDbPath() : localDbPath)) {
     
+    // Risposte VizieR/SIMBAD su disco: le query ripetute non vanno in rete
+    std::string httpCacheDirectory = config::LibraryConfig::getInstance().getHttpCacheDirectory();
+    if (!httpCacheDirectory.empty()) {
+        auto cache = utils::HttpCache::open(httpCacheDirectory);
+        if (cache->isEnabled()) pImpl_->httpClient_.setCache(cache);
+    }
+    
     if (localDatabase_->isAvailable()) {
         std::cout << "✓ Gaia-SAO local database loaded successfully" << std::endl;
     } else {
         std::cout << "✗ Gaia-SAO local database not available at: " << localDbPath << std::endl;
-        std::cout << "  (Online fallbacks are disabled for performance)" << std::endl;
+        std::cout << "  (Online fallbacks are disabled unless setOnlineFallback(true))" << std::endl;
     }
 }
 
@@ -46,89 +430,64 @@ std::optional<int> SAOCatalog::findSAOByCoordinates(
 }
 
 std::shared_ptr<core::Star> SAOCatalog::findBySAONumber(int saoNumber) {
-    // Controlla cache locale
-    auto it = pImpl_->localCache_.find(saoNumber);
-    if (it != pImpl_->localCache_.end()) {
+    // PRIORITÀ 1: tabella per numero SAO del database locale (accesso diretto)
+    if (auto index = hasLocalDatabase() ? localDatabase_->getSAONumberIndex() : nullptr) {
+        if (const auto* entry = index->find(saoNumber)) {
+            auto star = std::make_shared<core::Star>();
+            star->setSAONumber(saoNumber);
+            star->setGaiaId(entry->gaiaSourceId);
+            star->setCoordinates(core::EquatorialCoordinates(entry->ra, entry->dec));
+            star->setMagnitude(entry->magnitude);
+            star->setSpectralType(index->spectralType(*entry));
+            return star;
+        }
+    }
+    
+    // PRIORITÀ 2: stelle già scaricate da VizieR
+    if (auto entry = pImpl_->cachedEntry(saoNumber)) {
         auto star = std::make_shared<core::Star>();
-        star->setSAONumber(it->second.saoNumber);
-        star->setCoordinates(it->second.coordinates);
-        star->setMagnitude(it->second.magnitude);
-        star->setSpectralType(it->second.spectralType);
-        star->setName(it->second.name);
+        star->setSAONumber(entry->saoNumber);
+        star->setCoordinates(entry->coordinates);
+        star->setMagnitude(entry->magnitude);
+        star->setSpectralType(entry->spectralType);
+        star->setName(entry->name);
         return star;
     }
     
-    // Query VizieR per numero SAO specifico
+    // FALLBACK 3: query VizieR per numero SAO specifico, solo se abilitata
+    if (!pImpl_->onlineFallback_) return nullptr;
+    
     std::ostringstream query;
-    query << VIZIER_SAO_URL << "?-source=I/131A/sao&-out.max=1&SAO=" << saoNumber;
+    query << pImpl_->serviceUrls().vizier << "?-source=I/131A/sao&-out.max=1&SAO=" << saoNumber
+          << "&-out=SAO,_RAJ2000,_DEJ2000,Vmag,SpType";
     
+    std::optional<SAOEntry> entry;
     try {
-        std::string response = pImpl_->httpClient_.get(query.str());
-        
-        // Parser semplificato - in produzione usare libreria XML
-        if (response.find("<TR>") != std::string::npos) {
-            auto star = std::make_shared<core::Star>();
-            star->setSAONumber(saoNumber);
-            
-            // Estrai dati dalla risposta VOTable
-            // Questo è un parser molto semplificato
-            size_t raPos = response.find("_RAJ2000");
-            size_t decPos = response.find("_DEJ2000");
-            size_t magPos = response.find("Vmag");
-            
-            // TODO: Implementare parser completo
-            
-            return star;
-        }
+        entry = parseVizierEntry(pImpl_->httpClient_.get(query.str()), saoNumber);
     } catch (const std::exception&) {
         // Errore nella query
     }
+    if (!entry) return nullptr;
+    
+    {
+        std::unique_lock<std::shared_mutex> lock(pImpl_->localCacheMutex_);
+        pImpl_->localCache_[saoNumber] = *entry;
+    }
     
-    return nullptr;
+    auto star = std::make_shared<core::Star>();
+    star->setSAONumber(entry->saoNumber);
+    star->setCoordinates(entry->coordinates);
+    star->setMagnitude(entry->magnitude);
+    star->setSpectralType(entry->spectralType);
+    return star;
 }
 
 std::optional<int> SAOCatalog::querySIMBADForSAO(long long gaiaId) {
     // Query SIMBAD per cross-reference
-    std::ostringstream adql;
-    adql << "SELECT ident.id FROM ident JOIN ids ON ident.oidref = ids.oidref "
-         << "WHERE ids.id = 'Gaia DR3 " << gaiaId << "' "
-         << "AND ident.id LIKE 'SAO %'";
-    
-    std::ostringstream requestUrl;
-    requestUrl << SIMBAD_TAP_URL << "?REQUEST=doQuery&LANG=ADQL&FORMAT=votable&QUERY=";
-    
-    // URL-encode
-    std::string encodedQuery;
-    for (char c : adql.str()) {
-        if (isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
-            encodedQuery += c;
-        } else if (c == ' ') {
-            encodedQuery += '+';
-        } else {
-            char hex[4];
-            snprintf(hex, sizeof(hex), "%%%02X", (unsigned char)c);
-            encodedQuery += hex;
-        }
-    }
-    
-    requestUrl << encodedQuery;
-    
     try {
         pImpl_->httpClient_.setTimeout(30);
-        std::string response = pImpl_->httpClient_.get(requestUrl.str());
-        
-        // Cerca pattern "SAO NNNN"
-        size_t pos = response.find("SAO ");
-        if (pos != std::string::npos) {
-            pos += 4;
-            std::string numStr;
-            while (pos < response.length() && isdigit(response[pos])) {
-                numStr += response[pos++];
-            }
-            if (!numStr.empty()) {
-                return std::stoi(numStr);
-            }
-        }
+        return parseSimbadSAO(pImpl_->httpClient_.get(
+            simbadSAOUrl(pImpl_->serviceUrls().simbadTap, gaiaId)));
     } catch (const std::exception&) {
         // Errore nella query
     }
@@ -141,35 +500,9 @@ std::optional<int> SAOCatalog::crossMatchVizieR(
     double radiusArcsec) {
     
     // Query VizieR con ricerca conica
-    std::ostringstream query;
-    query << VIZIER_SAO_URL 
-          << "?-source=I/131A/sao"
-          << "&-c=" << coords.getRightAscension() 
-          << "+" << coords.getDeclination()
-          << "&-c.rs=" << (radiusArcsec / 3600.0) // converti in gradi
-          << "&-out.max=1"
-          << "&-out=SAO,_RAJ2000,_DEJ2000,Vmag";
-    
     try {
-        std::string response = pImpl_->httpClient_.get(query.str());
-        
-        // Parser semplificato per estrarre numero SAO
-        size_t saoPos = response.find("<TD>");
-        if (saoPos != std::string::npos) {
-            saoPos += 4;
-            size_t endPos = response.find("</TD>", saoPos);
-            if (endPos != std::string::npos) {
-                std::string saoStr = response.substr(saoPos, endPos - saoPos);
-                try {
-                    // Rimuovi spazi
-                    saoStr.erase(remove_if(saoStr.begin(), saoStr.end(), ::isspace), 
-                                saoStr.end());
-                    if (!saoStr.empty() && isdigit(saoStr[0])) {
-                        return std::stoi(saoStr);
-                    }
-                } catch (...) {}
-            }
-        }
+        return parseVizierSAO(pImpl_->httpClient_.get(
+            vizierConeUrl(pImpl_->serviceUrls().vizier, coords, radiusArcsec)));
     } catch (const std::exception&) {
         // Errore nella query
     }
@@ -204,12 +537,313 @@ bool SAOCatalog::enrichWithSAO(std::shared_ptr<core::Star> star) {
         }
     }
     
-    // FALLBACK 3 e 4: Query online DISABILITATE per performance
-    // Per usarle, genera prima il database locale con scripts/build_gaia_sao_database.py
+    // FALLBACK 3 e 4: query online, solo se abilitate (con la cache HTTP
+    // le ripetizioni costano una lettura da disco)
+    if (pImpl_->onlineFallback_) {
+        std::optional<int> sao;
+        if (star->getGaiaId() > 0) {
+            sao = querySIMBADForSAO(star->getGaiaId());
+        }
+        if (!sao) {
+            sao = crossMatchVizieR(star->getCoordinates(), 5.0);
+        }
+        if (sao) {
+            star->setSAONumber(*sao);
+            return true;
+        }
+    }
     
     return false;
 }
 
+size_t SAOCatalog::enrichWithSAO(core::StarBlock& stars, double maxMagnitude) {
+    size_t enriched = 0;
+    
+    // Righe da arricchire
+    std::vector<size_t> pending;
+    for (size_t i = 0; i < stars.size(); ++i) {
+        if (stars.getMagnitude(i) > maxMagnitude) continue;
+        
+        if (stars.has(i, core::FIELD_SAO)) {
+            enriched++;
+            continue;
+        }
+        pending.push_back(i);
+    }
+    
+    if (pending.empty()) return enriched;
+    bool online = pImpl_->onlineFallback_;
+    if (!hasLocalDatabase()) {
+        return online ? enriched + enrichOnline(stars, pending) : enriched;
+    }
+    
+    // Le righe non trovate nel database locale vanno online, se abilitato
+    std::vector<size_t> notFound;
+    enriched += enrichRows(*localDatabase_, stars, pending.data(), pending.size(),
+                           online ? &notFound : nullptr);
+    if (!notFound.empty()) {
+        enriched += enrichOnline(stars, notFound);
+    }
+    return enriched;
+}
+
+size_t SAOCatalog::enrichWithSAOParallel(core::StarBlock& stars, double maxMagnitude,
+                                         int numThreads) {
+    size_t enriched = 0;
+    
+    std::vector<size_t> pending;
+    for (size_t i = 0; i < stars.size(); ++i) {
+        if (stars.getMagnitude(i) > maxMagnitude) continue;
+        
+        if (stars.has(i, core::FIELD_SAO)) {
+            enriched++;
+            continue;
+        }
+        pending.push_back(i);
+    }
+    
+    if (pending.empty()) return enriched;
+    bool online = pImpl_->onlineFallback_;
+    if (!hasLocalDatabase()) {
+        return online ? enriched + enrichOnline(stars, pending) : enriched;
+    }
+    
+    size_t threads = 1;
+#ifdef _OPENMP
+    threads = static_cast<size_t>(numThreads > 0 ? numThreads : omp_get_max_threads());
+#else
+    (void)numThreads;
+#endif
+    size_t workers = std::min(threads, pending.size() / PARALLEL_ENRICH_MIN_ROWS);
+    
+    if (workers <= 1) {
+        std::vector<size_t> notFound;
+        enriched += enrichRows(*localDatabase_, stars, pending.data(), pending.size(),
+                               online ? &notFound : nullptr);
+        if (!notFound.empty()) {
+            enriched += enrichOnline(stars, notFound);
+        }
+        return enriched;
+    }
+    
+    // Blocchi contigui di righe: ogni riga è scritta da un solo worker.
+    // Ogni ricerca prende in prestito una connessione dal pool del database
+    GaiaSAODatabase& database = *localDatabase_;
+    size_t chunk = (pending.size() + workers - 1) / workers;
+    size_t found = 0;
+    std::vector<std::vector<size_t>> notFound(workers);
+    
+    #pragma omp parallel for num_threads(static_cast<int>(workers)) schedule(static, 1) reduction(+:found)
+    for (int k = 0; k < static_cast<int>(workers); ++k) {
+        size_t begin = static_cast<size_t>(k) * chunk;
+        size_t end = std::min(pending.size(), begin + chunk);
+        if (begin < end) {
+            found += enrichRows(database, stars, pending.data() + begin, end - begin,
+                                online ? &notFound[k] : nullptr);
+        }
+    }
+    
+    // Le query online sono già parallele (motore HTTP condiviso): un solo
+    // passaggio per tutte le righe rimaste
+    std::vector<size_t> remaining;
+    for (const auto& rows : notFound) {
+        remaining.insert(remaining.end(), rows.begin(), rows.end());
+    }
+    if (!remaining.empty()) {
+        found += enrichOnline(stars, remaining);
+    }
+    
+    return enriched + found;
+}
+
+size_t SAOCatalog::enrichWithSAO(std::vector<std::shared_ptr<core::Star>>& stars,
+                                 double maxMagnitude) {
+    size_t enriched = 0;
+    
+    std::vector<std::shared_ptr<core::Star>> pending;
+    std::vector<long long> gaiaIds;
+    for (const auto& star : stars) {
+        if (!star || star->getMagnitude() > maxMagnitude) continue;
+        
+        if (star->getSAONumber().has_value()) {
+            enriched++;
+            continue;
+        }
+        pending.push_back(star);
+        gaiaIds.push_back(star->getGaiaId());
+    }
+    
+    if (pending.empty()) return enriched;
+    if (!hasLocalDatabase()) {
+        return pImpl_->onlineFallback_ ? enriched + enrichOnline(pending) : enriched;
+    }
+    
+    auto byId = localDatabase_->findSAOByGaiaIds(gaiaIds);
+    
+    std::vector<std::shared_ptr<core::Star>> unmatched;
+    std::vector<core::EquatorialCoordinates> coords;
+    for (size_t k = 0; k < pending.size(); ++k) {
+        if (byId[k].has_value()) {
+            pending[k]->setSAONumber(byId[k].value());
+            enriched++;
+        } else {
+            unmatched.push_back(pending[k]);
+            coords.push_back(pending[k]->getCoordinates());
+        }
+    }
+    
+    std::vector<std::shared_ptr<core::Star>> notFound;
+    if (!coords.empty()) {
+        auto byPosition = localDatabase_->findSAOByCoordinates(coords, 5.0);
+        for (size_t k = 0; k < unmatched.size(); ++k) {
+            if (byPosition[k].has_value()) {
+                unmatched[k]->setSAONumber(byPosition[k].value());
+                enriched++;
+            } else {
+                notFound.push_back(unmatched[k]);
+            }
+        }
+    }
+    
+    if (pImpl_->onlineFallback_ && !notFound.empty()) {
+        enriched += enrichOnline(notFound);
+    }
+    
+    return enriched;
+}
+
+std::map<long long, int> SAOCatalog::querySIMBADForSAO(const std::vector<long long>& gaiaIds) {
+    std::vector<long long> ids;
+    ids.reserve(gaiaIds.size());
+    for (long long id : gaiaIds) {
+        if (id > 0) ids.push_back(id);
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+    
+    std::map<long long, int> results;
+    if (ids.empty()) return results;
+    
+    // Un blocco per richiesta, tutti i blocchi in parallelo. Le righe
+    // vengono lette man mano che arrivano, senza accumulare le risposte
+    auto cache = pImpl_->httpClient_.getCache();
+    std::string serviceUrl = pImpl_->serviceUrls().simbadTap;
+    std::vector<std::shared_ptr<std::map<long long, int>>> partial;
+    std::vector<std::shared_ptr<VOTableReader>> readers;
+    std::vector<std::future<utils::HttpResponse>> responses;
+    for (size_t begin = 0; begin < ids.size(); begin += SIMBAD_BATCH_SIZE) {
+        size_t count = std::min(SIMBAD_BATCH_SIZE, ids.size() - begin);
+        auto found = std::make_shared<std::map<long long, int>>();
+        auto reader = std::make_shared<VOTableReader>(
+            [found](size_t, const VOTableColumns& columns) { collectSimbadBatch(columns, *found); });
+        
+        utils::HttpRequest request;
+        request.url = simbadTapUrl(serviceUrl, simbadBatchQuery(ids.data() + begin, count), "votable");
+        request.cache = cache;
+        responses.push_back(submitVOTable(std::move(request), reader));
+        partial.push_back(found);
+        readers.push_back(reader);
+    }
+    
+    for (size_t k = 0; k < responses.size(); ++k) {
+        try {
+            if (responses[k].get().ok() && !readers[k]->finish()) {
+                std::cerr << "SIMBAD: " << readers[k]->getError() << std::endl;
+            }
+        } catch (const std::exception&) {
+            // Errore nella query o documento rifiutato dal lettore: il
+            // blocco resta senza le righe mancanti
+        }
+        results.insert(partial[k]->begin(), partial[k]->end());
+    }
+    return results;
+}
+
+std::map<size_t, int> SAOCatalog::crossMatchVizieR(
+    const std::vector<core::EquatorialCoordinates>& coords,
+    double radiusArcsec) {
+    
+    std::map<size_t, int> results;
+    if (coords.empty()) return results;
+    
+    // Il risultato di ogni blocco è letto in streaming; i blocchi sono
+    // disgiunti negli idx, quindi le mappe si uniscono senza conflitti
+    std::string serviceUrl = pImpl_->serviceUrls().xmatch;
+    std::vector<std::shared_ptr<std::map<size_t, int>>> partial;
+    std::vector<std::shared_ptr<VOTableReader>> readers;
+    std::vector<std::future<utils::HttpResponse>> responses;
+    for (size_t begin = 0; begin < coords.size(); begin += XMATCH_BATCH_SIZE) {
+        size_t end = std::min(coords.size(), begin + XMATCH_BATCH_SIZE);
+        auto found = std::make_shared<std::map<size_t, int>>();
+        auto distances = std::make_shared<std::map<size_t, double>>();
+        auto reader = std::make_shared<VOTableReader>(
+            [found, distances](size_t, const VOTableColumns& columns) {
+                collectXMatch(columns, *found, *distances);
+            });
+        responses.push_back(submitVOTable(xmatchRequest(serviceUrl, coords, begin, end, radiusArcsec), reader));
+        partial.push_back(found);
+        readers.push_back(reader);
+    }
+    
+    for (size_t k = 0; k < responses.size(); ++k) {
+        try {
+            if (responses[k].get().ok() && !readers[k]->finish()) {
+                std::cerr << "X-Match: " << readers[k]->getError() << std::endl;
+            }
+        } catch (const std::exception&) {
+            // Errore nella query o documento rifiutato dal lettore: il
+            // blocco resta senza le righe mancanti
+        }
+        results.insert(partial[k]->begin(), partial[k]->end());
+    }
+    return results;
+}
+
+size_t SAOCatalog::enrichOnline(std::vector<std::shared_ptr<core::Star>>& stars) {
+    std::vector<std::shared_ptr<core::Star>> pending;
+    for (const auto& star : stars) {
+        if (star && !star->getSAONumber().has_value()) pending.push_back(star);
+    }
+    
+    return resolveOnline(*this, pending.size(),
+        [&pending](size_t k) { return pending[k]->getGaiaId(); },
+        [&pending](size_t k) { return pending[k]->getCoordinates(); },
+        [&pending](size_t k, int sao) { pending[k]->setSAONumber(sao); });
+}
+
+size_t SAOCatalog::enrichOnline(core::StarBlock& stars, const std::vector<size_t>& rows) {
+    std::vector<size_t> pending;
+    for (size_t row : rows) {
+        if (row < stars.size() && !stars.has(row, core::FIELD_SAO)) pending.push_back(row);
+    }
+    
+    return resolveOnline(*this, pending.size(),
+        [&](size_t k) { return stars.getGaiaId(pending[k]); },
+        [&](size_t k) { return stars.getCoordinates(pending[k]); },
+        [&](size_t k, int sao) { stars.setSAONumber(pending[k], sao); });
+}
+
+void SAOCatalog::setOnlineFallback(bool enabled) {
+    pImpl_->onlineFallback_ = enabled;
+}
+
+bool SAOCatalog::isOnlineFallbackEnabled() const {
+    return pImpl_->onlineFallback_;
+}
+
+void SAOCatalog::setServiceUrls(const SAOServiceUrls& urls) {
+    std::lock_guard<std::mutex> lock(pImpl_->serviceUrlsMutex_);
+    pImpl_->serviceUrls_ = urls;
+}
+
+SAOServiceUrls SAOCatalog::getServiceUrls() const {
+    return pImpl_->serviceUrls();
+}
+
+utils::HttpClient& SAOCatalog::getHttpClient() {
+    return pImpl_->httpClient_;
+}
+
 bool SAOCatalog::hasLocalDatabase() const {
     return localDatabase_ && localDatabase_->isAvailable();
 }
@@ -0,0 +1,70 @@
+#include "starmap/catalog/SAONumberIndex.h"
+#include <algorithm>
+#include <limits>
+
+namespace starmap {
+namespace catalog {
+
+static_assert(sizeof(SAONumberIndex::Star) == 32, "SAONumberIndex::Star deve restare di 32 byte");
+
+SAONumberIndex::SAONumberIndex()
+    : spectralTypes_(1) {
+}
+
+bool SAONumberIndex::add(int saoNumber, double ra, double dec, double magnitude,
+                         long long gaiaSourceId, const std::string& spectralType) {
+    if (saoNumber <= 0 || saoNumber > MAX_SAO_NUMBER || std::isnan(ra) || std::isnan(dec)) {
+        return false;
+    }
+
+    size_t index = static_cast<size_t>(saoNumber);
+    if (index >= stars_.size()) {
+        Star empty{std::numeric_limits<double>::quiet_NaN(), 0.0, 0, 0.0f, 0, 0};
+        // Crescita geometrica: i numeri arrivano in ordine qualsiasi
+        if (index >= stars_.capacity()) {
+            stars_.reserve(std::max(index + 1, stars_.capacity() * 2));
+        }
+        stars_.resize(index + 1, empty);
+    }
+
+    Star& star = stars_[index];
+    if (!std::isnan(star.ra)) {
+        // Più controparti per lo stesso numero: vale la più brillante
+        if (!(magnitude < star.magnitude)) return true;
+    } else {
+        count_++;
+    }
+
+    uint16_t typeId = 0;
+    if (!spectralType.empty()) {
+        auto it = spectralTypeIds_.find(spectralType);
+        if (it != spectralTypeIds_.end()) {
+            typeId = it->second;
+        } else if (spectralTypes_.size() <= std::numeric_limits<uint16_t>::max()) {
+            typeId = static_cast<uint16_t>(spectralTypes_.size());
+            spectralTypes_.push_back(spectralType);
+            spectralTypeIds_.emplace(spectralType, typeId);
+        }
+    }
+
+    star = Star{ra, dec, gaiaSourceId, static_cast<float>(magnitude), typeId, 0};
+    return true;
+}
+
+void SAONumberIndex::finish() {
+    stars_.shrink_to_fit();
+    spectralTypes_.shrink_to_fit();
+    std::unordered_map<std::string, uint16_t>().swap(spectralTypeIds_);
+}
+
+size_t SAONumberIndex::memoryUsage() const {
+    size_t bytes = stars_.capacity() * sizeof(Star) +
+                   spectralTypes_.capacity() * sizeof(std::string);
+    for (const auto& type : spectralTypes_) {
+        bytes += type.capacity();
+    }
+    return bytes;
+}
+
+} // namespace catalog
+} // namespace starmap
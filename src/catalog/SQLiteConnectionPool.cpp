@@ -0,0 +1,247 @@
+#include "starmap/catalog/SQLiteConnectionPool.h"
+#include "starmap/catalog/SkyIndex.h"
+#include <sqlite3.h>
+#include <algorithm>
+#include <thread>
+
+namespace starmap {
+namespace catalog {
+
+std::mutex SQLiteConnectionPool::registryMutex_;
+std::unordered_map<std::string, std::shared_ptr<SQLiteConnectionPool>> SQLiteConnectionPool::registry_;
+
+// ========== CachedStatement ==========
+
+CachedStatement::~CachedStatement() {
+    if (stmt_) {
+        sqlite3_reset(stmt_);
+        sqlite3_clear_bindings(stmt_);
+    }
+}
+
+// ========== Connection ==========
+
+SQLiteConnectionPool::Connection::Connection(sqlite3* db, uint64_t generation)
+    : db_(db), generation_(generation) {
+}
+
+SQLiteConnectionPool::Connection::~Connection() {
+    // Le SpatialQuery finalizzano i propri statement
+    spatialQueries_.clear();
+    for (auto& entry : statements_) {
+        sqlite3_finalize(entry.second);
+    }
+    statements_.clear();
+    if (db_) sqlite3_close(db_);
+}
+
+CachedStatement SQLiteConnectionPool::Connection::statement(const std::string& sql) {
+    auto it = statements_.find(sql);
+    if (it != statements_.end()) {
+        return CachedStatement(it->second);
+    }
+
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v3(db_, sql.c_str(), -1, SQLITE_PREPARE_PERSISTENT,
+                           &stmt, nullptr) != SQLITE_OK) {
+        return CachedStatement(nullptr);
+    }
+    statements_.emplace(sql, stmt);
+    return CachedStatement(stmt);
+}
+
+SpatialQuery& SQLiteConnectionPool::Connection::spatialQuery(const std::string& table,
+                                                             const std::string& raColumn,
+                                                             const std::string& decColumn,
+                                                             const std::string& columns,
+                                                             const std::string& condition) {
+    std::string key = table + '\n' + raColumn + '\n' + decColumn + '\n' + columns + '\n' + condition;
+    auto& query = spatialQueries_[key];
+    if (!query) {
+        query = std::make_unique<SpatialQuery>(db_, table, raColumn, decColumn, columns, condition);
+    }
+    return *query;
+}
+
+// ========== Lease ==========
+
+SQLiteConnectionPool::Lease::Lease(Lease&& other) noexcept
+    : pool_(std::move(other.pool_)), connection_(std::move(other.connection_)) {}
+
+SQLiteConnectionPool::Lease& SQLiteConnectionPool::Lease::operator=(Lease&& other) noexcept {
+    if (this != &other) {
+        release();
+        pool_ = std::move(other.pool_);
+        connection_ = std::move(other.connection_);
+    }
+    return *this;
+}
+
+void SQLiteConnectionPool::Lease::release() {
+    if (pool_ && connection_) {
+        pool_->giveBack(std::move(connection_));
+    }
+    connection_.reset();
+    pool_.reset();
+}
+
+// ========== SQLiteConnectionPool ==========
+
+SQLiteConnectionPool::SQLiteConnectionPool(const std::string& path)
+    : path_(path)
+    , maxConnections_(std::max<size_t>(4, std::thread::hardware_concurrency())) {
+}
+
+SQLiteConnectionPool::~SQLiteConnectionPool() = default;
+
+std::shared_ptr<SQLiteConnectionPool> SQLiteConnectionPool::forPath(const std::string& path) {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    auto& pool = registry_[path];
+    if (!pool) {
+        pool = std::shared_ptr<SQLiteConnectionPool>(new SQLiteConnectionPool(path));
+    }
+    return pool;
+}
+
+void SQLiteConnectionPool::closeAll() {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    registry_.clear();
+}
+
+std::unique_ptr<SQLiteConnectionPool::Connection> SQLiteConnectionPool::open() {
+    sqlite3* db = nullptr;
+    if (sqlite3_open_v2(path_.c_str(), &db, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX,
+                        nullptr) != SQLITE_OK) {
+        if (db) sqlite3_close(db);
+        return nullptr;
+    }
+
+    // Mappatura del file e page cache ampie: le ricerche sono letture
+    // casuali ripetute sugli stessi indici
+    std::string pragmas = "PRAGMA mmap_size=" + std::to_string(DEFAULT_MMAP_SIZE) + ";"
+                          "PRAGMA cache_size=-" + std::to_string(DEFAULT_CACHE_SIZE_KB) + ";"
+                          "PRAGMA temp_store=MEMORY;";
+    sqlite3_exec(db, pragmas.c_str(), nullptr, nullptr, nullptr);
+
+    // L'apertura è pigra: la prima lettura dello schema verifica che il
+    // file sia davvero un database
+    if (sqlite3_exec(db, "SELECT count(*) FROM sqlite_master;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+        sqlite3_close(db);
+        return nullptr;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.opened++;
+    return std::unique_ptr<Connection>(new Connection(db, generation_));
+}
+
+SQLiteConnectionPool::Lease SQLiteConnectionPool::acquire() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (idle_.empty() && open_ >= maxConnections_) {
+            stats_.waits++;
+            available_.wait(lock, [this] { return !idle_.empty() || open_ < maxConnections_; });
+        }
+        stats_.checkouts++;
+
+        if (!idle_.empty()) {
+            auto connection = std::move(idle_.back());
+            idle_.pop_back();
+            return Lease(shared_from_this(), std::move(connection));
+        }
+        open_++;   // Posto riservato, la connessione si apre fuori dal lock
+    }
+
+    auto connection = open();
+    if (!connection) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            open_--;
+        }
+        available_.notify_one();
+        return Lease();
+    }
+    return Lease(shared_from_this(), std::move(connection));
+}
+
+void SQLiteConnectionPool::giveBack(std::unique_ptr<Connection> connection) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (connection->generation_ == generation_ && open_ <= maxConnections_) {
+            idle_.push_back(std::move(connection));
+        } else {
+            // Schema cambiato o pool ridimensionato: la connessione si chiude
+            open_--;
+        }
+    }
+    connection.reset();
+    available_.notify_one();
+}
+
+void SQLiteConnectionPool::invalidate() {
+    std::vector<std::unique_ptr<Connection>> closing;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        generation_++;
+        open_ -= idle_.size();
+        closing.swap(idle_);
+    }
+    {
+        std::lock_guard<std::mutex> lock(sharedMutex_);
+        shared_.clear();
+    }
+    available_.notify_all();
+}
+
+std::shared_ptr<const void> SQLiteConnectionPool::sharedData(
+    const std::string& name, Connection& connection,
+    const std::function<std::shared_ptr<const void>(Connection&)>& build) {
+
+    // Il lock resta preso durante la costruzione: chi arriva dopo aspetta
+    // invece di ricostruire lo stesso dato
+    std::lock_guard<std::mutex> lock(sharedMutex_);
+    auto it = shared_.find(name);
+    if (it != shared_.end()) return it->second;
+
+    auto data = build(connection);
+
+    uint64_t generation;
+    {
+        std::lock_guard<std::mutex> poolLock(mutex_);
+        generation = generation_;
+    }
+    // Un dato letto da una connessione precedente a invalidate() non va in cache
+    if (connection.generation_ == generation) {
+        shared_.emplace(name, data);
+    }
+    return data;
+}
+
+void SQLiteConnectionPool::setMaxConnections(size_t maxConnections) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        maxConnections_ = std::max<size_t>(1, maxConnections);
+        while (open_ > maxConnections_ && !idle_.empty()) {
+            idle_.pop_back();
+            open_--;
+        }
+    }
+    available_.notify_all();
+}
+
+size_t SQLiteConnectionPool::getMaxConnections() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return maxConnections_;
+}
+
+SQLitePoolStatistics SQLiteConnectionPool::getStatistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    SQLitePoolStatistics stats = stats_;
+    stats.open = open_;
+    stats.idle = idle_.size();
+    stats.maxConnections = maxConnections_;
+    return stats;
+}
+
+} // namespace catalog
+} // namespace starmap
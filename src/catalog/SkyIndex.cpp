@@ -0,0 +1,358 @@
+#include "starmap/catalog/SkyIndex.h"
+#include <sqlite3.h>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace starmap {
+namespace catalog {
+
+namespace {
+
+constexpr double DEG_TO_RAD = M_PI / 180.0;
+constexpr double RAD_TO_DEG = 180.0 / M_PI;
+
+int zoneOf(double dec) {
+    int zone = static_cast<int>(std::floor((dec + 90.0) / SkyIndex::ZONE_HEIGHT));
+    return std::clamp(zone, 0, SkyIndex::NUM_ZONES - 1);
+}
+
+int cellOf(double ra) {
+    int cell = static_cast<int>(std::floor(ra / SkyIndex::ZONE_HEIGHT));
+    return std::clamp(cell, 0, SkyIndex::RA_CELLS - 1);
+}
+
+double normalizeRa(double ra) {
+    ra = std::fmod(ra, 360.0);
+    return ra < 0.0 ? ra + 360.0 : ra;
+}
+
+/**
+ * @brief Semi-ampiezza in RA (gradi) di un cono alla declinazione dec
+ *
+ * Risolve cos r = sin d sin d0 + cos d cos d0 cos a; restituisce 180
+ * quando l'intero parallelo è nel cono.
+ */
+double coneHalfWidth(double dec, double dec0, double radius) {
+    double cosD = std::cos(dec * DEG_TO_RAD);
+    double cosD0 = std::cos(dec0 * DEG_TO_RAD);
+    if (cosD < 1e-12 || cosD0 < 1e-12) return 180.0;
+
+    double c = (std::cos(radius * DEG_TO_RAD) -
+                std::sin(dec * DEG_TO_RAD) * std::sin(dec0 * DEG_TO_RAD)) / (cosD * cosD0);
+    if (c <= -1.0) return 180.0;
+    if (c >= 1.0) return 0.0;
+    return std::acos(c) * RAD_TO_DEG;
+}
+
+/**
+ * @brief Buffer di intervalli a capacità fissa (nessuna allocazione)
+ */
+struct RangeBuffer {
+    PixelRange* data;
+    size_t capacity;
+    size_t count = 0;
+
+    void push(int64_t first, int64_t last) {
+        // Unisce intervalli contigui (es. zone consecutive interamente coperte)
+        if (count > 0 && data[count - 1].last + 1 >= first) {
+            data[count - 1].last = std::max(data[count - 1].last, last);
+        } else if (count < capacity) {
+            data[count++] = {first, last};
+        }
+    }
+};
+
+/**
+ * @brief Accoda gli intervalli di una zona per le RA [raMin, raMax]
+ */
+void appendZone(RangeBuffer& ranges, int zone, double raMin, double raMax) {
+    const int64_t base = static_cast<int64_t>(zone) * SkyIndex::RA_CELLS;
+
+    if (raMax - raMin >= 360.0) {
+        ranges.push(base, base + SkyIndex::RA_CELLS - 1);
+        return;
+    }
+
+    double lo = normalizeRa(raMin);
+    double hi = lo + (raMax - raMin);
+    if (hi < 360.0) {
+        ranges.push(base + cellOf(lo), base + cellOf(hi));
+    } else {
+        // A cavallo di 0h: [0, hi-360] e [lo, 360)
+        ranges.push(base, base + cellOf(hi - 360.0));
+        ranges.push(base + cellOf(lo), base + SkyIndex::RA_CELLS - 1);
+    }
+}
+
+} // anonymous namespace
+
+int64_t SkyIndex::pixelId(double ra, double dec) {
+    return static_cast<int64_t>(zoneOf(dec)) * RA_CELLS + cellOf(normalizeRa(ra));
+}
+
+std::vector<PixelRange> SkyIndex::coverCone(double ra, double dec, double radiusDeg) {
+    std::vector<PixelRange> ranges(MAX_COVER_RANGES);
+    ranges.resize(coverCone(ra, dec, radiusDeg, ranges.data(), ranges.size()));
+    return ranges;
+}
+
+size_t SkyIndex::coverCone(double ra, double dec, double radiusDeg,
+                           PixelRange* out, size_t capacity) {
+    RangeBuffer ranges{out, capacity};
+    if (radiusDeg <= 0.0) {
+        int64_t id = pixelId(ra, dec);
+        ranges.push(id, id);
+        return ranges.count;
+    }
+
+    double decLo = std::max(-90.0, dec - radiusDeg);
+    double decHi = std::min(90.0, dec + radiusDeg);
+
+    // Declinazione di massima ampiezza in RA (se il cono non contiene un polo)
+    double sinPeak = std::sin(dec * DEG_TO_RAD) / std::cos(radiusDeg * DEG_TO_RAD);
+
+    for (int zone = zoneOf(decLo); zone <= zoneOf(decHi); ++zone) {
+        double zoneLo = std::max(decLo, -90.0 + zone * ZONE_HEIGHT);
+        double zoneHi = std::min(decHi, -90.0 + (zone + 1) * ZONE_HEIGHT);
+
+        // L'ampiezza è unimodale in dec: basta valutarla agli estremi
+        // della fascia e nel picco, se cade al suo interno
+        double halfWidth = std::max(coneHalfWidth(zoneLo, dec, radiusDeg),
+                                    coneHalfWidth(zoneHi, dec, radiusDeg));
+        if (std::abs(sinPeak) <= 1.0) {
+            double peak = std::asin(sinPeak) * RAD_TO_DEG;
+            if (peak > zoneLo && peak < zoneHi) {
+                halfWidth = std::max(halfWidth, coneHalfWidth(peak, dec, radiusDeg));
+            }
+        }
+
+        if (halfWidth >= 180.0) {
+            appendZone(ranges, zone, 0.0, 360.0);
+        } else {
+            appendZone(ranges, zone, ra - halfWidth, ra + halfWidth);
+        }
+    }
+
+    return ranges.count;
+}
+
+std::vector<PixelRange> SkyIndex::coverBox(double raMin, double raMax,
+                                           double decMin, double decMax) {
+    std::vector<PixelRange> out(MAX_COVER_RANGES);
+    RangeBuffer ranges{out.data(), out.size()};
+    if (raMin > raMax) raMax += 360.0;
+
+    int zoneLo = zoneOf(std::max(-90.0, decMin));
+    int zoneHi = zoneOf(std::min(90.0, decMax));
+    for (int zone = zoneLo; zone <= zoneHi; ++zone) {
+        appendZone(ranges, zone, raMin, raMax);
+    }
+    out.resize(ranges.count);
+    return out;
+}
+
+std::vector<SkyBox> SkyIndex::coneBoxes(double ra, double dec, double radiusDeg) {
+    double decMin = std::max(-90.0, dec - radiusDeg);
+    double decMax = std::min(90.0, dec + radiusDeg);
+
+    // Il cono contiene un polo: tutte le RA
+    if (decMax >= 90.0 || decMin <= -90.0) {
+        return {{0.0, 360.0, decMin, decMax}};
+    }
+
+    double s = std::sin(radiusDeg * DEG_TO_RAD) / std::cos(dec * DEG_TO_RAD);
+    if (s >= 1.0) {
+        return {{0.0, 360.0, decMin, decMax}};
+    }
+
+    double halfWidth = std::asin(s) * RAD_TO_DEG;
+    return splitBox(ra - halfWidth, ra + halfWidth, decMin, decMax);
+}
+
+std::vector<SkyBox> SkyIndex::splitBox(double raMin, double raMax,
+                                       double decMin, double decMax) {
+    decMin = std::max(-90.0, decMin);
+    decMax = std::min(90.0, decMax);
+    if (raMin > raMax) raMax += 360.0;
+
+    if (raMax - raMin >= 360.0) {
+        return {{0.0, 360.0, decMin, decMax}};
+    }
+
+    double lo = normalizeRa(raMin);
+    double hi = lo + (raMax - raMin);
+    if (hi <= 360.0) {
+        return {{lo, hi, decMin, decMax}};
+    }
+    return {{lo, 360.0, decMin, decMax}, {0.0, hi - 360.0, decMin, decMax}};
+}
+
+void SkyIndex::withinCone(const double* ra, const double* dec, size_t count,
+                          double centerRa, double centerDec, double radiusDeg,
+                          uint8_t* keep) {
+    // Prodotto scalare tra versori: cos(sep) >= cos(r)
+    const double cosRadius = std::cos(radiusDeg * DEG_TO_RAD);
+    const double sinDec0 = std::sin(centerDec * DEG_TO_RAD);
+    const double cosDec0 = std::cos(centerDec * DEG_TO_RAD);
+
+    for (size_t i = 0; i < count; ++i) {
+        double d = dec[i] * DEG_TO_RAD;
+        double dRa = (ra[i] - centerRa) * DEG_TO_RAD;
+        double cosSep = std::sin(d) * sinDec0 + std::cos(d) * cosDec0 * std::cos(dRa);
+        keep[i] = cosSep >= cosRadius;
+    }
+}
+
+void SkyIndex::withinBox(const double* ra, const double* dec, size_t count,
+                         double raMin, double raMax, double decMin, double decMax,
+                         uint8_t* keep) {
+    if (raMin > raMax) raMax += 360.0;
+    const bool allRa = raMax - raMin >= 360.0;
+    const double lo = normalizeRa(raMin);
+    const double width = raMax - raMin;
+
+    for (size_t i = 0; i < count; ++i) {
+        double offset = ra[i] - lo;
+        if (offset < 0.0) offset += 360.0;
+        keep[i] = dec[i] >= decMin && dec[i] <= decMax && (allRa || offset <= width);
+    }
+}
+
+// ========== SpatialQuery ==========
+
+SpatialQuery::SpatialQuery(sqlite3* db,
+                           const std::string& table,
+                           const std::string& raColumn,
+                           const std::string& decColumn,
+                           const std::string& columns,
+                           const std::string& condition)
+    : db_(db) {
+
+    if (!db_) return;
+
+    // L'indice a pixel si usa solo se createIndices() lo ha costruito
+    std::string checkIndex = "SELECT 1 FROM sqlite_master WHERE type='index' AND name='" +
+                             pixelIndexName(table) + "';";
+    sqlite3_stmt* stmt = nullptr;
+    if (sqlite3_prepare_v2(db_, checkIndex.c_str(), -1, &stmt, nullptr) == SQLITE_OK) {
+        usePixels_ = (sqlite3_step(stmt) == SQLITE_ROW);
+        sqlite3_finalize(stmt);
+    }
+
+    std::string sql = selectSql(table, raColumn, decColumn, columns, condition, usePixels_);
+
+    sqlite3_stmt** target = usePixels_ ? &pixelStmt_ : &boxStmt_;
+    if (sqlite3_prepare_v2(db_, sql.c_str(), -1, target, nullptr) != SQLITE_OK) {
+        std::cerr << "Failed to prepare spatial query on " << table << ": "
+                  << sqlite3_errmsg(db_) << std::endl;
+        *target = nullptr;
+    }
+}
+
+SpatialQuery::~SpatialQuery() {
+    if (pixelStmt_) sqlite3_finalize(pixelStmt_);
+    if (boxStmt_) sqlite3_finalize(boxStmt_);
+}
+
+std::string SpatialQuery::pixelIndexName(const std::string& table) {
+    return "idx_" + table + "_sky_pix";
+}
+
+std::string SpatialQuery::selectSql(const std::string& table,
+                                    const std::string& raColumn,
+                                    const std::string& decColumn,
+                                    const std::string& columns,
+                                    const std::string& condition,
+                                    bool pixels) {
+    std::string select = "SELECT " + raColumn + ", " + decColumn +
+                         (columns.empty() ? "" : ", " + columns) +
+                         " FROM " + table + " WHERE ";
+    std::string extra = condition.empty() ? "" : " AND (" + condition + ")";
+
+    return pixels
+        ? select + "sky_pix BETWEEN ? AND ?" + extra + ";"
+        : select + raColumn + " BETWEEN ? AND ? AND " + decColumn + " BETWEEN ? AND ?" + extra + ";";
+}
+
+size_t SpatialQuery::scanPixels(const std::vector<PixelRange>& ranges, const RowCallback& onRow) {
+    if (!pixelStmt_) return 0;
+
+    size_t rows = 0;
+    for (const auto& range : ranges) {
+        sqlite3_bind_int64(pixelStmt_, 1, range.first);
+        sqlite3_bind_int64(pixelStmt_, 2, range.last);
+        while (sqlite3_step(pixelStmt_) == SQLITE_ROW) {
+            onRow(pixelStmt_);
+            rows++;
+        }
+        sqlite3_reset(pixelStmt_);
+    }
+    return rows;
+}
+
+size_t SpatialQuery::scanBoxes(const std::vector<SkyBox>& boxes, const RowCallback& onRow) {
+    if (!boxStmt_) return 0;
+
+    size_t rows = 0;
+    for (const auto& b : boxes) {
+        sqlite3_bind_double(boxStmt_, 1, b.raMin);
+        sqlite3_bind_double(boxStmt_, 2, b.raMax);
+        sqlite3_bind_double(boxStmt_, 3, b.decMin);
+        sqlite3_bind_double(boxStmt_, 4, b.decMax);
+        while (sqlite3_step(boxStmt_) == SQLITE_ROW) {
+            onRow(boxStmt_);
+            rows++;
+        }
+        sqlite3_reset(boxStmt_);
+    }
+    return rows;
+}
+
+std::vector<uint8_t> SpatialQuery::cone(double ra, double dec, double radiusDeg,
+                                        const RowCallback& onRow) {
+    candidateRa_.clear();
+    candidateDec_.clear();
+
+    auto collect = [&](sqlite3_stmt* stmt) {
+        candidateRa_.push_back(sqlite3_column_double(stmt, 0));
+        candidateDec_.push_back(sqlite3_column_double(stmt, 1));
+        onRow(stmt);
+    };
+
+    if (usePixels_) {
+        scanPixels(SkyIndex::coverCone(ra, dec, radiusDeg), collect);
+    } else {
+        scanBoxes(SkyIndex::coneBoxes(ra, dec, radiusDeg), collect);
+    }
+
+    std::vector<uint8_t> keep(candidateRa_.size());
+    SkyIndex::withinCone(candidateRa_.data(), candidateDec_.data(), keep.size(),
+                         ra, dec, radiusDeg, keep.data());
+    return keep;
+}
+
+size_t SpatialQuery::box(double raMin, double raMax, double decMin, double decMax,
+                         const RowCallback& onRow) {
+    if (!usePixels_) {
+        // Le condizioni SQL sul box sono già esatte
+        return scanBoxes(SkyIndex::splitBox(raMin, raMax, decMin, decMax), onRow);
+    }
+
+    size_t rows = 0;
+    auto filter = [&](sqlite3_stmt* stmt) {
+        double starRa = sqlite3_column_double(stmt, 0);
+        double starDec = sqlite3_column_double(stmt, 1);
+        uint8_t inside = 0;
+        SkyIndex::withinBox(&starRa, &starDec, 1, raMin, raMax, decMin, decMax, &inside);
+        if (inside) {
+            onRow(stmt);
+            rows++;
+        }
+    };
+    scanPixels(SkyIndex::coverBox(raMin, raMax, decMin, decMax), filter);
+    return rows;
+}
+
+} // namespace catalog
+} // namespace starmap
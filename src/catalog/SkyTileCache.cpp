@@ -0,0 +1,624 @@
+#include "starmap/catalog/SkyTileCache.h"
+#include "starmap/catalog/SkyIndex.h"
+#include "starmap/core/UnitVector.h"
+#include <zlib.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace starmap {
+namespace catalog {
+
+namespace {
+
+constexpr char TILE_MAGIC[8] = {'S', 'M', 'T', 'I', 'L', 'E', '0', '1'};
+constexpr const char* TILE_DIR_PREFIX = "tiles_v";
+
+// File che identifica una directory di tile creata da SkyTileCache
+constexpr const char* OWNER_MARKER = ".starmap_tiles";
+
+// Pixel di SkyIndex per lato di tile
+constexpr int PIXELS_PER_TILE = static_cast<int>(SkyTileCache::TILE_SIZE / SkyIndex::ZONE_HEIGHT);
+static_assert(PIXELS_PER_TILE * SkyTileCache::TILE_ZONES == SkyIndex::NUM_ZONES,
+              "Le tile devono raggruppare zone intere di SkyIndex");
+static_assert(PIXELS_PER_TILE * SkyTileCache::TILE_CELLS == SkyIndex::RA_CELLS,
+              "Le tile devono raggruppare celle intere di SkyIndex");
+
+// Quantizzazione delle posizioni: 1e-9 gradi
+constexpr double POSITION_SCALE = 1e9;
+
+constexpr double DEG_TO_RAD = M_PI / 180.0;
+constexpr double RAD_TO_DEG = 180.0 / M_PI;
+
+struct TileHeader {
+    char magic[8];
+    uint32_t version;
+    int32_t tileId;
+    float depth;          // Magnitudine fino alla quale la tile è completa
+    uint32_t numChunks;
+};
+
+// Un blocco per ogni magnitudine intera presente nella tile
+struct ChunkHeader {
+    float minMagnitude;
+    float maxMagnitude;
+    uint32_t count;
+    uint32_t rawSize;
+    uint32_t compressedSize;
+};
+
+// ========== Codifica varint / zigzag ==========
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void putSigned(std::vector<uint8_t>& out, int64_t value) {
+    putVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+template<typename T>
+void putRaw(std::vector<uint8_t>& out, T value) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&value);
+    out.insert(out.end(), bytes, bytes + sizeof(T));
+}
+
+/**
+ * @brief Lettore sequenziale di un blocco decompresso (con controllo dei limiti)
+ */
+class ChunkReader {
+public:
+    ChunkReader(const uint8_t* data, size_t size) : pos_(data), end_(data + size) {}
+
+    bool ok() const { return ok_; }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos_ >= end_) { ok_ = false; return 0; }
+            uint8_t byte = *pos_++;
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        ok_ = false;
+        return 0;
+    }
+
+    int64_t signedVarint() {
+        uint64_t value = varint();
+        return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+    }
+
+    template<typename T>
+    T raw() {
+        T value{};
+        if (static_cast<size_t>(end_ - pos_) < sizeof(T)) { ok_ = false; return value; }
+        std::memcpy(&value, pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return value;
+    }
+
+    std::string string(size_t length) {
+        if (static_cast<size_t>(end_ - pos_) < length) { ok_ = false; return std::string(); }
+        std::string value(reinterpret_cast<const char*>(pos_), length);
+        pos_ += length;
+        return value;
+    }
+
+private:
+    const uint8_t* pos_;
+    const uint8_t* end_;
+    bool ok_ = true;
+};
+
+// Le magnitudini sono positive: l'ordine dei bit coincide con quello dei valori
+uint32_t magnitudeBits(float magnitude) {
+    uint32_t bits;
+    std::memcpy(&bits, &magnitude, sizeof(bits));
+    return bits;
+}
+
+float magnitudeFromBits(uint32_t bits) {
+    float magnitude;
+    std::memcpy(&magnitude, &bits, sizeof(magnitude));
+    return magnitude;
+}
+
+void tileOrigin(int tileId, double& raMin, double& decMin) {
+    raMin = (tileId % SkyTileCache::TILE_CELLS) * SkyTileCache::TILE_SIZE;
+    decMin = -90.0 + (tileId / SkyTileCache::TILE_CELLS) * SkyTileCache::TILE_SIZE;
+}
+
+/**
+ * @brief Codifica le righe [begin, end) di order (ordinate per magnitudine)
+ */
+void encodeChunk(const core::StarBlock& stars, const std::vector<uint32_t>& order,
+                 size_t begin, size_t end, double raMin, double decMin,
+                 std::vector<uint8_t>& out) {
+    int64_t prevRa = 0, prevDec = 0, prevId = 0;
+    uint32_t prevMag = 0;
+
+    for (size_t k = begin; k < end; ++k) {
+        size_t i = order[k];
+
+        int64_t ra = std::llround((stars.getRightAscension(i) - raMin) * POSITION_SCALE);
+        int64_t dec = std::llround((stars.getDeclination(i) - decMin) * POSITION_SCALE);
+        int64_t id = stars.getGaiaId(i);
+        uint32_t mag = magnitudeBits(static_cast<float>(stars.getMagnitude(i)));
+
+        putSigned(out, ra - prevRa);
+        putSigned(out, dec - prevDec);
+        putSigned(out, id - prevId);
+        putVarint(out, mag - prevMag);
+        prevRa = ra;
+        prevDec = dec;
+        prevId = id;
+        prevMag = mag;
+
+        uint8_t flags = stars.flagsColumn()[i];
+        out.push_back(flags);
+        if (flags & core::FIELD_COLOR) putRaw(out, stars.colorColumn()[i]);
+        if (flags & core::FIELD_PARALLAX) putRaw(out, stars.parallaxColumn()[i]);
+        if (flags & core::FIELD_PROPER_MOTION) {
+            putRaw(out, stars.pmRAColumn()[i]);
+            putRaw(out, stars.pmDecColumn()[i]);
+        }
+        if (flags & core::FIELD_SAO) putVarint(out, static_cast<uint32_t>(stars.saoColumn()[i]));
+        if (flags & core::FIELD_NAME) {
+            const std::string& name = stars.getName(i);
+            putVarint(out, name.size());
+            out.insert(out.end(), name.begin(), name.end());
+        }
+    }
+}
+
+/**
+ * @brief Decodifica un blocco accodando le righe con magnitudine <= maxMagnitude
+ */
+bool decodeChunk(const uint8_t* data, size_t size, uint32_t count,
+                 double raMin, double decMin, double maxMagnitude,
+                 core::StarBlock& out) {
+    ChunkReader reader(data, size);
+    int64_t ra = 0, dec = 0, id = 0;
+    uint32_t mag = 0;
+
+    for (uint32_t k = 0; k < count; ++k) {
+        ra += reader.signedVarint();
+        dec += reader.signedVarint();
+        id += reader.signedVarint();
+        mag += static_cast<uint32_t>(reader.varint());
+        uint8_t flags = reader.raw<uint8_t>();
+
+        float color = 0, parallax = 0, pmRA = 0, pmDec = 0;
+        int sao = 0;
+        std::string name;
+        if (flags & core::FIELD_COLOR) color = reader.raw<float>();
+        if (flags & core::FIELD_PARALLAX) parallax = reader.raw<float>();
+        if (flags & core::FIELD_PROPER_MOTION) {
+            pmRA = reader.raw<float>();
+            pmDec = reader.raw<float>();
+        }
+        if (flags & core::FIELD_SAO) sao = static_cast<int>(reader.varint());
+        if (flags & core::FIELD_NAME) name = reader.string(reader.varint());
+        if (!reader.ok()) return false;
+
+        float magnitude = magnitudeFromBits(mag);
+        // Righe ordinate per magnitudine: le successive sono tutte più deboli
+        if (magnitude > maxMagnitude) break;
+
+        size_t i = out.append(raMin + ra / POSITION_SCALE, decMin + dec / POSITION_SCALE,
+                              magnitude, id);
+        if (flags & core::FIELD_COLOR) out.setColorIndex(i, color);
+        if (flags & core::FIELD_PARALLAX) out.setParallax(i, parallax);
+        if (flags & core::FIELD_PROPER_MOTION) out.setProperMotion(i, pmRA, pmDec);
+        if (flags & core::FIELD_SAO) out.setSAONumber(i, sao);
+        if (flags & core::FIELD_NAME) out.setName(i, name);
+    }
+    return true;
+}
+
+double angularDistance(double ra1, double dec1, double ra2, double dec2) {
+    double d1 = dec1 * DEG_TO_RAD, d2 = dec2 * DEG_TO_RAD;
+    double cosDist = std::sin(d1) * std::sin(d2) +
+                     std::cos(d1) * std::cos(d2) * std::cos((ra2 - ra1) * DEG_TO_RAD);
+    return std::acos(std::max(-1.0, std::min(1.0, cosDist))) * RAD_TO_DEG;
+}
+
+uint64_t fnv1a(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+uint64_t hashFile(uint64_t hash, const fs::path& path) {
+    std::error_code ec;
+    std::string name = path.string();
+    hash = fnv1a(hash, name.data(), name.size());
+
+    uint64_t size = fs::file_size(path, ec);
+    if (ec) return hash;
+    auto mtime = fs::last_write_time(path, ec).time_since_epoch().count();
+    hash = fnv1a(hash, &size, sizeof(size));
+    return fnv1a(hash, &mtime, sizeof(mtime));
+}
+
+} // namespace
+
+SkyTileCache::SkyTileCache(const std::string& directory, uint64_t catalogFingerprint) {
+    if (directory.empty()) return;
+
+    char name[64];
+    std::snprintf(name, sizeof(name), "%s%u_%016llx", TILE_DIR_PREFIX, FORMAT_VERSION,
+                  static_cast<unsigned long long>(catalogFingerprint));
+    tileDirectory_ = (fs::path(directory) / name).string();
+
+    std::error_code ec;
+    fs::create_directories(tileDirectory_, ec);
+    if (ec) {
+        std::cerr << "Cannot create tile cache directory " << tileDirectory_
+                  << ": " << ec.message() << std::endl;
+        return;
+    }
+    enabled_ = true;
+
+    // Marcatore per removeObsoleteTiles(): solo queste directory sono rimovibili
+    fs::path marker = fs::path(tileDirectory_) / OWNER_MARKER;
+    if (!fs::exists(marker, ec)) {
+        std::ofstream(marker) << "starmap tile cache v" << FORMAT_VERSION << "\n";
+    }
+}
+
+size_t SkyTileCache::removeObsoleteTiles() {
+    if (!enabled_) return 0;
+
+    fs::path current(tileDirectory_);
+    size_t removed = 0;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(current.parent_path(), ec)) {
+        std::string entryName = entry.path().filename().string();
+        std::error_code entryError;
+        if (!entry.is_directory(entryError) || entryName == current.filename().string() ||
+            entryName.compare(0, std::strlen(TILE_DIR_PREFIX), TILE_DIR_PREFIX) != 0 ||
+            !fs::exists(entry.path() / OWNER_MARKER, entryError)) {
+            continue;
+        }
+        if (fs::remove_all(entry.path(), entryError) > 0 && !entryError) removed++;
+    }
+    return removed;
+}
+
+int SkyTileCache::tileId(double ra, double dec) {
+    int64_t pixel = SkyIndex::pixelId(ra, dec);
+    int zone = static_cast<int>(pixel / SkyIndex::RA_CELLS);
+    int cell = static_cast<int>(pixel % SkyIndex::RA_CELLS);
+    return (zone / PIXELS_PER_TILE) * TILE_CELLS + cell / PIXELS_PER_TILE;
+}
+
+std::vector<int> SkyTileCache::coverCone(double ra, double dec, double radiusDeg) {
+    PixelRange ranges[SkyIndex::MAX_COVER_RANGES];
+    size_t numRanges = SkyIndex::coverCone(ra, dec, radiusDeg, ranges, SkyIndex::MAX_COVER_RANGES);
+
+    std::vector<int> tiles;
+    for (size_t r = 0; r < numRanges; ++r) {
+        int64_t firstZone = ranges[r].first / SkyIndex::RA_CELLS;
+        int64_t lastZone = ranges[r].last / SkyIndex::RA_CELLS;
+
+        // Un intervallo può attraversare più zone (zone interamente coperte)
+        for (int64_t zone = firstZone; zone <= lastZone; ++zone) {
+            int64_t firstCell = zone == firstZone ? ranges[r].first % SkyIndex::RA_CELLS : 0;
+            int64_t lastCell = zone == lastZone ? ranges[r].last % SkyIndex::RA_CELLS
+                                                : SkyIndex::RA_CELLS - 1;
+            int tileZone = static_cast<int>(zone / PIXELS_PER_TILE);
+            for (int64_t cell = firstCell / PIXELS_PER_TILE; cell <= lastCell / PIXELS_PER_TILE; ++cell) {
+                tiles.push_back(tileZone * TILE_CELLS + static_cast<int>(cell));
+            }
+        }
+    }
+
+    std::sort(tiles.begin(), tiles.end());
+    tiles.erase(std::unique(tiles.begin(), tiles.end()), tiles.end());
+    return tiles;
+}
+
+void SkyTileCache::tileCone(int tileId, double& ra, double& dec, double& radiusDeg) {
+    double raMin, decMin;
+    tileOrigin(tileId, raMin, decMin);
+    ra = raMin + TILE_SIZE / 2.0;
+    dec = decMin + TILE_SIZE / 2.0;
+
+    // Sulla tile la distanza dal centro è massima in uno dei vertici
+    radiusDeg = 0.0;
+    for (double cornerRa : {raMin, raMin + TILE_SIZE}) {
+        for (double cornerDec : {decMin, decMin + TILE_SIZE}) {
+            radiusDeg = std::max(radiusDeg, angularDistance(ra, dec, cornerRa, cornerDec));
+        }
+    }
+    radiusDeg += 1e-6;
+}
+
+std::string SkyTileCache::tilePath(int tileId) const {
+    return tileDirectory_ + "/" + std::to_string(tileId) + ".tile";
+}
+
+bool SkyTileCache::readTile(int tileId, double maxMagnitude, core::StarBlock& out) {
+    return readChunks(tileId, maxMagnitude, out, nullptr);
+}
+
+bool SkyTileCache::readChunks(int tileId, double maxMagnitude, core::StarBlock& out,
+                              const std::function<void(float)>& onChunk) {
+    std::ifstream in(tilePath(tileId), std::ios::binary);
+    if (!in) return false;
+
+    TileHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, TILE_MAGIC, sizeof(TILE_MAGIC)) != 0 ||
+        header.version != FORMAT_VERSION || header.tileId != tileId) {
+        return false;
+    }
+    if (header.depth < maxMagnitude) return false;
+
+    std::vector<ChunkHeader> chunks(header.numChunks);
+    if (!in.read(reinterpret_cast<char*>(chunks.data()), chunks.size() * sizeof(ChunkHeader))) {
+        return false;
+    }
+
+    double raMin, decMin;
+    tileOrigin(tileId, raMin, decMin);
+
+    // Su errore la tile viene scartata: si ripristina il blocco di uscita
+    size_t initialSize = out.size();
+    std::vector<uint8_t> compressed, raw;
+    for (const auto& chunk : chunks) {
+        if (chunk.minMagnitude > maxMagnitude) break;
+
+        compressed.resize(chunk.compressedSize);
+        raw.resize(chunk.rawSize);
+        uLongf rawSize = chunk.rawSize;
+        bool ok = static_cast<bool>(in.read(reinterpret_cast<char*>(compressed.data()), compressed.size())) &&
+                  uncompress(raw.data(), &rawSize, compressed.data(), compressed.size()) == Z_OK &&
+                  rawSize == chunk.rawSize &&
+                  decodeChunk(raw.data(), raw.size(), chunk.count, raMin, decMin, maxMagnitude, out);
+        if (!ok) {
+            std::cerr << "Corrupted sky tile, ignoring: " << tilePath(tileId) << std::endl;
+            out.truncate(initialSize);
+            return false;
+        }
+        bytesRead_ += compressed.size();
+        if (onChunk) onChunk(chunk.maxMagnitude);
+    }
+
+    return true;
+}
+
+bool SkyTileCache::writeTile(int tileId, double depth, const core::StarBlock& stars) {
+    if (!enabled_) return false;
+
+    double raMin, decMin;
+    tileOrigin(tileId, raMin, decMin);
+    std::vector<uint32_t> order = stars.sortedByMagnitude();
+
+    // Blocchi per magnitudine intera
+    std::vector<ChunkHeader> chunks;
+    std::vector<std::vector<uint8_t>> payloads;
+    std::vector<uint8_t> raw;
+    for (size_t begin = 0; begin < order.size();) {
+        double bin = std::floor(stars.getMagnitude(order[begin]));
+        size_t end = begin;
+        while (end < order.size() && std::floor(stars.getMagnitude(order[end])) == bin) end++;
+
+        raw.clear();
+        encodeChunk(stars, order, begin, end, raMin, decMin, raw);
+
+        uLongf compressedSize = compressBound(raw.size());
+        std::vector<uint8_t> compressed(compressedSize);
+        if (compress2(compressed.data(), &compressedSize, raw.data(), raw.size(),
+                      Z_DEFAULT_COMPRESSION) != Z_OK) {
+            std::cerr << "Cannot compress sky tile " << tileId << std::endl;
+            return false;
+        }
+        compressed.resize(compressedSize);
+
+        ChunkHeader chunk;
+        chunk.minMagnitude = static_cast<float>(stars.getMagnitude(order[begin]));
+        chunk.maxMagnitude = static_cast<float>(stars.getMagnitude(order[end - 1]));
+        chunk.count = static_cast<uint32_t>(end - begin);
+        chunk.rawSize = static_cast<uint32_t>(raw.size());
+        chunk.compressedSize = static_cast<uint32_t>(compressed.size());
+        chunks.push_back(chunk);
+        payloads.push_back(std::move(compressed));
+        begin = end;
+    }
+
+    TileHeader header;
+    std::memcpy(header.magic, TILE_MAGIC, sizeof(TILE_MAGIC));
+    header.version = FORMAT_VERSION;
+    header.tileId = tileId;
+    header.depth = static_cast<float>(depth);
+    header.numChunks = static_cast<uint32_t>(chunks.size());
+
+    // File temporaneo univoco e rename: lettori e altri processi vedono
+    // sempre una tile completa
+    std::string path = tilePath(tileId);
+    std::ostringstream tmpName;
+    tmpName << path << ".tmp." << getpid() << "." << std::hash<std::thread::id>()(std::this_thread::get_id());
+    std::string tmpPath = tmpName.str();
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "Cannot create sky tile file: " << tmpPath << std::endl;
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(chunks.data()), chunks.size() * sizeof(ChunkHeader));
+        for (const auto& payload : payloads) {
+            out.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+        }
+        if (!out) {
+            std::cerr << "Error writing sky tile file: " << tmpPath << std::endl;
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+    }
+
+    if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "Cannot rename sky tile file: " << tmpPath << std::endl;
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+    tilesWritten_++;
+    return true;
+}
+
+core::StarBlock SkyTileCache::queryCone(double ra, double dec, double radiusDeg,
+                                        double maxMagnitude, const Fetcher& fetch) {
+    core::StarBlock stars;
+
+    // Le tile vengono lette dal catalogo a magnitudini intere, così le
+    // richieste successive con limiti vicini non le invalidano
+    double depth = std::ceil(maxMagnitude);
+
+    for (int tile : coverCone(ra, dec, radiusDeg)) {
+        if (readTile(tile, maxMagnitude, stars)) {
+            tileHits_++;
+            continue;
+        }
+        tileMisses_++;
+
+        core::StarBlock fetched = fetchTile(tile, depth, fetch);
+        for (uint32_t i : fetched.sortedByMagnitude()) {
+            if (fetched.getMagnitude(i) > maxMagnitude) break;
+            stars.appendRow(fetched, i);
+        }
+    }
+
+    // Verifica esatta sul cono dai versori, che restano nel risultato:
+    // chi disegna o filtra di nuovo il blocco non ricalcola la trigonometria
+    stars.computeUnitVectors();
+    std::vector<uint8_t> keep(stars.size());
+    core::SphericalCap::cone(ra, dec, radiusDeg).contains(
+        stars.xColumn().data(), stars.yColumn().data(), stars.zColumn().data(),
+        stars.size(), keep.data());
+    stars.retain(keep);
+    return stars;
+}
+
+size_t SkyTileCache::forEachInCone(double ra, double dec, double radiusDeg,
+                                   double maxMagnitude, const Fetcher& fetch,
+                                   const Visitor& visit) {
+    const auto cap = core::SphericalCap::cone(ra, dec, radiusDeg);
+    double depth = std::ceil(maxMagnitude);   // vedi queryCone
+
+    // Blocco di lavoro e maschera riusati per tutti i blocchi delle tile
+    core::StarBlock chunk;
+    std::vector<uint8_t> keep;
+    size_t visited = 0;
+    auto visitChunk = [&]() {
+        chunk.computeUnitVectors();
+        keep.resize(chunk.size());
+        cap.contains(chunk.xColumn().data(), chunk.yColumn().data(), chunk.zColumn().data(),
+                     chunk.size(), keep.data());
+        for (size_t i = 0; i < chunk.size(); ++i) {
+            if (keep[i]) {
+                visit(chunk, i);
+                visited++;
+            }
+        }
+        chunk.clear();
+    };
+
+    for (int tile : coverCone(ra, dec, radiusDeg)) {
+        // Blocchi già consegnati se la tile si rivela corrotta a metà
+        float visitedUpTo = -std::numeric_limits<float>::infinity();
+        bool complete = readChunks(tile, maxMagnitude, chunk, [&](float chunkMaxMagnitude) {
+            visitChunk();
+            visitedUpTo = chunkMaxMagnitude;
+        });
+        if (complete) {
+            tileHits_++;
+            continue;
+        }
+        tileMisses_++;
+        chunk.clear();
+
+        // I blocchi sono per magnitudine intera: le stelle fino a
+        // visitedUpTo sono già state visitate
+        core::StarBlock fetched = fetchTile(tile, depth, fetch);
+        for (uint32_t i : fetched.sortedByMagnitude()) {
+            if (fetched.getMagnitude(i) > maxMagnitude) break;
+            if (static_cast<float>(fetched.getMagnitude(i)) <= visitedUpTo) continue;
+            chunk.appendRow(fetched, i);
+        }
+        visitChunk();
+    }
+    return visited;
+}
+
+core::StarBlock SkyTileCache::fetchTile(int tileId, double depth, const Fetcher& fetch) {
+    double tileRa, tileDec, tileRadius;
+    tileCone(tileId, tileRa, tileDec, tileRadius);
+    core::StarBlock fetched = fetch(tileRa, tileDec, tileRadius, depth);
+
+    // Solo le stelle che appartengono alla tile
+    std::vector<uint8_t> keep(fetched.size());
+    for (size_t i = 0; i < fetched.size(); ++i) {
+        keep[i] = fetched.getMagnitude(i) <= depth &&
+                  SkyTileCache::tileId(fetched.getRightAscension(i), fetched.getDeclination(i)) == tileId;
+    }
+    fetched.retain(keep);
+
+    writeTile(tileId, depth, fetched);
+    return fetched;
+}
+
+uint64_t SkyTileCache::fingerprint(const std::vector<std::string>& paths) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+
+    for (const auto& path : paths) {
+        std::error_code ec;
+        if (fs::is_directory(path, ec)) {
+            // Ordine di visita non garantito: si ordinano i path
+            std::vector<fs::path> files;
+            for (auto it = fs::recursive_directory_iterator(path, ec);
+                 !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                if (it->is_regular_file(ec)) files.push_back(it->path());
+            }
+            std::sort(files.begin(), files.end());
+            for (const auto& file : files) hash = hashFile(hash, file);
+        } else {
+            hash = hashFile(hash, path);
+        }
+    }
+
+    return hash;
+}
+
+SkyTileCacheStatistics SkyTileCache::getStatistics() const {
+    SkyTileCacheStatistics stats;
+    stats.tileHits = tileHits_;
+    stats.tileMisses = tileMisses_;
+    stats.tilesWritten = tilesWritten_;
+    stats.bytesRead = bytesRead_;
+    return stats;
+}
+
+} // namespace catalog
+} // namespace starmap
@@ -0,0 +1,750 @@
+#include "starmap/catalog/VOTableReader.h"
+#include <libxml/parser.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+namespace starmap {
+namespace catalog {
+
+namespace {
+
+std::string attribute(const xmlChar** attributes, int count, const char* name) {
+    // 5 puntatori per attributo: nome, prefisso, URI, inizio e fine del valore
+    for (int i = 0; i < count; ++i) {
+        const xmlChar** attr = attributes + i * 5;
+        if (std::strcmp(reinterpret_cast<const char*>(attr[0]), name) == 0) {
+            return std::string(reinterpret_cast<const char*>(attr[3]),
+                               reinterpret_cast<const char*>(attr[4]));
+        }
+    }
+    return "";
+}
+
+std::string trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) return "";
+    size_t last = text.find_last_not_of(" \t\r\n");
+    return text.substr(first, last - first + 1);
+}
+
+VOTableType classify(const std::string& datatype, const std::string& arraysize) {
+    if (datatype == "char" || datatype == "unicodeChar") return VOTableType::Text;
+    if (!arraysize.empty() && arraysize != "1") return VOTableType::Text;
+    if (datatype == "boolean") return VOTableType::Boolean;
+    if (datatype == "bit" || datatype == "unsignedByte" || datatype == "short" ||
+        datatype == "int" || datatype == "long") return VOTableType::Integer;
+    if (datatype == "float" || datatype == "double") return VOTableType::Real;
+    return VOTableType::Text;
+}
+
+/**
+ * @brief Dimensione in byte di un elemento nella serializzazione binaria (0 = sconosciuto)
+ */
+size_t elementBytes(const std::string& datatype) {
+    if (datatype == "boolean" || datatype == "unsignedByte" || datatype == "char") return 1;
+    if (datatype == "short" || datatype == "unicodeChar") return 2;
+    if (datatype == "int" || datatype == "float") return 4;
+    if (datatype == "long" || datatype == "double" || datatype == "floatComplex") return 8;
+    if (datatype == "doubleComplex") return 16;
+    return 0;
+}
+
+uint64_t readBigEndian(const uint8_t* data, size_t bytes) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < bytes; ++i) value = (value << 8) | data[i];
+    return value;
+}
+
+void appendUtf8(std::string& out, uint32_t code) {
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    } else if (code < 0x800) {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+int base64Value(char c) {
+    if (c >= 'A' && c <= 'Z') return c - 'A';
+    if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+    if (c >= '0' && c <= '9') return c - '0' + 52;
+    if (c == '+') return 62;
+    if (c == '/') return 63;
+    return -1;
+}
+
+void ignoreMessage(void*, const char*, ...) {}
+
+} // namespace
+
+// ========== VOTableColumns ==========
+
+int VOTableColumns::columnIndex(const std::string& name) const {
+    for (size_t i = 0; i < fields_.size(); ++i) {
+        if (fields_[i].name == name) return static_cast<int>(i);
+    }
+    for (size_t i = 0; i < fields_.size(); ++i) {
+        if (!fields_[i].id.empty() && fields_[i].id == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+bool VOTableColumns::isNull(size_t column, size_t row) const {
+    return columns_[column].nulls[row] != 0;
+}
+
+std::optional<long long> VOTableColumns::getInteger(size_t column, size_t row) const {
+    if (isNull(column, row)) return std::nullopt;
+    const Column& col = columns_[column];
+    switch (fields_[column].type) {
+        case VOTableType::Boolean:
+        case VOTableType::Integer:
+            return col.integers[row];
+        case VOTableType::Real:
+            return static_cast<long long>(col.reals[row]);
+        case VOTableType::Text: {
+            std::string text = getText(column, row);
+            char* end = nullptr;
+            long long value = std::strtoll(text.c_str(), &end, 10);
+            if (end == text.c_str()) return std::nullopt;
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<double> VOTableColumns::getReal(size_t column, size_t row) const {
+    if (isNull(column, row)) return std::nullopt;
+    const Column& col = columns_[column];
+    switch (fields_[column].type) {
+        case VOTableType::Boolean:
+        case VOTableType::Integer:
+            return static_cast<double>(col.integers[row]);
+        case VOTableType::Real:
+            return col.reals[row];
+        case VOTableType::Text: {
+            std::string text = getText(column, row);
+            char* end = nullptr;
+            double value = std::strtod(text.c_str(), &end);
+            if (end == text.c_str()) return std::nullopt;
+            return value;
+        }
+    }
+    return std::nullopt;
+}
+
+std::string VOTableColumns::getText(size_t column, size_t row) const {
+    if (isNull(column, row)) return "";
+    const Column& col = columns_[column];
+    switch (fields_[column].type) {
+        case VOTableType::Boolean:
+            return col.integers[row] ? "T" : "F";
+        case VOTableType::Integer:
+            return std::to_string(col.integers[row]);
+        case VOTableType::Real: {
+            std::ostringstream out;
+            out.precision(15);
+            out << col.reals[row];
+            return out.str();
+        }
+        case VOTableType::Text:
+            return col.chars.substr(col.offsets[row], col.offsets[row + 1] - col.offsets[row]);
+    }
+    return "";
+}
+
+void VOTableColumns::reset(std::vector<VOTableField> fields) {
+    fields_ = std::move(fields);
+    columns_.assign(fields_.size(), Column());
+    clearRows();
+}
+
+void VOTableColumns::clearRows() {
+    // I buffer mantengono la capacità: il blocco successivo non rialloca
+    for (Column& col : columns_) {
+        col.integers.clear();
+        col.reals.clear();
+        col.chars.clear();
+        col.offsets.assign(1, 0);
+        col.nulls.clear();
+    }
+    rows_ = 0;
+}
+
+// ========== VOTableReader ==========
+
+class VOTableReader::Impl {
+public:
+    enum class Encoding { None, Binary, Binary2 };
+
+    /**
+     * @brief Disposizione di un campo nella serializzazione binaria
+     */
+    struct BinaryLayout {
+        size_t elementBytes = 0;
+        size_t count = 1;           // Elementi (dimensioni fisse moltiplicate)
+        bool variable = false;      // Lunghezza in testa (4 byte)
+        bool bits = false;          // datatype="bit": count bit
+        int64_t nullInteger = 0;
+        bool hasNullInteger = false;
+    };
+
+    Impl(RowsCallback onRows, size_t blockRows)
+        : onRows_(std::move(onRows)), blockRows_(std::max<size_t>(1, blockRows)) {
+        std::memset(&sax_, 0, sizeof(sax_));
+        sax_.initialized = XML_SAX2_MAGIC;
+        sax_.startElementNs = &Impl::onStartElement;
+        sax_.endElementNs = &Impl::onEndElement;
+        sax_.characters = &Impl::onCharacters;
+        sax_.cdataBlock = &Impl::onCharacters;
+        sax_.warning = &ignoreMessage;
+        sax_.error = &ignoreMessage;
+    }
+
+    ~Impl() {
+        if (ctxt_) xmlFreeParserCtxt(ctxt_);
+    }
+
+    bool feed(const char* data, size_t size) {
+        if (failed_) return false;
+        if (!ctxt_) {
+            ctxt_ = xmlCreatePushParserCtxt(&sax_, this, nullptr, 0, nullptr);
+            if (!ctxt_) return fail("Cannot create XML parser");
+            // Nessun accesso alla rete; testi lunghi ammessi (STREAM base64)
+            xmlCtxtUseOptions(ctxt_, XML_PARSE_NONET | XML_PARSE_HUGE);
+        }
+
+        // xmlParseChunk accetta int: frammenti molto grandi vanno divisi
+        while (size > 0 && !failed_) {
+            int chunk = static_cast<int>(std::min<size_t>(size, 1 << 20));
+            if (xmlParseChunk(ctxt_, data, chunk, 0) != 0 && !failed_) {
+                return fail(parserError());
+            }
+            data += chunk;
+            size -= static_cast<size_t>(chunk);
+        }
+        return !failed_;
+    }
+
+    bool finish() {
+        if (failed_) return false;
+        if (!ctxt_) return fail("Empty VOTable document");
+        if (xmlParseChunk(ctxt_, nullptr, 0, 1) != 0 && !failed_) {
+            return fail(parserError());
+        }
+        if (failed_) return false;
+        if (!sawVOTable_) return fail("Not a VOTable document");
+        deliver();
+        return true;
+    }
+
+    VOTableColumns columns_;
+    size_t totalRows_ = 0;
+    std::string error_;
+
+private:
+    bool fail(const std::string& message) {
+        if (!failed_) {
+            failed_ = true;
+            error_ = message;
+            if (ctxt_) xmlStopParser(ctxt_);
+        }
+        return false;
+    }
+
+    std::string parserError() const {
+        const xmlError* error = xmlCtxtGetLastError(ctxt_);
+        if (error && error->message) {
+            return "XML error at line " + std::to_string(error->line) + ": " + trim(error->message);
+        }
+        return "XML error";
+    }
+
+    /**
+     * @brief Consegna le righe accumulate e svuota le colonne
+     */
+    void deliver() {
+        if (onRows_ && columns_.rowCount() > 0) {
+            onRows_(static_cast<size_t>(std::max(0, table_)), columns_);
+            columns_.clearRows();
+        }
+    }
+
+    void endRow() {
+        columns_.rows_++;
+        totalRows_++;
+        if (columns_.rows_ >= blockRows_) deliver();
+    }
+
+    // ---------- Eventi SAX ----------
+
+    static void onStartElement(void* ctx, const xmlChar* localname, const xmlChar*, const xmlChar*,
+                               int, const xmlChar**, int attributeCount, int,
+                               const xmlChar** attributes) {
+        static_cast<Impl*>(ctx)->startElement(reinterpret_cast<const char*>(localname),
+                                              attributes, attributeCount);
+    }
+
+    static void onEndElement(void* ctx, const xmlChar* localname, const xmlChar*, const xmlChar*) {
+        static_cast<Impl*>(ctx)->endElement(reinterpret_cast<const char*>(localname));
+    }
+
+    static void onCharacters(void* ctx, const xmlChar* ch, int len) {
+        static_cast<Impl*>(ctx)->characters(reinterpret_cast<const char*>(ch), static_cast<size_t>(len));
+    }
+
+    void startElement(const char* name, const xmlChar** attributes, int count) {
+        if (failed_) return;
+
+        if (std::strcmp(name, "TD") == 0) {
+            inCell_ = true;
+            cell_.clear();
+        } else if (std::strcmp(name, "TR") == 0) {
+            column_ = 0;
+        } else if (std::strcmp(name, "VOTABLE") == 0) {
+            sawVOTable_ = true;
+        } else if (std::strcmp(name, "TABLE") == 0) {
+            deliver();
+            table_++;
+            fields_.clear();
+        } else if (std::strcmp(name, "FIELD") == 0) {
+            VOTableField field;
+            field.name = attribute(attributes, count, "name");
+            field.id = attribute(attributes, count, "ID");
+            field.datatype = attribute(attributes, count, "datatype");
+            field.arraysize = attribute(attributes, count, "arraysize");
+            field.unit = attribute(attributes, count, "unit");
+            field.ucd = attribute(attributes, count, "ucd");
+            field.type = classify(field.datatype, field.arraysize);
+            fields_.push_back(field);
+            inField_ = true;
+        } else if (std::strcmp(name, "VALUES") == 0) {
+            if (inField_ && !fields_.empty()) {
+                fields_.back().nullValue = attribute(attributes, count, "null");
+            }
+        } else if (std::strcmp(name, "DATA") == 0) {
+            deliver();
+            columns_.reset(fields_);
+        } else if (std::strcmp(name, "BINARY") == 0) {
+            startBinary(Encoding::Binary);
+        } else if (std::strcmp(name, "BINARY2") == 0) {
+            startBinary(Encoding::Binary2);
+        } else if (std::strcmp(name, "STREAM") == 0) {
+            if (encoding_ != Encoding::None) {
+                std::string streamEncoding = attribute(attributes, count, "encoding");
+                if (streamEncoding != "base64") {
+                    fail("Unsupported VOTable stream encoding: " +
+                         (streamEncoding.empty() ? std::string("external reference") : streamEncoding));
+                    return;
+                }
+                inStream_ = true;
+                quad_ = 0;
+                quadLength_ = 0;
+                bytes_.clear();
+                consumed_ = 0;
+            }
+        } else if (std::strcmp(name, "INFO") == 0) {
+            if (attribute(attributes, count, "name") == "QUERY_STATUS" &&
+                attribute(attributes, count, "value") == "ERROR") {
+                inErrorInfo_ = true;
+                cell_.clear();
+            }
+        }
+    }
+
+    void endElement(const char* name) {
+        if (failed_) return;
+
+        if (std::strcmp(name, "TD") == 0) {
+            if (column_ < columns_.columnCount()) appendText(column_, cell_);
+            column_++;
+            inCell_ = false;
+        } else if (std::strcmp(name, "TR") == 0) {
+            // Celle mancanti in fondo alla riga: null
+            for (; column_ < columns_.columnCount(); ++column_) appendNull(column_);
+            endRow();
+        } else if (std::strcmp(name, "FIELD") == 0) {
+            inField_ = false;
+        } else if (std::strcmp(name, "STREAM") == 0) {
+            if (inStream_) {
+                inStream_ = false;
+                if (consumed_ < bytes_.size()) {
+                    fail("Truncated VOTable binary stream");
+                }
+            }
+        } else if (std::strcmp(name, "BINARY") == 0 || std::strcmp(name, "BINARY2") == 0) {
+            encoding_ = Encoding::None;
+        } else if (std::strcmp(name, "TABLE") == 0) {
+            deliver();
+        } else if (std::strcmp(name, "INFO") == 0 && inErrorInfo_) {
+            inErrorInfo_ = false;
+            fail("VOTable query error: " + trim(cell_));
+        }
+    }
+
+    void characters(const char* data, size_t length) {
+        if (failed_) return;
+        if (inCell_ || inErrorInfo_) {
+            cell_.append(data, length);
+        } else if (inStream_) {
+            decodeBase64(data, length);
+            parseBinaryRows();
+        }
+    }
+
+    // ---------- TABLEDATA ----------
+
+    void appendNull(size_t column) {
+        auto& col = columns_.columns_[column];
+        switch (columns_.fields_[column].type) {
+            case VOTableType::Boolean:
+            case VOTableType::Integer:
+                col.integers.push_back(0);
+                break;
+            case VOTableType::Real:
+                col.reals.push_back(std::numeric_limits<double>::quiet_NaN());
+                break;
+            case VOTableType::Text:
+                col.offsets.push_back(static_cast<uint32_t>(col.chars.size()));
+                break;
+        }
+        col.nulls.push_back(1);
+    }
+
+    void appendText(size_t column, const std::string& raw) {
+        const VOTableField& field = columns_.fields_[column];
+        auto& col = columns_.columns_[column];
+        std::string text = trim(raw);
+        if (text.empty() || (!field.nullValue.empty() && text == field.nullValue)) {
+            appendNull(column);
+            return;
+        }
+
+        switch (field.type) {
+            case VOTableType::Boolean: {
+                char c = text[0];
+                if (c == 'T' || c == 't' || c == '1') {
+                    col.integers.push_back(1);
+                } else if (c == 'F' || c == 'f' || c == '0') {
+                    col.integers.push_back(0);
+                } else {
+                    appendNull(column);
+                    return;
+                }
+                break;
+            }
+            case VOTableType::Integer: {
+                char* end = nullptr;
+                bool hex = text.size() > 2 && text[0] == '0' && (text[1] == 'x' || text[1] == 'X');
+                long long value = std::strtoll(text.c_str(), &end, hex ? 16 : 10);
+                if (end == text.c_str()) {
+                    appendNull(column);
+                    return;
+                }
+                col.integers.push_back(value);
+                break;
+            }
+            case VOTableType::Real: {
+                char* end = nullptr;
+                double value = std::strtod(text.c_str(), &end);
+                if (end == text.c_str() || std::isnan(value)) {
+                    appendNull(column);
+                    return;
+                }
+                col.reals.push_back(value);
+                break;
+            }
+            case VOTableType::Text:
+                col.chars += text;
+                col.offsets.push_back(static_cast<uint32_t>(col.chars.size()));
+                break;
+        }
+        col.nulls.push_back(0);
+    }
+
+    // ---------- BINARY / BINARY2 ----------
+
+    void startBinary(Encoding encoding) {
+        encoding_ = encoding;
+        layouts_.clear();
+        for (const VOTableField& field : columns_.fields_) {
+            BinaryLayout layout;
+            layout.bits = (field.datatype == "bit");
+            layout.elementBytes = layout.bits ? 1 : elementBytes(field.datatype);
+            if (layout.elementBytes == 0) {
+                fail("Unsupported VOTable datatype: " + field.datatype);
+                return;
+            }
+
+            // arraysize "N", "NxM", "*", "N*", "NxM*"
+            std::string dims = field.arraysize;
+            if (!dims.empty() && dims.back() == '*') {
+                layout.variable = true;
+                dims.pop_back();
+                size_t lastX = dims.rfind('x');
+                dims = (lastX == std::string::npos) ? "" : dims.substr(0, lastX);
+            }
+            std::istringstream parts(dims);
+            std::string part;
+            while (std::getline(parts, part, 'x')) {
+                if (!part.empty()) layout.count *= std::max<size_t>(1, std::strtoul(part.c_str(), nullptr, 10));
+            }
+
+            if (!field.nullValue.empty()) {
+                char* end = nullptr;
+                long long value = std::strtoll(field.nullValue.c_str(), &end, 10);
+                layout.hasNullInteger = (end != field.nullValue.c_str());
+                layout.nullInteger = value;
+            }
+            layouts_.push_back(layout);
+        }
+    }
+
+    void decodeBase64(const char* data, size_t length) {
+        for (size_t i = 0; i < length; ++i) {
+            char c = data[i];
+            if (c == '=') {
+                // Padding: chiude il gruppo corrente
+                if (quadLength_ == 2) {
+                    bytes_ += static_cast<char>((quad_ >> 4) & 0xFF);
+                } else if (quadLength_ == 3) {
+                    bytes_ += static_cast<char>((quad_ >> 10) & 0xFF);
+                    bytes_ += static_cast<char>((quad_ >> 2) & 0xFF);
+                }
+                quad_ = 0;
+                quadLength_ = 0;
+                continue;
+            }
+            int value = base64Value(c);
+            if (value < 0) continue;   // Spazi e a capo
+            quad_ = (quad_ << 6) | static_cast<uint32_t>(value);
+            if (++quadLength_ == 4) {
+                bytes_ += static_cast<char>((quad_ >> 16) & 0xFF);
+                bytes_ += static_cast<char>((quad_ >> 8) & 0xFF);
+                bytes_ += static_cast<char>(quad_ & 0xFF);
+                quad_ = 0;
+                quadLength_ = 0;
+            }
+        }
+    }
+
+    /**
+     * @brief Byte occupati da un campo a partire da offset (0 = dati incompleti)
+     */
+    size_t fieldBytes(const BinaryLayout& layout, size_t offset, size_t available) const {
+        size_t count = layout.count;
+        size_t header = 0;
+        if (layout.variable) {
+            if (available - offset < 4) return 0;
+            count *= static_cast<size_t>(readBigEndian(
+                reinterpret_cast<const uint8_t*>(bytes_.data()) + offset, 4));
+            header = 4;
+        }
+        size_t payload = layout.bits ? (count + 7) / 8 : count * layout.elementBytes;
+        if (available - offset < header + payload) return 0;
+        return header + payload;
+    }
+
+    void parseBinaryRows() {
+        const size_t fieldCount = layouts_.size();
+        const size_t maskBytes = (encoding_ == Encoding::Binary2) ? (fieldCount + 7) / 8 : 0;
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(bytes_.data());
+        const size_t available = bytes_.size();
+
+        extents_.resize(fieldCount);
+        while (!failed_) {
+            // Prima verifica che la riga sia completa, poi la decodifica
+            size_t offset = consumed_;
+            if (available - offset < maskBytes) break;
+            offset += maskBytes;
+            bool complete = true;
+            for (size_t f = 0; f < fieldCount; ++f) {
+                size_t size = fieldBytes(layouts_[f], offset, available);
+                if (size == 0) {
+                    complete = false;
+                    break;
+                }
+                extents_[f] = offset;
+                offset += size;
+            }
+            if (!complete) break;
+
+            const uint8_t* mask = data + consumed_;
+            for (size_t f = 0; f < fieldCount; ++f) {
+                bool isNull = maskBytes > 0 && (mask[f / 8] & (0x80 >> (f % 8)));
+                if (isNull) {
+                    appendNull(f);
+                } else {
+                    appendBinary(f, data + extents_[f]);
+                }
+            }
+            consumed_ = offset;
+            endRow();
+        }
+
+        // Scarta i byte già letti (la coda resta in attesa del resto della riga)
+        if (consumed_ > 0 && consumed_ >= bytes_.size() / 2) {
+            bytes_.erase(0, consumed_);
+            consumed_ = 0;
+        }
+    }
+
+    void appendBinary(size_t column, const uint8_t* data) {
+        const VOTableField& field = columns_.fields_[column];
+        const BinaryLayout& layout = layouts_[column];
+        auto& col = columns_.columns_[column];
+
+        size_t count = layout.count;
+        if (layout.variable) {
+            count *= static_cast<size_t>(readBigEndian(data, 4));
+            data += 4;
+        }
+
+        switch (field.type) {
+            case VOTableType::Boolean: {
+                char c = static_cast<char>(data[0]);
+                if (c == 'T' || c == 't' || c == '1') {
+                    col.integers.push_back(1);
+                } else if (c == 'F' || c == 'f' || c == '0') {
+                    col.integers.push_back(0);
+                } else {
+                    appendNull(column);
+                    return;
+                }
+                break;
+            }
+            case VOTableType::Integer: {
+                int64_t value;
+                if (layout.bits) {
+                    value = (data[0] & 0x80) ? 1 : 0;
+                } else if (field.datatype == "unsignedByte") {
+                    value = data[0];
+                } else if (field.datatype == "short") {
+                    value = static_cast<int16_t>(readBigEndian(data, 2));
+                } else if (field.datatype == "int") {
+                    value = static_cast<int32_t>(readBigEndian(data, 4));
+                } else {
+                    value = static_cast<int64_t>(readBigEndian(data, 8));
+                }
+                if (layout.hasNullInteger && value == layout.nullInteger) {
+                    appendNull(column);
+                    return;
+                }
+                col.integers.push_back(value);
+                break;
+            }
+            case VOTableType::Real: {
+                double value;
+                if (field.datatype == "float") {
+                    uint32_t bits = static_cast<uint32_t>(readBigEndian(data, 4));
+                    float f;
+                    std::memcpy(&f, &bits, sizeof(f));
+                    value = f;
+                } else {
+                    uint64_t bits = readBigEndian(data, 8);
+                    std::memcpy(&value, &bits, sizeof(value));
+                }
+                if (std::isnan(value)) {
+                    appendNull(column);
+                    return;
+                }
+                col.reals.push_back(value);
+                break;
+            }
+            case VOTableType::Text: {
+                std::string text;
+                if (field.datatype == "char") {
+                    text.assign(reinterpret_cast<const char*>(data),
+                                strnlen(reinterpret_cast<const char*>(data), count));
+                } else if (field.datatype == "unicodeChar") {
+                    for (size_t i = 0; i < count; ++i) {
+                        uint32_t code = static_cast<uint32_t>(readBigEndian(data + 2 * i, 2));
+                        if (code == 0) break;
+                        appendUtf8(text, code);
+                    }
+                } else {
+                    // Array numerici binari: non decodificati
+                    appendNull(column);
+                    return;
+                }
+                text = trim(text);
+                if (text.empty()) {
+                    appendNull(column);
+                    return;
+                }
+                col.chars += text;
+                col.offsets.push_back(static_cast<uint32_t>(col.chars.size()));
+                break;
+            }
+        }
+        col.nulls.push_back(0);
+    }
+
+    RowsCallback onRows_;
+    size_t blockRows_;
+    xmlSAXHandler sax_;
+    xmlParserCtxtPtr ctxt_ = nullptr;
+    bool failed_ = false;
+
+    bool sawVOTable_ = false;
+    int table_ = -1;
+    std::vector<VOTableField> fields_;
+    bool inField_ = false;
+    bool inErrorInfo_ = false;
+
+    // TABLEDATA
+    bool inCell_ = false;
+    std::string cell_;
+    size_t column_ = 0;
+
+    // BINARY / BINARY2
+    Encoding encoding_ = Encoding::None;
+    bool inStream_ = false;
+    std::vector<BinaryLayout> layouts_;
+    std::vector<size_t> extents_;
+    uint32_t quad_ = 0;
+    int quadLength_ = 0;
+    std::string bytes_;         // Byte decodificati non ancora letti da consumed_
+    size_t consumed_ = 0;
+};
+
+VOTableReader::VOTableReader(RowsCallback onRows, size_t blockRows)
+    : pImpl_(std::make_unique<Impl>(std::move(onRows), blockRows)) {
+}
+
+VOTableReader::~VOTableReader() = default;
+
+bool VOTableReader::feed(const char* data, size_t size) {
+    return pImpl_->feed(data, size);
+}
+
+bool VOTableReader::finish() {
+    return pImpl_->finish();
+}
+
+bool VOTableReader::parse(const std::string& document) {
+    return pImpl_->feed(document.data(), document.size()) && pImpl_->finish();
+}
+
+const VOTableColumns& VOTableReader::columns() const {
+    return pImpl_->columns_;
+}
+
+size_t VOTableReader::totalRows() const {
+    return pImpl_->totalRows_;
+}
+
+const std::string& VOTableReader::getError() const {
+    return pImpl_->error_;
+}
+
+} // namespace catalog
+} // namespace starmap
@@ -4,46 +4,74 @@ namespace starmap {
 namespace config {
 
 std::unique_ptr<LibraryConfig> LibraryConfig::instance_ = nullptr;
-bool LibraryConfig::initialized_ = false;
+std::once_flag LibraryConfig::instanceOnce_;
+std::atomic<bool> LibraryConfig::initialized_{false};
+
+LibraryConfig::LibraryConfig()
+    : paths_(std::make_shared<const CatalogPaths>()) {
+}
 
 void LibraryConfig::initialize(const CatalogPaths& paths) {
-    if (!instance_) {
-        instance_ = std::unique_ptr<LibraryConfig>(new LibraryConfig());
+    auto& config = getInstance();
+    {
+        std::unique_lock<std::shared_mutex> lock(config.mutex_);
+        config.paths_ = std::make_shared<const CatalogPaths>(paths);
     }
-    instance_->paths_ = paths;
     initialized_ = true;
 }
 
 LibraryConfig& LibraryConfig::getInstance() {
-    if (!instance_) {
-        // Auto-inizializza con valori di default se non è stata chiamata initialize()
-        initialize();
-    }
+    // Auto-inizializza con valori di default se non è stata chiamata initialize()
+    std::call_once(instanceOnce_, [] {
+        instance_ = std::unique_ptr<LibraryConfig>(new LibraryConfig());
+        initialized_ = true;
+    });
     return *instance_;
 }
 
+std::shared_ptr<const LibraryConfig::CatalogPaths> LibraryConfig::getPaths() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return paths_;
+}
+
 void LibraryConfig::setGaiaSaoDbPath(const std::string& path) {
-    paths_.gaiaSaoDatabase = path;
+    modify([&](CatalogPaths& paths) { paths.gaiaSaoDatabase = path; });
 }
 
-const std::string& LibraryConfig::getGaiaSaoDbPath() const {
-    return paths_.gaiaSaoDatabase;
+std::string LibraryConfig::getGaiaSaoDbPath() const {
+    return getPaths()->gaiaSaoDatabase;
 }
 
 void LibraryConfig::setIauCatalogPath(const std::string& path) {
-    paths_.iauCatalog = path;
+    modify([&](CatalogPaths& paths) { paths.iauCatalog = path; });
 }
 
-const std::string& LibraryConfig::getIauCatalogPath() const {
-    return paths_.iauCatalog;
+std::string LibraryConfig::getIauCatalogPath() const {
+    return getPaths()->iauCatalog;
 }
 
 void LibraryConfig::setStarNamesDbPath(const std::string& path) {
-    paths_.starNamesDatabase = path;
+    modify([&](CatalogPaths& paths) { paths.starNamesDatabase = path; });
+}
+
+std::string LibraryConfig::getStarNamesDbPath() const {
+    return getPaths()->starNamesDatabase;
+}
+
+void LibraryConfig::setTileCacheDirectory(const std::string& path) {
+    modify([&](CatalogPaths& paths) { paths.tileCacheDirectory = path; });
+}
+
+std::string LibraryConfig::getTileCacheDirectory() const {
+    return getPaths()->tileCacheDirectory;
+}
+
+void LibraryConfig::setHttpCacheDirectory(const std::string& path) {
+    modify([&](CatalogPaths& paths) { paths.httpCacheDirectory = path; });
 }
 
-const std::string& LibraryConfig::getStarNamesDbPath() const {
-    return paths_.starNamesDatabase;
+std::string LibraryConfig::getHttpCacheDirectory() const {
+    return getPaths()->httpCacheDirectory;
 }
 
 bool LibraryConfig::isInitialized() {
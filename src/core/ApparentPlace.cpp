@@ -0,0 +1,270 @@
+#include "starmap/core/ApparentPlace.h"
+#include "starmap/core/EpochPropagation.h"
+#include "starmap/core/StarBlock.h"
+#include "starmap/core/UnitVector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace starmap {
+namespace core {
+
+namespace {
+
+constexpr double DEG_TO_RAD = M_PI / 180.0;
+constexpr double ARCSEC_TO_RAD = DEG_TO_RAD / 3600.0;
+
+// Costante di aberrazione (20.49552") e 2GM/(c² · 1 UA)
+constexpr double ABERRATION_CONSTANT = 20.49552 * ARCSEC_TO_RAD;
+constexpr double SUN_DEFLECTION = 1.97412574336e-8;
+
+// Obliquità dell'eclittica J2000 (84381.448")
+constexpr double OBLIQUITY_J2000 = 84381.448 * ARCSEC_TO_RAD;
+
+// Limite inferiore di 1 + e·p nella deflessione (stelle dietro al Sole)
+constexpr double MIN_DEFLECTION_DENOMINATOR = 1e-6;
+
+/**
+ * @brief Termine della serie di nutazione IAU 1980 (Meeus, tab. 22.A)
+ *
+ * Multipli di D, M, M', F, Ω e coefficienti in 0.0001".
+ */
+struct NutationTerm {
+    int d, m, mp, f, om;
+    double psi, psiT, eps, epsT;
+};
+
+// I 30 termini principali: i restanti valgono meno di 0.0015" ciascuno
+constexpr NutationTerm NUTATION_TERMS[] = {
+    { 0,  0,  0, 0, 1, -171996, -174.2, 92025,  8.9},
+    {-2,  0,  0, 2, 2,  -13187,   -1.6,  5736, -3.1},
+    { 0,  0,  0, 2, 2,   -2274,   -0.2,   977, -0.5},
+    { 0,  0,  0, 0, 2,    2062,    0.2,  -895,  0.5},
+    { 0,  1,  0, 0, 0,    1426,   -3.4,    54, -0.1},
+    { 0,  0,  1, 0, 0,     712,    0.1,    -7,  0.0},
+    {-2,  1,  0, 2, 2,    -517,    1.2,   224, -0.6},
+    { 0,  0,  0, 2, 1,    -386,   -0.4,   200,  0.0},
+    { 0,  0,  1, 2, 2,    -301,    0.0,   129, -0.1},
+    {-2, -1,  0, 2, 2,     217,   -0.5,   -95,  0.3},
+    {-2,  0,  1, 0, 0,    -158,    0.0,     0,  0.0},
+    {-2,  0,  0, 2, 1,     129,    0.1,   -70,  0.0},
+    { 0,  0, -1, 2, 2,     123,    0.0,   -53,  0.0},
+    { 2,  0,  0, 0, 0,      63,    0.0,     0,  0.0},
+    { 0,  0,  1, 0, 1,      63,    0.1,   -33,  0.0},
+    { 2,  0, -1, 2, 2,     -59,    0.0,    26,  0.0},
+    { 0,  0, -1, 0, 1,     -58,   -0.1,    32,  0.0},
+    { 0,  0,  1, 2, 1,     -51,    0.0,    27,  0.0},
+    {-2,  0,  2, 0, 0,      48,    0.0,     0,  0.0},
+    { 0,  0, -2, 2, 1,      46,    0.0,   -24,  0.0},
+    { 2,  0,  0, 2, 2,     -38,    0.0,    16,  0.0},
+    { 0,  0,  2, 2, 2,     -31,    0.0,    13,  0.0},
+    { 0,  0,  2, 0, 0,      29,    0.0,     0,  0.0},
+    {-2,  0,  1, 2, 2,      29,    0.0,   -12,  0.0},
+    { 0,  0,  0, 2, 0,      26,    0.0,     0,  0.0},
+    {-2,  0,  0, 2, 0,     -22,    0.0,     0,  0.0},
+    { 0,  0, -1, 2, 1,      21,    0.0,   -10,  0.0},
+    { 0,  2,  0, 0, 0,      17,   -0.1,     0,  0.0},
+    { 2,  0, -1, 0, 1,      16,    0.0,    -8,  0.0},
+    {-2,  2,  0, 2, 2,     -16,    0.1,     7,  0.0},
+};
+
+using Matrix3 = ApparentPlace::Matrix3;
+using Vector3 = ApparentPlace::Vector3;
+
+Matrix3 multiply(const Matrix3& a, const Matrix3& b) {
+    Matrix3 r{};
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            r[i][j] = a[i][0] * b[0][j] + a[i][1] * b[1][j] + a[i][2] * b[2][j];
+        }
+    }
+    return r;
+}
+
+// Rotazioni attorno agli assi (convenzione SOFA: R(φ) ruota il sistema)
+Matrix3 rotationX(double phi) {
+    double c = std::cos(phi), s = std::sin(phi);
+    return {{{1, 0, 0}, {0, c, s}, {0, -s, c}}};
+}
+
+Matrix3 rotationY(double phi) {
+    double c = std::cos(phi), s = std::sin(phi);
+    return {{{c, 0, -s}, {0, 1, 0}, {s, 0, c}}};
+}
+
+Matrix3 rotationZ(double phi) {
+    double c = std::cos(phi), s = std::sin(phi);
+    return {{{c, s, 0}, {-s, c, 0}, {0, 0, 1}}};
+}
+
+// Eclittica J2000 -> equatoriale J2000
+Vector3 eclipticToEquatorial(double x, double y, double z) {
+    double c = std::cos(OBLIQUITY_J2000), s = std::sin(OBLIQUITY_J2000);
+    return {x, y * c - z * s, y * s + z * c};
+}
+
+} // namespace
+
+ApparentPlace::ApparentPlace(double jd) : jd_(jd) {
+    const double t = (jd - EpochPropagation::J2000_JD) / 36525.0;
+    const double t2 = t * t, t3 = t2 * t;
+
+    // Precessione IAU 1976 (Lieske): P = R3(-z) R2(θ) R3(-ζ)
+    double zeta = (2306.2181 * t + 0.30188 * t2 + 0.017998 * t3) * ARCSEC_TO_RAD;
+    double z = (2306.2181 * t + 1.09468 * t2 + 0.018203 * t3) * ARCSEC_TO_RAD;
+    double theta = (2004.3109 * t - 0.42665 * t2 - 0.041833 * t3) * ARCSEC_TO_RAD;
+    precession_ = multiply(rotationZ(-z), multiply(rotationY(theta), rotationZ(-zeta)));
+
+    // Nutazione IAU 1980: argomenti fondamentali (gradi)
+    double d = 297.85036 + 445267.111480 * t - 0.0019142 * t2 + t3 / 189474.0;
+    double m = 357.52772 + 35999.050340 * t - 0.0001603 * t2 - t3 / 300000.0;
+    double mp = 134.96298 + 477198.867398 * t + 0.0086972 * t2 + t3 / 56250.0;
+    double f = 93.27191 + 483202.017538 * t - 0.0036825 * t2 + t3 / 327270.0;
+    double om = 125.04452 - 1934.136261 * t + 0.0020708 * t2 + t3 / 450000.0;
+
+    double psi = 0.0, eps = 0.0;
+    for (const auto& term : NUTATION_TERMS) {
+        double arg = (term.d * d + term.m * m + term.mp * mp + term.f * f + term.om * om) *
+                     DEG_TO_RAD;
+        psi += (term.psi + term.psiT * t) * std::sin(arg);
+        eps += (term.eps + term.epsT * t) * std::cos(arg);
+    }
+    deltaPsi_ = psi * 1e-4;
+    deltaEpsilon_ = eps * 1e-4;
+
+    double meanObliquity = 84381.448 - 46.8150 * t - 0.00059 * t2 + 0.001813 * t3;
+    trueObliquity_ = meanObliquity + deltaEpsilon_;
+
+    // N = R1(-ε) R3(-Δψ) R1(ε0)
+    nutation_ = multiply(rotationX(-trueObliquity_ * ARCSEC_TO_RAD),
+                         multiply(rotationZ(-deltaPsi_ * ARCSEC_TO_RAD),
+                                  rotationX(meanObliquity * ARCSEC_TO_RAD)));
+    matrix_ = multiply(nutation_, precession_);
+
+    // Sole a bassa precisione (Meeus, cap. 25), longitudini riportate
+    // all'eclittica J2000
+    double l0 = 280.46646 + 36000.76983 * t + 0.0003032 * t2;
+    double ms = (357.52911 + 35999.05029 * t - 0.0001537 * t2) * DEG_TO_RAD;
+    double e = 0.016708634 - 0.000042037 * t - 0.0000001267 * t2;
+    double c = (1.914602 - 0.004817 * t - 0.000014 * t2) * std::sin(ms) +
+               (0.019993 - 0.000101 * t) * std::sin(2 * ms) +
+               0.000289 * std::sin(3 * ms);
+    double precessionInLongitude = 1.3970 * t;
+    double sun = (l0 + c - precessionInLongitude) * DEG_TO_RAD;
+    double perihelion = (102.93735 + 1.71946 * t + 0.00046 * t2 - precessionInLongitude) *
+                        DEG_TO_RAD;
+    double distance = 1.000001018 * (1 - e * e) / (1 + e * std::cos(ms + c * DEG_TO_RAD));
+
+    // Direzione Sole -> Terra e velocità della Terra (termini e compresi)
+    sunToEarth_ = eclipticToEquatorial(-std::cos(sun), -std::sin(sun), 0.0);
+    velocity_ = eclipticToEquatorial(
+        ABERRATION_CONSTANT * (std::sin(sun) - e * std::sin(perihelion)),
+        ABERRATION_CONSTANT * (-std::cos(sun) + e * std::cos(perihelion)),
+        0.0);
+    double v2 = velocity_[0] * velocity_[0] + velocity_[1] * velocity_[1] +
+                velocity_[2] * velocity_[2];
+    inverseLorentz_ = std::sqrt(1.0 - v2);
+    deflection_ = SUN_DEFLECTION / distance;
+}
+
+std::optional<ApparentPlace> ApparentPlace::at(const std::string& isoTime) {
+    auto epoch = EpochPropagation::parseEpoch(isoTime);
+    if (!epoch) return std::nullopt;
+    return ApparentPlace(EpochPropagation::J2000_JD +
+                         (*epoch - 2000.0) * EpochPropagation::JULIAN_YEAR_DAYS);
+}
+
+double ApparentPlace::epoch() const {
+    return EpochPropagation::julianEpoch(jd_);
+}
+
+EquatorialCoordinates ApparentPlace::apply(const EquatorialCoordinates& position) const {
+    double ra = position.getRightAscension();
+    double dec = position.getDeclination();
+    apply(&ra, &dec, 1);
+    return EquatorialCoordinates(ra, dec);
+}
+
+void ApparentPlace::apply(double* x, double* y, double* z, size_t count) const {
+    deflect(x, y, z, count);
+    aberrate(x, y, z, count);
+    rotate(x, y, z, count);
+}
+
+void ApparentPlace::apply(double* ra, double* dec, size_t count) const {
+    const size_t chunks = (count + CHUNK_ROWS - 1) / CHUNK_ROWS;
+
+    // Blocchi indipendenti di CHUNK_ROWS righe: i versori restano in cache
+    #pragma omp parallel for schedule(static) if(count >= PARALLEL_MIN_ROWS)
+    for (size_t k = 0; k < chunks; ++k) {
+        double x[CHUNK_ROWS], y[CHUNK_ROWS], z[CHUNK_ROWS];
+        size_t begin = k * CHUNK_ROWS;
+        size_t n = std::min(CHUNK_ROWS, count - begin);
+
+        toUnitVectors(ra + begin, dec + begin, n, x, y, z);
+        apply(x, y, z, n);
+        fromUnitVectors(x, y, z, n, ra + begin, dec + begin);
+    }
+}
+
+void ApparentPlace::apply(StarBlock& stars) const {
+    apply(stars.raColumn().data(), stars.decColumn().data(), stars.size());
+}
+
+void ApparentPlace::toUnitVectors(const double* ra, const double* dec, size_t count,
+                                  double* x, double* y, double* z) {
+    UnitVector::fromRaDec(ra, dec, count, x, y, z);
+}
+
+void ApparentPlace::fromUnitVectors(const double* x, const double* y, const double* z,
+                                    size_t count, double* ra, double* dec) {
+    UnitVector::toRaDec(x, y, z, count, ra, dec);
+}
+
+void ApparentPlace::deflect(double* x, double* y, double* z, size_t count) const {
+    // p' = p + g/r · (e - (e·p) p) / (1 + e·p), e = Sole -> Terra
+    const double ex = sunToEarth_[0], ey = sunToEarth_[1], ez = sunToEarth_[2];
+    const double g = deflection_;
+
+    #pragma omp simd
+    for (size_t i = 0; i < count; ++i) {
+        double ep = ex * x[i] + ey * y[i] + ez * z[i];
+        double w = g / std::max(1.0 + ep, MIN_DEFLECTION_DENOMINATOR);
+        x[i] += w * (ex - ep * x[i]);
+        y[i] += w * (ey - ep * y[i]);
+        z[i] += w * (ez - ep * z[i]);
+    }
+}
+
+void ApparentPlace::aberrate(double* x, double* y, double* z, size_t count) const {
+    // Aberrazione relativistica: p' ∝ p/γ + (1 + p·v/(1 + 1/γ)) v
+    const double vx = velocity_[0], vy = velocity_[1], vz = velocity_[2];
+    const double bm1 = inverseLorentz_;
+
+    #pragma omp simd
+    for (size_t i = 0; i < count; ++i) {
+        double pv = vx * x[i] + vy * y[i] + vz * z[i];
+        double w = 1.0 + pv / (1.0 + bm1);
+        double px = bm1 * x[i] + w * vx;
+        double py = bm1 * y[i] + w * vy;
+        double pz = bm1 * z[i] + w * vz;
+        double inv = 1.0 / std::sqrt(px * px + py * py + pz * pz);
+        x[i] = px * inv;
+        y[i] = py * inv;
+        z[i] = pz * inv;
+    }
+}
+
+void ApparentPlace::rotate(double* x, double* y, double* z, size_t count) const {
+    const Matrix3& r = matrix_;
+
+    #pragma omp simd
+    for (size_t i = 0; i < count; ++i) {
+        double px = x[i], py = y[i], pz = z[i];
+        x[i] = r[0][0] * px + r[0][1] * py + r[0][2] * pz;
+        y[i] = r[1][0] * px + r[1][1] * py + r[1][2] * pz;
+        z[i] = r[2][0] * px + r[2][1] * py + r[2][2] * pz;
+    }
+}
+
+} // namespace core
+} // namespace starmap
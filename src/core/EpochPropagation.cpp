@@ -0,0 +1,107 @@
+#include "starmap/core/EpochPropagation.h"
+#include "starmap/core/StarBlock.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace starmap {
+namespace core {
+
+namespace {
+
+constexpr double DEG_TO_RAD = M_PI / 180.0;
+constexpr double MAS_TO_DEG = 1.0 / 3.6e6;
+
+// Limite inferiore di cos(dec): evita la divisione per zero sui poli
+constexpr double MIN_COS_DEC = 1e-9;
+
+} // namespace
+
+double EpochPropagation::julianDate(int year, int month, int day, double hours) {
+    // Meeus, Astronomical Algorithms, cap. 7 (calendario gregoriano)
+    if (month <= 2) {
+        year -= 1;
+        month += 12;
+    }
+    int a = year / 100;
+    int b = 2 - a + a / 4;
+    return std::floor(365.25 * (year + 4716)) + std::floor(30.6001 * (month + 1)) +
+           day + b - 1524.5 + hours / 24.0;
+}
+
+std::optional<double> EpochPropagation::parseEpoch(const std::string& isoTime) {
+    const char* s = isoTime.c_str();
+    int year = 0, month = 0, day = 0, consumed = 0;
+    if (std::sscanf(s, "%4d-%2d-%2d%n", &year, &month, &day, &consumed) != 3) {
+        return std::nullopt;
+    }
+    s += consumed;
+
+    int hour = 0, minute = 0;
+    double second = 0.0;
+    if (*s == 'T' || *s == ' ') {
+        ++s;
+        if (std::sscanf(s, "%2d:%2d%n", &hour, &minute, &consumed) != 2) {
+            return std::nullopt;
+        }
+        s += consumed;
+        if (*s == ':') {
+            ++s;
+            if (std::sscanf(s, "%lf%n", &second, &consumed) != 1) return std::nullopt;
+            s += consumed;
+        }
+    }
+
+    // Fuso: Z oppure +hh[:mm] / -hh[:mm]
+    double offsetHours = 0.0;
+    if (*s == 'Z') {
+        ++s;
+    } else if (*s == '+' || *s == '-') {
+        int sign = (*s == '-') ? -1 : 1;
+        int oh = 0, om = 0;
+        ++s;
+        if (std::sscanf(s, "%2d%n", &oh, &consumed) != 1) return std::nullopt;
+        s += consumed;
+        if (*s == ':') ++s;
+        if (std::sscanf(s, "%2d%n", &om, &consumed) == 1) s += consumed;
+        offsetHours = sign * (oh + om / 60.0);
+    }
+    if (*s != '\0') return std::nullopt;
+
+    if (month < 1 || month > 12 || day < 1 || day > 31 ||
+        hour < 0 || hour > 24 || minute < 0 || minute > 59 ||
+        second < 0.0 || second >= 61.0) {
+        return std::nullopt;
+    }
+
+    double hours = hour + minute / 60.0 + second / 3600.0 - offsetHours;
+    return julianEpoch(julianDate(year, month, day, hours));
+}
+
+void EpochPropagation::propagate(double* ra, double* dec,
+                                 const float* pmRA, const float* pmDec,
+                                 size_t count, double years) {
+    if (count == 0 || years == 0.0) return;
+
+    const double scale = years * MAS_TO_DEG;
+
+    // Corpo senza diramazioni: vettorizzabile, diviso tra i thread solo
+    // sopra la soglia
+    #pragma omp parallel for simd schedule(static) if(count >= PARALLEL_MIN_ROWS)
+    for (size_t i = 0; i < count; ++i) {
+        double cosDec = std::max(std::cos(dec[i] * DEG_TO_RAD), MIN_COS_DEC);
+        double r = ra[i] + pmRA[i] * scale / cosDec;
+        ra[i] = r - 360.0 * std::floor(r / 360.0);
+        dec[i] = std::min(90.0, std::max(-90.0, dec[i] + pmDec[i] * scale));
+    }
+}
+
+void EpochPropagation::propagate(StarBlock& stars, double targetEpoch,
+                                 double sourceEpoch) {
+    propagate(stars.raColumn().data(), stars.decColumn().data(),
+              stars.pmRAColumn().data(), stars.pmDecColumn().data(),
+              stars.size(), targetEpoch - sourceEpoch);
+}
+
+} // namespace core
+} // namespace starmap
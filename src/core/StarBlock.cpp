@@ -0,0 +1,281 @@
+#include "starmap/core/StarBlock.h"
+#include "starmap/core/UnitVector.h"
+#include <algorithm>
+#include <numeric>
+
+namespace starmap {
+namespace core {
+
+namespace {
+const std::string EMPTY_NAME;
+}
+
+void StarBlock::reserve(size_t n) {
+    ra_.reserve(n);
+    dec_.reserve(n);
+    mag_.reserve(n);
+    color_.reserve(n);
+    pmRA_.reserve(n);
+    pmDec_.reserve(n);
+    parallax_.reserve(n);
+    gaiaId_.reserve(n);
+    sao_.reserve(n);
+    flags_.reserve(n);
+    nameRef_.reserve(n);
+    if (hasUnitVectors_) {
+        x_.reserve(n);
+        y_.reserve(n);
+        z_.reserve(n);
+    }
+}
+
+void StarBlock::clear() {
+    ra_.clear();
+    dec_.clear();
+    mag_.clear();
+    color_.clear();
+    pmRA_.clear();
+    pmDec_.clear();
+    parallax_.clear();
+    gaiaId_.clear();
+    sao_.clear();
+    flags_.clear();
+    nameRef_.clear();
+    names_.clear();
+    x_.clear();
+    y_.clear();
+    z_.clear();
+    hasUnitVectors_ = false;
+}
+
+size_t StarBlock::append(double ra, double dec, double magnitude, long long gaiaId) {
+    size_t i = appendColumns(ra, dec, magnitude, gaiaId);
+    if (hasUnitVectors_) {
+        UnitVector v = UnitVector::fromRaDec(ra, dec);
+        x_.push_back(v.x);
+        y_.push_back(v.y);
+        z_.push_back(v.z);
+    }
+    return i;
+}
+
+size_t StarBlock::appendColumns(double ra, double dec, double magnitude, long long gaiaId) {
+    ra_.push_back(ra);
+    dec_.push_back(dec);
+    mag_.push_back(static_cast<float>(magnitude));
+    color_.push_back(0.0f);
+    pmRA_.push_back(0.0f);
+    pmDec_.push_back(0.0f);
+    parallax_.push_back(0.0f);
+    gaiaId_.push_back(gaiaId);
+    sao_.push_back(0);
+    flags_.push_back(0);
+    nameRef_.push_back(0);
+    return ra_.size() - 1;
+}
+
+size_t StarBlock::append(const Star& star) {
+    const auto& coords = star.getCoordinates();
+    size_t i = append(coords.getRightAscension(), coords.getDeclination(),
+                      star.getMagnitude(), star.getGaiaId());
+
+    if (auto ci = star.getColorIndex()) setColorIndex(i, *ci);
+    if (auto plx = star.getParallax()) setParallax(i, *plx);
+
+    auto pmRA = star.getProperMotionRA();
+    auto pmDec = star.getProperMotionDec();
+    if (pmRA.has_value() || pmDec.has_value()) {
+        setProperMotion(i, pmRA.value_or(0.0), pmDec.value_or(0.0));
+    }
+
+    if (auto sao = star.getSAONumber()) setSAONumber(i, *sao);
+    if (!star.getName().empty()) setName(i, star.getName());
+
+    return i;
+}
+
+size_t StarBlock::appendRow(const StarBlock& other, size_t index) {
+    size_t i;
+    if (hasUnitVectors_ && other.hasUnitVectors_) {
+        // Versore copiato dalla sorgente, senza ricalcolo
+        i = appendColumns(other.ra_[index], other.dec_[index], other.mag_[index],
+                          other.gaiaId_[index]);
+        x_.push_back(other.x_[index]);
+        y_.push_back(other.y_[index]);
+        z_.push_back(other.z_[index]);
+    } else {
+        i = append(other.ra_[index], other.dec_[index], other.mag_[index],
+                   other.gaiaId_[index]);
+    }
+    color_[i] = other.color_[index];
+    pmRA_[i] = other.pmRA_[index];
+    pmDec_[i] = other.pmDec_[index];
+    parallax_[i] = other.parallax_[index];
+    sao_[i] = other.sao_[index];
+    flags_[i] = other.flags_[index] & static_cast<uint8_t>(~FIELD_NAME);
+
+    if (other.has(index, FIELD_NAME)) {
+        setName(i, other.getName(index));
+    }
+    return i;
+}
+
+void StarBlock::appendBlock(const StarBlock& other) {
+    reserve(size() + other.size());
+    for (size_t i = 0; i < other.size(); ++i) {
+        appendRow(other, i);
+    }
+}
+
+void StarBlock::setName(size_t i, const std::string& name) {
+    if (name.empty()) return;
+
+    if (nameRef_[i] != 0) {
+        names_[nameRef_[i] - 1] = name;
+    } else {
+        names_.push_back(name);
+        nameRef_[i] = static_cast<uint32_t>(names_.size());
+    }
+    flags_[i] |= FIELD_NAME;
+}
+
+const std::string& StarBlock::getName(size_t i) const {
+    uint32_t ref = nameRef_[i];
+    return ref != 0 ? names_[ref - 1] : EMPTY_NAME;
+}
+
+void StarBlock::retain(const std::vector<uint8_t>& keep) {
+    size_t n = std::min(keep.size(), size());
+    std::vector<std::string> keptNames;
+
+    size_t out = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (!keep[i]) continue;
+
+        ra_[out] = ra_[i];
+        dec_[out] = dec_[i];
+        mag_[out] = mag_[i];
+        color_[out] = color_[i];
+        pmRA_[out] = pmRA_[i];
+        pmDec_[out] = pmDec_[i];
+        parallax_[out] = parallax_[i];
+        gaiaId_[out] = gaiaId_[i];
+        sao_[out] = sao_[i];
+        flags_[out] = flags_[i];
+        if (hasUnitVectors_) {
+            x_[out] = x_[i];
+            y_[out] = y_[i];
+            z_[out] = z_[i];
+        }
+
+        // Compatta anche il pool dei nomi
+        if (nameRef_[i] != 0) {
+            keptNames.push_back(std::move(names_[nameRef_[i] - 1]));
+            nameRef_[out] = static_cast<uint32_t>(keptNames.size());
+        } else {
+            nameRef_[out] = 0;
+        }
+        ++out;
+    }
+
+    names_ = std::move(keptNames);
+    truncate(out);
+}
+
+void StarBlock::truncate(size_t n) {
+    if (n >= size()) return;
+
+    ra_.resize(n);
+    dec_.resize(n);
+    mag_.resize(n);
+    color_.resize(n);
+    pmRA_.resize(n);
+    pmDec_.resize(n);
+    parallax_.resize(n);
+    gaiaId_.resize(n);
+    sao_.resize(n);
+    flags_.resize(n);
+    nameRef_.resize(n);
+    if (hasUnitVectors_) {
+        x_.resize(n);
+        y_.resize(n);
+        z_.resize(n);
+    }
+}
+
+void StarBlock::computeUnitVectors() {
+    x_.resize(size());
+    y_.resize(size());
+    z_.resize(size());
+    UnitVector::fromRaDec(ra_.data(), dec_.data(), size(), x_.data(), y_.data(), z_.data());
+    hasUnitVectors_ = true;
+}
+
+std::vector<uint32_t> StarBlock::sortedByMagnitude(bool faintFirst) const {
+    std::vector<uint32_t> order(size());
+    std::iota(order.begin(), order.end(), 0u);
+
+    if (faintFirst) {
+        std::stable_sort(order.begin(), order.end(),
+                         [this](uint32_t a, uint32_t b) { return mag_[a] > mag_[b]; });
+    } else {
+        std::stable_sort(order.begin(), order.end(),
+                         [this](uint32_t a, uint32_t b) { return mag_[a] < mag_[b]; });
+    }
+    return order;
+}
+
+size_t StarBlock::memoryUsage() const {
+    size_t bytes = ra_.capacity() * sizeof(double) +
+                   dec_.capacity() * sizeof(double) +
+                   (mag_.capacity() + color_.capacity() + pmRA_.capacity() +
+                    pmDec_.capacity() + parallax_.capacity()) * sizeof(float) +
+                   gaiaId_.capacity() * sizeof(long long) +
+                   sao_.capacity() * sizeof(int) +
+                   flags_.capacity() * sizeof(uint8_t) +
+                   nameRef_.capacity() * sizeof(uint32_t) +
+                   (x_.capacity() + y_.capacity() + z_.capacity()) * sizeof(double);
+    for (const auto& name : names_) {
+        bytes += sizeof(std::string) + name.capacity();
+    }
+    return bytes;
+}
+
+std::shared_ptr<Star> StarBlock::toStar(size_t i) const {
+    auto star = std::make_shared<Star>();
+    star->setCoordinates(EquatorialCoordinates(ra_[i], dec_[i]));
+    star->setMagnitude(mag_[i]);
+    star->setGaiaId(gaiaId_[i]);
+
+    if (has(i, FIELD_COLOR)) star->setColorIndex(color_[i]);
+    if (has(i, FIELD_PARALLAX)) star->setParallax(parallax_[i]);
+    if (has(i, FIELD_PROPER_MOTION)) {
+        star->setProperMotionRA(pmRA_[i]);
+        star->setProperMotionDec(pmDec_[i]);
+    }
+    if (has(i, FIELD_SAO)) star->setSAONumber(sao_[i]);
+    if (has(i, FIELD_NAME)) star->setName(getName(i));
+
+    return star;
+}
+
+std::vector<std::shared_ptr<Star>> StarBlock::toStars() const {
+    std::vector<std::shared_ptr<Star>> stars;
+    stars.reserve(size());
+    for (size_t i = 0; i < size(); ++i) {
+        stars.push_back(toStar(i));
+    }
+    return stars;
+}
+
+StarBlock StarBlock::fromStars(const std::vector<std::shared_ptr<Star>>& stars) {
+    StarBlock block;
+    block.reserve(stars.size());
+    for (const auto& star : stars) {
+        if (star) block.append(*star);
+    }
+    return block;
+}
+
+} // namespace core
+} // namespace starmap
@@ -0,0 +1,102 @@
+#include "starmap/core/UnitVector.h"
+#include <algorithm>
+#include <cmath>
+
+namespace starmap {
+namespace core {
+
+namespace {
+
+constexpr double DEG_TO_RAD = M_PI / 180.0;
+constexpr double RAD_TO_DEG = 180.0 / M_PI;
+
+} // namespace
+
+UnitVector UnitVector::fromRaDec(double raDeg, double decDeg) {
+    double a = raDeg * DEG_TO_RAD, d = decDeg * DEG_TO_RAD;
+    double cosDec = std::cos(d);
+    return {cosDec * std::cos(a), cosDec * std::sin(a), std::sin(d)};
+}
+
+EquatorialCoordinates UnitVector::toEquatorial() const {
+    double ra, dec;
+    toRaDec(&x, &y, &z, 1, &ra, &dec);
+    return EquatorialCoordinates(ra, dec);
+}
+
+void UnitVector::fromRaDec(const double* ra, const double* dec, size_t count,
+                           double* x, double* y, double* z) {
+    #pragma omp simd
+    for (size_t i = 0; i < count; ++i) {
+        double a = ra[i] * DEG_TO_RAD, d = dec[i] * DEG_TO_RAD;
+        double cosDec = std::cos(d);
+        x[i] = cosDec * std::cos(a);
+        y[i] = cosDec * std::sin(a);
+        z[i] = std::sin(d);
+    }
+}
+
+void UnitVector::toRaDec(const double* x, const double* y, const double* z,
+                         size_t count, double* ra, double* dec) {
+    #pragma omp simd
+    for (size_t i = 0; i < count; ++i) {
+        double a = std::atan2(y[i], x[i]) * RAD_TO_DEG;
+        ra[i] = a < 0.0 ? a + 360.0 : a;
+        dec[i] = std::atan2(z[i], std::sqrt(x[i] * x[i] + y[i] * y[i])) * RAD_TO_DEG;
+    }
+}
+
+double angularSeparation(const UnitVector& a, const UnitVector& b) {
+    double degrees;
+    angularSeparations(a, &b.x, &b.y, &b.z, 1, &degrees);
+    return degrees;
+}
+
+double chordSquaredForSeparation(double degrees) {
+    if (degrees >= 180.0) return 4.0;
+    double halfChord = std::sin(0.5 * degrees * DEG_TO_RAD);
+    return 4.0 * halfChord * halfChord;
+}
+
+void angularSeparations(const UnitVector& from, const double* x, const double* y,
+                        const double* z, size_t count, double* degrees) {
+    #pragma omp simd
+    for (size_t i = 0; i < count; ++i) {
+        // Corda verso b o verso -b, la più corta: asin resta ben
+        // condizionato sia vicino a 0° sia vicino a 180°
+        double dx = x[i] - from.x, dy = y[i] - from.y, dz = z[i] - from.z;
+        double sx = x[i] + from.x, sy = y[i] + from.y, sz = z[i] + from.z;
+        double minus = dx * dx + dy * dy + dz * dz;
+        double plus = sx * sx + sy * sy + sz * sz;
+        double angle = 2.0 * std::asin(std::min(1.0, 0.5 * std::sqrt(std::min(minus, plus))));
+        degrees[i] = (minus <= plus ? angle : M_PI - angle) * RAD_TO_DEG;
+    }
+}
+
+SphericalCap::SphericalCap(const UnitVector& axis, double radiusDeg)
+    : axis_(axis), radiusDeg_(radiusDeg),
+      cosRadius_(radiusDeg >= 180.0 ? -1.0 : std::cos(radiusDeg * DEG_TO_RAD)) {
+}
+
+SphericalCap SphericalCap::cone(double raDeg, double decDeg, double radiusDeg) {
+    return SphericalCap(UnitVector::fromRaDec(raDeg, decDeg), radiusDeg);
+}
+
+void SphericalCap::contains(const double* x, const double* y, const double* z, size_t count,
+                            uint8_t* keep) const {
+    const double ax = axis_.x, ay = axis_.y, az = axis_.z;
+    const double cosRadius = cosRadius_;
+
+    #pragma omp simd
+    for (size_t i = 0; i < count; ++i) {
+        keep[i] = ax * x[i] + ay * y[i] + az * z[i] >= cosRadius;
+    }
+}
+
+bool SphericalCap::intersects(const SphericalCap& other) const {
+    if (radiusDeg_ + other.radiusDeg_ >= 180.0) return true;
+    return angularSeparation(axis_, other.axis_) <= radiusDeg_ + other.radiusDeg_;
+}
+
+} // namespace core
+} // namespace starmap
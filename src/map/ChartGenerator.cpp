@@ -6,9 +6,14 @@
 #include "starmap/map/ChartGenerator.h"
 #include "starmap/map/ConstellationData.h"
 #include "starmap/catalog/GaiaClient.h"
+#include "starmap/catalog/GaiaSAOSchema.h"
 #include "starmap/catalog/SAOCatalog.h"
+#include "starmap/catalog/SkyIndex.h"
+#include "starmap/catalog/SQLiteConnectionPool.h"
 #include "starmap/config/LibraryConfig.h"
+#include "starmap/core/BrightestSelector.h"
 #include <sqlite3.h>
+#include <cstring>
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -22,6 +27,9 @@
 namespace starmap {
 namespace map {
 
+// Limite di stelle per carta (memoria e leggibilità)
+constexpr size_t MAX_CHART_STARS = 50000;
+
 // ============================================================================
 // ChartGenerator Implementation
 // ============================================================================
@@ -91,84 +99,81 @@ bool ChartGenerator::generate(const ChartConfig& config) {
 void ChartGenerator::loadBrightStarsFromDatabase() {
     // Carica stelle luminose (mag < 6) dal database stellar_crossref
     // per coprire quelle che mancano in Gaia DR3
-    sqlite3* db = nullptr;
     std::string dbPath = config::LibraryConfig::getInstance().getGaiaSaoDbPath();
+    auto lease = catalog::SQLiteConnectionPool::forPath(dbPath)->acquire();
     
-    if (sqlite3_open(dbPath.c_str(), &db) != SQLITE_OK) {
+    if (!lease) {
         return; // Database non disponibile, continua senza
     }
     
-    const char* query = R"(
-        SELECT gaia_dr3, ra_deg, dec_deg, magnitude, sao, proper_name, bayer, flamsteed
-        FROM stars
-        WHERE ra_deg BETWEEN ? AND ?
-          AND dec_deg BETWEEN ? AND ?
-          AND magnitude < 6.0
-          AND (gaia_dr3 IS NULL OR gaia_dr3 = 0)
-    )";
-    
-    sqlite3_stmt* stmt;
-    if (sqlite3_prepare_v2(db, query, -1, &stmt, nullptr) != SQLITE_OK) {
-        sqlite3_close(db);
-        return;
-    }
-    
-    // Calcola bounding box
+    // Box attorno al centro: la query spaziale gestisce 0h e le calotte polari
     double raWidth = config_.fieldRadius / std::cos(config_.centerDec * M_PI / 180.0);
     double raMin = config_.centerRA - raWidth;
     double raMax = config_.centerRA + raWidth;
     double decMin = config_.centerDec - config_.fieldRadius;
     double decMax = config_.centerDec + config_.fieldRadius;
     
-    sqlite3_bind_double(stmt, 1, raMin);
-    sqlite3_bind_double(stmt, 2, raMax);
-    sqlite3_bind_double(stmt, 3, decMin);
-    sqlite3_bind_double(stmt, 4, decMax);
-    
     int addedCount = 0;
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        double ra = sqlite3_column_double(stmt, 1);
-        double dec = sqlite3_column_double(stmt, 2);
-        double mag = sqlite3_column_double(stmt, 3);
+    {
+        // Query preparata una volta per connessione e riusata tra le carte.
+        // Schema corrente: indice parziale coprente delle stelle luminose,
+        // nome già risolto (proprio, Bayer o Flamsteed) in un'unica colonna
+        bool legacy = catalog::GaiaSAOSchema::version(lease->handle()) < catalog::GaiaSAOSchema::VERSION;
+        auto schema = catalog::GaiaSAOSchema::current();
+        auto& query = legacy
+            ? lease->spatialQuery("stars", "ra_deg", "dec_deg",
+                                  "magnitude, sao, proper_name, bayer, flamsteed",
+                                  "magnitude < 6.0 AND (gaia_dr3 IS NULL OR gaia_dr3 = 0)")
+            : lease->spatialQuery(schema.table, schema.ra, schema.dec,
+                                  catalog::GaiaSAOSchema::BRIGHT_COLUMNS,
+                                  catalog::GaiaSAOSchema::BRIGHT_CONDITION);
         
-        auto star = std::make_shared<core::Star>();
-        star->setCoordinates(core::EquatorialCoordinates(ra, dec));
-        star->setMagnitude(mag);
+        // Colonne: 0 ra, 1 dec, poi quelle richieste
+        constexpr int COL_MAG = catalog::SpatialQuery::FIRST_COLUMN;
+        constexpr int COL_SAO = COL_MAG + 1;
+        constexpr int COL_NAME = COL_MAG + 2;
+        constexpr int COL_BAYER = COL_MAG + 3;
+        constexpr int COL_FLAMSTEED = COL_MAG + 4;
         
-        // Aggiungi SAO se disponibile
-        if (sqlite3_column_type(stmt, 4) == SQLITE_INTEGER) {
-            star->setSAONumber(sqlite3_column_int(stmt, 4));
-        }
-        
-        // Aggiungi nome proprio se disponibile
-        if (sqlite3_column_type(stmt, 5) == SQLITE_TEXT) {
-            const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 5));
-            if (name && strlen(name) > 0) {
-                star->setName(name);
+        query.box(raMin, raMax, decMin, decMax, [&](sqlite3_stmt* stmt) {
+            double ra = sqlite3_column_double(stmt, 0);
+            double dec = sqlite3_column_double(stmt, 1);
+            double mag = sqlite3_column_double(stmt, COL_MAG);
+            
+            size_t i = stars_.append(ra, dec, mag);
+            
+            // Aggiungi SAO se disponibile
+            if (sqlite3_column_type(stmt, COL_SAO) == SQLITE_INTEGER) {
+                stars_.setSAONumber(i, sqlite3_column_int(stmt, COL_SAO));
             }
-        }
-        
-        // Se non ha nome proprio, usa Bayer o Flamsteed
-        if (star->getName().empty()) {
-            if (sqlite3_column_type(stmt, 6) == SQLITE_TEXT) {
-                const char* bayer = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 6));
-                if (bayer && strlen(bayer) > 0) {
-                    star->setName(bayer);
+            
+            // Aggiungi nome proprio se disponibile
+            if (sqlite3_column_type(stmt, COL_NAME) == SQLITE_TEXT) {
+                const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, COL_NAME));
+                if (name && strlen(name) > 0) {
+                    stars_.setName(i, name);
                 }
-            } else if (sqlite3_column_type(stmt, 7) == SQLITE_INTEGER) {
-                int flamsteed = sqlite3_column_int(stmt, 7);
-                if (flamsteed > 0) {
-                    star->setName(std::to_string(flamsteed));
+            }
+            
+            // Se non ha nome proprio, usa Bayer o Flamsteed
+            if (legacy && stars_.getName(i).empty()) {
+                if (sqlite3_column_type(stmt, COL_BAYER) == SQLITE_TEXT) {
+                    const char* bayer = reinterpret_cast<const char*>(sqlite3_column_text(stmt, COL_BAYER));
+                    if (bayer && strlen(bayer) > 0) {
+                        stars_.setName(i, bayer);
+                    }
+                } else if (sqlite3_column_type(stmt, COL_FLAMSTEED) == SQLITE_INTEGER) {
+                    int flamsteed = sqlite3_column_int(stmt, COL_FLAMSTEED);
+                    if (flamsteed > 0) {
+                        stars_.setName(i, std::to_string(flamsteed));
+                    }
                 }
             }
-        }
-        
-        stars_.push_back(star);
-        addedCount++;
+            
+            addedCount++;
+        });
     }
-    
-    sqlite3_finalize(stmt);
-    sqlite3_close(db);
+    lease.release();
     
     if (addedCount > 0) {
         std::cout << "  Aggiunte " << addedCount << " stelle luminose dal database\n";
@@ -205,70 +210,66 @@ bool ChartGenerator::loadStars() {
     params.center = core::EquatorialCoordinates(config_.centerRA, config_.centerDec);
     params.radiusDegrees = diagonalRadius;
     params.maxMagnitude = config_.maxMagnitude;
-    params.maxResults = 20000; // Increased to avoid truncation in wide fields
     
-    // Calcola automaticamente il limite ottimale per evitare overflow di memoria
-    params.calculateOptimalMaxResults();
-    
-    std::cout << "  Query Gaia con limite dinamico: " << params.maxResults << " stelle max\n";
-    
-    auto allStars = gaia.queryRegion(params);
-    
-    std::cout << "  Query Gaia: " << allStars.size() << " stelle trovate (raggio " << diagonalRadius << "°)\n";
-    
-    // Filtra per il rettangolo effettivo (non il cerchio)
+    // Filtra per il rettangolo effettivo (non il cerchio) e per magnitudine
+    // minima durante la visita. Oltre MAX_CHART_STARS si tengono le più
+    // luminose: la selezione avviene nella visita e vengono copiate solo le
+    // stelle che in quel momento rientrano tra le migliori
     double cosCenter = std::cos(config_.centerDec * M_PI / 180.0);
+    bool filterMinMagnitude = config_.minMagnitude > -10;
     
     stars_.clear();
-    stars_.reserve(std::min(allStars.size(), static_cast<size_t>(50000)));
+    core::BrightestSelector selector(MAX_CHART_STARS);
+    
+    // Elimina le righe scartate dal selettore (indici riassegnati in ordine)
+    auto keepSelected = [&]() {
+        std::vector<uint8_t> keep(stars_.size(), 0);
+        for (uint32_t i : selector.indices()) keep[i] = 1;
+        stars_.retain(keep);
+        selector = core::BrightestSelector(MAX_CHART_STARS);
+        for (size_t i = 0; i < stars_.size(); ++i) {
+            selector.offer(static_cast<float>(stars_.getMagnitude(i)), static_cast<uint32_t>(i));
+        }
+    };
     
-    for (const auto& star : allStars) {
-        double ra = star->getCoordinates().getRightAscension();
-        double dec = star->getCoordinates().getDeclination();
+    size_t inField = 0;
+    size_t inCone = gaia.forEachInCone(params, [&](const catalog::StarView& star) {
+        if (filterMinMagnitude && star.getMagnitude() < config_.minMagnitude) return;
         
         // Calcola offset dal centro
-        double dra = (ra - config_.centerRA) * cosCenter;
-        double ddec = dec - config_.centerDec;
+        double dra = (star.getRightAscension() - config_.centerRA) * cosCenter;
+        double ddec = star.getDeclination() - config_.centerDec;
         
         // Gestisci wrap-around RA (0-360)
         if (dra > 180 * cosCenter) dra -= 360 * cosCenter;
         if (dra < -180 * cosCenter) dra += 360 * cosCenter;
         
         // Controlla se dentro il rettangolo
-        if (std::abs(dra) <= fieldW && std::abs(ddec) <= fieldH) {
-            stars_.push_back(star);
-        }
+        if (std::abs(dra) > fieldW || std::abs(ddec) > fieldH) return;
+        inField++;
         
-        // Limita numero stelle per prevenire consumo eccessivo di memoria
-        if (stars_.size() >= static_cast<size_t>(50000)) {
-            std::cout << "  ATTENZIONE: Raggiunto limite di 50000 stelle, troncamento necessario\n";
-            std::cout << "  Suggerimento: riduci limitingMagnitude o fieldOfView per vedere tutte le stelle\n";
-            break;
-        }
-    }
-    
-    std::cout << "  Stelle nel rettangolo: " << stars_.size() << " (dopo filtro geometrico)\n";
-    
-    // Filtra per magnitudine minima
-    if (config_.minMagnitude > -10) {
-        stars_.erase(
-            std::remove_if(stars_.begin(), stars_.end(),
-                [this](const auto& s) { return s->getMagnitude() < config_.minMagnitude; }),
-            stars_.end()
-        );
+        float magnitude = static_cast<float>(star.getMagnitude());
+        if (!selector.accepts(magnitude)) return;
+        selector.offer(magnitude, static_cast<uint32_t>(star.appendTo(stars_)));
+        
+        // Le righe superate restano nel blocco fino alla compattazione
+        if (stars_.size() >= 2 * MAX_CHART_STARS) keepSelected();
+    });
+    if (stars_.size() > selector.size()) keepSelected();
+    
+    std::cout << "  Query Gaia: " << inCone << " stelle trovate (raggio " << diagonalRadius << "°)\n";
+    std::cout << "  Stelle nel rettangolo: " << inField << " (dopo filtro geometrico)\n";
+    
+    if (inField > MAX_CHART_STARS) {
+        std::cout << "  ATTENZIONE: " << inField << " stelle nel campo, tenute le "
+                  << MAX_CHART_STARS << " più luminose\n";
+        std::cout << "  Suggerimento: riduci limitingMagnitude o fieldOfView per vedere tutte le stelle\n";
     }
     
     // Arricchisci stelle con numeri SAO se richiesto
     if (config_.showSAONumbers) {
         catalog::SAOCatalog saoCatalog;
-        int enrichedCount = 0;
-        for (auto& star : stars_) {
-            if (star->getMagnitude() <= config_.saoMagnitudeLimit) {
-                if (saoCatalog.enrichWithSAO(star)) {
-                    enrichedCount++;
-                }
-            }
-        }
+        size_t enrichedCount = saoCatalog.enrichWithSAO(stars_, config_.saoMagnitudeLimit);
         // Debug: mostra quante stelle hanno SAO
         if (enrichedCount > 0) {
             std::cout << "  Arricchite " << enrichedCount << " stelle con numeri SAO\n";
@@ -569,18 +570,14 @@ bool ChartGenerator::generateSVG(const std::string& path) {
     svg << "\n  <!-- Stars (" << stars_.size() << " total) -->\n";
     svg << "  <g clip-path=\"url(#chartArea)\">\n";
     
-    // Ordina per magnitudine (più deboli prima)
-    std::vector<std::shared_ptr<core::Star>> sortedStars = stars_;
-    std::sort(sortedStars.begin(), sortedStars.end(),
-              [](const auto& a, const auto& b) {
-                  return a->getMagnitude() > b->getMagnitude();
-              });
+    // Ordina per magnitudine (più deboli prima): solo una permutazione di indici
+    std::vector<uint32_t> sortedStars = stars_.sortedByMagnitude(true);
     
     int starCount = 0;
-    for (const auto& star : sortedStars) {
-        double ra = star->getCoordinates().getRightAscension();
-        double dec = star->getCoordinates().getDeclination();
-        double mag = star->getMagnitude();
+    for (uint32_t idx : sortedStars) {
+        double ra = stars_.getRightAscension(idx);
+        double dec = stars_.getDeclination(idx);
+        double mag = stars_.getMagnitude(idx);
         
         auto [x, y] = projectToChart(ra, dec);
         
@@ -594,7 +591,7 @@ bool ChartGenerator::generateSVG(const std::string& path) {
         // Colore stella
         std::string color = s.starColor;
         if (s.useStarColors) {
-            auto ciOpt = star->getColorIndex();
+            auto ciOpt = stars_.getColorIndex(idx);
             if (ciOpt.has_value()) {
                 color = getStarColor(ciOpt.value());
             }
@@ -618,18 +615,18 @@ bool ChartGenerator::generateSVG(const std::string& path) {
             << "\" fill=\"" << s.labelColor << "\" font-weight=\"bold\">\n";
         
         int labelCount = 0;
-        for (const auto& star : sortedStars) {
-            double mag = star->getMagnitude();
+        for (uint32_t idx : sortedStars) {
+            double mag = stars_.getMagnitude(idx);
             if (mag > config_.labelMagnitudeLimit) continue;
             
-            double ra = star->getCoordinates().getRightAscension();
-            double dec = star->getCoordinates().getDeclination();
+            double ra = stars_.getRightAscension(idx);
+            double dec = stars_.getDeclination(idx);
             auto [x, y] = projectToChart(ra, dec);
             
             if (x < chartX + 20 || x > chartX + chartW - 20 || 
                 y < chartY + 20 || y > chartY + chartH - 20) continue;
             
-            std::string starName = star->getName();
+            const std::string& starName = stars_.getName(idx);
             if (starName.empty()) continue;
             
             // Filtra: mostra solo nomi comuni (non numeri Gaia/HD/HIP)
@@ -656,12 +653,12 @@ bool ChartGenerator::generateSVG(const std::string& path) {
             << "\" fill=\"" << s.labelColor << "\" opacity=\"0.7\">\n";
         
         int saoCount = 0;
-        for (const auto& star : sortedStars) {
-            double mag = star->getMagnitude();
+        for (uint32_t idx : sortedStars) {
+            double mag = stars_.getMagnitude(idx);
             if (mag > config_.saoMagnitudeLimit) continue;
             
             // Salta se ha un nome proprio
-            std::string starName = star->getName();
+            const std::string& starName = stars_.getName(idx);
             bool hasProperName = !starName.empty() && 
                                 starName.find("Gaia") != 0 && 
                                 starName.find("HD ") != 0 && 
@@ -670,11 +667,11 @@ bool ChartGenerator::generateSVG(const std::string& path) {
             if (hasProperName) continue;
             
             // Verifica se ha numero SAO
-            auto saoOpt = star->getSAONumber();
+            auto saoOpt = stars_.getSAONumber(idx);
             if (!saoOpt.has_value()) continue;
             
-            double ra = star->getCoordinates().getRightAscension();
-            double dec = star->getCoordinates().getDeclination();
+            double ra = stars_.getRightAscension(idx);
+            double dec = stars_.getDeclination(idx);
             auto [x, y] = projectToChart(ra, dec);
             
             if (x < chartX + 20 || x > chartX + chartW - 20 || 
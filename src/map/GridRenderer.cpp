@@ -18,9 +18,20 @@ std::vector<core::CartesianCoordinates> GridRenderer::generateSmoothCurve(
     
     std::vector<core::CartesianCoordinates> cartesianPoints;
     
-    for (const auto& point : celestialPoints) {
-        if (projection_.isVisible(point)) {
-            cartesianPoints.push_back(projection_.project(point));
+    size_t count = celestialPoints.size();
+    std::vector<double> ra(count), dec(count);
+    for (size_t i = 0; i < count; ++i) {
+        ra[i] = celestialPoints[i].getRightAscension();
+        dec[i] = celestialPoints[i].getDeclination();
+    }
+    std::vector<float> x(count), y(count);
+    std::vector<uint8_t> visible(count);
+    projection_.projectBatch(ra.data(), dec.data(), count, x.data(), y.data(), visible.data());
+    
+    cartesianPoints.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        if (visible[i]) {
+            cartesianPoints.emplace_back(x[i], y[i]);
         }
     }
     
@@ -121,12 +132,22 @@ std::vector<MapLabel> GridRenderer::generateCoordinateLabels() {
     
     double labelDec = centerDec + fovDec / 2.0 - 1.0; // Vicino al bordo superiore
     
+    std::vector<double> labelRAs, labelDecs;
     for (double ra = raStart; ra <= raEnd; ra += raStep) {
-        core::EquatorialCoordinates coord(ra, labelDec);
+        labelRAs.push_back(ra);
+        labelDecs.push_back(labelDec);
+    }
+    std::vector<float> x(labelRAs.size()), y(labelRAs.size());
+    std::vector<uint8_t> visible(labelRAs.size());
+    projection_.projectBatch(labelRAs.data(), labelDecs.data(), labelRAs.size(),
+                             x.data(), y.data(), visible.data());
+    
+    for (size_t i = 0; i < labelRAs.size(); ++i) {
+        double ra = labelRAs[i];
         
-        if (projection_.isVisible(coord)) {
+        if (visible[i]) {
             MapLabel label;
-            label.position = projection_.project(coord);
+            label.position = core::CartesianCoordinates(x[i], y[i]);
             label.color = config_.gridStyle.labelColor;
             label.fontSize = config_.gridStyle.labelFontSize;
             
@@ -150,14 +171,25 @@ std::vector<MapLabel> GridRenderer::generateCoordinateLabels() {
     
     double labelRA = centerRA - fovRA / 2.0 + 1.0;
     
+    labelRAs.clear();
+    labelDecs.clear();
     for (double dec = decStart; dec <= decEnd; dec += decStep) {
         if (dec < -90.0 || dec > 90.0) continue;
+        labelRAs.push_back(labelRA);
+        labelDecs.push_back(dec);
+    }
+    x.resize(labelDecs.size());
+    y.resize(labelDecs.size());
+    visible.resize(labelDecs.size());
+    projection_.projectBatch(labelRAs.data(), labelDecs.data(), labelDecs.size(),
+                             x.data(), y.data(), visible.data());
+    
+    for (size_t i = 0; i < labelDecs.size(); ++i) {
+        double dec = labelDecs[i];
         
-        core::EquatorialCoordinates coord(labelRA, dec);
-        
-        if (projection_.isVisible(coord)) {
+        if (visible[i]) {
             MapLabel label;
-            label.position = projection_.project(coord);
+            label.position = core::CartesianCoordinates(x[i], y[i]);
             label.color = config_.gridStyle.labelColor;
             label.fontSize = config_.gridStyle.labelFontSize;
             
@@ -1,4 +1,5 @@
 #include "starmap/map/MapConfiguration.h"
+#include "starmap/core/EpochPropagation.h"
 
 namespace starmap {
 namespace map {
@@ -31,6 +32,12 @@ bool MapConfiguration::validate() const {
         return false;
     }
     
+    // Istante di osservazione (ISO 8601)
+    if (useObservationTime &&
+        !core::EpochPropagation::parseEpoch(observationTime).has_value()) {
+        return false;
+    }
+    
     return true;
 }
 
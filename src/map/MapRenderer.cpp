@@ -1,7 +1,9 @@
 #include "starmap/map/MapRenderer.h"
+#include "starmap/core/EpochPropagation.h"
 #include <algorithm>
 #include <cmath>
 #include <cstring>
+#include <iostream>
 
 #define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "starmap/utils/stb_image_write.h"
@@ -9,6 +11,13 @@
 namespace starmap {
 namespace map {
 
+namespace {
+
+// Stelle proiettate per chiamata a projectBatch (buffer sullo stack)
+constexpr size_t PROJECTION_CHUNK = 1024;
+
+} // namespace
+
 // ============================================================================
 // ImageBuffer
 // ============================================================================
@@ -100,13 +109,36 @@ ImageBuffer MapRenderer::renderBackground() {
 ImageBuffer MapRenderer::render(
     const std::vector<std::shared_ptr<core::Star>>& stars) {
     
+    return render(core::StarBlock::fromStars(stars));
+}
+
+ImageBuffer MapRenderer::render(const core::StarBlock& stars) {
+    
+    // Con un istante di osservazione le posizioni del catalogo (J2016.0)
+    // vengono riportate a quell'epoca su una copia del blocco
+    if (config_.useObservationTime) {
+        auto epoch = core::EpochPropagation::parseEpoch(config_.observationTime);
+        if (epoch) {
+            core::StarBlock propagated = stars;
+            core::EpochPropagation::propagate(propagated, *epoch);
+            return renderStars(propagated);
+        }
+        std::cerr << "Istante di osservazione non valido: '" << config_.observationTime
+                  << "', posizioni all'epoca del catalogo\n";
+    }
+    
+    return renderStars(stars);
+}
+
+ImageBuffer MapRenderer::renderStars(const core::StarBlock& stars) {
+    
     ImageBuffer buffer = renderBackground();
     
     // Se troppe stelle, usa rendering in batch
     if (stars.size() > static_cast<size_t>(config_.starBatchSize)) {
         renderStarsBatched(buffer, stars);
     } else {
-        drawStars(buffer, stars);
+        drawStars(buffer, stars, 0, stars.size());
     }
     
     // Disegna overlay personalizzati
@@ -120,26 +152,23 @@ ImageBuffer MapRenderer::render(
 void MapRenderer::renderStarsBatched(ImageBuffer& buffer,
                                      const std::vector<std::shared_ptr<core::Star>>& stars,
                                      int batchSize) {
+    renderStarsBatched(buffer, core::StarBlock::fromStars(stars), batchSize);
+}
+
+void MapRenderer::renderStarsBatched(ImageBuffer& buffer,
+                                     const core::StarBlock& stars,
+                                     int batchSize) {
     // Usa dimensione batch dalla config se non specificato
     if (batchSize <= 0) {
         batchSize = config_.starBatchSize;
     }
     
-    // Processa le stelle in batch per ridurre il consumo di memoria
+    // Le colonne sono già contigue: i batch sono solo intervalli di indici,
+    // nessuna copia temporanea
     size_t totalStars = stars.size();
     for (size_t i = 0; i < totalStars; i += batchSize) {
         size_t end = std::min(i + batchSize, totalStars);
-        
-        // Crea un vettore temporaneo per questo batch
-        std::vector<std::shared_ptr<core::Star>> batch(
-            stars.begin() + i, 
-            stars.begin() + end
-        );
-        
-        // Renderizza questo batch
-        drawStars(buffer, batch);
-        
-        // Il batch viene distrutto qui, liberando memoria
+        drawStars(buffer, stars, i, end);
     }
 }
 
@@ -221,13 +250,13 @@ float MapRenderer::calculateStarSize(double magnitude) const {
     return std::min(style.maxSymbolSize, size);
 }
 
-uint32_t MapRenderer::calculateStarColor(const core::Star& star) const {
+uint32_t MapRenderer::calculateStarColor(const core::StarBlock& stars, size_t index) const {
     if (!config_.starStyle.useSpectralColors) {
         return config_.starStyle.defaultColor;
     }
     
     // Usa color index (B-V) se disponibile
-    auto colorIndex = star.getColorIndex();
+    auto colorIndex = stars.getColorIndex(index);
     
     if (colorIndex.has_value()) {
         double bv = colorIndex.value();
@@ -278,68 +307,80 @@ void MapRenderer::drawCircleAA(ImageBuffer& buffer, int cx, int cy,
     uint8_t b = (color >> 8) & 0xFF;
     uint8_t a = color & 0xFF;
     
+    const float outer = radius + 0.5f;
+    const float inner = radius - 0.5f;
+    
+    // Il riquadro è già ritagliato sul buffer: accesso diretto alle righe
+    // RGBA, senza i controlli di getPixel/setPixel per pixel
     for (int y = minY; y <= maxY; ++y) {
+        uint8_t* row = buffer.data.data() + static_cast<size_t>(y) * buffer.width * 4;
+        float dy = y - cy;
+        
         for (int x = minX; x <= maxX; ++x) {
             float dx = x - cx;
-            float dy = y - cy;
             float dist = std::sqrt(dx * dx + dy * dy);
             
-            if (dist <= radius + 0.5f) {
+            if (dist <= outer) {
                 float alpha = 1.0f;
-                if (dist > radius - 0.5f) {
-                    alpha = radius + 0.5f - dist;
+                if (dist > inner) {
+                    alpha = outer - dist;
                 }
                 
                 uint8_t finalAlpha = static_cast<uint8_t>(a * alpha);
-                uint32_t pixelColor = (r << 24) | (g << 16) | (b << 8) | finalAlpha;
                 
                 // Alpha blending
-                uint32_t bgColor = buffer.getPixel(x, y);
-                uint8_t bgR = (bgColor >> 24) & 0xFF;
-                uint8_t bgG = (bgColor >> 16) & 0xFF;
-                uint8_t bgB = (bgColor >> 8) & 0xFF;
-                
+                uint8_t* pixel = row + x * 4;
                 float blendAlpha = finalAlpha / 255.0f;
-                uint8_t newR = static_cast<uint8_t>(r * blendAlpha + bgR * (1.0f - blendAlpha));
-                uint8_t newG = static_cast<uint8_t>(g * blendAlpha + bgG * (1.0f - blendAlpha));
-                uint8_t newB = static_cast<uint8_t>(b * blendAlpha + bgB * (1.0f - blendAlpha));
-                
-                buffer.setPixel(x, y, (newR << 24) | (newG << 16) | (newB << 8) | 0xFF);
+                pixel[0] = static_cast<uint8_t>(r * blendAlpha + pixel[0] * (1.0f - blendAlpha));
+                pixel[1] = static_cast<uint8_t>(g * blendAlpha + pixel[1] * (1.0f - blendAlpha));
+                pixel[2] = static_cast<uint8_t>(b * blendAlpha + pixel[2] * (1.0f - blendAlpha));
+                pixel[3] = 0xFF;
             }
         }
     }
 }
 
 void MapRenderer::drawStars(ImageBuffer& buffer, 
-                           const std::vector<std::shared_ptr<core::Star>>& stars) {
-    
-    for (const auto& star : stars) {
-        if (!star) continue;
-        
-        const auto& coords = star->getCoordinates();
-        
-        // Verifica se la stella è visibile
-        if (!projection_->isVisible(coords)) {
-            continue;
+                           const core::StarBlock& stars,
+                           size_t begin, size_t end) {
+    
+    const double* ra = stars.raColumn().data();
+    const double* dec = stars.decColumn().data();
+    float x[PROJECTION_CHUNK], y[PROJECTION_CHUNK];
+    uint8_t visible[PROJECTION_CHUNK];
+    
+    // Proiezione e visibilità in un solo passaggio per blocco di colonne;
+    // con i versori già calcolati nessuna trigonometria per stella
+    for (size_t chunk = begin; chunk < end; chunk += PROJECTION_CHUNK) {
+        size_t count = std::min(PROJECTION_CHUNK, end - chunk);
+        if (stars.hasUnitVectors()) {
+            projection_->projectUnitVectors(stars.xColumn().data() + chunk,
+                                            stars.yColumn().data() + chunk,
+                                            stars.zColumn().data() + chunk,
+                                            count, x, y, visible);
+        } else {
+            projection_->projectBatch(ra + chunk, dec + chunk, count, x, y, visible);
         }
         
-        // Proietta coordinate
-        auto projected = projection_->project(coords);
-        
-        drawStar(buffer, projected, *star);
+        for (size_t j = 0; j < count; ++j) {
+            if (!visible[j]) continue;
+            drawStar(buffer, core::CartesianCoordinates(x[j], y[j]), stars, chunk + j);
+        }
     }
 }
 
 void MapRenderer::drawStar(ImageBuffer& buffer, 
                           const core::CartesianCoordinates& pos,
-                          const core::Star& star) {
+                          const core::StarBlock& stars, size_t index) {
     
     int px, py;
     normalizedToPixel(pos, px, py);
     
+    double magnitude = stars.getMagnitude(index);
+    
     // Calcola dimensione e colore
-    float size = calculateStarSize(star.getMagnitude());
-    uint32_t color = calculateStarColor(star);
+    float size = calculateStarSize(magnitude);
+    uint32_t color = calculateStarColor(stars, index);
     
     // Disegna cerchio con antialiasing
     drawCircleAA(buffer, px, py, size, color);
@@ -348,24 +389,26 @@ void MapRenderer::drawStar(ImageBuffer& buffer,
     // Aumentiamo il limite di magnitudine per le label (molte stelle di occultazione sono mag 8-9)
     float labelLimit = std::max(config_.starStyle.minMagnitudeForLabel, 10.0f);
     
-    if (config_.starStyle.showNames && !star.getName().empty() &&
-        star.getMagnitude() < labelLimit) {
+    const std::string& name = stars.getName(index);
+    if (config_.starStyle.showNames && !name.empty() &&
+        magnitude < labelLimit) {
         
         MapLabel label;
         label.position = pos;
-        label.text = star.getName();
+        label.text = name;
         label.color = config_.starStyle.labelColor;
         label.fontSize = config_.starStyle.labelFontSize;
         drawLabel(buffer, label);
     }
     
     // Numero SAO se disponibile
-    if (config_.starStyle.showSAONumbers && star.getSAONumber().has_value() &&
-        star.getMagnitude() < labelLimit) {
+    auto sao = stars.getSAONumber(index);
+    if (config_.starStyle.showSAONumbers && sao.has_value() &&
+        magnitude < labelLimit) {
         
         MapLabel label;
         label.position = core::CartesianCoordinates(pos.getX(), pos.getY() - 0.02);
-        label.text = "SAO " + std::to_string(star.getSAONumber().value());
+        label.text = "SAO " + std::to_string(sao.value());
         label.color = config_.starStyle.labelColor;
         label.fontSize = config_.starStyle.labelFontSize * 0.8f;
         drawLabel(buffer, label);
@@ -530,11 +573,6 @@ void MapRenderer::drawOverlayPaths(ImageBuffer& buffer) {
 }
 
 void MapRenderer::drawRectangle(ImageBuffer& buffer, const OverlayRectangle& rect) {
-    // Converti coordinate celesti in coordinate schermo
-    core::EquatorialCoordinates center(rect.centerRA, rect.centerDec);
-    
-    if (!projection_->isVisible(center)) return;
-    
     // Calcola i 4 angoli del rettangolo
     double halfWidthRA = rect.widthRA / 2.0;
     double halfHeightDec = rect.heightDec / 2.0;
@@ -543,22 +581,30 @@ void MapRenderer::drawRectangle(ImageBuffer& buffer, const OverlayRectangle& rec
     double cosCenter = std::cos(rect.centerDec * M_PI / 180.0);
     double actualHalfWidthRA = halfWidthRA / (cosCenter > 0.01 ? cosCenter : 0.01);
     
-    core::EquatorialCoordinates corners[4] = {
-        core::EquatorialCoordinates(rect.centerRA - actualHalfWidthRA, rect.centerDec - halfHeightDec),
-        core::EquatorialCoordinates(rect.centerRA + actualHalfWidthRA, rect.centerDec - halfHeightDec),
-        core::EquatorialCoordinates(rect.centerRA + actualHalfWidthRA, rect.centerDec + halfHeightDec),
-        core::EquatorialCoordinates(rect.centerRA - actualHalfWidthRA, rect.centerDec + halfHeightDec)
+    // Angoli 0-3 e centro (4) proiettati insieme
+    double ra[5] = {
+        rect.centerRA - actualHalfWidthRA, rect.centerRA + actualHalfWidthRA,
+        rect.centerRA + actualHalfWidthRA, rect.centerRA - actualHalfWidthRA,
+        rect.centerRA
     };
+    double dec[5] = {
+        rect.centerDec - halfHeightDec, rect.centerDec - halfHeightDec,
+        rect.centerDec + halfHeightDec, rect.centerDec + halfHeightDec,
+        rect.centerDec
+    };
+    float x[5], y[5];
+    uint8_t visible[5];
+    projection_->projectBatch(ra, dec, 5, x, y, visible);
+    
+    // Rettangolo fuori vista se il centro o un angolo non è visibile
+    for (int i = 0; i < 5; ++i) {
+        if (!visible[i]) return;
+    }
     
     // Converti in pixel
     int px[4], py[4];
     for (int i = 0; i < 4; ++i) {
-        if (projection_->isVisible(corners[i])) {
-            auto projected = projection_->project(corners[i]);
-            normalizedToPixel(projected, px[i], py[i]);
-        } else {
-            return; // Rettangolo fuori vista
-        }
+        normalizedToPixel(core::CartesianCoordinates(x[i], y[i]), px[i], py[i]);
     }
     
     // Disegna riempimento se richiesto
@@ -611,22 +657,24 @@ void MapRenderer::drawRectangle(ImageBuffer& buffer, const OverlayRectangle& rec
 void MapRenderer::drawPath(ImageBuffer& buffer, const OverlayPath& path) {
     if (path.points.size() < 2) return;
     
+    // Ogni punto è proiettato una sola volta, anche se condiviso da due segmenti
+    size_t count = path.points.size();
+    std::vector<double> ra(count), dec(count);
+    for (size_t i = 0; i < count; ++i) {
+        ra[i] = path.points[i].ra;
+        dec[i] = path.points[i].dec;
+    }
+    std::vector<float> x(count), y(count);
+    std::vector<uint8_t> visible(count);
+    projection_->projectBatch(ra.data(), dec.data(), count, x.data(), y.data(), visible.data());
+    
     // Disegna linee tra i punti
-    for (size_t i = 0; i < path.points.size() - 1; ++i) {
-        const auto& p1 = path.points[i];
-        const auto& p2 = path.points[i + 1];
-        
-        core::EquatorialCoordinates coord1(p1.ra, p1.dec);
-        core::EquatorialCoordinates coord2(p2.ra, p2.dec);
-        
-        if (!projection_->isVisible(coord1) || !projection_->isVisible(coord2)) continue;
-        
-        auto proj1 = projection_->project(coord1);
-        auto proj2 = projection_->project(coord2);
+    for (size_t i = 0; i < count - 1; ++i) {
+        if (!visible[i] || !visible[i + 1]) continue;
         
         int x0, y0, x1, y1;
-        normalizedToPixel(proj1, x0, y0);
-        normalizedToPixel(proj2, x1, y1);
+        normalizedToPixel(core::CartesianCoordinates(x[i], y[i]), x0, y0);
+        normalizedToPixel(core::CartesianCoordinates(x[i + 1], y[i + 1]), x1, y1);
         
         // Bresenham line drawing
         int dx = std::abs(x1 - x0);
@@ -664,13 +712,11 @@ void MapRenderer::drawPath(ImageBuffer& buffer, const OverlayPath& path) {
     
     // Disegna i punti se richiesto
     if (path.showPoints) {
-        for (const auto& point : path.points) {
-            core::EquatorialCoordinates coord(point.ra, point.dec);
-            if (!projection_->isVisible(coord)) continue;
+        for (size_t i = 0; i < count; ++i) {
+            if (!visible[i]) continue;
             
-            auto projected = projection_->project(coord);
             int px, py;
-            normalizedToPixel(projected, px, py);
+            normalizedToPixel(core::CartesianCoordinates(x[i], y[i]), px, py);
             
             drawCircleAA(buffer, px, py, path.pointSize, path.color);
         }
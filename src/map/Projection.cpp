@@ -1,10 +1,49 @@
 #include "starmap/map/Projection.h"
+#include "starmap/core/UnitVector.h"
+#include <algorithm>
 #include <cmath>
 #include <stdexcept>
 
 namespace starmap {
 namespace map {
 
+namespace {
+
+constexpr double DEG_TO_RAD = M_PI / 180.0;
+
+// Marcatore dei punti dietro il piano della proiezione gnomonica
+constexpr double BEHIND_PLANE = 1e10;
+
+// Versori convertiti in RA/Dec per blocco (implementazione di base)
+constexpr size_t CONVERSION_CHUNK = 256;
+
+} // namespace
+
+// ============================================================================
+// Projection
+// ============================================================================
+
+void Projection::projectBatch(const double* ra, const double* dec, size_t count,
+                              float* x, float* y, uint8_t* visible) const {
+    for (size_t i = 0; i < count; ++i) {
+        core::EquatorialCoordinates coords(ra[i], dec[i]);
+        auto projected = project(coords);
+        x[i] = static_cast<float>(projected.getX());
+        y[i] = static_cast<float>(projected.getY());
+        visible[i] = isVisible(coords) ? 1 : 0;
+    }
+}
+
+void Projection::projectUnitVectors(const double* vx, const double* vy, const double* vz,
+                                    size_t count, float* x, float* y, uint8_t* visible) const {
+    double ra[CONVERSION_CHUNK], dec[CONVERSION_CHUNK];
+    for (size_t begin = 0; begin < count; begin += CONVERSION_CHUNK) {
+        size_t n = std::min(CONVERSION_CHUNK, count - begin);
+        core::UnitVector::toRaDec(vx + begin, vy + begin, vz + begin, n, ra, dec);
+        projectBatch(ra, dec, n, x + begin, y + begin, visible + begin);
+    }
+}
+
 // ============================================================================
 // ProjectionFactory
 // ============================================================================
@@ -37,7 +76,10 @@ std::unique_ptr<Projection> ProjectionFactory::create(
 StereographicProjection::StereographicProjection(
     const core::EquatorialCoordinates& center,
     double fovWidth, double fovHeight)
-    : center_(center), fovWidth_(fovWidth), fovHeight_(fovHeight) {
+    : center_(center),
+      sinDec0_(std::sin(center.getDeclination() * DEG_TO_RAD)),
+      cosDec0_(std::cos(center.getDeclination() * DEG_TO_RAD)),
+      fovWidth_(fovWidth), fovHeight_(fovHeight) {
     
     // Calcola scala basata sul FOV
     scale_ = 2.0 / std::tan((fovWidth * M_PI / 180.0) / 2.0);
@@ -50,7 +92,6 @@ core::CartesianCoordinates StereographicProjection::project(
     double ra = celestial.getRightAscension() * M_PI / 180.0;
     double dec = celestial.getDeclination() * M_PI / 180.0;
     double ra0 = center_.getRightAscension() * M_PI / 180.0;
-    double dec0 = center_.getDeclination() * M_PI / 180.0;
     
     // Differenza in RA
     double dRA = ra - ra0;
@@ -58,8 +99,8 @@ core::CartesianCoordinates StereographicProjection::project(
     // Formula della proiezione stereografica
     double cosDec = std::cos(dec);
     double sinDec = std::sin(dec);
-    double cosDec0 = std::cos(dec0);
-    double sinDec0 = std::sin(dec0);
+    double cosDec0 = cosDec0_;
+    double sinDec0 = sinDec0_;
     double cosDRA = std::cos(dRA);
     
     double k = scale_ / (1.0 + sinDec0 * sinDec + cosDec0 * cosDec * cosDRA);
@@ -105,8 +146,20 @@ bool StereographicProjection::isVisible(
     return (std::abs(x) <= aspectRatio && std::abs(y) <= 1.0);
 }
 
+void StereographicProjection::projectBatch(const double* ra, const double* dec, size_t count,
+                                           float* x, float* y, uint8_t* visible) const {
+    kernels::projectColumns(kernel(), ra, dec, count, x, y, visible);
+}
+
+void StereographicProjection::projectUnitVectors(const double* vx, const double* vy, const double* vz,
+                                                 size_t count, float* x, float* y, uint8_t* visible) const {
+    kernels::projectVectorColumns(kernel(), vx, vy, vz, count, x, y, visible);
+}
+
 void StereographicProjection::setCenter(const core::EquatorialCoordinates& center) {
     center_ = center;
+    sinDec0_ = std::sin(center.getDeclination() * DEG_TO_RAD);
+    cosDec0_ = std::cos(center.getDeclination() * DEG_TO_RAD);
 }
 
 void StereographicProjection::setFieldOfView(double widthDeg, double heightDeg) {
@@ -115,6 +168,12 @@ void StereographicProjection::setFieldOfView(double widthDeg, double heightDeg)
     scale_ = 2.0 / std::tan((fovWidth_ * M_PI / 180.0) / 2.0);
 }
 
+kernels::Stereographic StereographicProjection::kernel() const {
+    double ra0 = center_.getRightAscension() * DEG_TO_RAD;
+    return {ra0, sinDec0_, cosDec0_, scale_, fovWidth_ / fovHeight_,
+            kernels::Frame::at(ra0, sinDec0_, cosDec0_)};
+}
+
 // ============================================================================
 // GnomonicProjection
 // ============================================================================
@@ -122,7 +181,10 @@ void StereographicProjection::setFieldOfView(double widthDeg, double heightDeg)
 GnomonicProjection::GnomonicProjection(
     const core::EquatorialCoordinates& center,
     double fovWidth, double fovHeight)
-    : center_(center), fovWidth_(fovWidth), fovHeight_(fovHeight) {
+    : center_(center),
+      sinDec0_(std::sin(center.getDeclination() * DEG_TO_RAD)),
+      cosDec0_(std::cos(center.getDeclination() * DEG_TO_RAD)),
+      fovWidth_(fovWidth), fovHeight_(fovHeight) {
 }
 
 core::CartesianCoordinates GnomonicProjection::project(
@@ -131,20 +193,19 @@ core::CartesianCoordinates GnomonicProjection::project(
     double ra = celestial.getRightAscension() * M_PI / 180.0;
     double dec = celestial.getDeclination() * M_PI / 180.0;
     double ra0 = center_.getRightAscension() * M_PI / 180.0;
-    double dec0 = center_.getDeclination() * M_PI / 180.0;
     
     double dRA = ra - ra0;
     double cosDec = std::cos(dec);
     double sinDec = std::sin(dec);
-    double cosDec0 = std::cos(dec0);
-    double sinDec0 = std::sin(dec0);
+    double cosDec0 = cosDec0_;
+    double sinDec0 = sinDec0_;
     double cosDRA = std::cos(dRA);
     
     double cosC = sinDec0 * sinDec + cosDec0 * cosDec * cosDRA;
     
     if (cosC <= 0) {
         // Punto dietro il piano di proiezione
-        return core::CartesianCoordinates(1e10, 1e10);
+        return core::CartesianCoordinates(BEHIND_PLANE, BEHIND_PLANE);
     }
     
     double x = cosDec * std::sin(dRA) / cosC;
@@ -192,8 +253,20 @@ bool GnomonicProjection::isVisible(const core::EquatorialCoordinates& celestial)
             x < 1e9 && y < 1e9); // Controlla se non dietro
 }
 
+void GnomonicProjection::projectBatch(const double* ra, const double* dec, size_t count,
+                                      float* x, float* y, uint8_t* visible) const {
+    kernels::projectColumns(kernel(), ra, dec, count, x, y, visible);
+}
+
+void GnomonicProjection::projectUnitVectors(const double* vx, const double* vy, const double* vz,
+                                            size_t count, float* x, float* y, uint8_t* visible) const {
+    kernels::projectVectorColumns(kernel(), vx, vy, vz, count, x, y, visible);
+}
+
 void GnomonicProjection::setCenter(const core::EquatorialCoordinates& center) {
     center_ = center;
+    sinDec0_ = std::sin(center.getDeclination() * DEG_TO_RAD);
+    cosDec0_ = std::cos(center.getDeclination() * DEG_TO_RAD);
 }
 
 void GnomonicProjection::setFieldOfView(double widthDeg, double heightDeg) {
@@ -201,6 +274,12 @@ void GnomonicProjection::setFieldOfView(double widthDeg, double heightDeg) {
     fovHeight_ = heightDeg;
 }
 
+kernels::Gnomonic GnomonicProjection::kernel() const {
+    double ra0 = center_.getRightAscension() * DEG_TO_RAD;
+    return {ra0, sinDec0_, cosDec0_, 180.0 / (fovWidth_ * M_PI), fovWidth_ / fovHeight_,
+            kernels::Frame::at(ra0, sinDec0_, cosDec0_)};
+}
+
 // ============================================================================
 // OrthographicProjection
 // ============================================================================
@@ -208,7 +287,10 @@ void GnomonicProjection::setFieldOfView(double widthDeg, double heightDeg) {
 OrthographicProjection::OrthographicProjection(
     const core::EquatorialCoordinates& center,
     double fovWidth, double fovHeight)
-    : center_(center), fovWidth_(fovWidth), fovHeight_(fovHeight) {
+    : center_(center),
+      sinDec0_(std::sin(center.getDeclination() * DEG_TO_RAD)),
+      cosDec0_(std::cos(center.getDeclination() * DEG_TO_RAD)),
+      fovWidth_(fovWidth), fovHeight_(fovHeight) {
 }
 
 core::CartesianCoordinates OrthographicProjection::project(
@@ -217,13 +299,12 @@ core::CartesianCoordinates OrthographicProjection::project(
     double ra = celestial.getRightAscension() * M_PI / 180.0;
     double dec = celestial.getDeclination() * M_PI / 180.0;
     double ra0 = center_.getRightAscension() * M_PI / 180.0;
-    double dec0 = center_.getDeclination() * M_PI / 180.0;
     
     double dRA = ra - ra0;
     
     double x = std::cos(dec) * std::sin(dRA);
-    double y = std::cos(dec0) * std::sin(dec) - 
-               std::sin(dec0) * std::cos(dec) * std::cos(dRA);
+    double y = cosDec0_ * std::sin(dec) - 
+               sinDec0_ * std::cos(dec) * std::cos(dRA);
     
     // Normalizza al FOV
     double scale = 180.0 / (fovWidth_ * M_PI);
@@ -265,19 +346,30 @@ bool OrthographicProjection::isVisible(const core::EquatorialCoordinates& celest
     double ra = celestial.getRightAscension() * M_PI / 180.0;
     double dec = celestial.getDeclination() * M_PI / 180.0;
     double ra0 = center_.getRightAscension() * M_PI / 180.0;
-    double dec0 = center_.getDeclination() * M_PI / 180.0;
     
     double dRA = ra - ra0;
     
     // Visibile se sul lato frontale della sfera
-    double cosC = std::sin(dec0) * std::sin(dec) + 
-                  std::cos(dec0) * std::cos(dec) * std::cos(dRA);
+    double cosC = sinDec0_ * std::sin(dec) + 
+                  cosDec0_ * std::cos(dec) * std::cos(dRA);
     
     return cosC > 0;
 }
 
+void OrthographicProjection::projectBatch(const double* ra, const double* dec, size_t count,
+                                          float* x, float* y, uint8_t* visible) const {
+    kernels::projectColumns(kernel(), ra, dec, count, x, y, visible);
+}
+
+void OrthographicProjection::projectUnitVectors(const double* vx, const double* vy, const double* vz,
+                                                size_t count, float* x, float* y, uint8_t* visible) const {
+    kernels::projectVectorColumns(kernel(), vx, vy, vz, count, x, y, visible);
+}
+
 void OrthographicProjection::setCenter(const core::EquatorialCoordinates& center) {
     center_ = center;
+    sinDec0_ = std::sin(center.getDeclination() * DEG_TO_RAD);
+    cosDec0_ = std::cos(center.getDeclination() * DEG_TO_RAD);
 }
 
 void OrthographicProjection::setFieldOfView(double widthDeg, double heightDeg) {
@@ -285,5 +377,11 @@ void OrthographicProjection::setFieldOfView(double widthDeg, double heightDeg) {
     fovHeight_ = heightDeg;
 }
 
+kernels::Orthographic OrthographicProjection::kernel() const {
+    double ra0 = center_.getRightAscension() * DEG_TO_RAD;
+    return {ra0, sinDec0_, cosDec0_, 180.0 / (fovWidth_ * M_PI),
+            kernels::Frame::at(ra0, sinDec0_, cosDec0_)};
+}
+
 } // namespace map
 } // namespace starmap
@@ -2,10 +2,18 @@
 #include "starmap/catalog/CatalogManager.h"
 #include "starmap/map/ChartGenerator.h"
 #include "starmap/core/CelestialObject.h"
+#include "starmap/core/ApparentPlace.h"
+#include "starmap/core/EpochPropagation.h"
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
 #include <fstream>
+#include <optional>
 #include <sstream>
 #include <iomanip>
 #include <ctime>
+#include <iostream>
+#include <utility>
 #include <nlohmann/json.hpp>
 
 using json = nlohmann::json;
@@ -25,6 +33,65 @@ public:
     std::vector<std::string> validationMessages;
     
     bool hasEvent = false;
+    
+    // Distanza massima tra il bersaglio e la sua controparte nel catalogo
+    static constexpr double TARGET_MATCH_ARCSEC = 1.0;
+    
+    /**
+     * @brief Riga della stella bersaglio nel blocco del catalogo
+     *
+     * Per Gaia ID se catalogId è "Gaia DR3 <id>", altrimenti la stella più
+     * vicina entro TARGET_MATCH_ARCSEC.
+     */
+    std::optional<size_t> findTarget(const core::StarBlock& stars) const {
+        const auto& target = event.targetStar;
+        const std::string& id = target.catalogId;
+        if (id.find("Gaia") != std::string::npos) {
+            size_t digits = id.size();
+            while (digits > 0 && std::isdigit(static_cast<unsigned char>(id[digits - 1]))) digits--;
+            if (digits < id.size()) {
+                long long gaiaId = std::strtoll(id.c_str() + digits, nullptr, 10);
+                for (size_t i = 0; i < stars.size(); ++i) {
+                    if (stars.getGaiaId(i) == gaiaId) return i;
+                }
+            }
+        }
+        
+        std::optional<size_t> nearest;
+        double best = TARGET_MATCH_ARCSEC / 3600.0;
+        for (size_t i = 0; i < stars.size(); ++i) {
+            double distance = target.coordinates.angularDistance(stars.getCoordinates(i));
+            if (distance <= best) {
+                best = distance;
+                nearest = i;
+            }
+        }
+        return nearest;
+    }
+    
+    /**
+     * @brief Propaga le stelle all'epoca indicata e restituisce lo spostamento del bersaglio
+     *
+     * Il bersaglio (centro della carta e marker) segue il moto proprio
+     * della sua controparte nel catalogo, come le altre stelle; le sue
+     * coordinate si assumono all'epoca del catalogo. Senza controparte lo
+     * spostamento è nullo e resta alla posizione dell'evento.
+     * @return Spostamento (RA, Dec) in gradi
+     */
+    std::pair<double, double> propagateWithTarget(core::StarBlock& stars, double epoch) const {
+        auto targetRow = findTarget(stars);
+        double targetRA = 0.0, targetDec = 0.0;
+        if (targetRow) {
+            targetRA = stars.getRightAscension(*targetRow);
+            targetDec = stars.getDeclination(*targetRow);
+        }
+        
+        core::EpochPropagation::propagate(stars, epoch);
+        
+        if (!targetRow) return {0.0, 0.0};
+        return {std::remainder(stars.getRightAscension(*targetRow) - targetRA, 360.0),
+                stars.getDeclination(*targetRow) - targetDec};
+    }
 };
 
 // ============================================================================
@@ -138,7 +205,7 @@ map::ImageBuffer OccultationChartBuilder::generateCustomChart(
     // Calcola automaticamente il limite ottimale
     params.calculateOptimalMaxResults();
     
-    auto stars = pImpl_->catalogManager.queryStars(params, true);
+    auto stars = pImpl_->catalogManager.queryStarBlock(params, true);
     
     // Aggiungi traccia asteroide
     if (chartConfig.showAsteroidPath) {
@@ -155,6 +222,14 @@ map::ImageBuffer OccultationChartBuilder::generateCustomChart(
         addInfoOverlay(mapConfig, chartConfig);
     }
     
+    // Riferimento apparente: stelle e overlay trasformati in blocco;
+    // altrimenti solo moto proprio, con il bersaglio che segue la sua stella
+    if (chartConfig.apparentPositions) {
+        toApparentFrame(mapConfig, stars);
+    } else if (mapConfig.useObservationTime) {
+        toEventEpoch(mapConfig, stars);
+    }
+    
     // Crea renderer con configurazione aggiornata
     map::MapRenderer renderer(mapConfig);
     
@@ -305,6 +380,12 @@ map::MapConfiguration OccultationChartBuilder::createMapConfig(
     // Magnitudine limite
     mapConfig.limitingMagnitude = chartConfig.limitingMagnitude;
     
+    // Posizioni stellari all'istante dell'evento (moto proprio)
+    if (!pImpl_->event.circumstances.eventTime.empty()) {
+        mapConfig.useObservationTime = true;
+        mapConfig.observationTime = pImpl_->event.circumstances.eventTime;
+    }
+    
     // Orientamento
     mapConfig.northUp = chartConfig.northUp;
     mapConfig.eastLeft = chartConfig.eastLeft;
@@ -408,6 +489,82 @@ void OccultationChartBuilder::addInfoOverlay(
     // Per ora il titolo contiene già molte informazioni
 }
 
+bool OccultationChartBuilder::toEventEpoch(map::MapConfiguration& mapConfig,
+                                           core::StarBlock& stars) {
+    // Istante non valido: lo segnala il renderer, che disegna all'epoca del catalogo
+    auto epoch = core::EpochPropagation::parseEpoch(mapConfig.observationTime);
+    if (!epoch) return false;
+    
+    // Stesso moto proprio del renderer, applicato qui per spostare anche
+    // centro e marker del bersaglio (vedi toApparentFrame)
+    auto [shiftRA, shiftDec] = pImpl_->propagateWithTarget(stars, *epoch);
+    mapConfig.useObservationTime = false;
+    
+    auto moveTarget = [shiftRA = shiftRA, shiftDec = shiftDec](double ra, double dec) {
+        return core::EquatorialCoordinates(std::fmod(ra + shiftRA + 360.0, 360.0), dec + shiftDec);
+    };
+    mapConfig.center = moveTarget(mapConfig.center.getRightAscension(),
+                                  mapConfig.center.getDeclination());
+    for (auto& rect : mapConfig.overlayRectangles) {
+        if (rect.label != "TARGET") continue;
+        auto center = moveTarget(rect.centerRA, rect.centerDec);
+        rect.centerRA = center.getRightAscension();
+        rect.centerDec = center.getDeclination();
+    }
+    return true;
+}
+
+bool OccultationChartBuilder::toApparentFrame(map::MapConfiguration& mapConfig,
+                                              core::StarBlock& stars) {
+    const std::string& eventTime = pImpl_->event.circumstances.eventTime;
+    auto place = core::ApparentPlace::at(eventTime);
+    if (!place) {
+        std::cerr << "Posizioni apparenti non calcolabili: istante dell'evento non valido '"
+                  << eventTime << "'\n";
+        return false;
+    }
+    
+    // Moto proprio nel riferimento del catalogo, poi una sola matrice per
+    // tutte le stelle; il renderer non deve propagare una seconda volta
+    auto [shiftRA, shiftDec] = pImpl_->propagateWithTarget(stars, place->epoch());
+    auto moveTarget = [&, shiftRA = shiftRA, shiftDec = shiftDec](double ra, double dec) {
+        ra = std::fmod(ra + shiftRA + 360.0, 360.0);
+        return place->apply(core::EquatorialCoordinates(ra, dec + shiftDec));
+    };
+    
+    place->apply(stars);
+    mapConfig.useObservationTime = false;
+    
+    // Centro sulla stella target (vedi createMapConfig)
+    mapConfig.center = moveTarget(mapConfig.center.getRightAscension(),
+                                  mapConfig.center.getDeclination());
+    
+    for (auto& rect : mapConfig.overlayRectangles) {
+        auto center = rect.label == "TARGET"
+            ? moveTarget(rect.centerRA, rect.centerDec)
+            : place->apply(core::EquatorialCoordinates(rect.centerRA, rect.centerDec));
+        rect.centerRA = center.getRightAscension();
+        rect.centerDec = center.getDeclination();
+    }
+    
+    for (auto& path : mapConfig.overlayPaths) {
+        std::vector<double> ra, dec;
+        ra.reserve(path.points.size());
+        dec.reserve(path.points.size());
+        for (const auto& pt : path.points) {
+            ra.push_back(pt.ra);
+            dec.push_back(pt.dec);
+        }
+        place->apply(ra.data(), dec.data(), ra.size());
+        for (size_t i = 0; i < path.points.size(); ++i) {
+            path.points[i].ra = ra[i];
+            path.points[i].dec = dec[i];
+        }
+    }
+    
+    return true;
+}
+
 std::string OccultationChartBuilder::generateAutoFilename(ChartType type) const {
     return utils::generateFilename(pImpl_->event, type);
 }
@@ -0,0 +1,572 @@
+#include "starmap/utils/AsyncHttpEngine.h"
+#include "starmap/utils/HttpCache.h"
+#include "starmap/utils/HttpClient.h"
+#include <curl/curl.h>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace starmap {
+namespace utils {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Attesa massima del thread quando non ci sono eventi (le submit lo svegliano)
+constexpr int IDLE_POLL_MS = 1000;
+
+// Header della risposta con nomi in minuscolo (come HttpClient)
+size_t collectHeader(char* buffer, size_t size, size_t nitems, void* userp) {
+    auto* headers = static_cast<std::map<std::string, std::string>*>(userp);
+    std::string line(buffer, size * nitems);
+
+    // Con i redirect arrivano più risposte: valgono gli header dell'ultima
+    if (line.compare(0, 5, "HTTP/") == 0) {
+        headers->clear();
+        return size * nitems;
+    }
+
+    size_t colon = line.find(':');
+    if (colon != std::string::npos) {
+        std::string name = line.substr(0, colon);
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        size_t begin = line.find_first_not_of(" \t", colon + 1);
+        size_t end = line.find_last_not_of(" \t\r\n");
+        (*headers)[name] = (begin == std::string::npos || end < begin)
+            ? "" : line.substr(begin, end - begin + 1);
+    }
+    return size * nitems;
+}
+
+/**
+ * @brief Nome dell'host di un URL (minuscolo, senza credenziali né porta)
+ */
+std::string hostOf(const std::string& url) {
+    size_t start = url.find("://");
+    start = (start == std::string::npos) ? 0 : start + 3;
+    size_t end = url.find_first_of("/?#", start);
+    std::string authority = url.substr(start, end == std::string::npos ? std::string::npos : end - start);
+
+    size_t at = authority.rfind('@');
+    if (at != std::string::npos) authority.erase(0, at + 1);
+
+    if (!authority.empty() && authority[0] == '[') {
+        size_t close = authority.find(']');
+        authority = authority.substr(0, close == std::string::npos ? std::string::npos : close + 1);
+    } else {
+        size_t colon = authority.find(':');
+        if (colon != std::string::npos) authority.erase(colon);
+    }
+
+    std::transform(authority.begin(), authority.end(), authority.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return authority;
+}
+
+// Un'eccezione per future: i future possono essere letti da thread diversi
+std::exception_ptr stoppedError() {
+    return std::make_exception_ptr(std::runtime_error("HTTP engine stopped"));
+}
+
+} // namespace
+
+class AsyncHttpEngine::Impl {
+public:
+    using Completion = std::function<void(HttpResponse&&, std::exception_ptr)>;
+
+    /**
+     * @brief Stato di una richiesta dalla submit() al completamento
+     */
+    struct Transfer {
+        HttpRequest request;
+        HttpResponse response;
+        std::string host;
+        std::string cacheKey;
+        std::optional<HttpCacheEntry> cached;   // Copia scaduta da rivalidare
+        Completion complete;
+        CURL* easy = nullptr;
+        curl_slist* headerList = nullptr;
+        bool rateLimited = false;
+        size_t streamed = 0;                    // Byte già passati a onData
+    };
+
+    /**
+     * @brief Token bucket di un host (capacità = un secondo di richieste)
+     */
+    struct Bucket {
+        double tokens = 0.0;
+        Clock::time_point last;
+        bool initialized = false;
+    };
+
+    explicit Impl(const AsyncHttpOptions& options) : options_(options) {
+        options_.maxInFlight = std::max<size_t>(1, options_.maxInFlight);
+        options_.maxConnectionsPerHost = std::max<size_t>(1, options_.maxConnectionsPerHost);
+
+        HttpClient::globalInit();
+        multi_ = curl_multi_init();
+        share_ = curl_share_init();
+        if (!multi_ || !share_) {
+            if (multi_) curl_multi_cleanup(multi_);
+            if (share_) curl_share_cleanup(share_);
+            throw std::runtime_error("Failed to initialize CURL multi");
+        }
+
+        // Connessioni riusate tra le richieste; con HTTP/2 più richieste
+        // allo stesso host condividono una connessione
+        curl_multi_setopt(multi_, CURLMOPT_MAX_TOTAL_CONNECTIONS, static_cast<long>(options_.maxInFlight));
+        curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, static_cast<long>(options_.maxConnectionsPerHost));
+        curl_multi_setopt(multi_, CURLMOPT_MAXCONNECTS, static_cast<long>(options_.maxInFlight));
+        curl_multi_setopt(multi_, CURLMOPT_PIPELINING, options_.http2 ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING);
+
+        // Sessioni TLS e DNS condivisi tra gli handle easy. Lo share è usato
+        // solo dal thread del motore: non servono callback di lock
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+
+        thread_ = std::thread([this] { run(); });
+    }
+
+    ~Impl() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+            curl_multi_wakeup(multi_);
+        }
+        thread_.join();
+
+        for (CURL* easy : idleHandles_) curl_easy_cleanup(easy);
+        curl_multi_cleanup(multi_);
+        curl_share_cleanup(share_);
+    }
+
+    void enqueue(HttpRequest request, Completion complete) {
+        auto transfer = std::make_unique<Transfer>();
+        transfer->host = hostOf(request.url);
+        transfer->complete = std::move(complete);
+
+        // Risposta ancora valida: nessun trasferimento
+        auto cache = request.cache;
+        if (cache && cache->isEnabled() && request.method == "GET") {
+            transfer->cacheKey = HttpCache::normalizeKey(request.method, request.url);
+            transfer->cached = cache->lookup(transfer->cacheKey);
+            if (transfer->cached && transfer->cached->isFresh(HttpCache::now())) {
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    stats_.submitted++;
+                    stats_.cacheHits++;
+                }
+                HttpResponse response;
+                response.status = 200;
+                response.body = std::move(transfer->cached->body);
+                response.fromCache = true;
+                if (!stream(*transfer, request, response)) return;
+                transfer->complete(std::move(response), nullptr);
+                return;
+            }
+            if (transfer->cached) {
+                HttpCache::addConditionalHeaders(*transfer->cached, request.headers);
+            }
+        } else {
+            request.cache.reset();
+        }
+        transfer->request = std::move(request);
+
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stopping_) {
+            lock.unlock();
+            transfer->complete(HttpResponse(), stoppedError());
+            return;
+        }
+        incoming_.push_back(std::move(transfer));
+        stats_.submitted++;
+        // Sotto lock: il distruttore non può chiudere l'handle multi nel frattempo
+        curl_multi_wakeup(multi_);
+    }
+
+    /**
+     * @brief Passa a onData un corpo completo (risposta servita dalla cache)
+     * @return false se onData ha rifiutato i dati (la richiesta è già completata con errore)
+     */
+    bool stream(Transfer& transfer, const HttpRequest& request, HttpResponse& response) {
+        if (!request.onData) return true;
+        std::string body = std::move(response.body);
+        response.body.clear();
+        if (!body.empty() && !request.onData(body.data(), body.size())) {
+            fail(transfer, "Response rejected by data handler");
+            return false;
+        }
+        return true;
+    }
+
+    void setHostRateLimit(const std::string& host, double requestsPerSecond) {
+        std::string name = host;
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        std::lock_guard<std::mutex> lock(mutex_);
+        hostRates_[name] = std::max(0.0, requestsPerSecond);
+    }
+
+    AsyncHttpStatistics getStatistics() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+    const AsyncHttpOptions& getOptions() const { return options_; }
+
+private:
+    void run() {
+        std::deque<std::unique_ptr<Transfer>> pending;
+        std::unordered_map<CURL*, std::unique_ptr<Transfer>> active;
+
+        for (;;) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                while (!incoming_.empty()) {
+                    pending.push_back(std::move(incoming_.front()));
+                    incoming_.pop_front();
+                }
+                if (stopping_) break;
+            }
+
+            // Avvio in ordine di arrivo; le richieste di un host oltre il
+            // limite restano in coda senza bloccare quelle degli altri host
+            int waitMs = IDLE_POLL_MS;
+            Clock::time_point now = Clock::now();
+            for (auto it = pending.begin(); it != pending.end() && active.size() < options_.maxInFlight;) {
+                double delay = takeToken((*it)->host, now);
+                if (delay > 0.0) {
+                    if (!(*it)->rateLimited) {
+                        (*it)->rateLimited = true;
+                        std::lock_guard<std::mutex> lock(mutex_);
+                        stats_.rateLimited++;
+                    }
+                    waitMs = std::min(waitMs, std::max(1, static_cast<int>(std::ceil(delay * 1000.0))));
+                    ++it;
+                    continue;
+                }
+
+                std::unique_ptr<Transfer> transfer = std::move(*it);
+                it = pending.erase(it);
+                if (start(*transfer)) {
+                    CURL* easy = transfer->easy;
+                    active.emplace(easy, std::move(transfer));
+                }
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stats_.queued = pending.size() + incoming_.size();
+                stats_.inFlight = active.size();
+                stats_.peakInFlight = std::max(stats_.peakInFlight, active.size());
+            }
+
+            int running = 0;
+            curl_multi_perform(multi_, &running);
+
+            bool finished = false;
+            int remaining = 0;
+            while (CURLMsg* message = curl_multi_info_read(multi_, &remaining)) {
+                if (message->msg != CURLMSG_DONE) continue;
+                auto node = active.find(message->easy_handle);
+                if (node == active.end()) continue;
+                std::unique_ptr<Transfer> transfer = std::move(node->second);
+                active.erase(node);
+                finish(*transfer, message->data.result);
+                finished = true;
+            }
+
+            // Posti liberati: avvia subito le richieste in coda
+            if (finished && !pending.empty()) continue;
+
+            curl_multi_poll(multi_, nullptr, 0, waitMs, nullptr);
+        }
+
+        // Arresto: le richieste non completate ricevono un errore
+        for (auto& [easy, transfer] : active) {
+            release(*transfer);
+            transfer->complete(HttpResponse(), stoppedError());
+        }
+        for (auto& transfer : pending) {
+            transfer->complete(HttpResponse(), stoppedError());
+        }
+    }
+
+    /**
+     * @brief Consuma un token dell'host
+     * @return 0 se la richiesta può partire, altrimenti secondi di attesa
+     */
+    double takeToken(const std::string& host, Clock::time_point now) {
+        double rate = options_.requestsPerSecondPerHost;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = hostRates_.find(host);
+            if (it != hostRates_.end()) rate = it->second;
+        }
+        if (rate <= 0.0) return 0.0;
+
+        double capacity = std::max(1.0, rate);
+        Bucket& bucket = buckets_[host];
+        if (!bucket.initialized) {
+            bucket.tokens = capacity;
+            bucket.last = now;
+            bucket.initialized = true;
+        }
+        double elapsed = std::chrono::duration<double>(now - bucket.last).count();
+        bucket.tokens = std::min(capacity, bucket.tokens + elapsed * rate);
+        bucket.last = now;
+
+        if (bucket.tokens >= 1.0) {
+            bucket.tokens -= 1.0;
+            return 0.0;
+        }
+        return (1.0 - bucket.tokens) / rate;
+    }
+
+    bool start(Transfer& transfer) {
+        CURL* easy = nullptr;
+        if (!idleHandles_.empty()) {
+            easy = idleHandles_.back();
+            idleHandles_.pop_back();
+            curl_easy_reset(easy);
+        } else {
+            easy = curl_easy_init();
+        }
+        if (!easy) {
+            fail(transfer, "Failed to initialize CURL");
+            return false;
+        }
+        transfer.easy = easy;
+
+        const HttpRequest& request = transfer.request;
+        long timeout = request.timeoutSeconds > 0 ? request.timeoutSeconds : options_.timeoutSeconds;
+
+        curl_easy_setopt(easy, CURLOPT_URL, request.url.c_str());
+        curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, &Impl::writeBody);
+        curl_easy_setopt(easy, CURLOPT_WRITEDATA, &transfer);
+        curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION, collectHeader);
+        curl_easy_setopt(easy, CURLOPT_HEADERDATA, &transfer.response.headers);
+        curl_easy_setopt(easy, CURLOPT_TIMEOUT, timeout);
+        curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+        curl_easy_setopt(easy, CURLOPT_SHARE, share_);
+        if (options_.http2) {
+            // HTTP/2 negoziato via ALPN; PIPEWAIT attende la prima connessione
+            // all'host per poterla multiplexare invece di aprirne altre
+            curl_easy_setopt(easy, CURLOPT_HTTP_VERSION, static_cast<long>(CURL_HTTP_VERSION_2TLS));
+            curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L);
+        }
+
+        for (const auto& [name, value] : request.headers) {
+            std::string header = name + ": " + value;
+            transfer.headerList = curl_slist_append(transfer.headerList, header.c_str());
+        }
+        if (transfer.headerList) {
+            curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer.headerList);
+        }
+
+        if (request.method == "POST") {
+            curl_easy_setopt(easy, CURLOPT_POSTFIELDSIZE, static_cast<long>(request.body.size()));
+            curl_easy_setopt(easy, CURLOPT_POSTFIELDS, request.body.c_str());
+        } else if (request.method != "GET") {
+            curl_easy_setopt(easy, CURLOPT_CUSTOMREQUEST, request.method.c_str());
+        }
+
+        if (curl_multi_add_handle(multi_, easy) != CURLM_OK) {
+            release(transfer);
+            fail(transfer, "Failed to start HTTP transfer");
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Callback di scrittura: corpo in HttpResponse::body o, per le
+     *        risposte 2xx con onData, direttamente al consumatore
+     */
+    static size_t writeBody(void* contents, size_t size, size_t nmemb, void* userp) {
+        auto& transfer = *static_cast<Transfer*>(userp);
+        const char* data = static_cast<const char*>(contents);
+        size_t length = size * nmemb;
+
+        if (transfer.request.onData) {
+            long status = 0;
+            curl_easy_getinfo(transfer.easy, CURLINFO_RESPONSE_CODE, &status);
+            if (status >= 200 && status < 300) {
+                // Con la cache il corpo serve anche per memorizzarlo
+                if (transfer.request.cache) transfer.response.body.append(data, length);
+                transfer.streamed += length;
+                return transfer.request.onData(data, length) ? length : 0;
+            }
+        }
+        transfer.response.body.append(data, length);
+        return length;
+    }
+
+    void finish(Transfer& transfer, CURLcode result) {
+        long status = 0;
+        long connects = 0;
+        curl_easy_getinfo(transfer.easy, CURLINFO_RESPONSE_CODE, &status);
+        curl_easy_getinfo(transfer.easy, CURLINFO_NUM_CONNECTS, &connects);
+        release(transfer);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.connections += static_cast<size_t>(connects);
+        }
+
+        if (result != CURLE_OK) {
+            // Servizio non raggiungibile: meglio una risposta scaduta che
+            // nessuna (se il consumatore non ha già ricevuto una parte del corpo)
+            if (transfer.cached && transfer.streamed == 0) {
+                HttpResponse response;
+                response.status = 200;
+                response.body = std::move(transfer.cached->body);
+                response.fromCache = true;
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    stats_.completed++;
+                }
+                if (!stream(transfer, transfer.request, response)) return;
+                transfer.complete(std::move(response), nullptr);
+                return;
+            }
+            fail(transfer, std::string("CURL error: ") + curl_easy_strerror(result));
+            return;
+        }
+
+        HttpResponse& response = transfer.response;
+        response.status = status;
+        if (transfer.request.cache) {
+            response.fromCache = transfer.request.cache->update(
+                transfer.cacheKey, transfer.cached, response.status, response.headers, response.body);
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.completed++;
+        }
+        if (transfer.request.onData && response.ok()) {
+            if (response.fromCache) {
+                if (!stream(transfer, transfer.request, response)) return;
+            } else {
+                response.body.clear();   // Già consegnato a onData
+            }
+        }
+        transfer.complete(std::move(response), nullptr);
+    }
+
+    /**
+     * @brief Stacca l'handle easy dal multi e lo conserva per le richieste successive
+     */
+    void release(Transfer& transfer) {
+        if (transfer.easy) {
+            curl_multi_remove_handle(multi_, transfer.easy);
+            if (idleHandles_.size() < options_.maxInFlight) {
+                idleHandles_.push_back(transfer.easy);
+            } else {
+                curl_easy_cleanup(transfer.easy);
+            }
+            transfer.easy = nullptr;
+        }
+        if (transfer.headerList) {
+            curl_slist_free_all(transfer.headerList);
+            transfer.headerList = nullptr;
+        }
+    }
+
+    void fail(Transfer& transfer, const std::string& message) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_.failed++;
+        }
+        transfer.complete(HttpResponse(), std::make_exception_ptr(std::runtime_error(message)));
+    }
+
+    AsyncHttpOptions options_;
+    CURLM* multi_ = nullptr;
+    CURLSH* share_ = nullptr;
+    std::thread thread_;
+
+    // Solo thread del motore
+    std::vector<CURL*> idleHandles_;
+    std::unordered_map<std::string, Bucket> buckets_;
+
+    mutable std::mutex mutex_;
+    std::deque<std::unique_ptr<Transfer>> incoming_;
+    std::unordered_map<std::string, double> hostRates_;
+    AsyncHttpStatistics stats_;
+    bool stopping_ = false;
+};
+
+AsyncHttpEngine::AsyncHttpEngine(const AsyncHttpOptions& options)
+    : pImpl_(std::make_unique<Impl>(options)) {
+}
+
+AsyncHttpEngine::~AsyncHttpEngine() = default;
+
+AsyncHttpEngine& AsyncHttpEngine::shared() {
+    static AsyncHttpEngine engine;
+    return engine;
+}
+
+std::future<HttpResponse> AsyncHttpEngine::submit(HttpRequest request) {
+    auto promise = std::make_shared<std::promise<HttpResponse>>();
+    std::future<HttpResponse> future = promise->get_future();
+    pImpl_->enqueue(std::move(request), [promise](HttpResponse&& response, std::exception_ptr error) {
+        if (error) {
+            promise->set_exception(error);
+        } else {
+            promise->set_value(std::move(response));
+        }
+    });
+    return future;
+}
+
+std::future<std::string> AsyncHttpEngine::get(const std::string& url,
+                                              const std::map<std::string, std::string>& headers,
+                                              std::shared_ptr<HttpCache> cache) {
+    HttpRequest request;
+    request.url = url;
+    request.headers = headers;
+    request.cache = std::move(cache);
+
+    auto promise = std::make_shared<std::promise<std::string>>();
+    std::future<std::string> future = promise->get_future();
+    pImpl_->enqueue(std::move(request), [promise](HttpResponse&& response, std::exception_ptr error) {
+        if (error) {
+            promise->set_exception(error);
+        } else if (response.status >= 400) {
+            promise->set_exception(std::make_exception_ptr(
+                std::runtime_error("HTTP error: " + std::to_string(response.status))));
+        } else {
+            promise->set_value(std::move(response.body));
+        }
+    });
+    return future;
+}
+
+void AsyncHttpEngine::setHostRateLimit(const std::string& host, double requestsPerSecond) {
+    pImpl_->setHostRateLimit(host, requestsPerSecond);
+}
+
+AsyncHttpStatistics AsyncHttpEngine::getStatistics() const {
+    return pImpl_->getStatistics();
+}
+
+const AsyncHttpOptions& AsyncHttpEngine::getOptions() const {
+    return pImpl_->getOptions();
+}
+
+} // namespace utils
+} // namespace starmap
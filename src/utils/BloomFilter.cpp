@@ -0,0 +1,46 @@
+#include "starmap/utils/BloomFilter.h"
+#include <cmath>
+
+namespace starmap {
+namespace utils {
+
+void BlockedBloomFilter::build(const int64_t* keys, size_t count, size_t bitsPerKey) {
+    blocks_.clear();
+    count_ = count;
+    if (count == 0) return;
+
+    size_t bits = count * (bitsPerKey > 0 ? bitsPerKey : 1);
+    size_t numBlocks = (bits + 511) / 512;
+    blocks_.assign(numBlocks, Block{});
+
+    for (size_t k = 0; k < count; ++k) {
+        uint64_t h = hash(static_cast<uint64_t>(keys[k]));
+        Block& block = blocks_[blockIndex(h)];
+        uint32_t h2 = static_cast<uint32_t>(h);
+        for (int i = 0; i < WORDS_PER_BLOCK; ++i) {
+            block.words[i] |= bitMask(h2, i);
+        }
+    }
+}
+
+double BlockedBloomFilter::estimatedFalsePositiveRate() const {
+    if (blocks_.empty()) return 1.0;
+
+    // Il carico dei blocchi segue una Poisson di media n/blocchi:
+    // FPR = somma_j P(j) * (1 - (1 - 1/64)^j)^8
+    double lambda = static_cast<double>(count_) / blocks_.size();
+    int maxLoad = static_cast<int>(lambda * 4.0) + 64;
+
+    double fpr = 0.0;
+    double logFactorial = 0.0;
+    for (int j = 0; j <= maxLoad; ++j) {
+        if (j > 0) logFactorial += std::log(static_cast<double>(j));
+        double pj = std::exp(j * std::log(lambda) - lambda - logFactorial);
+        double wordHit = 1.0 - std::pow(1.0 - 1.0 / 64.0, j);
+        fpr += pj * std::pow(wordHit, WORDS_PER_BLOCK);
+    }
+    return fpr;
+}
+
+} // namespace utils
+} // namespace starmap
@@ -0,0 +1,516 @@
+#include "starmap/utils/HttpCache.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include <unistd.h>
+
+namespace starmap {
+namespace utils {
+
+namespace fs = std::filesystem;
+
+std::mutex HttpCache::registryMutex_;
+std::unordered_map<std::string, std::weak_ptr<HttpCache>> HttpCache::registry_;
+
+namespace {
+
+constexpr char ENTRY_MAGIC[8] = {'S', 'M', 'H', 'T', 'T', 'P', '0', '1'};
+constexpr const char* ENTRY_DIR_PREFIX = "http_v";
+constexpr const char* ENTRY_EXTENSION = ".http";
+
+// Dopo un'eviction lo spazio occupato scende a questa frazione del limite,
+// così le scritture successive non rimuovono un file alla volta
+constexpr double EVICTION_TARGET = 0.9;
+
+uint64_t fnv1a(const std::string& data) {
+    uint64_t hash = 0xCBF29CE484222325ULL;
+    for (unsigned char c : data) {
+        hash ^= c;
+        hash *= 0x100000001B3ULL;
+    }
+    return hash;
+}
+
+std::string toLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+/**
+ * @brief Decodifica percent-encoding e '+', poi comprime gli spazi
+ */
+std::string decodeComponent(const std::string& text) {
+    std::string decoded;
+    decoded.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (c == '+') {
+            decoded += ' ';
+        } else if (c == '%' && i + 2 < text.size() &&
+                   hexValue(text[i + 1]) >= 0 && hexValue(text[i + 2]) >= 0) {
+            decoded += static_cast<char>(hexValue(text[i + 1]) * 16 + hexValue(text[i + 2]));
+            i += 2;
+        } else {
+            decoded += c;
+        }
+    }
+
+    // Spazi, tab e a capo multipli contano come uno solo (formattazione ADQL)
+    std::string compact;
+    compact.reserve(decoded.size());
+    bool pendingSpace = false;
+    for (char c : decoded) {
+        if (std::isspace(static_cast<unsigned char>(c))) {
+            pendingSpace = !compact.empty();
+        } else {
+            if (pendingSpace) compact += ' ';
+            pendingSpace = false;
+            compact += c;
+        }
+    }
+    return compact;
+}
+
+std::string encodeComponent(const std::string& text) {
+    std::string encoded;
+    for (unsigned char c : text) {
+        if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+            encoded += static_cast<char>(c);
+        } else {
+            char hex[4];
+            std::snprintf(hex, sizeof(hex), "%%%02X", c);
+            encoded += hex;
+        }
+    }
+    return encoded;
+}
+
+/**
+ * @brief Parametri name=value decodificati e ordinati, ricodificati in forma canonica
+ */
+std::string normalizeParameters(const std::string& query) {
+    std::vector<std::pair<std::string, std::string>> params;
+    size_t start = 0;
+    while (start <= query.size()) {
+        size_t end = query.find('&', start);
+        if (end == std::string::npos) end = query.size();
+        std::string part = query.substr(start, end - start);
+        if (!part.empty()) {
+            size_t eq = part.find('=');
+            if (eq == std::string::npos) {
+                params.emplace_back(decodeComponent(part), "");
+            } else {
+                params.emplace_back(decodeComponent(part.substr(0, eq)),
+                                    decodeComponent(part.substr(eq + 1)));
+            }
+        }
+        start = end + 1;
+    }
+    std::stable_sort(params.begin(), params.end());
+
+    std::string result;
+    for (const auto& [name, value] : params) {
+        if (!result.empty()) result += '&';
+        result += encodeComponent(name) + '=' + encodeComponent(value);
+    }
+    return result;
+}
+
+template <typename T>
+void writeValue(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void writeString(std::ostream& out, const std::string& text) {
+    uint64_t size = text.size();
+    writeValue(out, size);
+    out.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+template <typename T>
+bool readValue(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+}
+
+bool readString(std::istream& in, std::string& text, uint64_t maxSize) {
+    uint64_t size = 0;
+    if (!readValue(in, size) || size > maxSize) return false;
+    text.resize(static_cast<size_t>(size));
+    return static_cast<bool>(in.read(&text[0], static_cast<std::streamsize>(size)));
+}
+
+} // namespace
+
+HttpCache::HttpCache(const std::string& directory, int64_t defaultTtlSeconds, size_t maxBytes)
+    : defaultTtl_(defaultTtlSeconds)
+    , maxBytes_(maxBytes) {
+
+    if (directory.empty()) return;
+
+    std::string name = ENTRY_DIR_PREFIX + std::to_string(FORMAT_VERSION);
+    entryDirectory_ = (fs::path(directory) / name).string();
+
+    std::error_code ec;
+    fs::create_directories(entryDirectory_, ec);
+    if (ec) {
+        std::cerr << "Cannot create HTTP cache directory " << entryDirectory_
+                  << ": " << ec.message() << std::endl;
+        return;
+    }
+    enabled_ = true;
+
+    // Le risposte salvate con formati precedenti non sono più leggibili
+    for (const auto& entry : fs::directory_iterator(directory, ec)) {
+        std::string entryName = entry.path().filename().string();
+        if (entry.is_directory() && entryName != name &&
+            entryName.compare(0, std::strlen(ENTRY_DIR_PREFIX), ENTRY_DIR_PREFIX) == 0) {
+            std::error_code removeError;
+            fs::remove_all(entry.path(), removeError);
+        }
+    }
+
+    scanDirectory();
+}
+
+std::shared_ptr<HttpCache> HttpCache::open(const std::string& directory) {
+    std::lock_guard<std::mutex> lock(registryMutex_);
+    auto cache = registry_[directory].lock();
+    if (!cache) {
+        cache = std::make_shared<HttpCache>(directory);
+        registry_[directory] = cache;
+    }
+    return cache;
+}
+
+int64_t HttpCache::now() {
+    return std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+std::string HttpCache::normalizeKey(const std::string& method, const std::string& url,
+                                    const std::string& body) {
+    std::string rest = url;
+
+    // Il frammento non viene inviato al server
+    size_t hash = rest.find('#');
+    if (hash != std::string::npos) rest.erase(hash);
+
+    std::string scheme;
+    size_t schemeEnd = rest.find("://");
+    if (schemeEnd != std::string::npos) {
+        scheme = toLower(rest.substr(0, schemeEnd));
+        rest = rest.substr(schemeEnd + 3);
+    }
+
+    size_t pathStart = rest.find_first_of("/?");
+    std::string host = toLower(rest.substr(0, pathStart));
+    rest = pathStart == std::string::npos ? "" : rest.substr(pathStart);
+
+    // Porta di default implicita
+    if (scheme == "http" && host.size() > 3 && host.compare(host.size() - 3, 3, ":80") == 0) {
+        host.erase(host.size() - 3);
+    } else if (scheme == "https" && host.size() > 4 && host.compare(host.size() - 4, 4, ":443") == 0) {
+        host.erase(host.size() - 4);
+    }
+
+    std::string path = rest;
+    std::string query;
+    size_t queryStart = rest.find('?');
+    if (queryStart != std::string::npos) {
+        path = rest.substr(0, queryStart);
+        query = rest.substr(queryStart + 1);
+    }
+    if (path.empty()) path = "/";
+
+    std::string key = toLower(method) + ' ' + scheme + "://" + host + path;
+    std::string params = normalizeParameters(query);
+    if (!params.empty()) key += '?' + params;
+    if (!body.empty()) key += '\n' + normalizeParameters(body);
+    return key;
+}
+
+std::string HttpCache::fileNameFor(const std::string& key) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx%s",
+                  static_cast<unsigned long long>(fnv1a(key)), ENTRY_EXTENSION);
+    return name;
+}
+
+std::string HttpCache::pathFor(const std::string& key) const {
+    return (fs::path(entryDirectory_) / fileNameFor(key)).string();
+}
+
+void HttpCache::scanDirectory() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    files_.clear();
+    diskUsage_ = 0;
+
+    // L'ordine d'uso tra un'esecuzione e l'altra si ricava dalla data di
+    // modifica dei file
+    std::vector<std::tuple<fs::file_time_type, std::string, size_t>> found;
+    std::error_code ec;
+    for (const auto& entry : fs::directory_iterator(entryDirectory_, ec)) {
+        if (!entry.is_regular_file() || entry.path().extension() != ENTRY_EXTENSION) continue;
+
+        std::error_code infoError;
+        size_t size = static_cast<size_t>(entry.file_size(infoError));
+        if (infoError) continue;
+        auto mtime = fs::last_write_time(entry.path(), infoError);
+        if (infoError) mtime = fs::file_time_type::min();
+        found.emplace_back(mtime, entry.path().filename().string(), size);
+    }
+    std::sort(found.begin(), found.end());
+
+    for (const auto& [mtime, name, size] : found) {
+        files_[name] = {size, ++accessClock_};
+        diskUsage_ += size;
+    }
+    evictLocked();
+}
+
+std::optional<HttpCacheEntry> HttpCache::lookup(const std::string& key) {
+    if (!enabled_) return std::nullopt;
+
+    std::string fileName = fileNameFor(key);
+    std::string path = pathFor(key);
+    size_t maxBody;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        maxBody = maxBytes_;
+    }
+
+    HttpCacheEntry entry;
+    bool found = false;
+    {
+        std::ifstream in(path, std::ios::binary);
+        char magic[sizeof(ENTRY_MAGIC)];
+        std::string storedKey;
+        if (in && in.read(magic, sizeof(magic)) &&
+            std::memcmp(magic, ENTRY_MAGIC, sizeof(magic)) == 0 &&
+            readValue(in, entry.storedAt) && readValue(in, entry.expiresAt) &&
+            readString(in, storedKey, 1 << 20) &&
+            readString(in, entry.etag, 1 << 16) &&
+            readString(in, entry.lastModified, 1 << 16) &&
+            readString(in, entry.body, maxBody)) {
+            // Stesso hash ma richiesta diversa: è un miss
+            found = (storedKey == key);
+        }
+    }
+
+    int64_t current = now();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!found) {
+        stats_.misses++;
+        return std::nullopt;
+    }
+
+    auto it = files_.find(fileName);
+    if (it != files_.end()) it->second.lastAccess = ++accessClock_;
+
+    if (entry.isFresh(current)) {
+        stats_.hits++;
+    } else {
+        stats_.stale++;
+    }
+    return entry;
+}
+
+bool HttpCache::store(const std::string& key, const HttpCacheEntry& entry) {
+    if (!enabled_) return false;
+
+    // Una risposta più grande dell'intera cache non viene memorizzata
+    size_t estimatedSize = entry.body.size() + key.size() + entry.etag.size() +
+                           entry.lastModified.size() + 64;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (estimatedSize > maxBytes_) return false;
+    }
+
+    // File temporaneo univoco e rename: i lettori vedono sempre una
+    // risposta completa
+    std::string path = pathFor(key);
+    std::ostringstream tmpName;
+    tmpName << path << ".tmp." << getpid() << "." << std::hash<std::thread::id>()(std::this_thread::get_id());
+    std::string tmpPath = tmpName.str();
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "Cannot create HTTP cache file: " << tmpPath << std::endl;
+            return false;
+        }
+        out.write(ENTRY_MAGIC, sizeof(ENTRY_MAGIC));
+        writeValue(out, entry.storedAt);
+        writeValue(out, entry.expiresAt);
+        writeString(out, key);
+        writeString(out, entry.etag);
+        writeString(out, entry.lastModified);
+        writeString(out, entry.body);
+        if (!out) {
+            std::cerr << "Error writing HTTP cache file: " << tmpPath << std::endl;
+            std::remove(tmpPath.c_str());
+            return false;
+        }
+    }
+
+    std::error_code ec;
+    size_t size = static_cast<size_t>(fs::file_size(tmpPath, ec));
+    if (ec || std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        std::cerr << "Cannot rename HTTP cache file: " << tmpPath << std::endl;
+        std::remove(tmpPath.c_str());
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto& info = files_[fileNameFor(key)];
+    diskUsage_ -= info.size;
+    info = {size, ++accessClock_};
+    diskUsage_ += size;
+    stats_.stores++;
+    evictLocked();
+    return true;
+}
+
+bool HttpCache::revalidated(const std::string& key, HttpCacheEntry entry, int64_t expiresAt) {
+    entry.expiresAt = expiresAt;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.revalidated++;
+    }
+    return store(key, entry);
+}
+
+void HttpCache::addConditionalHeaders(const HttpCacheEntry& entry,
+                                      std::map<std::string, std::string>& headers) {
+    if (!entry.etag.empty()) headers["If-None-Match"] = entry.etag;
+    if (!entry.lastModified.empty()) headers["If-Modified-Since"] = entry.lastModified;
+}
+
+bool HttpCache::update(const std::string& key, const std::optional<HttpCacheEntry>& cached,
+                       long& status, const std::map<std::string, std::string>& headers,
+                       std::string& body) {
+    int64_t current = now();
+    if (status == 304 && cached) {
+        auto expiry = expiryFor(headers, current);
+        revalidated(key, *cached, expiry.value_or(current));
+        status = 200;
+        body = cached->body;
+        return true;
+    }
+
+    // Servizio in errore: meglio una risposta scaduta che nessuna
+    if (status >= 500 && cached) {
+        status = 200;
+        body = cached->body;
+        return true;
+    }
+
+    if (status >= 200 && status < 300) {
+        if (auto expiry = expiryFor(headers, current)) {
+            HttpCacheEntry entry;
+            entry.body = body;
+            entry.storedAt = current;
+            entry.expiresAt = *expiry;
+            auto etag = headers.find("etag");
+            if (etag != headers.end()) entry.etag = etag->second;
+            auto lastModified = headers.find("last-modified");
+            if (lastModified != headers.end()) entry.lastModified = lastModified->second;
+            store(key, entry);
+        }
+    }
+    return false;
+}
+
+std::optional<int64_t> HttpCache::expiryFor(const std::map<std::string, std::string>& headers,
+                                            int64_t now) const {
+    int64_t ttl;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ttl = defaultTtl_;
+    }
+
+    auto it = headers.find("cache-control");
+    if (it != headers.end()) {
+        std::string value = toLower(it->second);
+        if (value.find("no-store") != std::string::npos) return std::nullopt;
+
+        // max-age del server al posto del TTL di default; no-cache = sempre da rivalidare
+        size_t pos = value.find("max-age=");
+        if (pos != std::string::npos) {
+            ttl = std::strtoll(value.c_str() + pos + 8, nullptr, 10);
+        } else if (value.find("no-cache") != std::string::npos) {
+            ttl = 0;
+        }
+    }
+    return now + std::max<int64_t>(0, ttl);
+}
+
+void HttpCache::evictLocked() {
+    if (diskUsage_ <= maxBytes_) return;
+
+    std::vector<std::pair<uint64_t, std::string>> byAge;
+    byAge.reserve(files_.size());
+    for (const auto& [name, info] : files_) {
+        byAge.emplace_back(info.lastAccess, name);
+    }
+    std::sort(byAge.begin(), byAge.end());
+
+    size_t target = static_cast<size_t>(maxBytes_ * EVICTION_TARGET);
+    for (const auto& [lastAccess, name] : byAge) {
+        if (diskUsage_ <= target) break;
+        std::error_code ec;
+        fs::remove(fs::path(entryDirectory_) / name, ec);
+        diskUsage_ -= files_[name].size;
+        files_.erase(name);
+        stats_.evictions++;
+    }
+}
+
+void HttpCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (const auto& [name, info] : files_) {
+        std::error_code ec;
+        fs::remove(fs::path(entryDirectory_) / name, ec);
+    }
+    files_.clear();
+    diskUsage_ = 0;
+}
+
+void HttpCache::setDefaultTtl(int64_t seconds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    defaultTtl_ = seconds;
+}
+
+void HttpCache::setMaxBytes(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    maxBytes_ = bytes;
+    evictLocked();
+}
+
+HttpCacheStatistics HttpCache::getStatistics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    HttpCacheStatistics stats = stats_;
+    stats.entries = files_.size();
+    stats.diskUsage = diskUsage_;
+    stats.maxBytes = maxBytes_;
+    return stats;
+}
+
+} // namespace utils
+} // namespace starmap
@@ -1,5 +1,10 @@
 #include "starmap/utils/HttpClient.h"
+#include "starmap/utils/HttpCache.h"
 #include <curl/curl.h>
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <mutex>
 #include <stdexcept>
 #include <memory>
 
@@ -12,34 +17,130 @@ static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* use
     return size * nmemb;
 }
 
-class HttpClient::Impl {
-public:
-    Impl() : timeout_(30L) {
-        curl_global_init(CURL_GLOBAL_DEFAULT);
-        curl_ = curl_easy_init();
-        if (!curl_) {
+// curl_global_init non è thread-safe: eseguita una sola volta per processo
+static std::once_flag curlGlobalInit;
+
+/**
+ * @brief Handle CURL del thread corrente (creato al primo uso, chiuso all'uscita del thread)
+ *
+ * Un handle easy non può essere usato da due thread insieme: ogni thread
+ * ha il proprio, condiviso da tutti gli HttpClient e riusato tra le
+ * richieste (connessioni e DNS restano in cache).
+ */
+static CURL* threadHandle() {
+    struct Handle {
+        CURL* curl = nullptr;
+        ~Handle() {
+            if (curl) curl_easy_cleanup(curl);
+        }
+    };
+    thread_local Handle handle;
+    
+    if (!handle.curl) {
+        HttpClient::globalInit();
+        handle.curl = curl_easy_init();
+        if (!handle.curl) {
             throw std::runtime_error("Failed to initialize CURL");
         }
+    } else {
+        // Le opzioni della richiesta precedente non devono restare attive
+        curl_easy_reset(handle.curl);
     }
+    return handle.curl;
+}
 
-    ~Impl() {
-        if (curl_) {
-            curl_easy_cleanup(curl_);
-        }
-        curl_global_cleanup();
+// Callback per raccogliere gli header della risposta (nomi in minuscolo)
+static size_t HeaderCallback(char* buffer, size_t size, size_t nitems, void* userp) {
+    auto* headers = static_cast<std::map<std::string, std::string>*>(userp);
+    std::string line(buffer, size * nitems);
+    
+    // Con i redirect arrivano più risposte: valgono gli header dell'ultima
+    if (line.compare(0, 5, "HTTP/") == 0) {
+        headers->clear();
+        return size * nitems;
+    }
+    
+    size_t colon = line.find(':');
+    if (colon != std::string::npos) {
+        std::string name = line.substr(0, colon);
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        size_t begin = line.find_first_not_of(" \t", colon + 1);
+        size_t end = line.find_last_not_of(" \t\r\n");
+        (*headers)[name] = (begin == std::string::npos || end < begin)
+            ? "" : line.substr(begin, end - begin + 1);
     }
+    return size * nitems;
+}
+
+class HttpClient::Impl {
+public:
+    Impl() : timeout_(30L) {}
+
+    /**
+     * @brief Risposta di una singola richiesta
+     */
+    struct Response {
+        long status = 0;
+        std::string body;
+        std::map<std::string, std::string> headers;
+    };
 
     std::string performRequest(const std::string& url, 
                               const std::string& method,
                               const std::string& postData,
                               const std::map<std::string, std::string>& headers) {
-        std::string response;
+        // Solo le GET passano dalla cache
+        auto cache = std::atomic_load(&cache_);
+        if (!cache || !cache->isEnabled() || method != "GET") {
+            Response response = transfer(url, method, postData, headers);
+            checkStatus(response.status);
+            return std::move(response.body);
+        }
+        
+        std::string key = HttpCache::normalizeKey(method, url);
+        auto cached = cache->lookup(key);
+        if (cached && cached->isFresh(HttpCache::now())) {
+            return std::move(cached->body);
+        }
+        
+        // Risposta scaduta: richiesta condizionale se il server aveva
+        // fornito ETag o Last-Modified
+        auto requestHeaders = headers;
+        if (cached) HttpCache::addConditionalHeaders(*cached, requestHeaders);
+        
+        Response response;
+        try {
+            response = transfer(url, method, postData, requestHeaders);
+        } catch (const std::exception&) {
+            // Servizio non raggiungibile: meglio una risposta scaduta che nessuna
+            if (cached) return std::move(cached->body);
+            throw;
+        }
         
-        curl_easy_setopt(curl_, CURLOPT_URL, url.c_str());
-        curl_easy_setopt(curl_, CURLOPT_WRITEFUNCTION, WriteCallback);
-        curl_easy_setopt(curl_, CURLOPT_WRITEDATA, &response);
-        curl_easy_setopt(curl_, CURLOPT_TIMEOUT, timeout_);
-        curl_easy_setopt(curl_, CURLOPT_FOLLOWLOCATION, 1L);
+        cache->update(key, cached, response.status, response.headers, response.body);
+        checkStatus(response.status);
+        return std::move(response.body);
+    }
+
+    /**
+     * @brief Esegue la richiesta sull'handle del thread corrente
+     */
+    Response transfer(const std::string& url,
+                      const std::string& method,
+                      const std::string& postData,
+                      const std::map<std::string, std::string>& headers) {
+        Response response;
+        CURL* curl = threadHandle();
+        
+        curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+        curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+        curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response.body);
+        curl_easy_setopt(curl, CURLOPT_HEADERFUNCTION, HeaderCallback);
+        curl_easy_setopt(curl, CURLOPT_HEADERDATA, &response.headers);
+        curl_easy_setopt(curl, CURLOPT_TIMEOUT, timeout_.load());
+        curl_easy_setopt(curl, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
         
         // Headers personalizzati
         struct curl_slist* headerList = nullptr;
@@ -49,15 +150,15 @@ public:
         }
         
         if (headerList) {
-            curl_easy_setopt(curl_, CURLOPT_HTTPHEADER, headerList);
+            curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headerList);
         }
         
         // POST data
         if (method == "POST" && !postData.empty()) {
-            curl_easy_setopt(curl_, CURLOPT_POSTFIELDS, postData.c_str());
+            curl_easy_setopt(curl, CURLOPT_POSTFIELDS, postData.c_str());
         }
         
-        CURLcode res = curl_easy_perform(curl_);
+        CURLcode res = curl_easy_perform(curl);
         
         if (headerList) {
             curl_slist_free_all(headerList);
@@ -68,23 +169,24 @@ public:
                                    curl_easy_strerror(res));
         }
         
-        long httpCode = 0;
-        curl_easy_getinfo(curl_, CURLINFO_RESPONSE_CODE, &httpCode);
-        
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response.status);
+        return response;
+    }
+
+    static void checkStatus(long httpCode) {
         if (httpCode >= 400) {
             throw std::runtime_error("HTTP error: " + std::to_string(httpCode));
         }
-        
-        return response;
     }
 
     void setTimeout(long seconds) {
         timeout_ = seconds;
     }
 
+    std::shared_ptr<HttpCache> cache_;
+
 private:
-    CURL* curl_;
-    long timeout_;
+    std::atomic<long> timeout_;
 };
 
 HttpClient::HttpClient() : pImpl_(new Impl()) {}
@@ -104,9 +206,21 @@ std::string HttpClient::post(const std::string& url,
     return pImpl_->performRequest(url, "POST", data, headers);
 }
 
+void HttpClient::globalInit() {
+    std::call_once(curlGlobalInit, [] { curl_global_init(CURL_GLOBAL_DEFAULT); });
+}
+
 void HttpClient::setTimeout(long seconds) {
     pImpl_->setTimeout(seconds);
 }
 
+void HttpClient::setCache(std::shared_ptr<HttpCache> cache) {
+    std::atomic_store(&pImpl_->cache_, std::move(cache));
+}
+
+std::shared_ptr<HttpCache> HttpClient::getCache() const {
+    return std::atomic_load(&pImpl_->cache_);
+}
+
 } // namespace utils
 } // namespace starmap
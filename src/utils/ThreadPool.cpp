@@ -0,0 +1,64 @@
+#include "starmap/utils/ThreadPool.h"
+#include <algorithm>
+
+namespace starmap {
+namespace utils {
+
+ThreadPool::ThreadPool(size_t numThreads, size_t maxQueued)
+    : maxQueued_(maxQueued) {
+    numThreads = std::max<size_t>(1, numThreads);
+    workers_.reserve(numThreads);
+    for (size_t i = 0; i < numThreads; ++i) {
+        workers_.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    taskAvailable_.notify_all();
+    spaceAvailable_.notify_all();
+
+    for (auto& worker : workers_) {
+        if (worker.joinable()) worker.join();
+    }
+}
+
+void ThreadPool::post(std::function<void()> task) {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (maxQueued_ > 0) {
+            spaceAvailable_.wait(lock, [this] { return queue_.size() < maxQueued_ || stopping_; });
+        }
+        queue_.push_back(std::move(task));
+    }
+    taskAvailable_.notify_one();
+}
+
+size_t ThreadPool::pending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            taskAvailable_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+
+            // In chiusura si svuota comunque la coda
+            if (queue_.empty()) return;
+
+            task = std::move(queue_.front());
+            queue_.pop_front();
+        }
+        spaceAvailable_.notify_one();
+        task();
+    }
+}
+
+} // namespace utils
+} // namespace starmap